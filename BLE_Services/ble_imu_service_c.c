@@ -31,7 +31,13 @@
 #include "ble_types.h"
 #include "ble_srv_common.h"
 #include "ble_gattc.h"
+#include "usr_gatt_sched.h"
+#include "usr_trace.h"
+#include "usr_latency.h"
+#include "usr_evlog.h"
+#include "settings.h"
 #define NRF_LOG_MODULE_NAME ble_imu_service_c
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_IMU_SERVICE
 #include "nrf_log.h"
 NRF_LOG_MODULE_REGISTER();
 
@@ -73,27 +79,7 @@ static tx_message_t m_tx_buffer[TX_BUFFER_SIZE];  /**< Transmit buffer for messa
 static uint32_t     m_tx_insert_index = 0;        /**< Current index in the transmit buffer where the next message should be inserted. */
 static uint32_t     m_tx_index = 0;               /**< Current index in the transmit buffer from where the next message to be transmitted resides. */
 
-
-/**@brief Function for intercepting errors of GATTC and BLE GATT Queue.
- *
- * @param[in] nrf_error   Error code.
- * @param[in] p_ctx       Parameter from the event handler.
- * @param[in] conn_handle Connection handle.
- */
-static void gatt_error_handler(uint32_t   nrf_error,
-                               void     * p_ctx,
-                               uint16_t   conn_handle)
-{
-    // ble_imu_service_c_t * p_tes_c = (ble_imu_service_c_t *)p_ctx;
-
-    NRF_LOG_INFO("A GATT Client error has occurred on conn_handle: 0X%X", conn_handle);
-
-    // if (p_tes_c->error_handler != NULL)
-    // {
-    //     p_tes_c->error_handler(nrf_error);
-    // }
-}
-
+STATIC_ASSERT(sizeof(ble_imu_service_config_t) <= USR_GATT_SCHED_VALUE_MAX_LEN);
 
 
 /**@brief Function for handling write response events.
@@ -133,41 +119,90 @@ static void on_hvx(ble_imu_service_c_t * p_ble_imu_service_c, ble_evt_t const *
     }
     
     ble_imu_service_c_evt_t ble_imu_service_c_evt;
+    ble_imu_service_c_evt_type_t evt_type;
+    uint16_t handle = p_ble_evt->evt.gattc_evt.params.hvx.handle;
+    uint16_t len    = p_ble_evt->evt.gattc_evt.params.hvx.len;
+    uint8_t const * p_data = p_ble_evt->evt.gattc_evt.params.hvx.data;
 
-    ble_imu_service_c_evt.conn_handle                = p_ble_imu_service_c->conn_handle;
-    
-    // Check if this is a Quaternion notification.
-    if (p_ble_evt->evt.gattc_evt.params.hvx.handle == p_ble_imu_service_c->peer_imu_service_db.quat_handle)
+    if (handle == p_ble_imu_service_c->peer_imu_service_db.quat_handle)
     {
-        ble_imu_service_c_evt.evt_type = BLE_IMU_SERVICE_EVT_QUAT;
-        ble_imu_service_c_evt.params.value.quat_data = *(ble_imu_service_quat_t *)p_ble_evt->evt.gattc_evt.params.hvx.data;
-    } 
-    // Check if this is a info notification.
-    else if (p_ble_evt->evt.gattc_evt.params.hvx.handle == p_ble_imu_service_c->peer_imu_service_db.info_handle)
+        evt_type = BLE_IMU_SERVICE_EVT_QUAT;
+    }
+    else if (handle == p_ble_imu_service_c->peer_imu_service_db.info_handle)
     {
-        ble_imu_service_c_evt.evt_type = BLE_IMU_SERVICE_EVT_INFO;
-        ble_imu_service_c_evt.params.value.info_data = *(ble_imu_service_info_t *)p_ble_evt->evt.gattc_evt.params.hvx.data;
+        evt_type = BLE_IMU_SERVICE_EVT_INFO;
     }
-    // Check if this is a Euler angle notification.
-    else if (p_ble_evt->evt.gattc_evt.params.hvx.handle == p_ble_imu_service_c->peer_imu_service_db.euler_handle)
+    else if (handle == p_ble_imu_service_c->peer_imu_service_db.euler_handle)
     {
-        ble_imu_service_c_evt.evt_type = BLE_IMU_SERVICE_EVT_EULER;
-        ble_imu_service_c_evt.params.value.euler_data = *(ble_imu_service_euler_t *)p_ble_evt->evt.gattc_evt.params.hvx.data;
+        evt_type = BLE_IMU_SERVICE_EVT_EULER;
     }
-    // Check if this is a Raw data notification.
-    else if (p_ble_evt->evt.gattc_evt.params.hvx.handle == p_ble_imu_service_c->peer_imu_service_db.raw_handle)
+    else if (handle == p_ble_imu_service_c->peer_imu_service_db.raw_handle)
     {
-        ble_imu_service_c_evt.evt_type = BLE_IMU_SERVICE_EVT_RAW;
-        ble_imu_service_c_evt.params.value.raw_data = *(ble_imu_service_raw_t *)p_ble_evt->evt.gattc_evt.params.hvx.data;
+        evt_type = BLE_IMU_SERVICE_EVT_RAW;
     }
-    else if (p_ble_evt->evt.gattc_evt.params.hvx.handle == p_ble_imu_service_c->peer_imu_service_db.adc_handle)
+    else if (handle == p_ble_imu_service_c->peer_imu_service_db.adc_handle)
     {
-        ble_imu_service_c_evt.evt_type = BLE_IMU_SERVICE_EVT_ADC;
-        ble_imu_service_c_evt.params.value.adc_data = *(ble_imu_service_adc_t *)p_ble_evt->evt.gattc_evt.params.hvx.data;
+        evt_type = BLE_IMU_SERVICE_EVT_ADC;
     }
     else return;
 
-    p_ble_imu_service_c->evt_handler(p_ble_imu_service_c, &ble_imu_service_c_evt);
+    // Frames built from this notification are timed from here, in the encoding task with FreeRTOS
+    #if (USR_FREERTOS == 0)
+    usr_latency_ingest_begin();
+    #endif
+
+    // Raw notification stream, before decoding
+    usr_trace_on_notif(p_ble_imu_service_c->conn_handle, evt_type, p_data, len);
+
+    if (ble_imu_service_c_notif_decode(evt_type, p_data, len, &ble_imu_service_c_evt) == NRF_SUCCESS)
+    {
+        ble_imu_service_c_evt.conn_handle = p_ble_imu_service_c->conn_handle;
+        p_ble_imu_service_c->evt_handler(p_ble_imu_service_c, &ble_imu_service_c_evt);
+    }
+
+    #if (USR_FREERTOS == 0)
+    usr_latency_ingest_end();
+    #endif
+}
+
+
+ret_code_t ble_imu_service_c_notif_decode(ble_imu_service_c_evt_type_t evt_type, uint8_t const * p_data, uint16_t len,
+                                          ble_imu_service_c_evt_t * p_evt)
+{
+    uint16_t size;
+
+    switch (evt_type)
+    {
+        case BLE_IMU_SERVICE_EVT_QUAT:
+            size = sizeof(ble_imu_service_quat_t);
+            break;
+        case BLE_IMU_SERVICE_EVT_INFO:
+            size = sizeof(ble_imu_service_info_t);
+            break;
+        case BLE_IMU_SERVICE_EVT_EULER:
+            size = sizeof(ble_imu_service_euler_t);
+            break;
+        case BLE_IMU_SERVICE_EVT_RAW:
+            size = sizeof(ble_imu_service_raw_t);
+            break;
+        case BLE_IMU_SERVICE_EVT_ADC:
+            size = sizeof(ble_imu_service_adc_t);
+            break;
+        default:
+            return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Notifications are truncated to ATT MTU - 3 when the MTU is smaller than negotiated for,
+    // drop those instead of copying past the received data
+    if (len < size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_evt->evt_type = evt_type;
+    memcpy(&p_evt->params.value, p_data, size);
+
+    return NRF_SUCCESS;
 }
 
 
@@ -372,25 +407,14 @@ static uint32_t cccd_configure_tes(ble_imu_service_c_t * p_ble_imu_service_c, ui
 {
     NRF_LOG_DEBUG("Configuring CCCD. CCCD Handle = %d, Connection Handle = %d", handle_cccd, conn_handle);
 
-    nrf_ble_gq_req_t tes_c_req;
     uint8_t          cccd[BLE_CCCD_VALUE_LEN];
     uint16_t         cccd_val = enable ? BLE_GATT_HVX_NOTIFICATION : 0;
 
     cccd[0] = LSB_16(cccd_val);
     cccd[1] = MSB_16(cccd_val);
 
-    memset(&tes_c_req, 0, sizeof(tes_c_req));
- 
-    tes_c_req.type                        = NRF_BLE_GQ_REQ_GATTC_WRITE;
-    tes_c_req.error_handler.cb            = gatt_error_handler;
-    tes_c_req.error_handler.p_ctx         = p_ble_imu_service_c;
-    tes_c_req.params.gattc_write.handle   = handle_cccd;
-    tes_c_req.params.gattc_write.len      = BLE_CCCD_VALUE_LEN;
-    tes_c_req.params.gattc_write.p_value  = cccd;
-    tes_c_req.params.gattc_write.offset   = 0;
-    tes_c_req.params.gattc_write.write_op = BLE_GATT_OP_WRITE_REQ;
-
-    return nrf_ble_gq_item_add(p_ble_imu_service_c->p_gatt_queue, &tes_c_req, conn_handle);
+    // Sent after pending configuration writes
+    return usr_gatt_sched_write(conn_handle, USR_GATT_PRIO_CCCD, handle_cccd, cccd, BLE_CCCD_VALUE_LEN);
 }
 
 
@@ -483,23 +507,9 @@ uint32_t ble_imu_service_config_set(ble_imu_service_c_t * p_imu_service, ble_imu
         return NRF_ERROR_INVALID_PARAM;
     }
 
-    nrf_ble_gq_req_t write_req;
-
-    memset(&write_req, 0, sizeof(nrf_ble_gq_req_t));
-
-    write_req.type                        = NRF_BLE_GQ_REQ_GATTC_WRITE;
-    write_req.error_handler.cb            = gatt_error_handler;
-    write_req.error_handler.p_ctx         = p_imu_service;
-    write_req.params.gattc_write.handle   = p_imu_service->peer_imu_service_db.config_handle;
-    write_req.params.gattc_write.len      = length;
-    write_req.params.gattc_write.offset   = 0;
-    write_req.params.gattc_write.p_value  = (uint8_t *)p_data;
-    write_req.params.gattc_write.write_op = BLE_GATT_OP_WRITE_REQ;
-    write_req.params.gattc_write.flags    = BLE_GATT_EXEC_WRITE_FLAG_PREPARED_WRITE;
-
-    ret_code_t err_code;
-    err_code =  nrf_ble_gq_item_add(p_imu_service->p_gatt_queue, &write_req, p_imu_service->conn_handle);
-    return err_code;
+    // Configuration (START, STOP, settings) goes before notification enables and battery reads
+    return usr_gatt_sched_write(p_imu_service->conn_handle, USR_GATT_PRIO_CONFIG,
+                                p_imu_service->peer_imu_service_db.config_handle, (uint8_t *)p_data, length);
 }
 
 uint32_t ble_imu_service_c_handles_assign(ble_imu_service_c_t    * p_ble_imu_service_c,
@@ -29,6 +29,7 @@
 #include "ble.h"
 #include "ble_db_discovery.h"
 #include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,6 +91,7 @@ NRF_SDH_BLE_OBSERVERS(_name ## _obs,
 
 // How many packets (QUAT - RAW) are grouped in a message
 #define BLE_PACKET_BUFFER_COUNT     5
+#define BLE_IMU_SERVICE_ADC_SAMPLES 40  // ADC (EMG) samples in one notification
 
 /**@brief ble_imu_service_c Client event type. */
 typedef enum
@@ -106,8 +108,8 @@ typedef enum
 
 typedef struct
 {
-    uint32_t raw[40];
-    uint32_t timestamp_ms;
+    uint32_t raw[BLE_IMU_SERVICE_ADC_SAMPLES];
+    uint32_t timestamp_ms;      // Time of the first sample
 }ble_imu_service_adc_t;
 
 typedef struct
@@ -319,6 +321,12 @@ uint32_t ble_imu_service_c_init(ble_imu_service_c_t * p_ble_imu_service_c, ble_i
  */
 void ble_imu_service_c_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
 
+// Decode a notification of characteristic evt_type into p_evt (conn_handle is not set).
+// Used for received notifications and for notifications replayed from a trace (usr_trace).
+// NRF_ERROR_INVALID_LENGTH when the notification is shorter than the characteristic.
+ret_code_t ble_imu_service_c_notif_decode(ble_imu_service_c_evt_type_t evt_type, uint8_t const * p_data, uint16_t len,
+                                          ble_imu_service_c_evt_t * p_evt);
+
 
 // Enable notifications from quaternions
 uint32_t ble_imu_service_c_quaternion_notif_enable(ble_imu_service_c_t * p_ble_imu_service_c);
@@ -0,0 +1,144 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_battery.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Battery level cache of the connected sensors
+ *
+ *               Levels are kept as the raw characteristic value and only
+ *               converted when they are reported.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_battery.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+#include "usr_frame.h"
+
+#define NRF_LOG_MODULE_NAME usr_battery_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static usr_battery_t m_battery[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static uint8_t m_reported_raw[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static usr_battery_report_handler_t m_report_handler = NULL;
+
+APP_TIMER_DEF(m_report_timer);
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_battery_observer, USR_BATTERY_OBSERVER_PRIO, on_ble_evt, NULL);
+
+
+static void report_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_report_handler != NULL)
+    {
+        m_report_handler();
+    }
+}
+
+static void report_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, report_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Battery report dropped: %d", err_code);
+    }
+}
+
+void usr_battery_init(usr_battery_report_handler_t report_handler)
+{
+    ret_code_t err_code;
+
+    m_report_handler = report_handler;
+
+    err_code = app_timer_create(&m_report_timer, APP_TIMER_MODE_REPEATED, report_timer_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+ret_code_t usr_battery_period_set(uint8_t period_s)
+{
+    ret_code_t err_code = app_timer_stop(m_report_timer);
+    if ((err_code != NRF_SUCCESS) || (period_s == 0))
+    {
+        return err_code;
+    }
+
+    return app_timer_start(m_report_timer, APP_TIMER_TICKS((uint32_t) period_s * 1000), NULL);
+}
+
+void usr_battery_update(uint16_t conn_handle, uint8_t raw)
+{
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    usr_battery_t * p_battery = &m_battery[conn_handle];
+    uint8_t percent = usr_frame_battery_percent(raw);
+    uint8_t delta = (raw > m_reported_raw[conn_handle]) ? (raw - m_reported_raw[conn_handle]) : (m_reported_raw[conn_handle] - raw);
+
+    if (!p_battery->valid || (percent != p_battery->percent) || (delta >= USR_BATTERY_HYSTERESIS))
+    {
+        p_battery->changed = true;
+    }
+
+    p_battery->raw = raw;
+    p_battery->percent = percent;
+    p_battery->valid = true;
+}
+
+ret_code_t usr_battery_get(uint16_t conn_handle, usr_battery_t * p_battery)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || !m_battery[conn_handle].valid)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_battery = m_battery[conn_handle];
+
+    return NRF_SUCCESS;
+}
+
+void usr_battery_reported(uint16_t conn_handle)
+{
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    m_battery[conn_handle].changed = false;
+    m_reported_raw[conn_handle] = m_battery[conn_handle].raw;
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+    if ((p_ble_evt->header.evt_id == BLE_GAP_EVT_DISCONNECTED) && (conn_handle < NRF_SDH_BLE_TOTAL_LINK_COUNT))
+    {
+        // The next sensor on this connection handle starts unknown
+        memset(&m_battery[conn_handle], 0, sizeof(usr_battery_t));
+        m_reported_raw[conn_handle] = 0;
+    }
+}
@@ -0,0 +1,66 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_battery.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Battery level cache of the connected sensors
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_BATTERY_H_
+#define _USR_BATTERY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#define USR_BATTERY_OBSERVER_PRIO   2
+
+// A level counts as changed when the percentage step changes or the raw value moved this much (~16 mV)
+#define USR_BATTERY_HYSTERESIS      3
+
+// Cached level of one link, converted with usr_frame_battery_mv / usr_frame_battery_percent
+typedef struct
+{
+    uint8_t raw;        // Battery level characteristic
+    uint8_t percent;
+    bool    valid;
+    bool    changed;    // Changed since it was last reported
+} usr_battery_t;
+
+// Called from the scheduler at the configured report period
+typedef void (*usr_battery_report_handler_t)(void);
+
+// Create the report timer, call after timer_init
+void usr_battery_init(usr_battery_report_handler_t report_handler);
+
+// Report the changed levels every period_s seconds, 0 stops it
+ret_code_t usr_battery_period_set(uint8_t period_s);
+
+// Battery level notification or read response
+void usr_battery_update(uint16_t conn_handle, uint8_t raw);
+
+// Cached level of a link, NRF_ERROR_NOT_FOUND when not known
+ret_code_t usr_battery_get(uint16_t conn_handle, usr_battery_t * p_battery);
+
+// The level of a link was reported, clears changed
+void usr_battery_reported(uint16_t conn_handle);
+
+#endif
@@ -31,8 +31,9 @@
 #include "nordic_common.h"
 
 // Logging
-
+#include "settings.h"
 #define NRF_LOG_MODULE_NAME usr_ble_c
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_BLE
 #include "nrf_log.h"
 NRF_LOG_MODULE_REGISTER();
 
@@ -62,6 +63,25 @@ NRF_LOG_MODULE_REGISTER();
 
 // Communication between nRF52 and STM32
 #include "usr_internal_comm.h"
+#include "usr_frame.h"
+
+// Bandwidth budget
+#include "usr_budget.h"
+
+// Connection parameter planner
+#include "usr_conn_params.h"
+#include "usr_link_negotiation.h"
+#include "usr_link_stats.h"
+#include "usr_reconnect.h"
+#include "usr_gatt_sched.h"
+#include "usr_battery.h"
+#include "usr_joint.h"
+#include "usr_prof.h"
+#include "usr_evlog.h"
+#include "nrf_atomic.h"
+#include "usr_evq.h"
+#include "usr_boot.h"
+#include "usr_warm.h"
 
 ///////////////////////////////////////////////
 
@@ -88,18 +108,11 @@ NRF_LOG_MODULE_REGISTER();
 // Defines //
 /////////////
 
-BATTERY_ARRAY batt_array;
-
 // Initialisation of IMU struct
 IMU imu = {
     .frequency = 0,
     .stop = 0,
     .sync_start_time = 0,
-    .received_packet_counter1 = 0,
-    .received_packet_counter2 = 0,
-    .received_packet_counter3 = 0,
-    .received_packet_counter4 = 0,
-    .evt_scheduled = 0,
     .uart_rx_evt_scheduled = 0,
     .uart = NRF_DRV_UART_INSTANCE(0),
     .wom = 0,
@@ -109,8 +122,6 @@ IMU imu = {
 // Initialisation of struct to keep track of different buffers
 BUFFER buffer;
 
-static char const *m_target_periph_name[NRF_BLE_SCAN_NAME_CNT] = {"IMU1", "IMU2", "IMU3", "IMU4"};
-
 static ble_gap_addr_t const address_init = {
     .addr_type = BLE_GAP_ADDR_TYPE_RANDOM_STATIC,
     .addr = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } // { 0xF2, 0x9C, 0x43, 0xE8, 0x5C, 0xD2 }
@@ -131,6 +142,36 @@ NRF_BLE_GQ_DEF(m_ble_gatt_queue, /**< BLE GATT Queue instance. */
 // Keep track of connected device conn_handles and IDs
 dcu_connected_devices_t dcu_conn_dev[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
 
+// Sensor specific measurement configuration, indexed like dcu_conn_dev
+static ble_imu_service_config_t m_sensor_config[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+// Sensors using m_sensor_config instead of the default configuration in imu
+static uint32_t m_sensor_config_mask = 0;
+
+#define TICKS_TO_MS(ticks)      ((uint32_t) (((uint64_t) (ticks) * 1000) / APP_TIMER_TICKS(1000)))
+
+// Scanning for the missing sensors of the device list, see usr_reconnect for the backoff
+static bool m_scanning = false;
+static bool m_scan_whitelist = false;
+
+// Measurement started with config_send(), sensors that (re)join get its configuration
+static bool m_meas_active = false;
+// Rejoined sensors whose configuration could not be sent yet, retried on the next GATTC event of the link
+static uint32_t m_rejoin_pending_mask = 0;
+static uint32_t m_rejoin_latency_ms[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+
+// Commissioning time, from set_conn_dev_mask() to all listed sensors connected
+// (measured with the app_timer counter, so up to 512 s)
+static bool m_commissioning = false;
+static uint32_t m_commissioning_start;
+static uint32_t m_commissioning_ms = 0;
+
+STATIC_ASSERT(NRF_SDH_BLE_CENTRAL_LINK_COUNT <= 32);
+
+static void config_meas_copy(ble_imu_service_config_t * p_dst, ble_imu_service_config_t const * p_src);
+static void commissioning_check(void);
+static void sensor_rejoin(uint16_t conn_handle);
+static void sensor_rejoin_retry(uint16_t conn_handle);
+
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -160,36 +201,9 @@ static void queue_process_packet(received_data_t * data, uint32_t * len)
     APP_ERROR_CHECK(err_code);
 }
 
-void print_packet_count(ble_imu_service_c_evt_t *p_evt)
-{
-    // Print out the packet count from each of the slaves
-    if (p_evt->conn_handle == 0)
-    {
-        imu.received_packet_counter1++;
-        NRF_LOG_INFO("received_packet_counter1 %d", imu.received_packet_counter1);
-    }
-    else if (p_evt->conn_handle == 1)
-    {
-        imu.received_packet_counter2++;
-        NRF_LOG_INFO("received_packet_counter2 %d", imu.received_packet_counter2);
-    }
-    else if (p_evt->conn_handle == 2)
-    {
-        imu.received_packet_counter3++;
-        NRF_LOG_INFO("received_packet_counter3 %d", imu.received_packet_counter3);
-    }
-    else if (p_evt->conn_handle == 3)
-    {
-        imu.received_packet_counter4++;
-        NRF_LOG_INFO("received_packet_counter4 %d", imu.received_packet_counter4);
-    }
-}
-
-
 void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu_service_c_evt_t *p_evt)
 {
-    // Print packet count for each connected device
-    // print_packet_count(p_evt);
+    USR_PROF_ENTER();
 
     // NRF_LOG_INFO("imu_service_c_evt_handler: %d", p_evt->evt_type);
 
@@ -202,6 +216,8 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
         NRF_LOG_INFO("imu_service_c_evt_handler: conn_handle: %d", p_evt->conn_handle);
 
+        usr_link_stats_on_discovery(p_evt->conn_handle);
+
         // Assign connection handles
         // usr_ble_handles_assign(p_ble_imu_service_c, p_evt);
 
@@ -216,7 +232,9 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
         // Enable notifications - in peripheral this equates to turning on the sensors
         usr_enable_notif(p_ble_imu_service_c, p_evt);
-        NRF_LOG_FLUSH();
+
+        // Join a running measurement
+        sensor_rejoin(p_evt->conn_handle);
 
         // Added in an attempt to improve faster commissioning
         // Send connection dev list once a device has connected
@@ -248,23 +266,40 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
             p_evt->params.value.info_data.accel_calibration_drone,
             p_evt->params.value.info_data.mag_calibration_done,
             p_evt->params.value.info_data.sync_complete);
-        NRF_LOG_FLUSH();
 
         // Process packet
         ble_imu_service_c_evt_type_t type = BLE_IMU_SERVICE_EVT_INFO;
-        comm_process(type, p_evt);
+        comm_ingest(type, p_evt);
 
     }
     break;
 
     case BLE_IMU_SERVICE_EVT_QUAT:
     {
+        usr_conn_params_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_quat_t));
+        usr_link_stats_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_quat_t), BLE_PACKET_BUFFER_COUNT);
+
+        // Relative orientation of the configured sensor pairs
+        uint8_t slot = usr_ble_sensor_slot_get(p_evt->conn_handle);
+        if (slot != USR_SENSOR_SLOT_INVALID)
+        {
+            usr_joint_sample_t samples[BLE_PACKET_BUFFER_COUNT];
+            for (uint8_t i = 0; i < BLE_PACKET_BUFFER_COUNT; i++)
+            {
+                samples[i].q.w = p_evt->params.value.quat_data.quat[i].w;
+                samples[i].q.x = p_evt->params.value.quat_data.quat[i].x;
+                samples[i].q.y = p_evt->params.value.quat_data.quat[i].y;
+                samples[i].q.z = p_evt->params.value.quat_data.quat[i].z;
+                samples[i].timestamp_ms = p_evt->params.value.quat_data.quat[i].timestamp_ms;
+            }
+            usr_joint_on_quat(slot, samples, BLE_PACKET_BUFFER_COUNT);
+        }
 
         #ifdef USE_INTERNAL_COMM
 
         // Process packet
         ble_imu_service_c_evt_type_t type = BLE_IMU_SERVICE_EVT_QUAT;
-        comm_process(type, p_evt);
+        comm_ingest(type, p_evt);
 
         #else
 
@@ -281,12 +316,12 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
             #define FIXED_POINT_FRACTIONAL_BITS_QUAT 30
 
-            received_quat.quat_data.w = ((float)p_evt->params.value.quat_data.quat[i].w / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_QUAT));
-            received_quat.quat_data.x = ((float)p_evt->params.value.quat_data.quat[i].x / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_QUAT));
-            received_quat.quat_data.y = ((float)p_evt->params.value.quat_data.quat[i].y / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_QUAT));
-            received_quat.quat_data.z = ((float)p_evt->params.value.quat_data.quat[i].z / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_QUAT));
+            received_quat.quat_data.w = usr_frame_q_to_float(p_evt->params.value.quat_data.quat[i].w, FIXED_POINT_FRACTIONAL_BITS_QUAT);
+            received_quat.quat_data.x = usr_frame_q_to_float(p_evt->params.value.quat_data.quat[i].x, FIXED_POINT_FRACTIONAL_BITS_QUAT);
+            received_quat.quat_data.y = usr_frame_q_to_float(p_evt->params.value.quat_data.quat[i].y, FIXED_POINT_FRACTIONAL_BITS_QUAT);
+            received_quat.quat_data.z = usr_frame_q_to_float(p_evt->params.value.quat_data.quat[i].z, FIXED_POINT_FRACTIONAL_BITS_QUAT);
 
-            NRF_LOG_INFO("quat: %d %d  %d  %d", (int)(received_quat.quat_data.w*1000), (int)(received_quat.quat_data.x*1000), (int)(received_quat.quat_data.y*1000), (int)(received_quat.quat_data.z*1000));
+            NRF_LOG_DEBUG("quat: %d %d  %d  %d", (int)(received_quat.quat_data.w*1000), (int)(received_quat.quat_data.x*1000), (int)(received_quat.quat_data.y*1000), (int)(received_quat.quat_data.z*1000));
 
             // Put data into FIFO buffer and let event handler know to process the packet
             queue_process_packet(&received_quat, &received_quat_len);
@@ -298,27 +333,42 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
     case BLE_IMU_SERVICE_EVT_EULER:
     {
+        usr_conn_params_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_euler_t));
+        usr_link_stats_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_euler_t), 1);
+
+        #ifdef USE_INTERNAL_COMM
+
+        // Process packet
+        ble_imu_service_c_evt_type_t type = BLE_IMU_SERVICE_EVT_EULER;
+        comm_ingest(type, p_evt);
+
+        #else
+
         float euler_buff[3];
         uint32_t euler_buff_len = sizeof(euler_buff);
 
         #define FIXED_POINT_FRACTIONAL_BITS_EULER 16
 
-        euler_buff[0] = ((float)p_evt->params.value.euler_data.yaw / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_EULER));
-        euler_buff[1] = ((float)p_evt->params.value.euler_data.pitch / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_EULER));
-        euler_buff[2] = ((float)p_evt->params.value.euler_data.roll / (float)(1 << FIXED_POINT_FRACTIONAL_BITS_EULER));
+        euler_buff[0] = usr_frame_q_to_float(p_evt->params.value.euler_data.yaw, FIXED_POINT_FRACTIONAL_BITS_EULER);
+        euler_buff[1] = usr_frame_q_to_float(p_evt->params.value.euler_data.pitch, FIXED_POINT_FRACTIONAL_BITS_EULER);
+        euler_buff[2] = usr_frame_q_to_float(p_evt->params.value.euler_data.roll, FIXED_POINT_FRACTIONAL_BITS_EULER);
 
-        NRF_LOG_INFO("euler: %d %d  %d", (int)euler_buff[0], (int)euler_buff[1], (int)euler_buff[2]);
-    
+        NRF_LOG_DEBUG("euler: %d %d  %d", (int)euler_buff[0], (int)euler_buff[1], (int)euler_buff[2]);
+
+        #endif
     }
     break;
 
     case BLE_IMU_SERVICE_EVT_RAW:
     {
+        usr_conn_params_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_raw_t));
+        usr_link_stats_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_raw_t), BLE_PACKET_BUFFER_COUNT);
+
         #ifdef USE_INTERNAL_COMM
 
         // Process packet
         ble_imu_service_c_evt_type_t type = BLE_IMU_SERVICE_EVT_RAW;
-        comm_process(type, p_evt);
+        comm_ingest(type, p_evt);
 
         // NRF_LOG_INFO("p_evt raw timestamp: %d", p_evt->params.value.raw_data.single_raw[0].timestamp_ms);
 
@@ -339,17 +389,17 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
             received_raw.conn_handle = p_evt->conn_handle;
             received_raw.raw_data_present = 1;
-            received_raw.raw_data.gryo.x = ((float)p_evt->params.value.raw_data.single_raw[i].gyro.x / (float)(1 << RAW_Q_FORMAT_GYR_COMMA_BITS));
-            received_raw.raw_data.gryo.y = ((float)p_evt->params.value.raw_data.single_raw[i].gyro.y / (float)(1 << RAW_Q_FORMAT_GYR_COMMA_BITS));
-            received_raw.raw_data.gryo.z = ((float)p_evt->params.value.raw_data.single_raw[i].gyro.z / (float)(1 << RAW_Q_FORMAT_GYR_COMMA_BITS));
+            received_raw.raw_data.gryo.x = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].gyro.x, RAW_Q_FORMAT_GYR_COMMA_BITS);
+            received_raw.raw_data.gryo.y = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].gyro.y, RAW_Q_FORMAT_GYR_COMMA_BITS);
+            received_raw.raw_data.gryo.z = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].gyro.z, RAW_Q_FORMAT_GYR_COMMA_BITS);
 
-            received_raw.raw_data.accel.x = ((float)p_evt->params.value.raw_data.single_raw[i].accel.x / (float)(1 << RAW_Q_FORMAT_ACC_COMMA_BITS));
-            received_raw.raw_data.accel.y = ((float)p_evt->params.value.raw_data.single_raw[i].accel.y / (float)(1 << RAW_Q_FORMAT_ACC_COMMA_BITS));
-            received_raw.raw_data.accel.z = ((float)p_evt->params.value.raw_data.single_raw[i].accel.z / (float)(1 << RAW_Q_FORMAT_ACC_COMMA_BITS));
+            received_raw.raw_data.accel.x = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].accel.x, RAW_Q_FORMAT_ACC_COMMA_BITS);
+            received_raw.raw_data.accel.y = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].accel.y, RAW_Q_FORMAT_ACC_COMMA_BITS);
+            received_raw.raw_data.accel.z = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].accel.z, RAW_Q_FORMAT_ACC_COMMA_BITS);
 
-            received_raw.raw_data.mag.x = ((float)p_evt->params.value.raw_data.single_raw[i].compass.x / (float)(1 << RAW_Q_FORMAT_CMP_COMMA_BITS));
-            received_raw.raw_data.mag.y = ((float)p_evt->params.value.raw_data.single_raw[i].compass.y / (float)(1 << RAW_Q_FORMAT_CMP_COMMA_BITS));
-            received_raw.raw_data.mag.z = ((float)p_evt->params.value.raw_data.single_raw[i].compass.z / (float)(1 << RAW_Q_FORMAT_CMP_COMMA_BITS));
+            received_raw.raw_data.mag.x = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].compass.x, RAW_Q_FORMAT_CMP_COMMA_BITS);
+            received_raw.raw_data.mag.y = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].compass.y, RAW_Q_FORMAT_CMP_COMMA_BITS);
+            received_raw.raw_data.mag.z = usr_frame_q_to_float(p_evt->params.value.raw_data.single_raw[i].compass.z, RAW_Q_FORMAT_CMP_COMMA_BITS);
 
             // Put data into FIFO buffer and let event handler know to process the packet
             queue_process_packet(&received_raw, &received_raw_len);
@@ -369,31 +419,26 @@ void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu
 
     case BLE_IMU_SERVICE_EVT_ADC:
     {
-        // NRF_LOG_INFO("ADC data: %d", p_evt->params.value.adc_data.raw[1]);
-
-        // received_data_t received_adc;
-        // uint32_t received_adc_len = sizeof(received_adc);
+        usr_conn_params_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_adc_t));
+        usr_link_stats_on_notif(p_evt->conn_handle, sizeof(ble_imu_service_adc_t), BLE_IMU_SERVICE_ADC_SAMPLES);
 
-        // // Initialize struct to all zeros
-        // memset(&received_adc, 0, received_adc_len);
-
-        // received_adc.conn_handle = p_evt->conn_handle;
-        // received_adc.adc_data_present = 1;
+        #ifdef USE_INTERNAL_COMM
 
-        // // TODO copy all data to print buffers
-        // received_adc.adc_data.raw[0] = p_evt->params.value.adc_data.raw[0];
+        // Process packet
+        comm_ingest(BLE_IMU_SERVICE_EVT_ADC, p_evt);
 
-        // // Put data into FIFO buffer and let event handler know to process the packet
-        // queue_process_packet(&received_adc, &received_adc_len);
+        #endif
     }
     break;
 
     default:
     {
-        NRF_LOG_INFO("imu_service_c_evt_handler DEFAULT: %d", (p_evt->evt_type));
+        usr_evlog(USR_EVLOG_NOTIF_UNKNOWN, p_evt->evt_type, p_evt->conn_handle);
     }
     break;
     }
+
+    USR_PROF_EXIT(USR_PROF_IMU_EVT);
 }
 
 void imu_service_c_init()
@@ -451,17 +496,23 @@ void usr_ble_config_send(ble_imu_service_config_t config)
         // TODO: Make list of connected handles instead of sending it to all of the 8 handles
         // This could prevent torubles in the future
 
-        NRF_LOG_INFO("IMU conn_handle: %d", m_imu_service_c[i].conn_handle);
+        NRF_LOG_DEBUG("IMU conn_handle: %d", m_imu_service_c[i].conn_handle);
 
-        err_code = ble_imu_service_config_set(&m_imu_service_c[i], &config);
+        // Sensors with their own settings only take the common fields (sync, stop, calibration)
+        ble_imu_service_config_t sensor_config = config;
+        uint8_t slot = usr_ble_sensor_slot_get(m_imu_service_c[i].conn_handle);
+        if ((slot != USR_SENSOR_SLOT_INVALID) && (m_sensor_config_mask & (1UL << slot)))
+        {
+            config_meas_copy(&sensor_config, &m_sensor_config[slot]);
+        }
+
+        err_code = ble_imu_service_config_set(&m_imu_service_c[i], &sensor_config);
 
         if(err_code != NRF_ERROR_INVALID_STATE && err_code != NRF_SUCCESS) 
         {
+            usr_evlog(USR_EVLOG_CONFIG_SEND, m_imu_service_c[i].conn_handle, err_code);
             APP_ERROR_CHECK(err_code);
         }
-        
-        NRF_LOG_FLUSH();
-
     }
 }
 
@@ -562,6 +613,392 @@ void set_config_reset()
     imu.adc = 0;
     imu.wom = 0;
     imu.start_calibration = 0;
+
+    // Drop sensor specific settings
+    m_sensor_config_mask = 0;
+}
+
+// Fill a configuration with the default settings
+static void config_from_imu(ble_imu_service_config_t * p_config)
+{
+    memset(p_config, 0, sizeof(ble_imu_service_config_t));
+    p_config->gyro_enabled = imu.gyro_enabled;
+    p_config->accel_enabled = imu.accel_enabled;
+    p_config->mag_enabled = imu.mag_enabled;
+    p_config->euler_enabled = imu.euler_enabled;
+    p_config->quat6_enabled = imu.quat6_enabled;
+    p_config->quat9_enabled = imu.quat9_enabled;
+    p_config->motion_freq_hz = imu.frequency;
+    p_config->wom_enabled = imu.wom;
+    p_config->sync_enabled = imu.sync_enabled;
+    p_config->sync_start_time = imu.sync_start_time;
+    p_config->stop = imu.stop;
+    p_config->adc_enabled = imu.adc;
+    p_config->start_calibration = imu.start_calibration;
+}
+
+// Store the measurement part of a configuration as default settings
+static void config_meas_to_imu(ble_imu_service_config_t const * p_config)
+{
+    imu.gyro_enabled = p_config->gyro_enabled;
+    imu.accel_enabled = p_config->accel_enabled;
+    imu.mag_enabled = p_config->mag_enabled;
+    imu.euler_enabled = p_config->euler_enabled;
+    imu.quat6_enabled = p_config->quat6_enabled;
+    imu.quat9_enabled = p_config->quat9_enabled;
+    imu.frequency = p_config->motion_freq_hz;
+    imu.wom = p_config->wom_enabled;
+    imu.adc = p_config->adc_enabled;
+}
+
+// Copy the measurement part of a configuration, common fields are left untouched
+static void config_meas_copy(ble_imu_service_config_t * p_dst, ble_imu_service_config_t const * p_src)
+{
+    p_dst->gyro_enabled = p_src->gyro_enabled;
+    p_dst->accel_enabled = p_src->accel_enabled;
+    p_dst->mag_enabled = p_src->mag_enabled;
+    p_dst->euler_enabled = p_src->euler_enabled;
+    p_dst->quat6_enabled = p_src->quat6_enabled;
+    p_dst->quat9_enabled = p_src->quat9_enabled;
+    p_dst->motion_freq_hz = p_src->motion_freq_hz;
+    p_dst->wom_enabled = p_src->wom_enabled;
+    p_dst->adc_enabled = p_src->adc_enabled;
+}
+
+static void config_meas_modify(ble_imu_service_config_t * p_config, uint32_t meas)
+{
+    switch (meas)
+    {
+    case COMM_CMD_MEAS_RAW:
+        p_config->gyro_enabled = 1;
+        p_config->accel_enabled = 1;
+        p_config->mag_enabled = 1;
+        break;
+
+    case COMM_CMD_MEAS_QUAT6:
+        p_config->quat6_enabled = 1;
+        break;
+
+    case COMM_CMD_MEAS_QUAT9:
+        p_config->quat9_enabled = 1;
+        break;
+
+    case COMM_CMD_MEAS_WOM:
+        p_config->wom_enabled = 1;
+        break;
+
+    case COMM_CMD_MEAS_EULER:
+        p_config->euler_enabled = 1;
+        break;
+
+    case COMM_CMD_MEAS_OFF:
+        p_config->gyro_enabled = 0;
+        p_config->accel_enabled = 0;
+        p_config->mag_enabled = 0;
+        p_config->euler_enabled = 0;
+        p_config->quat6_enabled = 0;
+        p_config->quat9_enabled = 0;
+        p_config->wom_enabled = 0;
+        p_config->adc_enabled = 0;
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void config_frequency_modify(ble_imu_service_config_t * p_config, uint32_t freq)
+{
+    p_config->motion_freq_hz = freq;
+}
+
+uint8_t usr_ble_sensor_slot_get(uint16_t conn_handle)
+{
+    if (conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return USR_SENSOR_SLOT_INVALID;
+    }
+
+    for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    {
+        if (dcu_conn_dev[i].conn_handle == conn_handle)
+        {
+            return i;
+        }
+    }
+    return USR_SENSOR_SLOT_INVALID;
+}
+
+// Slot has a device assigned by the STM32 or is connected
+static bool sensor_slot_in_use(uint8_t slot)
+{
+    return (dcu_conn_dev[slot].conn_handle != BLE_CONN_HANDLE_INVALID) ||
+           !compare_equal_ble_gap_addr_t(dcu_conn_dev[slot].addr, address_init);
+}
+
+// Configuration the sensor in a slot will receive (USR_SENSOR_SLOT_INVALID: defaults)
+static void sensor_config_get(uint8_t slot, ble_imu_service_config_t * p_config)
+{
+    config_from_imu(p_config);
+
+    if ((slot != USR_SENSOR_SLOT_INVALID) && (m_sensor_config_mask & (1UL << slot)))
+    {
+        config_meas_copy(p_config, &m_sensor_config[slot]);
+    }
+}
+
+// Send the running measurement configuration to a sensor in a slot, false when it has to be retried
+static bool sensor_config_push(uint16_t conn_handle, uint8_t slot)
+{
+    // Same sync start time as the other sensors, so the samples share the time base
+    ble_imu_service_config_t config;
+    sensor_config_get(slot, &config);
+
+    ret_code_t err_code = ble_imu_service_config_set(&m_imu_service_c[conn_handle], &config);
+    if (err_code != NRF_SUCCESS)
+    {
+        // GATT queue full or link busy, not fatal: retried on the next GATTC event of the link
+        NRF_LOG_WARNING("Sensor %d: config not sent (%d), retrying", slot, err_code);
+        m_rejoin_pending_mask |= (1UL << slot);
+        return false;
+    }
+
+    m_rejoin_pending_mask &= ~(1UL << slot);
+    return true;
+}
+
+// Send the running measurement configuration to a sensor that (re)joined and report the time it was lost
+static void sensor_rejoin(uint16_t conn_handle)
+{
+    uint8_t slot = usr_ble_sensor_slot_get(conn_handle);
+    bool config_pushed = false;
+
+    if (slot == USR_SENSOR_SLOT_INVALID)
+    {
+        return;
+    }
+
+    m_rejoin_pending_mask &= ~(1UL << slot);
+    if (m_meas_active)
+    {
+        config_pushed = sensor_config_push(conn_handle, slot);
+    }
+
+    uint32_t latency_ms = usr_reconnect_on_rejoin(slot);
+    m_rejoin_latency_ms[slot] = latency_ms;
+    if (latency_ms != USR_RECONNECT_NOT_LOST)
+    {
+        NRF_LOG_INFO("Sensor %d rejoined after %d ms, config %d", slot, latency_ms, config_pushed);
+        uart_send_rejoin(slot, latency_ms, config_pushed, usr_reconnect_level_get());
+    }
+}
+
+// Configuration of a rejoined sensor that could not be sent, reported again once it is
+static void sensor_rejoin_retry(uint16_t conn_handle)
+{
+    uint8_t slot = usr_ble_sensor_slot_get(conn_handle);
+
+    if ((slot == USR_SENSOR_SLOT_INVALID) || !(m_rejoin_pending_mask & (1UL << slot)))
+    {
+        return;
+    }
+
+    if (!m_meas_active)
+    {
+        m_rejoin_pending_mask &= ~(1UL << slot);
+        return;
+    }
+
+    if (sensor_config_push(conn_handle, slot) && (m_rejoin_latency_ms[slot] != USR_RECONNECT_NOT_LOST))
+    {
+        NRF_LOG_INFO("Sensor %d config sent on retry", slot);
+        uart_send_rejoin(slot, m_rejoin_latency_ms[slot], true, usr_reconnect_level_get());
+    }
+}
+
+// Negotiated capability of a link, NULL while unknown so the budget uses the defaults
+static usr_link_caps_t const * link_caps_get(uint16_t conn_handle, usr_link_caps_t * p_caps)
+{
+    return (usr_link_caps_get(conn_handle, p_caps) == NRF_SUCCESS) ? p_caps : NULL;
+}
+
+ret_code_t config_budget_check()
+{
+    usr_budget_t budget;
+    usr_budget_init(&budget);
+
+    for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    {
+        if (!sensor_slot_in_use(i))
+        {
+            continue;
+        }
+
+        ble_imu_service_config_t config;
+        usr_link_caps_t caps;
+        sensor_config_get(i, &config);
+        usr_budget_add_sensor(&budget, &config, link_caps_get(dcu_conn_dev[i].conn_handle, &caps));
+    }
+
+    return usr_budget_check(&budget);
+}
+
+// Plan connection intervals for the connected sensors and their configuration
+void conn_params_plan()
+{
+    usr_conn_demand_t demand[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+    uint8_t count = 0;
+
+    for (uint32_t i = 0; (i < conn_central_handles.len) && (count < NRF_SDH_BLE_CENTRAL_LINK_COUNT); i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+
+        ble_imu_service_config_t config;
+        usr_link_caps_t caps;
+        sensor_config_get(usr_ble_sensor_slot_get(conn_handle), &config);
+
+        usr_budget_t budget;
+        usr_budget_init(&budget);
+        usr_budget_add_sensor(&budget, &config, link_caps_get(conn_handle, &caps));
+
+        demand[count].conn_handle = conn_handle;
+        demand[count].air_us = budget.air_us;
+        demand[count].att_bytes = budget.att_bytes;
+        count++;
+    }
+
+    usr_conn_params_plan(demand, count);
+}
+
+// Apply a change to the default or sensor specific settings, roll back when the result does not fit the budget
+static ret_code_t config_update(uint32_t sensor_mask, void (*modify)(ble_imu_service_config_t *, uint32_t), uint32_t value)
+{
+    ret_code_t err_code;
+
+    if (sensor_mask & ~USR_SENSOR_MASK_ALL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    ble_imu_service_config_t default_backup;
+    ble_imu_service_config_t sensor_backup[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+    uint32_t mask_backup = m_sensor_config_mask;
+
+    config_from_imu(&default_backup);
+    memcpy(sensor_backup, m_sensor_config, sizeof(sensor_backup));
+
+    if (sensor_mask == USR_SENSOR_MASK_DEFAULT)
+    {
+        ble_imu_service_config_t config = default_backup;
+        modify(&config, value);
+        config_meas_to_imu(&config);
+    }else
+    {
+        for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+        {
+            if (!(sensor_mask & (1UL << i)))
+            {
+                continue;
+            }
+
+            // First sensor specific setting starts from the defaults
+            if (!(m_sensor_config_mask & (1UL << i)))
+            {
+                m_sensor_config[i] = default_backup;
+                m_sensor_config_mask |= (1UL << i);
+            }
+            modify(&m_sensor_config[i], value);
+        }
+    }
+
+    err_code = config_budget_check();
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("Configuration exceeds link capacity, rejected");
+
+        config_meas_to_imu(&default_backup);
+        memcpy(m_sensor_config, sensor_backup, sizeof(sensor_backup));
+        m_sensor_config_mask = mask_backup;
+    }else
+    {
+        conn_params_plan();
+        usr_ble_warm_save();
+    }
+
+    return err_code;
+}
+
+// Device list and measurement configuration, kept over a reset
+static void boot_state_get(usr_boot_state_t * p_state)
+{
+    ble_imu_service_config_t config;
+
+    memset(p_state, 0, sizeof(usr_boot_state_t));
+
+    for (uint8_t i = 0; i < NRF_BLE_SCAN_ADDRESS_CNT; i++)
+    {
+        memcpy(p_state->dev[i].addr, dcu_conn_dev[i].addr.addr, BLE_GAP_ADDR_LEN);
+    }
+
+    // Only the measurement part, the session fields (sync, stop, calibration) start cleared
+    config_from_imu(&config);
+    config_meas_copy(&p_state->config, &config);
+    for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    {
+        if (m_sensor_config_mask & (1UL << i))
+        {
+            config_meas_copy(&p_state->sensor_config[i], &m_sensor_config[i]);
+        }
+    }
+    p_state->sensor_mask = m_sensor_config_mask;
+}
+
+// Apply the configurations of a stored state
+static void boot_state_apply(usr_boot_state_t const * p_state)
+{
+    config_meas_to_imu(&p_state->config);
+
+    m_sensor_config_mask = p_state->sensor_mask & USR_SENSOR_MASK_ALL;
+    for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    {
+        config_from_imu(&m_sensor_config[i]);
+        config_meas_copy(&m_sensor_config[i], &p_state->sensor_config[i]);
+    }
+}
+
+// Kept in flash for a fast boot, and in RAM for a warm restart
+static void boot_state_save(void)
+{
+    usr_boot_state_t state;
+
+    boot_state_get(&state);
+    usr_boot_save(&state);
+
+    usr_ble_warm_save();
+}
+
+void usr_ble_warm_save()
+{
+    usr_warm_state_t state;
+
+    boot_state_get(&state.boot);
+    config_from_imu(&state.config);
+    state.global_time = get_stm32_real_time();
+    state.offset_time = get_stm32_offset_time();
+    state.meas_active = m_meas_active;
+
+    usr_warm_save(&state);
+}
+
+ret_code_t config_meas_update(uint32_t sensor_mask, command_type_meas_byte_t meas)
+{
+    return config_update(sensor_mask, config_meas_modify, meas);
+}
+
+ret_code_t config_frequency_update(uint32_t sensor_mask, uint32_t freq)
+{
+    return config_update(sensor_mask, config_frequency_modify, freq);
 }
 
 uint32_t config_send()
@@ -569,18 +1006,7 @@ uint32_t config_send()
     ret_code_t err_code;
 
     ble_imu_service_config_t config;
-    config.gyro_enabled = imu.gyro_enabled;
-    config.accel_enabled = imu.accel_enabled;
-    config.mag_enabled = imu.mag_enabled;
-    config.euler_enabled = imu.euler_enabled;
-    config.quat6_enabled = imu.quat6_enabled;
-    config.quat9_enabled = imu.quat9_enabled;
-    config.motion_freq_hz = imu.frequency;
-    config.wom_enabled = imu.wom;
-    config.sync_enabled = imu.sync_enabled;
-    config.stop = imu.stop;
-    config.adc_enabled = imu.adc;
-    config.start_calibration = imu.start_calibration;
+    config_from_imu(&config);
 
     // Get timestamp from master
     imu.sync_start_time = usr_ts_timestamp_get_ticks_u64();
@@ -602,6 +1028,19 @@ uint32_t config_send()
     // Send config to peripheral
     usr_ble_config_send(config);
 
+    // Calibration is not repeated on sensors that rejoin
+    if (!config.start_calibration)
+    {
+        m_meas_active = true;
+    }
+
+    // Intervals for the measurement that starts, throughput is measured from here
+    conn_params_plan();
+    usr_conn_params_report_reset();
+
+    // Configuration of the last measurement, for the next boot
+    boot_state_save();
+
     // Return ms to first packet
     return (uint32_t) (config.sync_start_time - temp_timestamp);
 }
@@ -615,18 +1054,8 @@ void config_send_stop()
     set_config_reset();
 
     ble_imu_service_config_t config;
-    config.gyro_enabled = imu.gyro_enabled;
-    config.accel_enabled = imu.accel_enabled;
-    config.mag_enabled = imu.mag_enabled;
-    config.euler_enabled = imu.euler_enabled;
-    config.quat6_enabled = imu.quat6_enabled;
-    config.quat9_enabled = imu.quat9_enabled;
-    config.motion_freq_hz = imu.frequency;
-    config.wom_enabled = imu.wom;
+    config_from_imu(&config);
     config.sync_enabled = 0; //imu.sync_enabled; // Here we have to adjust for the stop condition
-    config.stop = imu.stop;
-    config.adc_enabled = imu.adc;
-    config.start_calibration = imu.start_calibration;
 
     // Get timestamp from master
     imu.sync_start_time = usr_ts_timestamp_get_ticks_u64();
@@ -641,26 +1070,30 @@ void config_send_stop()
  
     // Send config to peripheral
     usr_ble_config_send(config);
+    m_meas_active = false;
+
+    // No data expected anymore, relax the intervals
+    conn_params_plan();
+
+    // Nothing to resume after a reset
+    usr_ble_warm_save();
 
 }
 
 
 
+// Set while a drain of the received data FIFO is queued
+static nrf_atomic_flag_t m_data_pending = 0;
+
 void schedule(app_sched_event_handler_t handler)
 {
     ret_code_t err_code;
 
     // Signal to event handler to execute sprintf + start UART transmission
-    // If there are already events in the queue
-    if (imu.evt_scheduled > 0)
-    {
-        imu.evt_scheduled++;
-    }
-    // If there are not yet any events in the queue, schedule event. In gpiote_evt_sceduled all callbacks are called
-    else
+    // Only the first sample after a drain queues an event, the drain empties the FIFO
+    if (nrf_atomic_flag_set_fetch(&m_data_pending) == 0)
     {
-        imu.evt_scheduled++;
-        err_code = app_sched_event_put(0, 0, imu_uart_sceduled);
+        err_code = usr_evq_put(USR_EVQ_DATA, handler);
         APP_ERROR_CHECK(err_code);
     }
 }
@@ -668,13 +1101,14 @@ void schedule(app_sched_event_handler_t handler)
 
 void imu_uart_sceduled(void *p_event_data, uint16_t event_size)
 {
-    while (imu.evt_scheduled > 0)
-    {
-        ret_code_t err_code;
+    bool read_success = true;
 
-        bool read_success = false;
+    // Cleared before the FIFO is read: a sample written from here on queues a new drain
+    (void) nrf_atomic_flag_clear(&m_data_pending);
 
-        // NRF_LOG_INFO("App scheduler execute: %d", imu.evt_scheduled);
+    while (read_success)
+    {
+        read_success = false;
 
         char string[1024];
 
@@ -712,7 +1146,6 @@ void imu_uart_sceduled(void *p_event_data, uint16_t event_size)
             // }
 
             read_success = true;
-            imu.evt_scheduled--;
         }
 
         // Get data from FIFO buffer if data is correctly recognized
@@ -720,8 +1153,8 @@ void imu_uart_sceduled(void *p_event_data, uint16_t event_size)
         {
             uint32_t string_len = calculate_string_len(string);
 
-            // Send data over UART
-            uart_queued_tx((uint8_t *)string, &string_len);
+            // Send data over UART, dropped when the FIFO is full
+            (void) uart_queued_tx_try((uint8_t *)string, &string_len);
         }
     }
 }
@@ -779,26 +1212,24 @@ static void bas_c_evt_handler(ble_bas_c_t * p_bas_c, ble_bas_c_evt_t * p_bas_c_e
             // Battery service discovered. Enable notification of Battery Level.
             NRF_LOG_DEBUG("Battery Service discovered. Reading battery level.");
 
-            err_code = ble_bas_c_bl_read(p_bas_c);
+            // Through usr_gatt_sched so configuration writes go first, ble_bas_c still handles the responses
+            err_code = usr_gatt_sched_read(p_bas_c->conn_handle, USR_GATT_PRIO_BATTERY, p_bas_c->peer_bas_db.bl_handle);
             APP_ERROR_CHECK(err_code);
 
             NRF_LOG_DEBUG("Enabling Battery Level Notification.");
-            err_code = ble_bas_c_bl_notif_enable(p_bas_c);
+            uint8_t cccd[BLE_CCCD_VALUE_LEN] = { LSB_16(BLE_GATT_HVX_NOTIFICATION), MSB_16(BLE_GATT_HVX_NOTIFICATION) };
+            err_code = usr_gatt_sched_write(p_bas_c->conn_handle, USR_GATT_PRIO_CCCD, p_bas_c->peer_bas_db.bl_cccd_handle,
+                                            cccd, sizeof(cccd));
             APP_ERROR_CHECK(err_code);
 
         } break;
 
         case BLE_BAS_C_EVT_BATT_NOTIFICATION:
         case BLE_BAS_C_EVT_BATT_READ_RESP:
-            NRF_LOG_INFO("Battery Level received %d %%.", p_bas_c_evt->params.battery_level);
+            NRF_LOG_DEBUG("Battery Level received %d (conn handle %d)", p_bas_c_evt->params.battery_level, p_bas_c_evt->conn_handle);
 
-            // Calculate and store battery voltage level in buffer
-            batt_array.batt[p_bas_c_evt->conn_handle].voltage = usr_map_adc_to_uint8(p_bas_c_evt->params.battery_level);
-            NRF_LOG_INFO("Voltage (conn handle %d) -> " NRF_LOG_FLOAT_MARKER "", p_bas_c_evt->conn_handle, NRF_LOG_FLOAT(batt_array.batt[p_bas_c_evt->conn_handle].voltage));
-
-            // Calculate and store battery percentage level in buffer
-            batt_array.batt[p_bas_c_evt->conn_handle].level =  usr_adc_voltage_to_percent(batt_array.batt[p_bas_c_evt->conn_handle].voltage);
-            NRF_LOG_INFO("Percentage (conn handle %d) -> %d", p_bas_c_evt->conn_handle, batt_array.batt[p_bas_c_evt->conn_handle].level);
+            // Raw level is cached, converted when it is reported
+            usr_battery_update(p_bas_c_evt->conn_handle, p_bas_c_evt->params.battery_level);
 
             break;
 
@@ -807,12 +1238,6 @@ static void bas_c_evt_handler(ble_bas_c_t * p_bas_c, ble_bas_c_evt_t * p_bas_c_e
     }
 }
 
-void get_battery(BATTERY_ARRAY* batt, uint32_t* len)
-{
-    *len = sizeof(batt_array);
-    memcpy(batt, &batt_array, *len);
-}
-
 /**
  * @brief Battery level collector initialization.
  */
@@ -843,10 +1268,16 @@ void usr_batt_print_conn_handle()
         for (uint32_t i = 0; i < conn_central_handles.len; i++)
         {
             uint16_t conn_handle = conn_central_handles.conn_handles[i];
+            usr_battery_t battery;
+
+            if (usr_battery_get(conn_handle, &battery) != NRF_SUCCESS)
+            {
+                continue;
+            }
 
             // Print Connected Devices
             uint8_t str[100];
-            sprintf(str, "Battery level: (conn handle %d)   %0.2f   ( +- %d procent )\n", conn_handle, batt_array.batt[conn_handle].voltage, batt_array.batt[conn_handle].level);
+            sprintf(str, "Battery level: (conn handle %d)   %d mV   ( +- %d procent )\n", conn_handle, usr_frame_battery_mv(battery.raw), battery.percent);
             uart_print(str);
         }
         uart_print("------------------------------------------\n");  
@@ -891,6 +1322,12 @@ static void db_disc_handler(ble_db_discovery_evt_t *p_evt)
 
     // Add discovery for Battery service
     ble_bas_on_db_disc_evt(&m_bas_c[p_evt->conn_handle], p_evt);
+
+    // Continue the link negotiation if the peer did not answer the MTU exchange
+    if (p_evt->evt_type == BLE_DB_DISCOVERY_COMPLETE)
+    {
+        usr_link_negotiation_kick(p_evt->conn_handle);
+    }
 }
 
 
@@ -914,6 +1351,8 @@ bool compare_equal_ble_gap_addr_t(ble_gap_addr_t first, ble_gap_addr_t second)
  */
 static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
 {
+    USR_PROF_ENTER();
+
     ret_code_t err_code;
     ble_gap_evt_t const *p_gap_evt = &p_ble_evt->evt.gap_evt;
 
@@ -979,11 +1418,13 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         /* ADDED CHANGES*/
         if (ble_conn_state_central_conn_count() < NRF_SDH_BLE_CENTRAL_LINK_COUNT)
         {
-            // Resume scanning.
+            // Resume scanning for the remaining sensors, stops when all listed sensors are connected
             scan_start();
         }
         /* END ADDED CHANGES */
 
+        commissioning_check();
+
         err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
         APP_ERROR_CHECK(err_code);
 
@@ -992,15 +1433,7 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         err_code = ble_db_discovery_start(&m_db_disc, p_ble_evt->evt.gap_evt.conn_handle);
         APP_ERROR_CHECK(err_code);
 
-        // Change to 2MBIT PHY
-        NRF_LOG_DEBUG("PHY update!");
-        ble_gap_phys_t const phys =
-            {
-                .rx_phys = BLE_GAP_PHY_2MBPS,
-                .tx_phys = BLE_GAP_PHY_2MBPS,
-            };
-        err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
-        APP_ERROR_CHECK(err_code);
+        // MTU, data length and 2MBIT PHY are negotiated by usr_link_negotiation
 
         // Print to uart if device disconnects
         // char str1[100];
@@ -1014,6 +1447,9 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         // get_connected_devices(dev, sizeof(dev));
         // uart_send_conn_dev(dev, sizeof(dev));
 
+        // Spread the connection events over all links
+        conn_params_plan();
+
         // Set connection LEDs
         DCU_set_connection_leds(dcu_conn_dev, CONNECTION);
     }
@@ -1034,6 +1470,10 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
                     // Map connection handle to address
                     dcu_conn_dev[i].conn_handle = BLE_CONN_HANDLE_INVALID;
                     NRF_LOG_INFO("Set connection handle to INVALID");
+
+                    usr_reconnect_on_disconnect(i);
+                    usr_joint_forget(i);
+                    m_rejoin_pending_mask &= ~(1UL << i);
                 }            
             }
         }else
@@ -1070,6 +1510,13 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         }
         uart_send_conn_dev_update(&address, sizeof(address), COMM_CMD_CONN_DEV_UPDATE_DISCONNECTED);
 
+        // Remaining links can use the freed events
+        conn_params_plan();
+
+        // Look for the lost sensor at the fastest scan level
+        usr_reconnect_restart();
+        scan_start();
+
         DCU_set_connection_leds(dcu_conn_dev, DISCONNECTION);
     }
     break;
@@ -1087,25 +1534,9 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         APP_ERROR_CHECK(err_code);
         break;
 
-    case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
-        // Accepting parameters requested by peer.
-        err_code = sd_ble_gap_conn_param_update(p_gap_evt->conn_handle,
-                                                &p_gap_evt->params.conn_param_update_request.conn_params);
-        APP_ERROR_CHECK(err_code);
-        break;
+    // BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST is answered by the connection planner (usr_conn_params)
 
-    case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
-    {
-        NRF_LOG_DEBUG("PHY update request.");
-        ble_gap_phys_t const phys =
-            {
-                .rx_phys = BLE_GAP_PHY_AUTO,
-                .tx_phys = BLE_GAP_PHY_AUTO,
-            };
-        err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
-        APP_ERROR_CHECK(err_code);
-    }
-    break;
+    // BLE_GAP_EVT_PHY_UPDATE_REQUEST is answered by the link negotiation (usr_link_negotiation)
 
     case BLE_GATTC_EVT_TIMEOUT:
         // Disconnect on GATT Client timeout event.
@@ -1123,6 +1554,13 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
         APP_ERROR_CHECK(err_code);
         break;
 
+    case BLE_GATTC_EVT_WRITE_RSP:
+    case BLE_GATTC_EVT_READ_RSP:
+    case BLE_GATTC_EVT_HVX:
+        // Room in the GATT queue again
+        sensor_rejoin_retry(p_ble_evt->evt.gattc_evt.conn_handle);
+        break;
+
         // case BLE_GATTS_EVT_SYS_ATTR_MISSING:
         //     // No system attributes have been stored.
         //     err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
@@ -1132,15 +1570,93 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
     default:
         break;
     }    
+
+    USR_PROF_EXIT(USR_PROF_BLE_EVT);
 }
 
-/**@brief Function to start scanning. */
+// Listed sensors and how many of them are connected
+static void listed_sensors_count(uint8_t * p_listed, uint8_t * p_connected)
+{
+    *p_listed = 0;
+    *p_connected = 0;
+
+    for (uint8_t i = 0; i < NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    {
+        if (!compare_equal_ble_gap_addr_t(dcu_conn_dev[i].addr, address_init))
+        {
+            (*p_listed)++;
+            if (dcu_conn_dev[i].conn_handle != BLE_CONN_HANDLE_INVALID)
+            {
+                (*p_connected)++;
+            }
+        }
+    }
+}
+
+// Stop the commissioning time once every listed sensor is connected
+static void commissioning_check(void)
+{
+    uint8_t listed, connected;
+
+    listed_sensors_count(&listed, &connected);
+    if (!m_commissioning || (connected < listed))
+    {
+        return;
+    }
+
+    m_commissioning = false;
+    m_commissioning_ms = TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_commissioning_start));
+
+    NRF_LOG_INFO("Commissioning: %d sensors connected in %d ms", listed, m_commissioning_ms);
+    uart_send_commissioning();
+}
+
+void usr_ble_commissioning_get(usr_commissioning_t * p_commissioning)
+{
+    listed_sensors_count(&p_commissioning->listed, &p_commissioning->connected);
+
+    p_commissioning->done = !m_commissioning;
+    p_commissioning->time_ms = m_commissioning ?
+        TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_commissioning_start)) : m_commissioning_ms;
+    p_commissioning->scan_mode = !m_scanning ? USR_SCAN_OFF : ((usr_reconnect_level_get() == 0) ? USR_SCAN_FAST : USR_SCAN_SLOW);
+    p_commissioning->whitelist = m_scan_whitelist;
+}
+
+/**@brief Function to start scanning.
+ *
+ * @details Scans for the listed sensors that are not connected: with the SoftDevice whitelist when they fit,
+ *          with the address filters otherwise. Stops scanning when none are missing.
+ */
 void scan_start(void)
 {
     ret_code_t ret;
+    uint8_t listed, connected;
+    ble_gap_scan_params_t scan_params;
 
+    listed_sensors_count(&listed, &connected);
+    if (connected >= listed)
+    {
+        nrf_ble_scan_stop();
+        m_scanning = false;
+        return;
+    }
+
+    memset(&scan_params, 0, sizeof(scan_params));
+    scan_params.active = 0;
+    scan_params.scan_phys = BLE_GAP_PHY_1MBPS;
+    usr_reconnect_scan_params_get(&scan_params);
+
+    // The whitelist filters in the radio, the address filters check every advertising report in software
+    m_scan_whitelist = (listed - connected) <= BLE_GAP_WHITELIST_ADDR_MAX_COUNT;
+    scan_params.filter_policy = m_scan_whitelist ? BLE_GAP_SCAN_FP_WHITELIST : BLE_GAP_SCAN_FP_ACCEPT_ALL;
+
+    ret = nrf_ble_scan_params_set(&m_scan, &scan_params);
+    APP_ERROR_CHECK(ret);
+
+    // Requests the whitelist (scan_evt_handler) when it is used
     ret = nrf_ble_scan_start(&m_scan);
     APP_ERROR_CHECK(ret);
+    m_scanning = true;
 
     ret = bsp_indication_set(BSP_INDICATE_SCANNING);
     APP_ERROR_CHECK(ret);
@@ -1154,6 +1670,34 @@ void scan_stop()
     // APP_ERROR_CHECK(err_code);
 }
 
+// Whitelist of the listed sensors that are not connected
+static void scan_whitelist_set(void)
+{
+    ret_code_t err_code;
+    ble_gap_addr_t const * p_whitelist[BLE_GAP_WHITELIST_ADDR_MAX_COUNT];
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; (i < NRF_SDH_BLE_CENTRAL_LINK_COUNT) && (count < BLE_GAP_WHITELIST_ADDR_MAX_COUNT); i++)
+    {
+        if (!compare_equal_ble_gap_addr_t(dcu_conn_dev[i].addr, address_init) &&
+            (dcu_conn_dev[i].conn_handle == BLE_CONN_HANDLE_INVALID))
+        {
+            p_whitelist[count++] = &dcu_conn_dev[i].addr;
+        }
+    }
+
+    err_code = sd_ble_gap_whitelist_set(p_whitelist, count);
+    if (err_code == NRF_ERROR_INVALID_STATE)
+    {
+        // Still in use by a pending connection, scan_start() is called again when it completes
+        NRF_LOG_INFO("Whitelist in use");
+        return;
+    }
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_INFO("Whitelist set: %d sensors", count);
+}
+
 
 /**@brief Function for handling Scanning Module events.
  */
@@ -1191,9 +1735,19 @@ static void scan_evt_handler(scan_evt_t const *p_scan_evt)
     }
     break;
 
+    case NRF_BLE_SCAN_EVT_WHITELIST_REQUEST:
+        scan_whitelist_set();
+        break;
+
+    case NRF_BLE_SCAN_EVT_WHITELIST_ADV_REPORT:
+        NRF_LOG_INFO("Whitelist MATCH");
+        break;
+
     case NRF_BLE_SCAN_EVT_SCAN_TIMEOUT:
     {
+        // Keep looking for the missing sensors at a lower duty cycle
         NRF_LOG_INFO("Scan timed out.");
+        usr_reconnect_backoff();
         scan_start();
     }
     break;
@@ -1219,24 +1773,35 @@ void scan_init(void)
     err_code = nrf_ble_scan_init(&m_scan, &init_scan, scan_evt_handler);
     APP_ERROR_CHECK(err_code);
 
-    // To start, set all connection handles invalid
+    // To start, set all connection handles invalid and add fixed addresses to list
     for(uint16_t i=0; i<NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
     {
         dcu_conn_dev[i].conn_handle = BLE_CONN_HANDLE_INVALID;
+        dcu_conn_dev[i].addr = address_init;
     }
-
-    // Add fixed addresses to list
-    dcu_conn_dev[0].addr = address_init;
-    dcu_conn_dev[1].addr = address_init;
-    dcu_conn_dev[2].addr = address_init;
-    dcu_conn_dev[3].addr = address_init;
-    dcu_conn_dev[4].addr = address_init;
-    dcu_conn_dev[5].addr = address_init;
-    dcu_conn_dev[6].addr = address_init;
-    dcu_conn_dev[7].addr = address_init;
 }
 
 
+#if defined(__GNUC__)
+extern uint32_t __bss_end__;
+extern uint32_t __StackLimit;
+#endif
+
+// RAM used for the configured number of sensors, to size the linker RAM region of a build
+static void mem_report(uint32_t ram_start)
+{
+    uint32_t per_link = sizeof(dcu_connected_devices_t) + sizeof(ble_imu_service_config_t) + sizeof(ble_imu_service_c_t) +
+                        sizeof(ble_bas_c_t) + sizeof(usr_battery_t) + sizeof(usr_link_caps_t) + sizeof(usr_link_stats_t);
+
+    NRF_LOG_INFO("Memory: %d links, SoftDevice RAM 0x%X bytes (app RAM start 0x%X)", NRF_SDH_BLE_CENTRAL_LINK_COUNT,
+                 ram_start - 0x20000000, ram_start);
+    NRF_LOG_INFO("Memory: %d bytes application tables per link, %d in total", per_link, per_link * NRF_SDH_BLE_CENTRAL_LINK_COUNT);
+#if defined(__GNUC__)
+    NRF_LOG_INFO("Memory: static RAM 0x%X bytes, free below stack 0x%X bytes",
+                 (uint32_t) &__bss_end__ - ram_start, (uint32_t) &__StackLimit - (uint32_t) &__bss_end__);
+#endif
+}
+
 /**@brief Function for initializing the BLE stack.
  *
  * @details Initializes the SoftDevice and the BLE event interrupt.
@@ -1254,10 +1819,22 @@ void ble_stack_init(void)
     err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
     APP_ERROR_CHECK(err_code);
 
+    // Event length from the connection planner instead of NRF_SDH_BLE_GAP_EVENT_LENGTH,
+    // so one interval holds an event of every link
+    ble_cfg_t ble_cfg;
+    memset(&ble_cfg, 0, sizeof(ble_cfg));
+    ble_cfg.conn_cfg.conn_cfg_tag = APP_BLE_CONN_CFG_TAG;
+    ble_cfg.conn_cfg.params.gap_conn_cfg.conn_count = NRF_SDH_BLE_TOTAL_LINK_COUNT;
+    ble_cfg.conn_cfg.params.gap_conn_cfg.event_length = USR_CONN_EVENT_LENGTH;
+    err_code = sd_ble_cfg_set(BLE_CONN_CFG_GAP, &ble_cfg, ram_start);
+    APP_ERROR_CHECK(err_code);
+
     // Enable BLE stack.
     err_code = nrf_sdh_ble_enable(&ram_start);
     APP_ERROR_CHECK(err_code);
 
+    mem_report(ram_start);
+
     // Register a handler for BLE events.
     NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
 }
@@ -1271,6 +1848,14 @@ void gatt_evt_handler(nrf_ble_gatt_t *p_gatt, nrf_ble_gatt_evt_t const *p_evt)
     {
         NRF_LOG_INFO("ATT MTU exchange completed.");
     }
+
+    usr_link_negotiation_on_gatt_evt(p_evt);
+}
+
+// Link negotiation finished, the airtime of the link is known now
+static void link_negotiation_done(uint16_t conn_handle)
+{
+    conn_params_plan();
 }
 
 /**@brief Function for initializing the GATT library. */
@@ -1283,6 +1868,8 @@ void gatt_init(void)
 
     err_code = nrf_ble_gatt_att_mtu_central_set(&m_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
     APP_ERROR_CHECK(err_code);
+
+    usr_link_negotiation_init(&m_gatt, link_negotiation_done);
 }
 
 
@@ -1298,6 +1885,9 @@ void db_discovery_init(void)
 
     ret_code_t err_code = ble_db_discovery_init(&db_init);
     APP_ERROR_CHECK(err_code);
+
+    // Prioritized requests of the IMU and battery clients
+    usr_gatt_sched_init(&m_ble_gatt_queue);
 }
 
 char const *phy_str(ble_gap_phys_t phys)
@@ -1371,7 +1961,7 @@ void usr_ble_disconnect()
 }
 
 // Tested - works
-void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t len)
+void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t count)
 {
     ret_code_t err_code;
 
@@ -1383,7 +1973,7 @@ void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t len)
     {
         for(uint8_t j=0; j<BLE_GAP_ADDR_LEN; j++)
         {
-           dcu_conn_dev[i].addr.addr[j] = data[i].addr[j];
+           dcu_conn_dev[i].addr.addr[j] = (i < count) ? data[i].addr[j] : address_init.addr[j];
         }
     }
 
@@ -1395,21 +1985,89 @@ void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t len)
     err_code = nrf_ble_scan_all_filter_remove(&m_scan);
     APP_ERROR_CHECK(err_code);
 
-    // Set filter based on address
+    // Set filter based on address, only for the listed sensors (not the FF placeholders)
+    uint8_t filters = 0;
     for (int i=0; i< NRF_BLE_SCAN_ADDRESS_CNT; i++){
+        if (compare_equal_ble_gap_addr_t(dcu_conn_dev[i].addr, address_init))
+        {
+            continue;
+        }
         err_code = nrf_ble_scan_filter_set(&m_scan, SCAN_ADDR_FILTER, &dcu_conn_dev[i].addr.addr);
         APP_ERROR_CHECK(err_code);
+        filters++;
     }
-    NRF_LOG_INFO("Filters set");
+    NRF_LOG_INFO("Filters set: %d", filters);
 
     // Only enable address filter
     err_code = nrf_ble_scan_filters_enable(&m_scan, NRF_BLE_SCAN_ADDR_FILTER, true);
     APP_ERROR_CHECK(err_code);
     NRF_LOG_INFO("Filters enabled");
 
+    // Start the commissioning time, sensors that are still connected count as connected
+    m_commissioning = true;
+    m_commissioning_start = app_timer_cnt_get();
+    usr_reconnect_forget();
+    usr_reconnect_restart();
+
     // Start scanning
     scan_start();
 
+    commissioning_check();
+
+    boot_state_save();
+}
+
+// Sensors of the device list stored before the reset connect without waiting for the STM32
+void usr_ble_boot_restore()
+{
+    usr_boot_state_t state;
+    usr_boot_status_t status;
+
+    if (!usr_boot_state_get(&state))
+    {
+        return;
+    }
+
+    boot_state_apply(&state);
+
+    usr_boot_status_get(&status);
+    if (status.devices > 0)
+    {
+        set_conn_dev_mask(state.dev, NRF_BLE_SCAN_ADDRESS_CNT);
+    }
+
+    NRF_LOG_INFO("Restored %d devices and the configuration", status.devices);
+}
+
+// The measurement that ran before a soft or watchdog reset continues on the same time base,
+// sensors that rejoin get its configuration and sync start time
+bool usr_ble_warm_restore()
+{
+    usr_warm_state_t state;
+
+    if (!usr_warm_state_get(&state))
+    {
+        return false;
+    }
+
+    boot_state_apply(&state.boot);
+    imu.sync_start_time = state.config.sync_start_time;
+    m_meas_active = state.meas_active;
+    set_stm32_real_time(state.global_time, state.offset_time);
+
+    // TimeSync already continues the old time base (usr_warm_time_resume)
+    if (state.config.sync_enabled)
+    {
+        sync_enable();
+    }
+
+    conn_params_plan();
+
+    set_conn_dev_mask(state.boot.dev, NRF_BLE_SCAN_ADDRESS_CNT);
+
+    NRF_LOG_INFO("Measurement resumed after a warm restart");
+
+    return true;
 }
 
 void get_connected_devices(dcu_connected_devices_t* conn_dev, uint32_t len)
@@ -1432,6 +2090,7 @@ void sync_enable()
     NRF_LOG_INFO("Starting sync beacon transmission!\r\n");
 
     set_config_sync_enable(1);
+    usr_ble_warm_save();
 }
 
 void sync_disable()
@@ -1445,6 +2104,7 @@ void sync_disable()
     NRF_LOG_INFO("Stopping sync beacon transmission!\r\n");
 
     set_config_sync_enable(0);
+    usr_ble_warm_save();
 }
 
 
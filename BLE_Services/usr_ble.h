@@ -42,6 +42,11 @@
 #define DISCONNECTION 0
 #define INVALID_VALUE  0xFFFF
 
+// Sensor selection for the per-sensor configuration (bit i = i-th device in the connected device list)
+#define USR_SENSOR_MASK_DEFAULT   0
+#define USR_SENSOR_MASK_ALL       ((uint32_t)((1ULL << NRF_SDH_BLE_CENTRAL_LINK_COUNT) - 1))
+#define USR_SENSOR_SLOT_INVALID   0xFF
+
 // Match connection handles to unique IDs
 typedef struct
 {
@@ -49,17 +54,25 @@ typedef struct
   ble_gap_addr_t addr;
 } dcu_connected_devices_t;
 
-
-typedef struct batt
+// Scan state, fast on the first backoff level of usr_reconnect
+typedef enum
 {
-    uint8_t level;
-    float voltage;
-} BATTERY;
+    USR_SCAN_OFF = 0,   // All listed sensors connected (or empty list)
+    USR_SCAN_FAST,
+    USR_SCAN_SLOW
+} usr_scan_mode_t;
 
-typedef struct batt_array
+// Time from the last device list to all listed sensors connected
+typedef struct
 {
-    BATTERY batt[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
-} BATTERY_ARRAY;
+    uint8_t  listed;        // Sensors in the device list
+    uint8_t  connected;     // Listed sensors that are connected
+    bool     done;          // All listed sensors connected
+    uint32_t time_ms;       // Commissioning time when done, time since the list was set otherwise
+    usr_scan_mode_t scan_mode;
+    bool     whitelist;     // Scanning uses the SoftDevice whitelist (not the address filters)
+} usr_commissioning_t;
+
 
 // Create a FIFO structure
 typedef struct buffer
@@ -136,12 +149,7 @@ typedef struct imu
     uint64_t sync_start_time;
     uint32_t frequency; // period in milliseconds (ms)
     uint16_t packet_length;
-    int received_packet_counter1;
-    int received_packet_counter2;
-    int received_packet_counter3;
-    int received_packet_counter4;
     nrf_drv_uart_t uart;
-    uint32_t evt_scheduled;
     uint32_t uart_rx_evt_scheduled;
     bool adc;
     bool start_calibration;
@@ -177,13 +185,27 @@ void usr_ble_disconnect();
 void usr_ble_handles_assign(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu_service_c_evt_t *p_evt);
 void usr_enable_notif(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu_service_c_evt_t *p_evt);
 
+// IMU service client events, the simulated sensor fleet (usr_sim) calls this with p_ble_imu_service_c NULL
+void imu_service_c_evt_handler(ble_imu_service_c_t *p_ble_imu_service_c, ble_imu_service_c_evt_t *p_evt);
+
 // Synchronization enable/disable
 void sync_enable();
 void sync_disable();
 
 // Set and get a whitelist of devices that may connect
-void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t len);
+void set_conn_dev_mask(dcu_conn_dev_t data[], uint8_t count);
+// Commissioning progress of the device list
+void usr_ble_commissioning_get(usr_commissioning_t * p_commissioning);
+// Apply the device list and configuration stored before the reset (usr_boot)
+void usr_ble_boot_restore();
+
+// Resume the measurement kept in RAM over a soft or watchdog reset (usr_warm), false after a cold boot
+bool usr_ble_warm_restore();
+
+// Measurement state changed, kept in RAM for a warm restart
+void usr_ble_warm_save();
 void get_connected_devices(dcu_connected_devices_t* conn_dev, uint32_t len);
+bool compare_equal_ble_gap_addr_t(ble_gap_addr_t first, ble_gap_addr_t second);
 
 //////////////////
 // Debugging
@@ -214,6 +236,18 @@ void set_config_frequency(uint32_t freq);
 void set_config_start_calibration(bool enable);
 void set_config_reset();
 
+// Change default (USR_SENSOR_MASK_DEFAULT) or sensor specific settings,
+// returns NRF_ERROR_RESOURCES and keeps the old settings when the bandwidth budget is exceeded
+ret_code_t config_meas_update(uint32_t sensor_mask, command_type_meas_byte_t meas);
+ret_code_t config_frequency_update(uint32_t sensor_mask, uint32_t freq);
+ret_code_t config_budget_check();
+
+// Recompute connection intervals (usr_conn_params) for the connected sensors
+void conn_params_plan();
+
+// Position in the connected device list of a connection handle
+uint8_t usr_ble_sensor_slot_get(uint16_t conn_handle);
+
 // Send buffered configuration to all sensors
 uint32_t config_send();
 void usr_ble_config_send(ble_imu_service_config_t config);
@@ -227,6 +261,5 @@ ret_code_t imu_disconnect(uint32_t conn_handle_num);
 
 // Battery
 void usr_batt_print_conn_handle();
-void get_battery(BATTERY_ARRAY* batt, uint32_t* len);
 
 #endif
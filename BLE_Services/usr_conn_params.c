@@ -0,0 +1,284 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_conn_params.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Connection parameter planner for multiple sensor links
+ *
+ *               All links share a base interval that gives every link one event
+ *               of USR_CONN_EVENT_LENGTH. Links with little data get a multiple
+ *               of the base interval, which keeps their events aligned.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_conn_params.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "ble_hci.h"
+
+#define NRF_LOG_MODULE_NAME usr_conn_params_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define EVENT_LENGTH_US         (USR_CONN_EVENT_LENGTH * 1250UL)
+#define INTERVAL_TO_US(i)       ((uint32_t)(i) * 1250UL)
+#define MAX_INTERVAL_DOUBLINGS  3
+
+typedef struct
+{
+    bool     active;
+    bool     update_pending;    // Procedure started, waiting for BLE_GAP_EVT_CONN_PARAM_UPDATE
+    uint16_t interval;
+    uint16_t current_interval;
+    uint32_t demand_air_us;
+    uint32_t demand_bytes;
+    uint32_t rx_bytes;
+} conn_link_t;
+
+static conn_link_t m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static uint32_t m_report_start_ticks = 0;
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_conn_params_observer, USR_CONN_PARAMS_OBSERVER_PRIO, on_ble_evt, NULL);
+
+
+// Radio time of the link fits in one event at this interval
+static bool demand_fits(uint32_t air_us, uint16_t interval)
+{
+    return ((uint64_t) air_us * INTERVAL_TO_US(interval)) <= ((uint64_t) EVENT_LENGTH_US * 1000000UL);
+}
+
+// Payload per second one event per interval can carry, at the payload / airtime ratio of the link
+static uint32_t link_capacity(conn_link_t const * p_link)
+{
+    uint64_t bytes_per_event;
+
+    if (p_link->demand_air_us == 0)
+    {
+        return 0;
+    }
+
+    bytes_per_event = ((uint64_t) EVENT_LENGTH_US * p_link->demand_bytes) / p_link->demand_air_us;
+    return (uint32_t) ((bytes_per_event * 1000000UL) / INTERVAL_TO_US(p_link->interval));
+}
+
+static void link_apply(uint16_t conn_handle)
+{
+    ret_code_t err_code;
+    conn_link_t * p_link = &m_links[conn_handle];
+
+    if (!p_link->active || p_link->update_pending || (p_link->interval == p_link->current_interval))
+    {
+        return;
+    }
+
+    ble_gap_conn_params_t params =
+    {
+        .min_conn_interval = p_link->interval,
+        .max_conn_interval = p_link->interval,
+        .slave_latency     = 0,
+        .conn_sup_timeout  = USR_CONN_SUP_TIMEOUT,
+    };
+
+    err_code = sd_ble_gap_conn_param_update(conn_handle, &params);
+    if (err_code == NRF_SUCCESS)
+    {
+        p_link->update_pending = true;
+        NRF_LOG_INFO("Conn %d: interval %d -> %d (x1.25 ms)", conn_handle, p_link->current_interval, p_link->interval);
+    }
+    else if (err_code == NRF_ERROR_BUSY)
+    {
+        // Another link layer procedure (PHY, DLE) is running, retried on its completion
+        NRF_LOG_INFO("Conn %d: parameter update busy", conn_handle);
+    }
+    else if ((err_code != NRF_ERROR_INVALID_STATE) && (err_code != BLE_ERROR_INVALID_CONN_HANDLE))
+    {
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+void usr_conn_params_plan(usr_conn_demand_t const * p_demand, uint8_t count)
+{
+    bool active[NRF_SDH_BLE_TOTAL_LINK_COUNT] = {0};
+
+    // Every link gets one event per base interval
+    uint16_t base_interval = MAX(USR_CONN_INTERVAL_MIN, count * USR_CONN_EVENT_LENGTH);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint16_t conn_handle = p_demand[i].conn_handle;
+        if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+        {
+            continue;
+        }
+
+        conn_link_t * p_link = &m_links[conn_handle];
+        uint16_t interval = base_interval;
+
+        active[conn_handle] = true;
+        p_link->active = true;
+        p_link->demand_air_us = p_demand[i].air_us;
+        p_link->demand_bytes = p_demand[i].att_bytes;
+
+        if (!demand_fits(p_link->demand_air_us, base_interval))
+        {
+            NRF_LOG_WARNING("Conn %d: demand exceeds one event per interval", conn_handle);
+        }
+
+        // Stretch the interval of links with little data
+        for (uint8_t k = 0; k < MAX_INTERVAL_DOUBLINGS; k++)
+        {
+            if ((interval * 2 > USR_CONN_INTERVAL_MAX) || !demand_fits(p_link->demand_air_us, interval * 2))
+            {
+                break;
+            }
+            interval *= 2;
+        }
+
+        p_link->interval = interval;
+    }
+
+    for (uint16_t conn_handle = 0; conn_handle < NRF_SDH_BLE_TOTAL_LINK_COUNT; conn_handle++)
+    {
+        if (!active[conn_handle])
+        {
+            // Not in the plan, the current interval and a pending update stay valid for the link
+            m_links[conn_handle].active = false;
+            m_links[conn_handle].interval = 0;
+            m_links[conn_handle].demand_air_us = 0;
+            m_links[conn_handle].demand_bytes = 0;
+            continue;
+        }
+        link_apply(conn_handle);
+    }
+
+    NRF_LOG_INFO("Plan: %d links, base interval %d (x1.25 ms), event length %d", count, base_interval, USR_CONN_EVENT_LENGTH);
+}
+
+void usr_conn_params_on_notif(uint16_t conn_handle, uint16_t len)
+{
+    if (conn_handle < NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        m_links[conn_handle].rx_bytes += len;
+    }
+}
+
+ret_code_t usr_conn_params_report_get(uint16_t conn_handle, usr_conn_link_report_t * p_report, bool reset)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || !m_links[conn_handle].active)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    conn_link_t * p_link = &m_links[conn_handle];
+    uint32_t ticks = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_report_start_ticks);
+
+    p_report->interval = p_link->interval;
+    p_report->current_interval = p_link->current_interval;
+    p_report->capacity_bytes = link_capacity(p_link);
+    p_report->predicted_bytes = MIN(p_link->demand_bytes, p_report->capacity_bytes);
+    p_report->achieved_bytes = (ticks == 0) ? 0 : (uint32_t) (((uint64_t) p_link->rx_bytes * APP_TIMER_TICKS(1000)) / ticks);
+
+    if (reset)
+    {
+        p_link->rx_bytes = 0;
+    }
+
+    return NRF_SUCCESS;
+}
+
+void usr_conn_params_report_reset(void)
+{
+    for (uint16_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        m_links[i].rx_bytes = 0;
+    }
+    m_report_start_ticks = app_timer_cnt_get();
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ret_code_t err_code;
+    ble_gap_evt_t const * p_gap_evt = &p_ble_evt->evt.gap_evt;
+    uint16_t conn_handle = p_gap_evt->conn_handle;
+
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    conn_link_t * p_link = &m_links[conn_handle];
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+        memset(p_link, 0, sizeof(conn_link_t));
+        p_link->current_interval = p_gap_evt->params.connected.conn_params.max_conn_interval;
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        memset(p_link, 0, sizeof(conn_link_t));
+        break;
+
+    case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+        p_link->update_pending = false;
+        p_link->current_interval = p_gap_evt->params.conn_param_update.conn_params.max_conn_interval;
+        NRF_LOG_INFO("Conn %d: interval now %d (x1.25 ms)", conn_handle, p_link->current_interval);
+        // Peer may have picked other values, or the plan changed meanwhile
+        link_apply(conn_handle);
+        break;
+
+    case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+        if (p_link->active && (p_link->interval != 0))
+        {
+            // Answer with the planned interval, the peer does not know the other links
+            ble_gap_conn_params_t params =
+            {
+                .min_conn_interval = p_link->interval,
+                .max_conn_interval = p_link->interval,
+                .slave_latency     = 0,
+                .conn_sup_timeout  = USR_CONN_SUP_TIMEOUT,
+            };
+            err_code = sd_ble_gap_conn_param_update(conn_handle, &params);
+        }else
+        {
+            // Accepting parameters requested by peer.
+            err_code = sd_ble_gap_conn_param_update(conn_handle, &p_gap_evt->params.conn_param_update_request.conn_params);
+        }
+        if (err_code == NRF_SUCCESS)
+        {
+            p_link->update_pending = true;
+        }
+        else if (err_code != NRF_ERROR_BUSY)
+        {
+            APP_ERROR_CHECK(err_code);
+        }
+        break;
+
+    case BLE_GAP_EVT_PHY_UPDATE:
+    case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+        // Retry an update refused with NRF_ERROR_BUSY
+        link_apply(conn_handle);
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,76 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_conn_params.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Connection parameter planner for multiple sensor links
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_CONN_PARAMS_H_
+#define _USR_CONN_PARAMS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble.h"
+#include "ble_gap.h"
+#include "app_util.h"
+#include "nrf_sdh_ble.h"
+
+#define USR_CONN_PARAMS_OBSERVER_PRIO   2   // Before the application observer, so CONNECTED is recorded first
+
+// Interval limits (1.25 ms units)
+#define USR_CONN_INTERVAL_MIN       ((uint16_t) MSEC_TO_UNITS(NRF_BLE_SCAN_MIN_CONNECTION_INTERVAL, UNIT_1_25_MS))
+#define USR_CONN_INTERVAL_MAX       ((uint16_t) MSEC_TO_UNITS(50, UNIT_1_25_MS))
+#define USR_CONN_SUP_TIMEOUT        ((uint16_t) MSEC_TO_UNITS(NRF_BLE_SCAN_SUPERVISION_TIMEOUT, UNIT_10_MS))
+
+// Event length reserved per link and connection interval (1.25 ms units), used for the connection configuration.
+// All links need an event within the shortest interval, otherwise the SoftDevice skips events of some links.
+#define USR_CONN_EVENT_LENGTH       MAX(BLE_GAP_EVENT_LENGTH_MIN, USR_CONN_INTERVAL_MIN / NRF_SDH_BLE_CENTRAL_LINK_COUNT)
+
+// Demand of one link, see usr_budget
+typedef struct
+{
+    uint16_t conn_handle;
+    uint32_t air_us;        // Radio time needed per second
+    uint32_t att_bytes;     // Notification payload per second
+} usr_conn_demand_t;
+
+// Plan and measurement of one link
+typedef struct
+{
+    uint16_t interval;          // Planned interval (1.25 ms units)
+    uint16_t current_interval;  // Interval in use (1.25 ms units)
+    uint32_t predicted_bytes;   // Payload per second the plan delivers
+    uint32_t capacity_bytes;    // Payload per second the planned interval can carry
+    uint32_t achieved_bytes;    // Payload per second received since the previous report
+} usr_conn_link_report_t;
+
+// Compute the connection interval of each link and request it from the peers
+void usr_conn_params_plan(usr_conn_demand_t const * p_demand, uint8_t count);
+
+// Count received notification payload, used for the achieved throughput
+void usr_conn_params_on_notif(uint16_t conn_handle, uint16_t len);
+
+// Report of one link, resets the achieved throughput window when reset is set
+ret_code_t usr_conn_params_report_get(uint16_t conn_handle, usr_conn_link_report_t * p_report, bool reset);
+
+// Restart the window of the achieved throughput for all links
+void usr_conn_params_report_reset(void);
+
+#endif
@@ -0,0 +1,433 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_gatt_sched.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: GATT client request scheduler with priority classes
+ *
+ *               nrf_ble_gq sends requests in the order they were queued, so a
+ *               configuration write waits behind all CCCD writes and battery
+ *               reads queued before it. Requests are kept here and passed to
+ *               nrf_ble_gq one at a time per link, highest class first.
+ *               Requests are added from thread mode and answered in the
+ *               SoftDevice interrupt, the link tables are only changed in
+ *               critical regions.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_gatt_sched.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+
+#define NRF_LOG_MODULE_NAME usr_gatt_sched_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define TICKS_TO_MS(ticks)          ((uint32_t) (((uint64_t) (ticks) * 1000) / APP_TIMER_TICKS(1000)))
+#define ENTRY_NONE                  0xFF
+
+typedef struct
+{
+    bool     used;
+    uint8_t  type;          // nrf_ble_gq_req_type_t
+    uint8_t  prio;
+    uint8_t  len;
+    uint8_t  retries;
+    uint16_t handle;
+    uint32_t seq;           // Queue order within a class
+    uint32_t queued_ticks;
+    uint8_t  value[USR_GATT_SCHED_VALUE_MAX_LEN];
+} gatt_entry_t;
+
+typedef struct
+{
+    gatt_entry_t entries[USR_GATT_SCHED_QUEUE_SIZE];
+    bool     connected;
+    uint8_t  outstanding;   // Entry passed to nrf_ble_gq, ENTRY_NONE when idle
+    bool     processing;
+    bool     wait;          // GATT queue full, retry on the next GATTC event
+    uint32_t seq;
+    usr_gatt_stats_t stats;
+} gatt_link_t;
+
+static gatt_link_t m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static nrf_ble_gq_t * m_p_gatt_queue = NULL;
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_gatt_sched_observer, USR_GATT_SCHED_OBSERVER_PRIO, on_ble_evt, NULL);
+
+static void gq_error_handler(uint32_t nrf_error, void * p_ctx, uint16_t conn_handle);
+
+
+static void link_reset(gatt_link_t * p_link)
+{
+    memset(p_link, 0, sizeof(gatt_link_t));
+    p_link->outstanding = ENTRY_NONE;
+}
+
+void usr_gatt_sched_init(nrf_ble_gq_t * p_gatt_queue)
+{
+    m_p_gatt_queue = p_gatt_queue;
+
+    for (uint16_t i = 0; i < NRF_SDH_BLE_TOTAL_LINK_COUNT; i++)
+    {
+        link_reset(&m_links[i]);
+    }
+}
+
+static void entry_free(gatt_link_t * p_link, uint8_t idx)
+{
+    p_link->entries[idx].used = false;
+    p_link->stats.depth--;
+}
+
+// Highest class first, oldest first within a class
+static uint8_t entry_next(gatt_link_t const * p_link)
+{
+    uint8_t next = ENTRY_NONE;
+
+    for (uint8_t i = 0; i < USR_GATT_SCHED_QUEUE_SIZE; i++)
+    {
+        gatt_entry_t const * p_entry = &p_link->entries[i];
+        if (!p_entry->used)
+        {
+            continue;
+        }
+
+        if ((next == ENTRY_NONE) ||
+            (p_entry->prio < p_link->entries[next].prio) ||
+            ((p_entry->prio == p_link->entries[next].prio) && ((int32_t) (p_entry->seq - p_link->entries[next].seq) < 0)))
+        {
+            next = i;
+        }
+    }
+
+    return next;
+}
+
+static void latency_add(usr_gatt_latency_t * p_latency, uint32_t ms)
+{
+    if (ms > UINT16_MAX)
+    {
+        ms = UINT16_MAX;
+    }
+
+    if (p_latency->count < UINT16_MAX)
+    {
+        p_latency->count++;
+    }
+    p_latency->avg_ms = (uint16_t) ((int32_t) p_latency->avg_ms + ((int32_t) ms - (int32_t) p_latency->avg_ms) / p_latency->count);
+    if (ms > p_latency->max_ms)
+    {
+        p_latency->max_ms = ms;
+    }
+}
+
+// Pass the next request to the GATT queue when none is in progress
+static void link_process(uint16_t conn_handle)
+{
+    ret_code_t err_code;
+    gatt_link_t * p_link = &m_links[conn_handle];
+
+    // nrf_ble_gq can call gq_error_handler from nrf_ble_gq_item_add
+    if (p_link->processing)
+    {
+        return;
+    }
+    p_link->processing = true;
+
+    while ((p_link->outstanding == ENTRY_NONE) && !p_link->wait)
+    {
+        uint8_t idx = entry_next(p_link);
+        if (idx == ENTRY_NONE)
+        {
+            break;
+        }
+
+        gatt_entry_t * p_entry = &p_link->entries[idx];
+        nrf_ble_gq_req_t req;
+
+        memset(&req, 0, sizeof(req));
+        req.type = (nrf_ble_gq_req_type_t) p_entry->type;
+        req.error_handler.cb = gq_error_handler;
+        req.error_handler.p_ctx = NULL;
+
+        if (p_entry->type == NRF_BLE_GQ_REQ_GATTC_WRITE)
+        {
+            req.params.gattc_write.handle = p_entry->handle;
+            req.params.gattc_write.len = p_entry->len;
+            req.params.gattc_write.offset = 0;
+            req.params.gattc_write.p_value = p_entry->value;
+            req.params.gattc_write.write_op = BLE_GATT_OP_WRITE_REQ;
+        }
+        else
+        {
+            req.params.gattc_read.handle = p_entry->handle;
+            req.params.gattc_read.offset = 0;
+        }
+
+        p_link->outstanding = idx;
+        err_code = nrf_ble_gq_item_add(m_p_gatt_queue, &req, conn_handle);
+        if (err_code == NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        p_link->outstanding = ENTRY_NONE;
+        if ((err_code == NRF_ERROR_NO_MEM) || (err_code == NRF_ERROR_BUSY))
+        {
+            // Shared with service discovery, try again when it answers
+            p_link->stats.retries++;
+            p_link->wait = true;
+        }
+        else
+        {
+            NRF_LOG_WARNING("GATT request 0x%X dropped on conn_handle %d: %d", p_entry->handle, conn_handle, err_code);
+            p_link->stats.errors++;
+            entry_free(p_link, idx);
+        }
+    }
+
+    p_link->processing = false;
+}
+
+static void gq_error_handler(uint32_t nrf_error, void * p_ctx, uint16_t conn_handle)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || (m_links[conn_handle].outstanding == ENTRY_NONE))
+    {
+        NRF_LOG_INFO("A GATT Client error has occurred on conn_handle: 0X%X", conn_handle);
+        return;
+    }
+
+    gatt_link_t * p_link = &m_links[conn_handle];
+
+    CRITICAL_REGION_ENTER();
+
+    uint8_t idx = p_link->outstanding;
+    gatt_entry_t * p_entry = &p_link->entries[idx];
+
+    p_link->outstanding = ENTRY_NONE;
+
+    if ((nrf_error == NRF_ERROR_BUSY) && (p_entry->retries < USR_GATT_SCHED_BUSY_RETRIES))
+    {
+        // Stays queued, sent again on the next GATTC event
+        p_entry->retries++;
+        p_link->stats.retries++;
+        p_link->wait = true;
+    }
+    else
+    {
+        NRF_LOG_WARNING("GATT request 0x%X failed on conn_handle %d: %d", p_entry->handle, conn_handle, nrf_error);
+        p_link->stats.errors++;
+        entry_free(p_link, idx);
+
+        link_process(conn_handle);
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+static ret_code_t entry_add(uint16_t conn_handle, usr_gatt_prio_t prio, uint8_t type, uint16_t handle,
+                            uint8_t const * p_value, uint16_t len)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || (prio >= USR_GATT_PRIO_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (len > USR_GATT_SCHED_VALUE_MAX_LEN)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+
+    ret_code_t err_code = NRF_SUCCESS;
+    gatt_link_t * p_link = &m_links[conn_handle];
+    uint8_t free_idx = ENTRY_NONE;
+    bool merged = false;
+
+    CRITICAL_REGION_ENTER();
+
+    if (!p_link->connected)
+    {
+        err_code = NRF_ERROR_INVALID_STATE;
+    }
+
+    for (uint8_t i = 0; (err_code == NRF_SUCCESS) && (i < USR_GATT_SCHED_QUEUE_SIZE); i++)
+    {
+        gatt_entry_t * p_entry = &p_link->entries[i];
+
+        if (!p_entry->used)
+        {
+            if (free_idx == ENTRY_NONE)
+            {
+                free_idx = i;
+            }
+            continue;
+        }
+
+        // Only the newest value of a pending write is sent, a pending read is not repeated
+        if ((i != p_link->outstanding) && (p_entry->handle == handle) && (p_entry->type == type))
+        {
+            if (type == NRF_BLE_GQ_REQ_GATTC_WRITE)
+            {
+                memcpy(p_entry->value, p_value, len);
+                p_entry->len = len;
+                p_entry->prio = MIN(p_entry->prio, prio);
+            }
+            merged = true;
+            break;
+        }
+    }
+
+    if ((err_code == NRF_SUCCESS) && !merged && (free_idx == ENTRY_NONE))
+    {
+        p_link->stats.dropped++;
+        err_code = NRF_ERROR_NO_MEM;
+    }
+
+    if ((err_code == NRF_SUCCESS) && !merged)
+    {
+        gatt_entry_t * p_entry = &p_link->entries[free_idx];
+        p_entry->used = true;
+        p_entry->type = type;
+        p_entry->prio = prio;
+        p_entry->len = len;
+        p_entry->retries = 0;
+        p_entry->handle = handle;
+        p_entry->seq = p_link->seq++;
+        p_entry->queued_ticks = app_timer_cnt_get();
+        if (len > 0)
+        {
+            memcpy(p_entry->value, p_value, len);
+        }
+
+        p_link->stats.depth++;
+        if (p_link->stats.depth > p_link->stats.max_depth)
+        {
+            p_link->stats.max_depth = p_link->stats.depth;
+        }
+
+        link_process(conn_handle);
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+ret_code_t usr_gatt_sched_write(uint16_t conn_handle, usr_gatt_prio_t prio, uint16_t handle, uint8_t const * p_value, uint16_t len)
+{
+    return entry_add(conn_handle, prio, NRF_BLE_GQ_REQ_GATTC_WRITE, handle, p_value, len);
+}
+
+ret_code_t usr_gatt_sched_read(uint16_t conn_handle, usr_gatt_prio_t prio, uint16_t handle)
+{
+    return entry_add(conn_handle, prio, NRF_BLE_GQ_REQ_GATTC_READ, handle, NULL, 0);
+}
+
+ret_code_t usr_gatt_stats_get(uint16_t conn_handle, usr_gatt_stats_t * p_stats)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || !m_links[conn_handle].connected)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_links[conn_handle].stats;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+// Response to the request in progress
+static void on_response(uint16_t conn_handle, uint8_t type, uint16_t handle, uint16_t gatt_status)
+{
+    gatt_link_t * p_link = &m_links[conn_handle];
+    uint8_t idx = p_link->outstanding;
+
+    if ((idx == ENTRY_NONE) || (p_link->entries[idx].type != type) || (p_link->entries[idx].handle != handle))
+    {
+        // Response to a request of service discovery
+        return;
+    }
+
+    gatt_entry_t * p_entry = &p_link->entries[idx];
+
+    if (gatt_status != BLE_GATT_STATUS_SUCCESS)
+    {
+        NRF_LOG_WARNING("GATT request 0x%X on conn_handle %d: status 0x%X", handle, conn_handle, gatt_status);
+        p_link->stats.errors++;
+    }
+
+    latency_add(&p_link->stats.latency[p_entry->prio],
+                TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), p_entry->queued_ticks)));
+
+    p_link->outstanding = ENTRY_NONE;
+    entry_free(p_link, idx);
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    // GAP and GATTC events both start with the connection handle
+    uint16_t conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    // Thread mode adds requests to the same link tables
+    CRITICAL_REGION_ENTER();
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+        link_reset(&m_links[conn_handle]);
+        m_links[conn_handle].connected = true;
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        // nrf_ble_gq drops the requests of a disconnected link as well
+        link_reset(&m_links[conn_handle]);
+        break;
+
+    case BLE_GATTC_EVT_WRITE_RSP:
+        on_response(conn_handle, NRF_BLE_GQ_REQ_GATTC_WRITE, p_ble_evt->evt.gattc_evt.params.write_rsp.handle,
+                    p_ble_evt->evt.gattc_evt.gatt_status);
+        break;
+
+    case BLE_GATTC_EVT_READ_RSP:
+        on_response(conn_handle, NRF_BLE_GQ_REQ_GATTC_READ, p_ble_evt->evt.gattc_evt.params.read_rsp.handle,
+                    p_ble_evt->evt.gattc_evt.gatt_status);
+        break;
+
+    default:
+        break;
+    }
+
+    // Every GATTC event can free room in the GATT queue
+    if ((p_ble_evt->header.evt_id >= BLE_GATTC_EVT_BASE) && (p_ble_evt->header.evt_id <= BLE_GATTC_EVT_LAST))
+    {
+        m_links[conn_handle].wait = false;
+        link_process(conn_handle);
+    }
+
+    CRITICAL_REGION_EXIT();
+}
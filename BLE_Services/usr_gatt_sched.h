@@ -0,0 +1,81 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_gatt_sched.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: GATT client request scheduler with priority classes
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_GATT_SCHED_H_
+#define _USR_GATT_SCHED_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble.h"
+#include "nrf_ble_gq.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#define USR_GATT_SCHED_OBSERVER_PRIO    2   // After nrf_ble_gq
+
+#define USR_GATT_SCHED_QUEUE_SIZE       8   // Pending requests per link, all classes together
+#define USR_GATT_SCHED_VALUE_MAX_LEN    32  // Largest write (ble_imu_service_config_t)
+#define USR_GATT_SCHED_BUSY_RETRIES     3   // Resubmissions of a request the SoftDevice was busy for
+
+// Priority classes, a lower value is sent first
+typedef enum
+{
+    USR_GATT_PRIO_CONFIG = 0,   // Configuration writes (START, STOP, measurement settings)
+    USR_GATT_PRIO_CCCD,         // Notification enable
+    USR_GATT_PRIO_BATTERY,      // Battery level reads
+    USR_GATT_PRIO_COUNT
+} usr_gatt_prio_t;
+
+// Request latency of one class, from queueing to the response
+typedef struct
+{
+    uint16_t count;
+    uint16_t avg_ms;
+    uint16_t max_ms;
+} usr_gatt_latency_t;
+
+// Queue statistics of one link since it connected
+typedef struct
+{
+    uint8_t  depth;         // Pending requests, including the one in progress
+    uint8_t  max_depth;
+    uint16_t retries;       // Resubmissions after NRF_ERROR_BUSY / NRF_ERROR_NO_MEM
+    uint16_t errors;        // Requests dropped on an error or answered with a GATT error
+    uint16_t dropped;       // Requests refused because the queue was full
+    usr_gatt_latency_t latency[USR_GATT_PRIO_COUNT];
+} usr_gatt_stats_t;
+
+// Requests are passed to the GATT queue one at a time per link, call after ble_db_discovery_init
+void usr_gatt_sched_init(nrf_ble_gq_t * p_gatt_queue);
+
+// Queue a write request, a pending write to the same handle gets the new value
+ret_code_t usr_gatt_sched_write(uint16_t conn_handle, usr_gatt_prio_t prio, uint16_t handle, uint8_t const * p_value, uint16_t len);
+
+// Queue a read request, the response is handled by the client of the handle
+ret_code_t usr_gatt_sched_read(uint16_t conn_handle, usr_gatt_prio_t prio, uint16_t handle);
+
+// Statistics of a link, NRF_ERROR_NOT_FOUND when not connected
+ret_code_t usr_gatt_stats_get(uint16_t conn_handle, usr_gatt_stats_t * p_stats);
+
+#endif
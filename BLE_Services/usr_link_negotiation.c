@@ -0,0 +1,334 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_link_negotiation.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Per-link ATT MTU, data length and PHY negotiation
+ *
+ *               The link layer procedures are started one after the other, the
+ *               SoftDevice refuses a second procedure with NRF_ERROR_BUSY while
+ *               one is running. nrf_ble_gatt starts the MTU exchange on connect,
+ *               this module follows with the data length update and the PHY update.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_link_negotiation.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "ble_hci.h"
+
+#define NRF_LOG_MODULE_NAME usr_link_negotiation_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define ATT_MTU_DEFAULT         23
+#define ATT_NOTIF_OVERHEAD      3   // ATT opcode 1 + handle 2
+#define PHY_RETRY_MAX           2
+
+static usr_link_caps_t m_caps[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static bool m_busy[NRF_SDH_BLE_TOTAL_LINK_COUNT];    // Step refused with NRF_ERROR_BUSY, retried on the next procedure event
+static nrf_ble_gatt_t * mp_gatt = NULL;
+static usr_link_neg_done_handler_t m_done_handler = NULL;
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_link_neg_observer, USR_LINK_NEG_OBSERVER_PRIO, on_ble_evt, NULL);
+
+
+static void link_done(uint16_t conn_handle)
+{
+    usr_link_caps_t * p_caps = &m_caps[conn_handle];
+
+    p_caps->state = USR_LINK_NEG_DONE;
+    NRF_LOG_INFO("Conn %d: MTU %d, DLE %d, PHY tx %d rx %d, fallback 0x%x", conn_handle,
+                 p_caps->att_mtu, p_caps->data_length, p_caps->tx_phy, p_caps->rx_phy, p_caps->fallback);
+
+    if (m_done_handler != NULL)
+    {
+        m_done_handler(conn_handle);
+    }
+}
+
+static void phy_request(uint16_t conn_handle)
+{
+    ret_code_t err_code;
+    usr_link_caps_t * p_caps = &m_caps[conn_handle];
+    ble_gap_phys_t const phys =
+        {
+            .rx_phys = BLE_GAP_PHY_2MBPS,
+            .tx_phys = BLE_GAP_PHY_2MBPS,
+        };
+
+    p_caps->state = USR_LINK_NEG_PHY;
+    m_busy[conn_handle] = false;
+
+    err_code = sd_ble_gap_phy_update(conn_handle, &phys);
+    if (err_code == NRF_SUCCESS)
+    {
+        p_caps->retries++;
+    }
+    else if (err_code == NRF_ERROR_BUSY)
+    {
+        m_busy[conn_handle] = true;
+        NRF_LOG_DEBUG("Conn %d: PHY update busy", conn_handle);
+    }
+    else if ((err_code == NRF_ERROR_INVALID_STATE) || (err_code == BLE_ERROR_INVALID_CONN_HANDLE))
+    {
+        // Disconnecting
+    }
+    else
+    {
+        // Keep 1M
+        p_caps->fallback |= USR_LINK_NEG_FALLBACK_PHY;
+        link_done(conn_handle);
+    }
+}
+
+static void dle_request(uint16_t conn_handle)
+{
+    ret_code_t err_code;
+    usr_link_caps_t * p_caps = &m_caps[conn_handle];
+
+    p_caps->state = USR_LINK_NEG_DLE;
+    m_busy[conn_handle] = false;
+
+    err_code = nrf_ble_gatt_data_length_set(mp_gatt, conn_handle, NRF_SDH_BLE_GAP_DATA_LENGTH);
+    if (err_code == NRF_ERROR_BUSY)
+    {
+        m_busy[conn_handle] = true;
+        NRF_LOG_DEBUG("Conn %d: data length update busy", conn_handle);
+    }
+    else if ((err_code == NRF_ERROR_INVALID_STATE) || (err_code == BLE_ERROR_INVALID_CONN_HANDLE))
+    {
+        // Disconnecting
+    }
+    else if (err_code != NRF_SUCCESS)
+    {
+        // Peer or controller does not support DLE, keep 27 octets
+        p_caps->fallback |= USR_LINK_NEG_FALLBACK_DLE;
+        phy_request(conn_handle);
+    }
+}
+
+// Repeat a step that was refused while another procedure was running
+static void busy_retry(uint16_t conn_handle)
+{
+    if (!m_busy[conn_handle])
+    {
+        return;
+    }
+
+    if (m_caps[conn_handle].state == USR_LINK_NEG_DLE)
+    {
+        dle_request(conn_handle);
+    }
+    else if (m_caps[conn_handle].state == USR_LINK_NEG_PHY)
+    {
+        phy_request(conn_handle);
+    }
+}
+
+void usr_link_negotiation_init(nrf_ble_gatt_t * p_gatt, usr_link_neg_done_handler_t done_handler)
+{
+    ret_code_t err_code;
+
+    mp_gatt = p_gatt;
+    m_done_handler = done_handler;
+    memset(m_caps, 0, sizeof(m_caps));
+    memset(m_busy, 0, sizeof(m_busy));
+
+    // nrf_ble_gatt would start the data length update together with the MTU exchange, keep the default
+    // so the procedures run in sequence
+    err_code = nrf_ble_gatt_data_length_set(mp_gatt, BLE_CONN_HANDLE_INVALID, BLE_GAP_DATA_LENGTH_DEFAULT);
+    APP_ERROR_CHECK(err_code);
+}
+
+void usr_link_negotiation_on_gatt_evt(nrf_ble_gatt_evt_t const * p_evt)
+{
+    uint16_t conn_handle = p_evt->conn_handle;
+
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    usr_link_caps_t * p_caps = &m_caps[conn_handle];
+
+    switch (p_evt->evt_id)
+    {
+    case NRF_BLE_GATT_EVT_ATT_MTU_UPDATED:
+        p_caps->att_mtu = p_evt->params.att_mtu_effective;
+        if (p_caps->att_mtu < NRF_SDH_BLE_GATT_MAX_MTU_SIZE)
+        {
+            p_caps->fallback |= USR_LINK_NEG_FALLBACK_MTU;
+        }
+        if (p_caps->state == USR_LINK_NEG_MTU)
+        {
+            dle_request(conn_handle);
+        }
+        break;
+
+    case NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED:
+        p_caps->data_length = p_evt->params.data_length;
+        if (p_caps->data_length < NRF_SDH_BLE_GAP_DATA_LENGTH)
+        {
+            p_caps->fallback |= USR_LINK_NEG_FALLBACK_DLE;
+        }
+        if (p_caps->state == USR_LINK_NEG_DLE)
+        {
+            phy_request(conn_handle);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void usr_link_negotiation_kick(uint16_t conn_handle)
+{
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    if (m_caps[conn_handle].state == USR_LINK_NEG_MTU)
+    {
+        // Peer did not answer the MTU exchange, go on with what nrf_ble_gatt has
+        m_caps[conn_handle].att_mtu = nrf_ble_gatt_eff_mtu_get(mp_gatt, conn_handle);
+        m_caps[conn_handle].fallback |= USR_LINK_NEG_FALLBACK_MTU;
+        dle_request(conn_handle);
+    }
+    else
+    {
+        busy_retry(conn_handle);
+    }
+}
+
+ret_code_t usr_link_caps_get(uint16_t conn_handle, usr_link_caps_t * p_caps)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || (m_caps[conn_handle].state == USR_LINK_NEG_IDLE))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_caps = m_caps[conn_handle];
+    return NRF_SUCCESS;
+}
+
+uint16_t usr_link_max_notif_len(uint16_t conn_handle)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || (m_caps[conn_handle].state == USR_LINK_NEG_IDLE))
+    {
+        return ATT_MTU_DEFAULT - ATT_NOTIF_OVERHEAD;
+    }
+
+    return m_caps[conn_handle].att_mtu - ATT_NOTIF_OVERHEAD;
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ret_code_t err_code;
+    ble_gap_evt_t const * p_gap_evt = &p_ble_evt->evt.gap_evt;
+    uint16_t conn_handle = p_gap_evt->conn_handle;
+
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    usr_link_caps_t * p_caps = &m_caps[conn_handle];
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+        memset(p_caps, 0, sizeof(usr_link_caps_t));
+        m_busy[conn_handle] = false;
+        p_caps->state = USR_LINK_NEG_MTU;
+        p_caps->att_mtu = ATT_MTU_DEFAULT;
+        p_caps->data_length = BLE_GAP_DATA_LENGTH_DEFAULT;
+        p_caps->tx_phy = BLE_GAP_PHY_1MBPS;
+        p_caps->rx_phy = BLE_GAP_PHY_1MBPS;
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        memset(p_caps, 0, sizeof(usr_link_caps_t));
+        break;
+
+    case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+    {
+        // Prefer 2M when the peer supports it, else leave the choice to the SoftDevice
+        ble_gap_phys_t const * p_peer = &p_gap_evt->params.phy_update_request.peer_preferred_phys;
+        ble_gap_phys_t phys =
+            {
+                .rx_phys = (p_peer->rx_phys & BLE_GAP_PHY_2MBPS) ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_AUTO,
+                .tx_phys = (p_peer->tx_phys & BLE_GAP_PHY_2MBPS) ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_AUTO,
+            };
+        err_code = sd_ble_gap_phy_update(conn_handle, &phys);
+        if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_INVALID_STATE) && (err_code != BLE_ERROR_INVALID_CONN_HANDLE))
+        {
+            APP_ERROR_CHECK(err_code);
+        }
+    }
+    break;
+
+    case BLE_GAP_EVT_PHY_UPDATE:
+    {
+        ble_gap_evt_phy_update_t const * p_phy = &p_gap_evt->params.phy_update;
+
+        if (p_phy->status == BLE_HCI_STATUS_CODE_SUCCESS)
+        {
+            p_caps->tx_phy = p_phy->tx_phy;
+            p_caps->rx_phy = p_phy->rx_phy;
+        }
+
+        if ((p_caps->state != USR_LINK_NEG_PHY) || m_busy[conn_handle])
+        {
+            // Peer initiated update
+            busy_retry(conn_handle);
+            break;
+        }
+
+        if ((p_phy->status == BLE_HCI_STATUS_CODE_SUCCESS) && (p_phy->tx_phy == BLE_GAP_PHY_2MBPS) && (p_phy->rx_phy == BLE_GAP_PHY_2MBPS))
+        {
+            link_done(conn_handle);
+        }
+        else if ((p_phy->status != BLE_HCI_STATUS_CODE_SUCCESS) && (p_phy->status != BLE_HCI_UNSUPPORTED_REMOTE_FEATURE) && (p_caps->retries < PHY_RETRY_MAX))
+        {
+            NRF_LOG_INFO("Conn %d: PHY update failed (0x%x), retry", conn_handle, p_phy->status);
+            phy_request(conn_handle);
+        }
+        else
+        {
+            // Peer does not support 2M, keep what was agreed
+            p_caps->fallback |= USR_LINK_NEG_FALLBACK_PHY;
+            link_done(conn_handle);
+        }
+    }
+    break;
+
+    case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+    case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+        // Another procedure finished
+        busy_retry(conn_handle);
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,82 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_link_negotiation.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Per-link ATT MTU, data length and PHY negotiation
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_LINK_NEGOTIATION_H_
+#define _USR_LINK_NEGOTIATION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble.h"
+#include "ble_gap.h"
+#include "nrf_ble_gatt.h"
+#include "nrf_sdh_ble.h"
+
+#define USR_LINK_NEG_OBSERVER_PRIO  2   // After nrf_ble_gatt, before the application
+
+// Negotiation steps, done one after the other: MTU -> DLE -> PHY
+typedef enum
+{
+    USR_LINK_NEG_IDLE = 0,  // Not connected
+    USR_LINK_NEG_MTU,       // Waiting for the ATT MTU exchange
+    USR_LINK_NEG_DLE,       // Waiting for the data length update
+    USR_LINK_NEG_PHY,       // Waiting for the PHY update
+    USR_LINK_NEG_DONE
+} usr_link_neg_state_t;
+
+// Steps that did not reach the preferred value
+#define USR_LINK_NEG_FALLBACK_MTU   (1 << 0)
+#define USR_LINK_NEG_FALLBACK_DLE   (1 << 1)
+#define USR_LINK_NEG_FALLBACK_PHY   (1 << 2)
+
+// Negotiated capability of one link
+typedef struct
+{
+    usr_link_neg_state_t state;
+    uint16_t att_mtu;       // Effective ATT MTU
+    uint8_t  data_length;   // Link layer payload octets
+    uint8_t  tx_phy;        // BLE_GAP_PHY_*
+    uint8_t  rx_phy;
+    uint8_t  fallback;      // USR_LINK_NEG_FALLBACK_*
+    uint8_t  retries;       // PHY update attempts
+} usr_link_caps_t;
+
+// Called when the negotiation of a link has finished
+typedef void (*usr_link_neg_done_handler_t)(uint16_t conn_handle);
+
+// Takes over the data length update from nrf_ble_gatt, call after nrf_ble_gatt_init
+void usr_link_negotiation_init(nrf_ble_gatt_t * p_gatt, usr_link_neg_done_handler_t done_handler);
+
+// Forward nrf_ble_gatt events
+void usr_link_negotiation_on_gatt_evt(nrf_ble_gatt_evt_t const * p_evt);
+
+// Continue with the next step when the current one did not answer (e.g. after service discovery)
+void usr_link_negotiation_kick(uint16_t conn_handle);
+
+// Capability of a link, NRF_ERROR_NOT_FOUND when not connected
+ret_code_t usr_link_caps_get(uint16_t conn_handle, usr_link_caps_t * p_caps);
+
+// Largest notification payload the link can carry
+uint16_t usr_link_max_notif_len(uint16_t conn_handle);
+
+#endif
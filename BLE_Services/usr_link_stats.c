@@ -0,0 +1,271 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_link_stats.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Per-link reception statistics
+ *
+ *               The notification path only increments counters and reads the
+ *               RTC, rates and connection events are derived when a report is made.
+ *               Windows longer than the app_timer counter period (512 s at
+ *               prescaler 0) are not supported.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_link_stats.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+#include "ble_hci.h"
+
+#define NRF_LOG_MODULE_NAME usr_link_stats_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define TICKS_TO_MS(ticks)          ((uint32_t) (((uint64_t) (ticks) * 1000) / APP_TIMER_TICKS(1000)))
+#define INTERVAL_TO_TICKS(i)        ((uint32_t) (((uint64_t) (i) * 1250 * APP_TIMER_TICKS(1000)) / 1000000))
+#define GAP_MIN_NOTIFS              8   // Notifications before the average period is trusted
+#define AVG_SHIFT                   3   // Average period over ~8 notifications
+
+typedef struct
+{
+    usr_link_stats_t stats;
+    bool     connected;
+    uint32_t window_start;      // app_timer ticks
+    uint32_t connect_ticks;
+    uint32_t last_notif_ticks;
+    uint32_t avg_period_ticks;
+    uint32_t interval_ticks;    // Connection interval
+    uint32_t interval_start;    // Start of the part of the window at interval_ticks
+} link_stats_t;
+
+static link_stats_t m_links[NRF_SDH_BLE_TOTAL_LINK_COUNT];
+static usr_link_stats_report_handler_t m_report_handler = NULL;
+
+APP_TIMER_DEF(m_report_timer);
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_link_stats_observer, USR_LINK_STATS_OBSERVER_PRIO, on_ble_evt, NULL);
+
+
+static void report_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_report_handler != NULL)
+    {
+        m_report_handler();
+    }
+}
+
+static void report_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, report_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Link stats report dropped: %d", err_code);
+    }
+}
+
+void usr_link_stats_init(usr_link_stats_report_handler_t report_handler)
+{
+    ret_code_t err_code;
+
+    m_report_handler = report_handler;
+
+    err_code = app_timer_create(&m_report_timer, APP_TIMER_MODE_REPEATED, report_timer_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+ret_code_t usr_link_stats_period_set(uint8_t period_s)
+{
+    ret_code_t err_code = app_timer_stop(m_report_timer);
+    if ((err_code != NRF_SUCCESS) || (period_s == 0))
+    {
+        return err_code;
+    }
+
+    return app_timer_start(m_report_timer, APP_TIMER_TICKS((uint32_t) period_s * 1000), NULL);
+}
+
+// Connection events since interval_start at the current interval, moves interval_start to now
+static void conn_events_update(link_stats_t * p_link, uint32_t now)
+{
+    if (p_link->interval_ticks == 0)
+    {
+        return;
+    }
+
+    uint32_t ticks = app_timer_cnt_diff_compute(now, p_link->interval_start);
+    uint32_t events = ticks / p_link->interval_ticks;
+
+    p_link->stats.conn_events += events;
+    // Keep the remainder for the next count
+    p_link->interval_start = now - (ticks - events * p_link->interval_ticks);
+}
+
+void usr_link_stats_on_notif(uint16_t conn_handle, uint16_t len, uint8_t samples)
+{
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    link_stats_t * p_link = &m_links[conn_handle];
+    uint32_t now = app_timer_cnt_get();
+
+    if (p_link->last_notif_ticks != 0)
+    {
+        uint32_t period = app_timer_cnt_diff_compute(now, p_link->last_notif_ticks);
+
+        if ((p_link->stats.notifs >= GAP_MIN_NOTIFS) && (period > USR_LINK_STATS_GAP_FACTOR * p_link->avg_period_ticks))
+        {
+            p_link->stats.gaps++;
+            p_link->stats.gaps_total++;
+        }
+
+        uint32_t period_ms = TICKS_TO_MS(period);
+        if (period_ms > p_link->stats.max_gap_ms)
+        {
+            p_link->stats.max_gap_ms = (period_ms > UINT16_MAX) ? UINT16_MAX : period_ms;
+        }
+
+        // Moving average, the first period seeds it
+        if (p_link->avg_period_ticks == 0)
+        {
+            p_link->avg_period_ticks = period;
+        }
+        else
+        {
+            p_link->avg_period_ticks += ((int32_t) period - (int32_t) p_link->avg_period_ticks) >> AVG_SHIFT;
+        }
+    }
+
+    p_link->last_notif_ticks = (now == 0) ? 1 : now;
+    p_link->stats.notifs++;
+    p_link->stats.samples += samples;
+    p_link->stats.samples_total += samples;
+    p_link->stats.bytes += len;
+}
+
+void usr_link_stats_on_discovery(uint16_t conn_handle)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || !m_links[conn_handle].connected)
+    {
+        return;
+    }
+
+    link_stats_t * p_link = &m_links[conn_handle];
+    uint32_t ms = TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), p_link->connect_ticks));
+
+    p_link->stats.discovery_ms = (ms > UINT16_MAX) ? UINT16_MAX : ms;
+}
+
+ret_code_t usr_link_stats_get(uint16_t conn_handle, usr_link_stats_t * p_stats, bool reset)
+{
+    if ((conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT) || !m_links[conn_handle].connected)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    link_stats_t * p_link = &m_links[conn_handle];
+    uint32_t now = app_timer_cnt_get();
+
+    conn_events_update(p_link, now);
+    p_link->stats.window_ms = TICKS_TO_MS(app_timer_cnt_diff_compute(now, p_link->window_start));
+
+    *p_stats = p_link->stats;
+
+    if (reset)
+    {
+        p_link->window_start = now;
+        p_link->stats.notifs = 0;
+        p_link->stats.samples = 0;
+        p_link->stats.bytes = 0;
+        p_link->stats.gaps = 0;
+        p_link->stats.max_gap_ms = 0;
+        p_link->stats.conn_events = 0;
+    }
+
+    return NRF_SUCCESS;
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ret_code_t err_code;
+    ble_gap_evt_t const * p_gap_evt = &p_ble_evt->evt.gap_evt;
+    uint16_t conn_handle = p_gap_evt->conn_handle;
+
+    if (conn_handle >= NRF_SDH_BLE_TOTAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    link_stats_t * p_link = &m_links[conn_handle];
+    uint32_t now = app_timer_cnt_get();
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+    {
+        // Disconnect history survives the reconnection
+        uint8_t disconnects = p_link->stats.disconnects;
+        uint8_t reason = p_link->stats.disconnect_reason;
+
+        memset(p_link, 0, sizeof(link_stats_t));
+        p_link->stats.disconnects = disconnects;
+        p_link->stats.disconnect_reason = reason;
+        p_link->connected = true;
+        p_link->connect_ticks = now;
+        p_link->window_start = now;
+        p_link->interval_start = now;
+        p_link->interval_ticks = INTERVAL_TO_TICKS(p_gap_evt->params.connected.conn_params.max_conn_interval);
+
+        err_code = sd_ble_gap_rssi_start(conn_handle, USR_LINK_STATS_RSSI_THRESHOLD, USR_LINK_STATS_RSSI_SKIP);
+        if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_INVALID_STATE) && (err_code != BLE_ERROR_INVALID_CONN_HANDLE))
+        {
+            APP_ERROR_CHECK(err_code);
+        }
+    }
+    break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        p_link->connected = false;
+        if (p_link->stats.disconnects < UINT8_MAX)
+        {
+            p_link->stats.disconnects++;
+        }
+        p_link->stats.disconnect_reason = p_gap_evt->params.disconnected.reason;
+        break;
+
+    case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+        // Count the events at the old interval first
+        conn_events_update(p_link, now);
+        p_link->interval_ticks = INTERVAL_TO_TICKS(p_gap_evt->params.conn_param_update.conn_params.max_conn_interval);
+        break;
+
+    case BLE_GAP_EVT_RSSI_CHANGED:
+        p_link->stats.rssi = p_gap_evt->params.rssi_changed.rssi;
+        break;
+
+    default:
+        break;
+    }
+}
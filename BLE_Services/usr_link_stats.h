@@ -0,0 +1,82 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_link_stats.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Per-link reception statistics
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_LINK_STATS_H_
+#define _USR_LINK_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble.h"
+#include "ble_gap.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#define USR_LINK_STATS_OBSERVER_PRIO    2
+
+// RSSI_CHANGED is reported when the RSSI changed this much (dBm) ...
+#define USR_LINK_STATS_RSSI_THRESHOLD   2
+// ... and stayed changed for this many samples
+#define USR_LINK_STATS_RSSI_SKIP        4
+
+// A notification counts as a gap when it arrives later than this multiple of the average notification period
+#define USR_LINK_STATS_GAP_FACTOR       2
+
+// Statistics of one link over the window since the previous report.
+// Disconnect count and reason are kept over reconnections on the same connection handle.
+typedef struct
+{
+    uint32_t window_ms;         // Length of the window
+    uint32_t notifs;            // Notifications received
+    uint32_t samples;           // Sensor samples in those notifications
+    uint32_t bytes;             // Notification payload
+    uint16_t gaps;              // Notifications later than USR_LINK_STATS_GAP_FACTOR x the average period
+    uint16_t max_gap_ms;        // Longest time between two notifications
+    uint32_t conn_events;       // Connection events (from the connection interval)
+    int8_t   rssi;              // Last reported RSSI (dBm)
+    uint8_t  disconnects;
+    uint8_t  disconnect_reason; // BLE_HCI_* of the last disconnect
+    uint16_t discovery_ms;      // Connect to service discovery complete
+    uint32_t samples_total;     // Since the connection, not reset with the window
+    uint32_t gaps_total;
+} usr_link_stats_t;
+
+// Called from the scheduler at the configured report period
+typedef void (*usr_link_stats_report_handler_t)(void);
+
+// Create the report timer, call after timer_init
+void usr_link_stats_init(usr_link_stats_report_handler_t report_handler);
+
+// Periodic report every period_s seconds, 0 stops it
+ret_code_t usr_link_stats_period_set(uint8_t period_s);
+
+// Count a received notification (called for every HVX, keep cheap)
+void usr_link_stats_on_notif(uint16_t conn_handle, uint16_t len, uint8_t samples);
+
+// Service discovery of a link finished
+void usr_link_stats_on_discovery(uint16_t conn_handle);
+
+// Statistics of a link, starts a new window when reset is set
+ret_code_t usr_link_stats_get(uint16_t conn_handle, usr_link_stats_t * p_stats, bool reset);
+
+#endif
@@ -0,0 +1,106 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_reconnect.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Reconnection of lost sensors with scan backoff
+ *
+ *               Scanning takes radio time from the active links, so it starts fast
+ *               when a sensor is lost and backs off when it does not come back.
+ *               Lost times longer than the app_timer counter period (512 s at
+ *               prescaler 0) are not measured correctly.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_reconnect.h"
+
+#include <string.h>
+
+#include "app_util.h"
+#include "app_timer.h"
+
+#define NRF_LOG_MODULE_NAME usr_reconnect_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define TICKS_TO_MS(ticks)          ((uint32_t) (((uint64_t) (ticks) * 1000) / APP_TIMER_TICKS(1000)))
+
+typedef struct
+{
+    bool     lost;
+    uint32_t lost_ticks;
+} lost_sensor_t;
+
+static lost_sensor_t m_lost[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+static uint8_t m_level = 0;
+
+
+void usr_reconnect_restart(void)
+{
+    m_level = 0;
+}
+
+void usr_reconnect_backoff(void)
+{
+    if (m_level < USR_RECONNECT_LEVELS - 1)
+    {
+        m_level++;
+        NRF_LOG_INFO("Scan backoff level %d", m_level);
+    }
+}
+
+uint8_t usr_reconnect_level_get(void)
+{
+    return m_level;
+}
+
+void usr_reconnect_scan_params_get(ble_gap_scan_params_t * p_scan_params)
+{
+    p_scan_params->interval = MSEC_TO_UNITS(USR_RECONNECT_INTERVAL_MS << m_level, UNIT_0_625_MS);
+    p_scan_params->window = MSEC_TO_UNITS(USR_RECONNECT_WINDOW_MS, UNIT_0_625_MS);
+
+    // The last level scans until the sensors are found
+    p_scan_params->timeout = (m_level < USR_RECONNECT_LEVELS - 1) ? MSEC_TO_UNITS(USR_RECONNECT_LEVEL_MS, UNIT_10_MS) : 0;
+}
+
+void usr_reconnect_on_disconnect(uint8_t slot)
+{
+    if (slot >= NRF_SDH_BLE_CENTRAL_LINK_COUNT)
+    {
+        return;
+    }
+
+    m_lost[slot].lost = true;
+    m_lost[slot].lost_ticks = app_timer_cnt_get();
+}
+
+uint32_t usr_reconnect_on_rejoin(uint8_t slot)
+{
+    if ((slot >= NRF_SDH_BLE_CENTRAL_LINK_COUNT) || !m_lost[slot].lost)
+    {
+        return USR_RECONNECT_NOT_LOST;
+    }
+
+    m_lost[slot].lost = false;
+
+    return TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_lost[slot].lost_ticks));
+}
+
+void usr_reconnect_forget(void)
+{
+    memset(m_lost, 0, sizeof(m_lost));
+}
@@ -0,0 +1,64 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_reconnect.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Reconnection of lost sensors with scan backoff
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_RECONNECT_H_
+#define _USR_RECONNECT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ble_gap.h"
+#include "nrf_sdh_ble.h"
+
+// Scan backoff: the scan interval doubles on every level, the window stays the same
+#define USR_RECONNECT_LEVELS            5       // Last level scans at 960 ms / 50 ms (~5 % duty cycle)
+#define USR_RECONNECT_LEVEL_MS          10000   // Time on a level before backing off, the last level has no limit
+#define USR_RECONNECT_INTERVAL_MS       60      // Scan interval of the first level
+#define USR_RECONNECT_WINDOW_MS         50
+
+// Rejoin of a sensor that was not lost (first connection)
+#define USR_RECONNECT_NOT_LOST          UINT32_MAX
+
+// Back to the first level, on a new device list or a lost sensor
+void usr_reconnect_restart(void);
+
+// Next level, when the scan of the current level timed out
+void usr_reconnect_backoff(void);
+
+// Current level, 0 is the fastest
+uint8_t usr_reconnect_level_get(void);
+
+// Interval, window and timeout of the current level
+void usr_reconnect_scan_params_get(ble_gap_scan_params_t * p_scan_params);
+
+// A listed sensor disconnected
+void usr_reconnect_on_disconnect(uint8_t slot);
+
+// A sensor is connected and discovered again, returns the time since it was lost in ms
+// (USR_RECONNECT_NOT_LOST when it was not lost)
+uint32_t usr_reconnect_on_rejoin(uint8_t slot);
+
+// Forget lost sensors, when the device list changes
+void usr_reconnect_forget(void);
+
+#endif
@@ -46,10 +46,14 @@
 #include "nrf_sdh_soc.h"
 #include "nrf_sdm.h"
 
+#include "usr_prof.h"
+#include "usr_evlog.h"
+#include "settings.h"
+
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
 #define NRF_LOG_MODULE_NAME time_sync
-#define NRF_LOG_LEVEL 4
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_TIME_SYNC
 #include "nrf_log.h"
 NRF_LOG_MODULE_REGISTER();
 
@@ -237,6 +241,8 @@ volatile uint32_t m_prev_sync_pkt_counter;
 
 void RADIO_IRQHandler(void)
 {
+    USR_PROF_ENTER();
+
     if (NRF_RADIO->EVENTS_END != 0)
     {
         NRF_RADIO->EVENTS_END = 0;
@@ -280,6 +286,8 @@ resume_radio_rx:
 
         NRF_RADIO->TASKS_START = 1;
     }
+
+    USR_PROF_EXIT(USR_PROF_TS_RADIO);
 }
 
 /**@brief   Function for handling timeslot events.
@@ -508,7 +516,8 @@ void timeslot_begin_handler(void)
     }
 
     p_pkt->timer_val   = m_params.high_freq_timer[0]->CC[1];
-    p_pkt->counter_val = m_params.high_freq_timer[1]->CC[1];
+    // Offset of a timing master that continues an earlier time base, 0 otherwise
+    p_pkt->counter_val = m_params.high_freq_timer[1]->CC[1] + (uint32_t) m_master_counter_diff;
 
 //    p_pkt->rtc_val     = m_params.rtc->COUNTER;
 
@@ -566,8 +575,7 @@ void ts_on_sys_evt(uint32_t sys_evt, void * p_context)
                         // NRF_LOG_INFO("sd_radio_request earliest: %d", err_code);
                         APP_ERROR_CHECK(err_code);
 
-                        NRF_LOG_INFO("!!FORBIDDEN!! timeslot with type normal");
-                        NRF_LOG_FLUSH();
+                        usr_evlog(USR_EVLOG_TS_FORBIDDEN, 0, 0);
                     }
                     APP_ERROR_CHECK(err_code);
                 }
@@ -701,6 +709,8 @@ uint32_t ts_set_timestamp_trigger(uint32_t ppi_event_endpoint)
 
 void SWI3_EGU3_IRQHandler(void)
 {
+    USR_PROF_ENTER();
+
     if (NRF_EGU3->EVENTS_TRIGGERED[0] != 0)
     {
         m_master_counter_diff = ((sync_pkt_t *) mp_curr_adj_pkt)->counter_val - m_curr_adj_counter;
@@ -809,6 +819,8 @@ void SWI3_EGU3_IRQHandler(void)
             m_callback(&evt);
         }
     }
+
+    USR_PROF_EXIT(USR_PROF_TS_EGU);
 }
 
 static inline bool sync_timer_offset_compensate(sync_pkt_t * p_pkt)
@@ -1243,6 +1255,11 @@ uint32_t ts_tx_stop()
     return NRF_SUCCESS;
 }
 
+void ts_master_counter_offset_set(int32_t counter_offset)
+{
+    m_master_counter_diff = counter_offset;
+}
+
 uint32_t ts_timestamp_get_ticks_u32(void)
 {
     uint32_t sync_timer_val;
@@ -1270,3 +1287,13 @@ uint64_t ts_timestamp_get_ticks_u64(void)
 
     return timestamp;
 }
+
+void ts_status_get(ts_status_t * p_status)
+{
+    p_status->session_open = (m_timeslot_session_open != 0);
+    p_status->transmitting = (m_send_sync_pkt != 0);
+    p_status->synchronized = m_synchronized;
+    p_status->sync_packets = m_sync_pkt_ringbuf_idx;
+    p_status->used_packets = m_used_packet_count;
+    p_status->blocked_cancelled = m_blocked_cancelled_count;
+}
@@ -166,6 +166,14 @@ uint32_t ts_tx_start(uint32_t sync_freq_hz);
  */
 uint32_t ts_tx_stop(void);
 
+/**@brief Offset the counter of a timing master, to continue an earlier time base (warm restart).
+ *
+ * @note Call before @ref ts_tx_start(). The offset is sent in the sync packets, receivers follow it.
+ *
+ * @param[in] counter_offset Offset in counter periods (@ref TIME_SYNC_TIMER_MAX_VAL ticks).
+ */
+void ts_master_counter_offset_set(int32_t counter_offset);
+
 /**@brief Trigger PPI endpoint at given tick
  *
  * @details Time unit is given by @ref TIME_SYNC_TIMER_MAX_VAL.
@@ -225,6 +233,22 @@ uint32_t ts_timestamp_get_ticks_u32(void);
  */
 uint64_t ts_timestamp_get_ticks_u64(void);
 
+typedef struct
+{
+    bool     session_open;      /* Radio timeslot session open */
+    bool     transmitting;      /* Sending sync packets (timing master) */
+    bool     synchronized;      /* Receiving sync packets (timing slave) */
+    uint32_t sync_packets;      /* Sync packets prepared for transmission */
+    uint32_t used_packets;      /* Sync packets received and used */
+    uint32_t blocked_cancelled; /* Timeslots blocked or cancelled by the SoftDevice */
+} ts_status_t;
+
+/**@brief Get the state of the time sync library
+ *
+ * @param[out] p_status State and counters since @ref ts_enable
+ */
+void ts_status_get(ts_status_t * p_status);
+
 #ifdef __cplusplus
 }
 #endif
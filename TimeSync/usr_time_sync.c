@@ -33,10 +33,17 @@
 #include "nrf_timer.h"
 
 #include "nordic_common.h"
+#include "app_util_platform.h"
 
-#include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "settings.h"
+#define NRF_LOG_MODULE_NAME usr_time_sync_c
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_TIME_SYNC
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "usr_evlog.h"
 
 #include "boards.h"
 
@@ -132,8 +139,7 @@ static void ts_evt_callback(const ts_evt_t *evt)
 
             if (err_code != NRF_SUCCESS)
             {
-                NRF_LOG_INFO("ts_evt_callback ERROR: %d", err_code);
-                NRF_LOG_FLUSH();
+                usr_evlog(USR_EVLOG_TS_TRIGGER, 0, err_code);
             }
             APP_ERROR_CHECK(err_code);
 
@@ -243,5 +249,12 @@ void ts_print_sync_time()
 
 uint64_t usr_ts_timestamp_get_ticks_u64()
 { 
-    return ts_timestamp_get_ticks_u64();
+    uint64_t ticks;
+
+    // The timer capture is not reentrant, it is also used from the BLE event interrupt (usr_trace)
+    CRITICAL_REGION_ENTER();
+    ticks = ts_timestamp_get_ticks_u64();
+    CRITICAL_REGION_EXIT();
+
+    return ticks;
 }
@@ -30,6 +30,8 @@
 // | ----------- |----------- |-----------          |------------|-----------|---------|------- |
 // | 1 byte      | 1 byte     | 1 byte              | 1 byte     | 1 byte    | k bytes | 1 byte |
 //  ____________________________________________________________________________________________
+// sensor_nr is the index of the sensor in the device list (COMM_CMD_SET_CONN_DEV_LIST), the same
+// number the reports use.
 
 
 #define START_BYTE                      0x73 // s
@@ -50,16 +52,42 @@ typedef enum
 { 
     QUATERNIONS = 1,
     EULER,
-    RAW
+    RAW,
+    EMG,
+    JOINT_QUAT,
+    JOINT_ANGLES
 } data_type_byte_t;
 
+// Euler angles: roll | pitch | yaw as int16 in 0.01 degrees (-180.00 .. 180.00) | timestamp (8 bytes)
+#define EULER_CENTIDEG_HALF_TURN        18000
+
+// Joint data (JOINT_QUAT / JOINT_ANGLES), sensor_nr is the index of the pair set with COMM_CMD_SET_JOINT_PAIRS
+//  JOINT_QUAT:   w | x | y | z as int32 Q30 (q_a^-1 * q_b, w >= 0) | timestamp (8 bytes)
+//  JOINT_ANGLES: roll | pitch | yaw of q_a^-1 * q_b as int16 in 0.01 degrees | timestamp (8 bytes)
+// The timestamp is the one of the sample of sensor b.
+
+// EMG (ADC) data, one notification is split over as few DATA frames as possible
+//  ______________________________________________________________________________________
+// | timestamp  | first  | count  | sample_bytes | count x sample (little endian)          |
+// | ---------- |------- |------- |------------- |---------------------------------------- |
+// | 8 bytes    | 1 byte | 1 byte | 1 byte       | count x sample_bytes                    |
+//  ______________________________________________________________________________________
+// All frames of a notification carry the timestamp of its first sample, first is the
+// index of the first sample of the frame in the notification.
+// 3: the low 24 bits of every sample, 2: samples saturated to 16 bits
+#ifndef EMG_SAMPLE_BYTES
+#define EMG_SAMPLE_BYTES                3
+#endif
+
 
 typedef enum
 {
     COMM_CMD_MEAS_RAW = 1,
     COMM_CMD_MEAS_QUAT6,
     COMM_CMD_MEAS_QUAT9,
-    COMM_CMD_MEAS_WOM
+    COMM_CMD_MEAS_WOM,
+    COMM_CMD_MEAS_OFF,
+    COMM_CMD_MEAS_EULER
 } command_type_meas_byte_t;
 
 typedef enum
@@ -82,9 +110,480 @@ typedef enum
     COMM_CMD_REQ_BATTERY_LEVEL,
     COMM_CMD_OK,
     COMM_CMD_TIME,
-    COMM_CMD_CONN_DEV_UPDATE
+    COMM_CMD_CONN_DEV_UPDATE,
+    COMM_CMD_MEAS_SENSOR,
+    COMM_CMD_FREQUENCY_SENSOR,
+    COMM_CMD_REJECTED,
+    COMM_CMD_REQ_CONN_PARAMS,
+    COMM_CMD_REQ_LINK_CAPS,
+    COMM_CMD_REQ_LINK_STATS,
+    COMM_CMD_LINK_STATS_PERIOD,
+    COMM_CMD_SET_CONN_DEV_LIST_PAGE,
+    COMM_CMD_REQ_CONN_DEV_LIST_PAGE,
+    COMM_CMD_REQ_COMMISSIONING,
+    COMM_CMD_SENSOR_REJOINED,
+    COMM_CMD_REQ_GATT_STATS,
+    COMM_CMD_BATTERY_PERIOD,
+    COMM_CMD_SET_JOINT_PAIRS,
+    COMM_CMD_RESUME,
+    COMM_CMD_REPLAY,
+    COMM_CMD_REQ_BACKLOG,
+    COMM_CMD_BACKLOG_MARKS,
+    COMM_CMD_FLOW,
+    COMM_CMD_REQ_SPOOL,
+    COMM_CMD_SIM,
+    COMM_CMD_REQ_SIM,
+    COMM_CMD_TRACE,
+    COMM_CMD_TRACE_DATA,
+    COMM_CMD_TRACE_INJECT,
+    COMM_CMD_REQ_LATENCY,
+    COMM_CMD_REQ_PROF,
+    COMM_CMD_CPU_LOAD,
+    COMM_CMD_REQ_TELEMETRY,
+    COMM_CMD_TELEMETRY_PERIOD,
+    COMM_CMD_TELEMETRY_LINKS,
+    COMM_CMD_REQ_EVLOG,
+    COMM_CMD_READY,
+    COMM_CMD_WARM_RESTART
 } command_type_byte_t;
 
+// Sensor specific configuration (COMM_CMD_MEAS_SENSOR / COMM_CMD_FREQUENCY_SENSOR)
+//  _____________________________________________________
+// | command     | sensor_mask         | meas / freq     |
+// |------------ |-------------------- |---------------- |
+// | 1 byte      | 4 bytes (LSB first) | 1 byte          |
+//  _____________________________________________________
+// Bit i of sensor_mask selects the i-th device of the connected device list,
+// a mask of 0 changes the default configuration (same as COMM_CMD_MEAS / COMM_CMD_FREQUENCY).
+// Configurations exceeding the BLE airtime or UART bandwidth are answered with COMM_CMD_REJECTED.
+#define SENSOR_MASK_LEN                 4
+
+// COMM_CMD_SET_CONN_DEV_LIST carries any whole number of 6 byte addresses up to the number of central
+// links of the DCU, the remaining entries are cleared (FF). Lists that do not fit one frame use pages.
+// Device list in pages, for lists that do not fit one frame (COMM_CMD_SET_CONN_DEV_LIST_PAGE / COMM_CMD_REQ_CONN_DEV_LIST_PAGE)
+//  ____________________________________________
+// | command | first  | count  | devices        |
+// |-------- |------- |------- |--------------- |
+// | 1 byte  | 1 byte | 1 byte | count x entry  |
+//  ____________________________________________
+// REQ is answered with pages of dcu_connected_devices_t entries, COMM_CMD_REQ_CONN_DEV_LIST is answered
+// the same way when the list does not fit one frame.
+#define CONN_DEV_PAGE_HEADER_LEN        2
+
+// SET pages carry the length of the whole list, entries are 6 byte addresses
+//  _____________________________________________________
+// | command | first  | count  | total  | devices        |
+// |-------- |------- |------- |------- |--------------- |
+// | 1 byte  | 1 byte | 1 byte | 1 byte | count x entry  |
+//  _____________________________________________________
+// Pages are sent in order, a page with first 0 starts a new list. The list is applied when the page ending
+// at total is received. total is at most the number of central links of the DCU, longer lists and pages
+// out of order are answered with COMM_CMD_REJECTED.
+#define CONN_DEV_SET_PAGE_HEADER_LEN    3
+
+// Connection plan report (answer to COMM_CMD_REQ_CONN_PARAMS), one entry per connected sensor
+//  _______________________________________________________________________________________________________________
+// | count  | sensor_nr | interval (1.25 ms) | current interval | predicted (B/s) | capacity (B/s) | achieved (B/s) |
+// |------- |---------- |------------------- |----------------- |---------------- |--------------- |--------------- |
+// | 1 byte | 1 byte    | 2 bytes            | 2 bytes          | 4 bytes         | 4 bytes        | 4 bytes        |
+//  _______________________________________________________________________________________________________________
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint16_t interval;
+    uint16_t current_interval;
+    uint32_t predicted_bytes;
+    uint32_t capacity_bytes;
+    uint32_t achieved_bytes;
+} stm32_conn_params_t;
+
+// Link capability report (answer to COMM_CMD_REQ_LINK_CAPS), one entry per connected sensor
+//  __________________________________________________________________________________________________________
+// | count  | sensor_nr | state  | att_mtu | data_length | tx_phy | rx_phy | fallback | max notification len |
+// |------- |---------- |------- |-------- |------------ |------- |------- |--------- |--------------------- |
+// | 1 byte | 1 byte    | 1 byte | 2 bytes | 1 byte      | 1 byte | 1 byte | 1 byte   | 2 bytes              |
+//  __________________________________________________________________________________________________________
+// state: usr_link_neg_state_t, phy: BLE_GAP_PHY_*, fallback: USR_LINK_NEG_FALLBACK_* (steps below the preferred value)
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint8_t  state;
+    uint16_t att_mtu;
+    uint8_t  data_length;
+    uint8_t  tx_phy;
+    uint8_t  rx_phy;
+    uint8_t  fallback;
+    uint16_t max_notif_len;
+} stm32_link_caps_t;
+
+// Link statistics report (answer to COMM_CMD_REQ_LINK_STATS, or every period set with
+// COMM_CMD_LINK_STATS_PERIOD [period in s, 0 = off]), one entry per connected sensor.
+// Rates and counters cover the window since the previous report.
+//  ___________________________________________________________________________________________________________
+// | count  | sensor_nr | rssi   | notif/s | samples/s | bytes   | gaps    | max gap | conn events | disconnects |
+// |------- |---------- |------- |-------- |---------- |-------- |-------- |-------- |------------ |------------ |
+// | 1 byte | 1 byte    | 1 byte | 2 bytes | 2 bytes   | 4 bytes | 2 bytes | 2 bytes | 4 bytes     | 1 byte      |
+//  ___________________________________________________________________________________________________________
+//  _______________________________________
+// | disconnect reason | discovery time    |
+// |------------------ |------------------ |
+// | 1 byte (BLE_HCI)  | 2 bytes (ms)      |
+//  _______________________________________
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    int8_t   rssi;
+    uint16_t notif_rate;
+    uint16_t sample_rate;
+    uint32_t bytes;
+    uint16_t gaps;
+    uint16_t max_gap_ms;
+    uint32_t conn_events;
+    uint8_t  disconnects;
+    uint8_t  disconnect_reason;
+    uint16_t discovery_ms;
+} stm32_link_stats_t;
+
+// Commissioning report (answer to COMM_CMD_REQ_COMMISSIONING, also sent when all listed sensors have connected)
+//  ______________________________________________________________________
+// | listed | connected | done   | time (ms) | scan mode | whitelist      |
+// |------- |---------- |------- |---------- |---------- |--------------- |
+// | 1 byte | 1 byte    | 1 byte | 4 bytes   | 1 byte    | 1 byte         |
+//  ______________________________________________________________________
+// time: from the last device list to all listed sensors connected, or since the list while not done
+// scan mode: usr_scan_mode_t (off, fast, slow)
+typedef struct __attribute__((packed))
+{
+    uint8_t  listed;
+    uint8_t  connected;
+    uint8_t  done;
+    uint32_t time_ms;
+    uint8_t  scan_mode;
+    uint8_t  whitelist;
+} stm32_commissioning_t;
+
+// Rejoin report (COMM_CMD_SENSOR_REJOINED), sent when a lost sensor is connected and discovered again
+//  ________________________________________________________
+// | sensor_nr | config pushed | scan level | latency (ms)   |
+// |---------- |-------------- |----------- |--------------- |
+// | 1 byte    | 1 byte        | 1 byte     | 4 bytes        |
+//  ________________________________________________________
+// config pushed: the running measurement configuration and sync start time were sent to the sensor
+// scan level: usr_reconnect backoff level the sensor was found at (0 = fastest)
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint8_t  config_pushed;
+    uint8_t  scan_level;
+    uint32_t latency_ms;
+} stm32_rejoin_t;
+
+// GATT request statistics (answer to COMM_CMD_REQ_GATT_STATS), one entry per connected sensor, since the sensor connected
+//  ________________________________________________________________________________________________
+// | count  | sensor_nr | depth  | max depth | retries | errors  | dropped | latency x 3 classes     |
+// |------- |---------- |------- |---------- |-------- |-------- |-------- |------------------------ |
+// | 1 byte | 1 byte    | 1 byte | 1 byte    | 2 bytes | 2 bytes | 2 bytes | 3 x (avg 2 B, max 2 B)  |
+//  ________________________________________________________________________________________________
+// latency (ms) from queueing to the response, classes in usr_gatt_prio_t order: config, CCCD, battery
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint8_t  depth;
+    uint8_t  max_depth;
+    uint16_t retries;
+    uint16_t errors;
+    uint16_t dropped;
+    struct __attribute__((packed))
+    {
+        uint16_t avg_ms;
+        uint16_t max_ms;
+    } latency[3];
+} stm32_gatt_stats_t;
+
+// Battery report (answer to COMM_CMD_REQ_BATTERY_LEVEL, or the changed levels every period set with
+// COMM_CMD_BATTERY_PERIOD [period in s, 0 = off]), one entry per connected sensor with a known level
+//  ___________________________________________
+// | count  | sensor_nr | percent | voltage    |
+// |------- |---------- |-------- |----------- |
+// | 1 byte | 1 byte    | 1 byte  | 2 bytes mV |
+//  ___________________________________________
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint8_t  percent;
+    uint16_t voltage_mv;
+} stm32_battery_t;
+
+// Sensor pairs for the relative orientation (COMM_CMD_SET_JOINT_PAIRS), count 0 stops it
+//  _______________________________________________________
+// | command | count  | sensor_a | sensor_b | outputs      |
+// |-------- |------- |--------- |--------- |------------- |
+// | 1 byte  | 1 byte | count x 3 bytes                    |
+//  _______________________________________________________
+// Sensors are indexes in the device list, outputs: bit 0 JOINT_QUAT, bit 1 JOINT_ANGLES.
+#define JOINT_PAIR_LEN                  3
+
+// Replay of the stored data frames after an STM32 outage (COMM_CMD_RESUME)
+//  ________________________________________________
+// | command | mode   | seq / time                  |
+// |-------- |------- |---------------------------- |
+// | 1 byte  | 1 byte | 8 bytes (LSB first)         |
+//  ________________________________________________
+// Every data frame is stored with a sequence number. The stored frames are replayed from
+// seq, or those with a timestamp of at least time, while the live data keeps flowing.
+// Replayed frames are the stored DATA frames wrapped in a COMM_CMD_REPLAY frame:
+//  | START_BYTE | packet_len | CONFIG | COMM_CMD_REPLAY | seq (4 bytes) | DATA frame | CS |
+// RESUME and the end of a replay are answered with the backlog status (COMM_CMD_REQ_BACKLOG).
+#define RESUME_VALUE_LEN                8
+
+typedef enum
+{
+    COMM_CMD_RESUME_SEQ = 0,
+    COMM_CMD_RESUME_TIME,
+    COMM_CMD_RESUME_STOP
+} command_type_resume_byte_t;
+
+// Backlog status (answer to COMM_CMD_REQ_BACKLOG)
+typedef struct __attribute__((packed))
+{
+    uint32_t size;
+    uint32_t used;
+    uint32_t oldest_seq;        // Oldest frame still stored
+    uint32_t next_seq;          // Sequence number of the next data frame
+    uint32_t replay_seq;        // Next frame of the replay (next_seq when not replaying)
+    uint32_t lost;              // Frames overwritten before they were replayed
+    uint32_t live_dropped;      // Frames that did not fit the UART FIFO (still stored)
+    uint8_t  replaying;
+} stm32_backlog_t;
+
+// Backlog watermarks (COMM_CMD_BACKLOG_MARKS, after the backlog status), one entry per sensor_nr with stored frames.
+// Joint data has its own entries, sensor_nr = BACKLOG_MARK_PAIR | pair.
+//  ____________________________________________________________
+// | count  | sensor_nr | records | newest seq | newest time     |
+// |------- |---------- |-------- |----------- |---------------- |
+// | 1 byte | 1 byte    | 2 bytes | 4 bytes    | 8 bytes         |
+//  ____________________________________________________________
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint16_t records;
+    uint32_t newest_seq;
+    uint64_t newest_time;
+} stm32_backlog_mark_t;
+
+#define BACKLOG_MARK_PAIR               0x80
+
+// Flow control (COMM_CMD_FLOW [credits]): 0 stops the live data frames, anything else resumes them.
+// Frames that are not sent live (no credits or UART FIFO full) are spooled to flash (nRF52840)
+// and drained as COMM_CMD_REPLAY frames once live data is accepted again.
+
+// Flash spool statistics (answer to COMM_CMD_REQ_SPOOL)
+typedef struct __attribute__((packed))
+{
+    uint16_t pages;             // Pages waiting to be drained
+    uint16_t pages_written;
+    uint32_t bytes_spooled;
+    uint32_t bytes_drained;
+    uint32_t overruns;          // Frames dropped, flash too slow
+    uint32_t lost;              // Frames dropped, spool full
+    uint16_t errors;
+    uint16_t write_ms_avg;      // Erase + write of one page
+    uint16_t write_ms_max;
+    uint8_t  flow_paused;
+} stm32_spool_t;
+
+// Simulated sensor fleet for load tests, firmware built with USR_SIM (COMM_CMD_SIM)
+//  ___________________________________________________________________________
+// | command | sensors | data_type | rate (Hz, per sensor) | jitter (ms) | loss (%) |
+// |-------- |-------- |---------- |---------------------- |------------ |--------- |
+// | 1 byte  | 1 byte  | 1 byte    | 2 bytes               | 1 byte      | 1 byte   |
+//  ___________________________________________________________________________
+// data_type is QUATERNIONS, EULER, RAW or EMG. The simulated sensors produce DATA frames with
+// sensor_nr 0 .. sensors-1, rejected while real sensors are connected. 0 sensors stops it.
+#define SIM_CONFIG_LEN                  6
+
+// Simulation statistics (answer to COMM_CMD_REQ_SIM), since the simulation was started
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensors;
+    uint8_t  data_type;
+    uint16_t rate;
+    uint8_t  running;
+    uint32_t elapsed_ms;
+    uint32_t notifications;
+    uint32_t samples;
+    uint32_t lost;              // Dropped on purpose (loss)
+    uint32_t late;              // Not generated in time, data path saturated
+    uint32_t frames;            // DATA frames sent live
+    uint32_t bytes;             // Bytes of those frames
+    uint32_t live_dropped;      // DATA frames that did not fit the UART FIFO (or flow paused)
+    uint16_t uart_pending_max;  // UART TX FIFO occupancy (bytes)
+    uint32_t ns_per_sample;     // Processing time of the data path
+    uint32_t notif_us_max;      // Longest notification
+} stm32_sim_t;
+
+// Capture of the raw notification stream (COMM_CMD_TRACE [mode]), answered with the trace status.
+// The trace (format in usr_trace.h) is streamed while capturing, in COMM_CMD_TRACE_DATA frames:
+//  | START_BYTE | packet_len | CONFIG | COMM_CMD_TRACE_DATA | offset (4 bytes) | trace bytes | CS |
+// offset is the position of the first byte in the trace, a gap means trace data was lost on the UART.
+typedef enum
+{
+    COMM_CMD_TRACE_STOP = 0,
+    COMM_CMD_TRACE_START,
+    COMM_CMD_TRACE_STATUS
+} command_type_trace_mode_t;
+
+#define TRACE_OFFSET_LEN                4
+#define TRACE_CHUNK_MAX                 (USR_INTERNAL_COMM_MAX_LEN - OVERHEAD_BYTES - TRACE_OFFSET_LEN)
+
+// Trace status (answer to COMM_CMD_TRACE)
+typedef struct __attribute__((packed))
+{
+    uint8_t  capturing;
+    uint32_t records;           // Notifications captured
+    uint32_t bytes;             // Trace length
+    uint32_t dropped;           // Notifications not captured, trace buffer full
+    uint32_t pending;           // Bytes not streamed yet
+} stm32_trace_t;
+
+// Replay of a captured notification through the decoding and framing (COMM_CMD_TRACE_INJECT)
+//  ________________________________________________________________________________
+// | command | conn_handle | evt_type | total_len | offset | count  | payload bytes |
+// |-------- |------------ |--------- |---------- |------- |------- |-------------- |
+// | 1 byte  | 1 byte      | 1 byte   | 1 byte    | 1 byte | 1 byte | count bytes   |
+//  ________________________________________________________________________________
+// Notifications longer than one frame are sent in parts, the notification is processed when
+// its last byte arrives and produces the same DATA frames as when it was received over BLE.
+// Only invalid parts are answered (COMM_CMD_REJECTED), all parts are rejected while sensors are
+// connected (as COMM_CMD_SIM).
+#define TRACE_INJECT_HEADER_LEN         5
+
+// Radio to UART latency of the DATA frames (COMM_CMD_REQ_LATENCY [sensor_nr] [reset]), sensor_nr 0xFF
+// combines all sensors. Answered with one frame per stage (process, queue, tx, total, command), reset 1
+// clears the statistics after reporting them. The command stage does not depend on sensor_nr.
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    uint8_t  stage;             // 0 process: received to UART FIFO, 1 queue: FIFO to DMA, 2 tx: DMA to TX_DONE, 3 total,
+                                // 4 command: UART RX to the command handled
+    uint32_t count;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t untracked;         // Frames not followed, too many in flight
+    uint32_t bins[16];          // Bin i: 2^i .. 2^(i+1) - 1 us, bin 0 from 0 us, last bin open
+} stm32_latency_t;
+
+// Handler profile (COMM_CMD_REQ_PROF [reset]), answered with one COMM_CMD_REQ_PROF frame per handler
+// (usr_prof_handler_t) and a COMM_CMD_CPU_LOAD frame. reset 1 clears the statistics after reporting them.
+typedef struct __attribute__((packed))
+{
+    uint8_t  handler;
+    uint32_t calls;
+    uint32_t min_cycles;        // CPU cycles (64 MHz), nested handlers included
+    uint32_t avg_cycles;
+    uint32_t max_cycles;
+} stm32_prof_t;
+
+typedef struct __attribute__((packed))
+{
+    uint32_t window_ms;         // Since boot or the last reset
+    uint16_t busy_permille;     // Profiled handlers
+    uint16_t idle_permille;     // Asleep
+} stm32_cpu_load_t;
+
+// Telemetry (answer to COMM_CMD_REQ_TELEMETRY, or every period set with COMM_CMD_TELEMETRY_PERIOD
+// [period in s, 0 = off]), followed by COMM_CMD_TELEMETRY_LINKS report frames with one entry per
+// connected sensor. Counters run since boot, fields are only ever appended (TELEMETRY_VERSION).
+#define TELEMETRY_VERSION               2
+
+#define TELEMETRY_TS_SESSION_OPEN       (1 << 0)
+#define TELEMETRY_TS_TRANSMITTING       (1 << 1)
+#define TELEMETRY_TS_SYNCHRONIZED       (1 << 2)
+
+#define TELEMETRY_BOOT_RESTORED         (1 << 0)    // Device list and configuration restored from flash
+#define TELEMETRY_BOOT_READY            (1 << 1)    // The STM32 answered COMM_CMD_READY
+#define TELEMETRY_BOOT_SAMPLED          (1 << 2)    // A data frame was sent
+
+typedef struct __attribute__((packed))
+{
+    uint8_t  version;
+    uint16_t seq;               // Gaps show lost telemetry frames
+    uint32_t time_ms;           // TimeSync time
+    uint32_t reset_reason;      // RESETREAS of this boot
+    uint16_t cpu_busy_permille; // See stm32_cpu_load_t
+    uint16_t cpu_idle_permille;
+    uint16_t sched_max;         // Event queue high-water mark (events), fullest class
+    uint16_t uart_tx_max;       // UART TX FIFO high-water mark (bytes)
+    uint32_t uart_tx_bytes;
+    uint32_t uart_tx_full;      // Frames refused, TX FIFO full (data, reports and answers)
+    uint16_t uart_rx_errors;
+    uint16_t flow_pauses;       // COMM_CMD_FLOW without credits
+    uint32_t live_dropped;      // Data frames not sent live (FIFO full or paused)
+    uint32_t backlog_used;      // Bytes
+    uint8_t  ts_flags;          // TELEMETRY_TS_*
+    uint32_t ts_sync_packets;
+    uint32_t ts_blocked;        // Timeslots blocked or cancelled
+    // Version 2
+    uint8_t  boot_flags;        // TELEMETRY_BOOT_*
+    uint32_t boot_ready_ms;     // time_ms of the ready handshake
+    uint32_t boot_sample_ms;    // time_ms of the first data frame, boot to first sample
+} stm32_telemetry_t;
+
+//  ______________________________________________________________________________________________
+// | count  | sensor_nr | rssi   | samples | gaps    | live dropped | GATT queue max | disconnects |
+// |------- |---------- |------- |-------- |-------- |------------- |--------------- |------------ |
+// | 1 byte | 1 byte    | 1 byte | 4 bytes | 4 bytes | 4 bytes      | 1 byte         | 1 byte      |
+//  ______________________________________________________________________________________________
+// Samples and gaps since the connection, live dropped since boot
+typedef struct __attribute__((packed))
+{
+    uint8_t  sensor_nr;
+    int8_t   rssi;
+    uint32_t samples;
+    uint32_t gaps;
+    uint32_t live_dropped;
+    uint8_t  gatt_max_depth;
+    uint8_t  disconnects;
+} stm32_telemetry_link_t;
+
+// Binary event log (answer to COMM_CMD_REQ_EVLOG): the entries logged since the previous request
+// in report frames (count | entries), the last frame has fewer entries than fit. Ids and
+// arguments: usr_evlog_id_t, id 0 (lost) reports entries that were overwritten before the request.
+typedef struct __attribute__((packed))
+{
+    uint8_t  id;
+    uint16_t a;
+    uint32_t b;
+    uint32_t ticks;             // app_timer ticks (16384 Hz, 24 bit)
+} stm32_evlog_t;
+
+// Ready handshake, replaces a fixed start-up delay. Sent by the DCU right after boot and every
+// 250 ms until the STM32 sends a valid frame (COMM_CMD_READY without payload, or any command).
+// The sensors of a restored device list are connecting already.
+#define READY_FLAG_RESTORED             (1 << 0)    // Device list and configuration restored from flash
+#define READY_FLAG_WARM                 (1 << 1)    // Measurement resumed, see COMM_CMD_WARM_RESTART
+
+typedef struct __attribute__((packed))
+{
+    uint32_t reset_reason;      // RESETREAS of this boot
+    uint8_t  flags;             // READY_FLAG_*
+    uint8_t  devices;           // Devices in the restored list
+    uint32_t time_ms;           // TimeSync time
+} stm32_ready_t;
+
+// Warm restart, sent once by the DCU after a soft or watchdog reset during a measurement. The
+// measurement continues: same configuration, STM32 time and TimeSync time base. No samples were
+// taken between last_ms and resume_ms, the gap is at most uncertainty_ms longer.
+typedef struct __attribute__((packed))
+{
+    uint32_t reset_reason;      // RESETREAS of this boot
+    uint16_t restarts;          // Warm restarts since the last cold boot
+    uint32_t last_ms;           // TimeSync time before the reset
+    uint32_t resume_ms;         // TimeSync time the time base continued at
+    uint32_t gap_ms;            // resume_ms - last_ms
+    uint16_t uncertainty_ms;
+} stm32_warm_restart_t;
+
 typedef enum 
 { 
     COMM_CMD_CONN_DEV_UPDATE_CONNECTED = 1,
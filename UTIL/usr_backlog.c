@@ -0,0 +1,308 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_backlog.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Store-and-forward ring of the data frames sent to the STM32
+ *
+ *               Frames are stored back to back as | len | key | time | frame |,
+ *               sequence numbers are implicit (oldest_seq + position).
+ *               Frames are stored from the BLE event interrupt and replayed from
+ *               the scheduler, the ring is only touched in a critical region.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_backlog.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+
+#define NRF_LOG_MODULE_NAME usr_backlog_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+typedef struct __attribute__((packed))
+{
+    uint8_t  len;
+    uint8_t  key;               // Sensor or joint pair, see USR_BACKLOG_KEYS
+    uint64_t time;
+} record_hdr_t;
+
+static uint8_t  m_ring[USR_BACKLOG_SIZE];
+static uint32_t m_head = 0;             // Write offset
+static uint32_t m_tail = 0;             // Offset of the oldest frame
+static uint32_t m_used = 0;
+static uint32_t m_oldest_seq = 0;
+static uint32_t m_next_seq = 0;
+
+static bool     m_replaying = false;
+static uint32_t m_replay_offset;
+static uint32_t m_replay_seq;
+static uint32_t m_replay_end;           // Frames from here on were stored during the replay and sent live
+static uint64_t m_replay_min_time;      // Frames older than this are skipped (time replay)
+static uint32_t m_lost = 0;
+
+static usr_backlog_mark_t m_marks[USR_BACKLOG_KEYS];
+static usr_backlog_replay_handler_t m_replay_handler = NULL;
+
+APP_TIMER_DEF(m_replay_timer);
+
+
+static void ring_write(uint32_t offset, void const * p_data, uint32_t len)
+{
+    uint32_t first = MIN(len, USR_BACKLOG_SIZE - offset);
+
+    memcpy(&m_ring[offset], p_data, first);
+    memcpy(m_ring, (uint8_t const *) p_data + first, len - first);
+}
+
+static void ring_read(uint32_t offset, void * p_data, uint32_t len)
+{
+    uint32_t first = MIN(len, USR_BACKLOG_SIZE - offset);
+
+    memcpy(p_data, &m_ring[offset], first);
+    memcpy((uint8_t *) p_data + first, m_ring, len - first);
+}
+
+static uint32_t ring_advance(uint32_t offset, uint32_t len)
+{
+    return (offset + len) % USR_BACKLOG_SIZE;
+}
+
+static void evict_oldest(void)
+{
+    record_hdr_t hdr;
+    ring_read(m_tail, &hdr, sizeof(hdr));
+
+    uint32_t size = sizeof(hdr) + hdr.len;
+
+    // The replay has not reached this frame yet
+    if (m_replaying && (m_replay_seq == m_oldest_seq) && (m_replay_seq != m_replay_end))
+    {
+        m_replay_offset = ring_advance(m_replay_offset, size);
+        m_replay_seq++;
+        m_lost++;
+    }
+
+    if ((hdr.key < USR_BACKLOG_KEYS) && (m_marks[hdr.key].records > 0))
+    {
+        m_marks[hdr.key].records--;
+    }
+
+    m_tail = ring_advance(m_tail, size);
+    m_used -= size;
+    m_oldest_seq++;
+}
+
+static void replay_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_replay_handler != NULL)
+    {
+        m_replay_handler();
+    }
+}
+
+static void replay_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, replay_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Replay tick dropped: %d", err_code);
+    }
+}
+
+void usr_backlog_init(usr_backlog_replay_handler_t replay_handler)
+{
+    ret_code_t err_code;
+
+    m_replay_handler = replay_handler;
+
+    err_code = app_timer_create(&m_replay_timer, APP_TIMER_MODE_REPEATED, replay_timer_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+uint32_t usr_backlog_put(uint8_t key, uint64_t time, uint8_t const * p_frame, uint8_t len)
+{
+    uint32_t seq;
+
+    if (len > USR_BACKLOG_FRAME_MAX)
+    {
+        return UINT32_MAX;
+    }
+
+    record_hdr_t hdr = { .len = len, .key = key, .time = time };
+    uint32_t size = sizeof(hdr) + len;
+
+    CRITICAL_REGION_ENTER();
+
+    while (USR_BACKLOG_SIZE - m_used < size)
+    {
+        evict_oldest();
+    }
+
+    ring_write(m_head, &hdr, sizeof(hdr));
+    ring_write(ring_advance(m_head, sizeof(hdr)), p_frame, len);
+    m_head = ring_advance(m_head, size);
+    m_used += size;
+    seq = m_next_seq++;
+
+    if (key < USR_BACKLOG_KEYS)
+    {
+        m_marks[key].records++;
+        m_marks[key].newest_seq = seq;
+        m_marks[key].newest_time = time;
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return seq;
+}
+
+static ret_code_t replay_start(uint32_t seq, uint64_t min_time)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+
+    CRITICAL_REGION_ENTER();
+
+    // Overwritten frames can not be replayed, start at the oldest one
+    if ((int32_t) (seq - m_oldest_seq) < 0)
+    {
+        seq = m_oldest_seq;
+    }
+
+    if ((int32_t) (m_next_seq - seq) <= 0)
+    {
+        err_code = NRF_ERROR_NOT_FOUND;
+    }
+    else
+    {
+        m_replay_offset = m_tail;
+        for (m_replay_seq = m_oldest_seq; m_replay_seq != seq; m_replay_seq++)
+        {
+            record_hdr_t hdr;
+            ring_read(m_replay_offset, &hdr, sizeof(hdr));
+            m_replay_offset = ring_advance(m_replay_offset, sizeof(hdr) + hdr.len);
+        }
+
+        m_replay_end = m_next_seq;
+        m_replay_min_time = min_time;
+        m_lost = 0;
+        m_replaying = true;
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Restart the pacing
+    (void) app_timer_stop(m_replay_timer);
+    return app_timer_start(m_replay_timer, APP_TIMER_TICKS(USR_BACKLOG_REPLAY_INTERVAL_MS), NULL);
+}
+
+ret_code_t usr_backlog_replay_seq(uint32_t seq)
+{
+    NRF_LOG_INFO("Replay from frame %d", seq);
+
+    return replay_start(seq, 0);
+}
+
+ret_code_t usr_backlog_replay_time(uint64_t time)
+{
+    NRF_LOG_INFO("Replay from time %d ms", (uint32_t) time);
+
+    return replay_start(m_oldest_seq, time);
+}
+
+void usr_backlog_replay_stop(void)
+{
+    m_replaying = false;
+    (void) app_timer_stop(m_replay_timer);
+}
+
+bool usr_backlog_next(uint32_t * p_seq, uint8_t * p_frame, uint8_t * p_len)
+{
+    bool found = false;
+
+    CRITICAL_REGION_ENTER();
+
+    while (m_replaying && (m_replay_seq != m_replay_end))
+    {
+        record_hdr_t hdr;
+        ring_read(m_replay_offset, &hdr, sizeof(hdr));
+
+        uint32_t frame_offset = ring_advance(m_replay_offset, sizeof(hdr));
+        m_replay_offset = ring_advance(frame_offset, hdr.len);
+        *p_seq = m_replay_seq++;
+
+        if (hdr.time >= m_replay_min_time)
+        {
+            ring_read(frame_offset, p_frame, hdr.len);
+            *p_len = hdr.len;
+            found = true;
+            break;
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    if (!found && m_replaying)
+    {
+        NRF_LOG_INFO("Replay done, %d frames lost", m_lost);
+        usr_backlog_replay_stop();
+    }
+
+    return found;
+}
+
+void usr_backlog_status_get(usr_backlog_status_t * p_status)
+{
+    CRITICAL_REGION_ENTER();
+
+    p_status->size = USR_BACKLOG_SIZE;
+    p_status->used = m_used;
+    p_status->oldest_seq = m_oldest_seq;
+    p_status->next_seq = m_next_seq;
+    p_status->replay_seq = m_replaying ? m_replay_seq : m_next_seq;
+    p_status->lost = m_lost;
+    p_status->replaying = m_replaying;
+
+    CRITICAL_REGION_EXIT();
+}
+
+ret_code_t usr_backlog_mark_get(uint8_t key, usr_backlog_mark_t * p_mark)
+{
+    if ((key >= USR_BACKLOG_KEYS) || (m_marks[key].records == 0))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    CRITICAL_REGION_ENTER();
+    *p_mark = m_marks[key];
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,103 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_backlog.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Store-and-forward ring of the data frames sent to the STM32
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_BACKLOG_H_
+#define _USR_BACKLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_sdh_ble.h"
+#include "usr_joint.h"
+
+// Spare RAM of the nRF52840 build, the nRF52832 only covers short hiccups
+#ifndef USR_BACKLOG_SIZE
+#if defined(NRF52840_XXAA)
+#define USR_BACKLOG_SIZE            (64 * 1024)
+#else
+#define USR_BACKLOG_SIZE            (4 * 1024)
+#endif
+#endif
+
+// Longest frame that is stored, a replay frame adds 9 bytes
+#define USR_BACKLOG_FRAME_MAX       112
+
+// Replay pacing: every interval, at most USR_BACKLOG_REPLAY_BYTES and only while the
+// UART TX FIFO holds less than USR_BACKLOG_REPLAY_FIFO_MAX bytes, live data goes first
+#define USR_BACKLOG_REPLAY_INTERVAL_MS  10
+#define USR_BACKLOG_REPLAY_BYTES        256
+#define USR_BACKLOG_REPLAY_FIFO_MAX     512
+
+// Watermarks are kept per key: the sensor_nr of the data frames (device list slot) below
+// USR_BACKLOG_SENSORS, the joint pairs above it
+#define USR_BACKLOG_SENSORS         NRF_SDH_BLE_TOTAL_LINK_COUNT
+#define USR_BACKLOG_KEYS            (USR_BACKLOG_SENSORS + USR_JOINT_PAIRS_MAX)
+#define USR_BACKLOG_KEY_PAIR(pair)  (USR_BACKLOG_SENSORS + (pair))
+
+typedef struct
+{
+    uint32_t size;          // Ring size (bytes)
+    uint32_t used;
+    uint32_t oldest_seq;    // Oldest frame still stored
+    uint32_t next_seq;      // Sequence number of the next stored frame
+    uint32_t replay_seq;    // Next frame of the replay
+    uint32_t lost;          // Frames overwritten before they were replayed
+    bool     replaying;
+} usr_backlog_status_t;
+
+// Newest frame stored of one sensor or joint pair
+typedef struct
+{
+    uint16_t records;       // Frames of the key still stored
+    uint32_t newest_seq;
+    uint64_t newest_time;   // STM32 time of that frame
+} usr_backlog_mark_t;
+
+// Called from the scheduler every replay interval while replaying
+typedef void (*usr_backlog_replay_handler_t)(void);
+
+// Create the replay timer, call after timer_init
+void usr_backlog_init(usr_backlog_replay_handler_t replay_handler);
+
+// Store a frame, the oldest frames are overwritten when the ring is full. Returns its sequence number.
+uint32_t usr_backlog_put(uint8_t key, uint64_t time, uint8_t const * p_frame, uint8_t len);
+
+// Replay from frame seq up to the last frame stored before the call, or from the oldest stored
+// frame when seq was already overwritten. NRF_ERROR_NOT_FOUND when there is nothing to replay.
+ret_code_t usr_backlog_replay_seq(uint32_t seq);
+
+// Replay the frames with a time of at least time
+ret_code_t usr_backlog_replay_time(uint64_t time);
+
+void usr_backlog_replay_stop(void);
+
+// Next frame of the replay, false when the replay has finished
+bool usr_backlog_next(uint32_t * p_seq, uint8_t * p_frame, uint8_t * p_len);
+
+void usr_backlog_status_get(usr_backlog_status_t * p_status);
+
+// NRF_ERROR_NOT_FOUND when no frame of the key was stored
+ret_code_t usr_backlog_mark_get(uint8_t key, usr_backlog_mark_t * p_mark);
+
+#endif
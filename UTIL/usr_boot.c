@@ -0,0 +1,376 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_boot.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Fast boot, device list and configuration kept in flash, ready handshake
+ *
+ *               The device list and the measurement configuration are appended
+ *               to one flash page as fixed size records, the newest complete
+ *               record wins. The magic word follows the state, so a record cut
+ *               off by a reset is skipped. A full page is erased first, a reset
+ *               during that erase loses the record and the STM32 commissions
+ *               the sensors again. Instead of a fixed delay the DCU sends
+ *               COMM_CMD_READY until the STM32 answers.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_boot.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_sd.h"
+#include "usr_evq.h"
+#include "usr_spool.h"
+#include "usr_time_sync.h"
+
+#define NRF_LOG_MODULE_NAME usr_boot_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define RECORD_MAGIC                0x544F4F42  // "BOOT"
+#define RECORD_SLOTS                (USR_BOOT_PAGE_SIZE / sizeof(boot_record_t))
+#define SLOT_ADDR(slot)             (USR_BOOT_FLASH_START + (uint32_t) (slot) * sizeof(boot_record_t))
+#define TS_TICKS_TO_MS(ticks)       ((uint32_t) ((ticks) / 16000))
+
+typedef struct
+{
+    usr_boot_state_t state;
+    uint32_t         magic;         // Written after the state
+} boot_record_t;
+
+STATIC_ASSERT((sizeof(boot_record_t) % sizeof(uint32_t)) == 0);
+STATIC_ASSERT(RECORD_SLOTS >= 1);
+#if defined(NRF52840_XXAA)
+STATIC_ASSERT(USR_SPOOL_END <= USR_BOOT_FLASH_START);
+#endif
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_boot_fs) =
+{
+    .evt_handler = fstorage_evt_handler,
+    .start_addr  = USR_BOOT_FLASH_START,
+    .end_addr    = USR_BOOT_FLASH_END,
+};
+
+static usr_boot_ready_handler_t m_ready_handler = NULL;
+
+static usr_boot_state_t m_state;            // Restored, then the last state handed to the flash
+static usr_boot_state_t m_pending;          // Latest usr_boot_save
+static bool     m_stored = false;           // m_state is in flash
+static boot_record_t m_record;              // Scratch at boot, write buffer afterwards
+static uint16_t m_next_slot = 0;
+static bool     m_busy = false;
+static bool     m_save_pending = false;
+static bool     m_disabled = false;         // Record page not known to be free
+static uint8_t  m_ready_tries = 0;
+
+static usr_boot_status_t m_status;
+
+APP_TIMER_DEF(m_save_timer);
+APP_TIMER_DEF(m_ready_timer);
+
+
+static uint32_t time_ms(void)
+{
+    return TS_TICKS_TO_MS(usr_ts_timestamp_get_ticks_u64());
+}
+
+static bool record_erased(boot_record_t const * p_record)
+{
+    uint32_t const * p_word = (uint32_t const *) p_record;
+
+    for (uint32_t i = 0; i < sizeof(boot_record_t) / sizeof(uint32_t); i++)
+    {
+        if (p_word[i] != 0xFFFFFFFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint8_t devices_count(usr_boot_state_t const * p_state)
+{
+    static uint8_t const empty[BLE_GAP_ADDR_LEN] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < NRF_BLE_SCAN_ADDRESS_CNT; i++)
+    {
+        if (memcmp(p_state->dev[i].addr, empty, BLE_GAP_ADDR_LEN) != 0)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void record_write(void)
+{
+    ret_code_t err_code = nrf_fstorage_write(&m_boot_fs, SLOT_ADDR(m_next_slot), &m_record, sizeof(m_record), NULL);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Boot record write failed: %d", err_code);
+        m_status.errors++;
+        m_stored = false;
+        m_busy = false;
+    }
+}
+
+static void save_retry(void)
+{
+    ret_code_t err_code = app_timer_start(m_save_timer, APP_TIMER_TICKS(USR_BOOT_SAVE_DELAY_MS), NULL);
+    APP_ERROR_CHECK(err_code);
+}
+
+static void save_done(bool ok)
+{
+    m_busy = false;
+
+    if (ok)
+    {
+        m_next_slot++;
+        m_status.saves++;
+    }
+    else
+    {
+        m_status.errors++;
+        m_stored = false;
+    }
+
+    // Changed while the flash was busy, through the timer so it keeps being the only producer
+    if (m_save_pending)
+    {
+        m_save_pending = false;
+        save_retry();
+    }
+}
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt)
+{
+    switch (p_evt->id)
+    {
+    case NRF_FSTORAGE_EVT_ERASE_RESULT:
+        if (p_evt->result != NRF_SUCCESS)
+        {
+            save_done(false);
+            break;
+        }
+        m_next_slot = 0;
+        record_write();
+        break;
+
+    case NRF_FSTORAGE_EVT_WRITE_RESULT:
+        save_done(p_evt->result == NRF_SUCCESS);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void save_scheduled(void * p_event_data, uint16_t event_size)
+{
+    usr_boot_state_t state;
+
+    if (m_busy)
+    {
+        m_save_pending = true;
+        return;
+    }
+
+    // Commands run in another task in the FreeRTOS build
+    CRITICAL_REGION_ENTER();
+    state = m_pending;
+    CRITICAL_REGION_EXIT();
+
+    // Unchanged, no flash wear
+    if (m_stored && (memcmp(&state, &m_state, sizeof(state)) == 0))
+    {
+        return;
+    }
+
+    m_state = state;
+    m_stored = true;
+    m_record.state = state;
+    m_record.magic = RECORD_MAGIC;
+    m_busy = true;
+
+    if (m_next_slot < RECORD_SLOTS)
+    {
+        record_write();
+        return;
+    }
+
+    ret_code_t err_code = nrf_fstorage_erase(&m_boot_fs, USR_BOOT_FLASH_START, 1, NULL);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Boot record erase failed: %d", err_code);
+        m_status.errors++;
+        m_stored = false;
+        m_busy = false;
+    }
+}
+
+static void save_timer_handler(void * p_context)
+{
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, save_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Boot record save dropped: %d", err_code);
+    }
+}
+
+static void ready_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_status.ready)
+    {
+        return;
+    }
+
+    if (++m_ready_tries >= USR_BOOT_READY_TRIES)
+    {
+        // Older STM32 firmware, it commissions the sensors when it is up
+        NRF_LOG_WARNING("No answer to COMM_CMD_READY");
+        (void) app_timer_stop(m_ready_timer);
+    }
+
+    m_ready_handler();
+}
+
+static void ready_timer_handler(void * p_context)
+{
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, ready_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("COMM_CMD_READY dropped: %d", err_code);
+    }
+}
+
+void usr_boot_init(usr_boot_ready_handler_t ready_handler)
+{
+    ret_code_t err_code;
+
+    m_ready_handler = ready_handler;
+
+    err_code = app_timer_create(&m_save_timer, APP_TIMER_MODE_SINGLE_SHOT, save_timer_handler);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_timer_create(&m_ready_timer, APP_TIMER_MODE_REPEATED, ready_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_fstorage_init(&m_boot_fs, &nrf_fstorage_sd, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    // Another bootloader may keep its data in the record page
+    uint32_t bootloader_addr = NRF_UICR->NRFFW[0];
+    if ((bootloader_addr != 0xFFFFFFFF) && (bootloader_addr != BOOTLOADER_START_ADDR))
+    {
+        NRF_LOG_ERROR("Bootloader at 0x%x, boot record disabled", bootloader_addr);
+        m_disabled = true;
+    }
+
+    // Newest complete record, appending continues after the last used slot
+    for (uint16_t slot = 0; (slot < RECORD_SLOTS) && !m_disabled; slot++)
+    {
+        err_code = nrf_fstorage_read(&m_boot_fs, SLOT_ADDR(slot), &m_record, sizeof(m_record));
+        APP_ERROR_CHECK(err_code);
+
+        if (record_erased(&m_record))
+        {
+            continue;
+        }
+
+        m_next_slot = slot + 1;
+        if (m_record.magic == RECORD_MAGIC)
+        {
+            m_state = m_record.state;
+            m_stored = true;
+        }
+    }
+
+    m_status.restored = m_stored;
+    m_status.devices = m_stored ? devices_count(&m_state) : 0;
+
+    NRF_LOG_INFO("Boot record: %s, %d devices", m_stored ? "restored" : "none", m_status.devices);
+
+    // First COMM_CMD_READY right away, the STM32 may be up already
+    m_ready_handler();
+
+    err_code = app_timer_start(m_ready_timer, APP_TIMER_TICKS(USR_BOOT_READY_INTERVAL_MS), NULL);
+    APP_ERROR_CHECK(err_code);
+}
+
+bool usr_boot_state_get(usr_boot_state_t * p_state)
+{
+    if (!m_status.restored)
+    {
+        return false;
+    }
+
+    *p_state = m_state;
+    return true;
+}
+
+void usr_boot_save(usr_boot_state_t const * p_state)
+{
+    if ((m_ready_handler == NULL) || m_disabled)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_pending = *p_state;
+    CRITICAL_REGION_EXIT();
+
+    // Restarted on every change
+    (void) app_timer_stop(m_save_timer);
+    save_retry();
+}
+
+void usr_boot_on_rx(void)
+{
+    if (m_status.ready)
+    {
+        return;
+    }
+
+    m_status.ready = true;
+    m_status.ready_ms = time_ms();
+    (void) app_timer_stop(m_ready_timer);
+
+    NRF_LOG_INFO("STM32 ready after %d ms", m_status.ready_ms);
+}
+
+void usr_boot_on_sample(void)
+{
+    if (!m_status.sampled)
+    {
+        m_status.sampled = true;
+        m_status.first_sample_ms = time_ms();
+    }
+}
+
+void usr_boot_status_get(usr_boot_status_t * p_status)
+{
+    *p_status = m_status;
+}
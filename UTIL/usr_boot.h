@@ -0,0 +1,105 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_boot.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Fast boot, device list and configuration kept in flash, ready handshake
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_BOOT_H_
+#define _USR_BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+#include "ble_imu_service_c.h"
+#include "usr_internal_comm.h"
+
+#define USR_BOOT_PAGE_SIZE          4096
+
+// Start of the DFU bootloader (DFU/bootloader.hex), the bootloader settings are above it.
+// Checked against UICR at boot.
+#ifndef BOOTLOADER_START_ADDR
+#if defined(NRF52840_XXAA)
+#define BOOTLOADER_START_ADDR       0xF8000
+#else
+#define BOOTLOADER_START_ADDR       0x78000
+#endif
+#endif
+
+// Pages kept by the bootloader under its start (bootloader sdk_config)
+#ifndef NRF_DFU_APP_DATA_AREA_SIZE
+#define NRF_DFU_APP_DATA_AREA_SIZE  (3 * USR_BOOT_PAGE_SIZE)
+#endif
+
+// One flash page under the DFU app data area, records are appended and the page is erased when full.
+// The application (nRF52832) or the spool (nRF52840) ends below it, see the linker script.
+#define USR_BOOT_FLASH_START        (BOOTLOADER_START_ADDR - NRF_DFU_APP_DATA_AREA_SIZE - USR_BOOT_PAGE_SIZE)
+#define USR_BOOT_FLASH_END          (USR_BOOT_FLASH_START + USR_BOOT_PAGE_SIZE)
+
+// Commissioning sends the list and the configuration in several commands, they are stored together
+#define USR_BOOT_SAVE_DELAY_MS      1000
+// COMM_CMD_READY is repeated until the STM32 sends a valid frame
+#define USR_BOOT_READY_INTERVAL_MS  250
+#define USR_BOOT_READY_TRIES        20
+
+// Kept over a reset. Configurations only hold the measurement part.
+typedef struct
+{
+    dcu_conn_dev_t           dev[NRF_BLE_SCAN_ADDRESS_CNT];     // 0xFF: no device
+    ble_imu_service_config_t config;                            // Defaults
+    ble_imu_service_config_t sensor_config[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+    uint32_t                 sensor_mask;                       // Sensors using sensor_config
+} usr_boot_state_t;
+
+typedef struct
+{
+    bool     restored;          // State found in flash at boot
+    bool     ready;             // The STM32 answered the ready handshake
+    bool     sampled;           // A data frame was sent
+    uint8_t  devices;           // Devices in the restored list
+    uint32_t ready_ms;          // TimeSync time (ms) of the handshake
+    uint32_t first_sample_ms;   // TimeSync time (ms) of the first data frame
+    uint16_t saves;             // Records written since boot
+    uint16_t errors;            // Flash operations that failed
+} usr_boot_status_t;
+
+// Send COMM_CMD_READY, called from the scheduler
+typedef void (*usr_boot_ready_handler_t)(void);
+
+// Read the newest record and send the first COMM_CMD_READY. Call after the SoftDevice,
+// the UART and the TimeSync timer are initialised.
+void usr_boot_init(usr_boot_ready_handler_t ready_handler);
+
+// State stored before the reset, false when there is none. Call right after usr_boot_init.
+bool usr_boot_state_get(usr_boot_state_t * p_state);
+
+// New device list or measurement started, stored after USR_BOOT_SAVE_DELAY_MS when it differs
+void usr_boot_save(usr_boot_state_t const * p_state);
+
+// Valid frame from the STM32, ends the ready handshake
+void usr_boot_on_rx(void);
+
+// Data frame sent to the STM32
+void usr_boot_on_sample(void);
+
+void usr_boot_status_get(usr_boot_status_t * p_status);
+
+#endif
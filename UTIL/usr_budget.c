@@ -0,0 +1,152 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_budget.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Airtime and UART bandwidth budget of a sensor configuration
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_budget.h"
+
+#include <string.h>
+
+#include "app_util.h"
+#include "usr_internal_comm.h"
+#include "usr_frame.h"
+
+#define NRF_LOG_MODULE_NAME usr_budget_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+// Link layer overhead per PDU on 2M PHY: preamble 2 + access address 4 + header 2 + CRC 3
+// (1M PHY has a 1 byte preamble, the extra byte is ignored)
+#define LL_PDU_OVERHEAD         11
+// L2CAP header 4 + ATT opcode 1 + ATT handle 2
+#define L2CAP_ATT_OVERHEAD      7
+// Inter frame space
+#define T_IFS_US                150
+
+// Link layer payload per PDU (data length extension)
+#if defined(NRF_SDH_BLE_GAP_DATA_LENGTH) && (NRF_SDH_BLE_GAP_DATA_LENGTH > 27)
+    #define LL_MAX_PAYLOAD      NRF_SDH_BLE_GAP_DATA_LENGTH
+#else
+    #define LL_MAX_PAYLOAD      27
+#endif
+
+// Frames sent to the STM32 per sample
+#define UART_QUAT_FRAME_LEN     USR_FRAME_QUAT_LEN
+#define UART_RAW_FRAME_LEN      USR_FRAME_RAW_LEN
+#define UART_EULER_FRAME_LEN    USR_FRAME_EULER_LEN
+// Bytes to the STM32 per EMG notification
+#define UART_EMG_BLOCK_LEN      (EMG_FRAMES * (OVERHEAD_BYTES + EMG_HEADER_LEN) + BLE_IMU_SERVICE_ADC_SAMPLES * EMG_SAMPLE_BYTES)
+
+#define BYTES_TO_AIR_US(bytes, mbps)    (((bytes) * 8) / (mbps))
+
+
+void usr_budget_init(usr_budget_t * p_budget)
+{
+    memset(p_budget, 0, sizeof(usr_budget_t));
+}
+
+uint32_t usr_budget_notif_air_us(uint16_t att_len, usr_link_caps_t const * p_caps)
+{
+    uint32_t ll_payload = LL_MAX_PAYLOAD;
+    uint32_t mbps = USR_BUDGET_PHY_MBPS;
+
+    // Negotiated values, the link carries data on the slower direction of the PHY pair
+    if ((p_caps != NULL) && (p_caps->state == USR_LINK_NEG_DONE))
+    {
+        ll_payload = MAX(p_caps->data_length, BLE_GAP_DATA_LENGTH_DEFAULT);
+        mbps = ((p_caps->tx_phy == BLE_GAP_PHY_2MBPS) && (p_caps->rx_phy == BLE_GAP_PHY_2MBPS)) ? 2 : 1;
+    }
+
+    uint32_t ll_len = att_len + L2CAP_ATT_OVERHEAD;
+    uint32_t pdus = CEIL_DIV(ll_len, ll_payload);
+
+    // Every slave PDU is polled by an empty master PDU: M -> IFS -> S -> IFS
+    uint32_t air_us = BYTES_TO_AIR_US(ll_len + pdus * LL_PDU_OVERHEAD, mbps);
+    air_us += pdus * (BYTES_TO_AIR_US(LL_PDU_OVERHEAD, mbps) + 2 * T_IFS_US);
+
+    return air_us;
+}
+
+void usr_budget_add_sensor(usr_budget_t * p_budget, ble_imu_service_config_t const * p_config, usr_link_caps_t const * p_caps)
+{
+    uint32_t freq = p_config->motion_freq_hz;
+    if (freq == 0)
+    {
+        freq = USR_BUDGET_DEFAULT_FREQ_HZ;
+    }
+
+    // Raw and quaternion samples are grouped per BLE_PACKET_BUFFER_COUNT in one notification
+    uint32_t notif_per_s = CEIL_DIV(freq, BLE_PACKET_BUFFER_COUNT);
+
+    if (p_config->gyro_enabled || p_config->accel_enabled || p_config->mag_enabled)
+    {
+        p_budget->air_us += notif_per_s * usr_budget_notif_air_us(sizeof(ble_imu_service_raw_t), p_caps);
+        p_budget->att_bytes += notif_per_s * sizeof(ble_imu_service_raw_t);
+        p_budget->uart_bytes += freq * UART_RAW_FRAME_LEN;
+    }
+
+    if (p_config->quat6_enabled || p_config->quat9_enabled)
+    {
+        p_budget->air_us += notif_per_s * usr_budget_notif_air_us(sizeof(ble_imu_service_quat_t), p_caps);
+        p_budget->att_bytes += notif_per_s * sizeof(ble_imu_service_quat_t);
+        p_budget->uart_bytes += freq * UART_QUAT_FRAME_LEN;
+    }
+
+    // Euler angles are sent one sample per notification
+    if (p_config->euler_enabled)
+    {
+        p_budget->air_us += freq * usr_budget_notif_air_us(sizeof(ble_imu_service_euler_t), p_caps);
+        p_budget->att_bytes += freq * sizeof(ble_imu_service_euler_t);
+        p_budget->uart_bytes += freq * UART_EULER_FRAME_LEN;
+    }
+
+    if (p_config->adc_enabled)
+    {
+        uint32_t emg_notif_per_s = CEIL_DIV(USR_BUDGET_EMG_FREQ_HZ, BLE_IMU_SERVICE_ADC_SAMPLES);
+
+        p_budget->air_us += emg_notif_per_s * usr_budget_notif_air_us(sizeof(ble_imu_service_adc_t), p_caps);
+        p_budget->att_bytes += emg_notif_per_s * sizeof(ble_imu_service_adc_t);
+        p_budget->uart_bytes += emg_notif_per_s * UART_EMG_BLOCK_LEN;
+    }
+}
+
+ret_code_t usr_budget_check(usr_budget_t const * p_budget)
+{
+    uint32_t air_permille = p_budget->air_us / 1000;
+    uint32_t uart_capacity = USR_BUDGET_UART_BAUDRATE / USR_BUDGET_UART_BITS_PER_BYTE;
+    uint32_t uart_permille = (uint32_t) (((uint64_t) p_budget->uart_bytes * 1000) / uart_capacity);
+
+    NRF_LOG_INFO("Budget: air %d permille, uart %d permille", air_permille, uart_permille);
+
+    if (air_permille > USR_BUDGET_AIRTIME_MAX_PERMILLE)
+    {
+        NRF_LOG_INFO("Budget: airtime exceeded");
+        return NRF_ERROR_RESOURCES;
+    }
+
+    if (uart_permille > USR_BUDGET_UART_MAX_PERMILLE)
+    {
+        NRF_LOG_INFO("Budget: UART exceeded");
+        return NRF_ERROR_RESOURCES;
+    }
+
+    return NRF_SUCCESS;
+}
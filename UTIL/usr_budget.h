@@ -0,0 +1,80 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_budget.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Airtime and UART bandwidth budget of a sensor configuration
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_BUDGET_H_
+#define _USR_BUDGET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "ble_imu_service_c.h"
+#include "usr_link_negotiation.h"
+
+// Share of the radio time the sensor links may use, the rest is left for
+// scanning, time sync timeslots and retransmissions (permille)
+#ifndef USR_BUDGET_AIRTIME_MAX_PERMILLE
+#define USR_BUDGET_AIRTIME_MAX_PERMILLE     600
+#endif
+
+// Share of the UART to the STM32 the data frames may use (permille)
+#ifndef USR_BUDGET_UART_MAX_PERMILLE
+#define USR_BUDGET_UART_MAX_PERMILLE        800
+#endif
+
+// UART towards the STM32: 8N1, so 10 bits per byte
+#define USR_BUDGET_UART_BAUDRATE            1000000
+#define USR_BUDGET_UART_BITS_PER_BYTE       10
+
+// Radio: 2M PHY is requested on every connection, used until the link negotiation is done
+#define USR_BUDGET_PHY_MBPS                 2
+
+// Sample rate assumed when no frequency is configured (sensor default)
+#define USR_BUDGET_DEFAULT_FREQ_HZ          50
+
+// EMG sample rate, fixed on the sensor
+#ifndef USR_BUDGET_EMG_FREQ_HZ
+#define USR_BUDGET_EMG_FREQ_HZ              1000
+#endif
+
+// Bandwidth needed per second
+typedef struct
+{
+    uint32_t air_us;        // Radio time (us)
+    uint32_t att_bytes;     // Notification payload bytes
+    uint32_t uart_bytes;    // Bytes towards the STM32
+} usr_budget_t;
+
+// Start a new budget
+void usr_budget_init(usr_budget_t * p_budget);
+
+// Add the demand of one sensor to the budget, p_caps is the negotiated link or NULL for the defaults
+void usr_budget_add_sensor(usr_budget_t * p_budget, ble_imu_service_config_t const * p_config, usr_link_caps_t const * p_caps);
+
+// Radio time of one notification of att_len bytes, including the empty master poll
+uint32_t usr_budget_notif_air_us(uint16_t att_len, usr_link_caps_t const * p_caps);
+
+// NRF_SUCCESS when the budget fits, NRF_ERROR_RESOURCES otherwise
+ret_code_t usr_budget_check(usr_budget_t const * p_budget);
+
+#endif
@@ -0,0 +1,106 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_evlog.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Binary event log for diagnostics of the data path
+ *
+ *               Handlers log an event id with two arguments instead of a
+ *               formatted NRF_LOG line: a slot is claimed with one atomic add,
+ *               nothing is formatted or flushed. Readers (the STM32, RTT in
+ *               DEBUG builds) copy the entries later from main context.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_evlog.h"
+
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_atomic.h"
+#include "nordic_common.h"
+
+#define NRF_LOG_MODULE_NAME usr_evlog_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define EVLOG_MASK                  (USR_EVLOG_SIZE - 1)
+#define EVLOG_PRINT_MAX             8       // Entries printed per main loop pass, the log buffer is small
+
+STATIC_ASSERT((USR_EVLOG_SIZE & EVLOG_MASK) == 0);
+
+static usr_evlog_entry_t m_entries[USR_EVLOG_SIZE];
+static nrf_atomic_u32_t  m_head = 0;        // Entries logged since boot
+
+#ifdef DEBUG
+static uint32_t m_log_cursor = 0;
+#endif
+
+
+void usr_evlog(usr_evlog_id_t id, uint16_t a, uint32_t b)
+{
+    uint32_t index = nrf_atomic_u32_fetch_add(&m_head, 1);
+    usr_evlog_entry_t * p_entry = &m_entries[index & EVLOG_MASK];
+
+    p_entry->time = app_timer_cnt_get();
+    p_entry->id = id;
+    p_entry->a = a;
+    p_entry->b = b;
+}
+
+uint8_t usr_evlog_read(uint32_t * p_cursor, usr_evlog_entry_t * p_entries, uint8_t max, uint32_t * p_lost)
+{
+    uint8_t count = 0;
+
+    *p_lost = 0;
+
+    CRITICAL_REGION_ENTER();
+
+    uint32_t head = m_head;
+
+    if (head - *p_cursor > USR_EVLOG_SIZE)
+    {
+        *p_lost = head - *p_cursor - USR_EVLOG_SIZE;
+        *p_cursor = head - USR_EVLOG_SIZE;
+    }
+
+    while ((*p_cursor != head) && (count < max))
+    {
+        p_entries[count++] = m_entries[*p_cursor & EVLOG_MASK];
+        (*p_cursor)++;
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return count;
+}
+
+void usr_evlog_process(void)
+{
+#ifdef DEBUG
+    usr_evlog_entry_t entry;
+    uint32_t lost;
+
+    for (uint8_t i = 0; (i < EVLOG_PRINT_MAX) && (usr_evlog_read(&m_log_cursor, &entry, 1, &lost) > 0); i++)
+    {
+        if (lost > 0)
+        {
+            NRF_LOG_WARNING("evlog: %d entries lost", lost);
+        }
+        NRF_LOG_INFO("evlog %d: id %d a %d b %d", entry.time, entry.id, entry.a, entry.b);
+    }
+#endif
+}
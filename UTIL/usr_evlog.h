@@ -0,0 +1,74 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_evlog.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Binary event log for diagnostics of the data path
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_EVLOG_H_
+#define _USR_EVLOG_H_
+
+#include <stdint.h>
+
+// Entries kept (power of two), the oldest are overwritten
+#if defined(NRF52840_XXAA)
+#define USR_EVLOG_SIZE              256
+#else
+#define USR_EVLOG_SIZE              64
+#endif
+
+// Arguments a and b per event
+typedef enum
+{
+    USR_EVLOG_LOST = 0,             // b: entries overwritten before they were read (readout only)
+    USR_EVLOG_UART_ERROR,           // a: UARTE ERRORSRC
+    USR_EVLOG_UART_OVERRUN,
+    USR_EVLOG_UART_RX_FULL,         // a: err_code, b: bytes received
+    USR_EVLOG_RX_INVALID,           // a: usr_frame_rx_status_t, b: length
+    USR_EVLOG_DATA_UNKNOWN,         // a: ble_imu_service_c_evt_type_t
+    USR_EVLOG_NOTIF_UNKNOWN,        // a: ble_imu_service_c_evt_type_t, b: conn_handle
+    USR_EVLOG_CONFIG_SEND,          // a: conn_handle, b: err_code
+    USR_EVLOG_TS_TRIGGER,           // b: err_code of ts_set_trigger
+    USR_EVLOG_TS_FORBIDDEN,         // Normal timeslot refused, earliest requested
+    USR_EVLOG_ENCODE_FULL,          // FreeRTOS build, a: ble_imu_service_c_evt_type_t, b: conn_handle
+    USR_EVLOG_EVQ_FULL,             // a: usr_evq_class_t
+    USR_EVLOG_UART_TX_DROP,         // Frame other than live data, TX FIFO full. a: command byte, b: length
+    USR_EVLOG_DATA_NO_SLOT,         // Notification of a sensor that is not in the device list. a: ble_imu_service_c_evt_type_t, b: conn_handle
+    USR_EVLOG_IDS
+} usr_evlog_id_t;
+
+typedef struct
+{
+    uint32_t time;                  // app_timer ticks
+    uint16_t id;
+    uint16_t a;
+    uint32_t b;
+} usr_evlog_entry_t;
+
+// Log an event, a few cycles from any interrupt level
+void usr_evlog(usr_evlog_id_t id, uint16_t a, uint32_t b);
+
+// Copy up to max entries from *p_cursor on and advance it. Entries overwritten before they
+// were read are skipped and counted in *p_lost. Every reader keeps its own cursor (start at 0).
+uint8_t usr_evlog_read(uint32_t * p_cursor, usr_evlog_entry_t * p_entries, uint8_t max, uint32_t * p_lost);
+
+// DEBUG builds: print the new entries with NRF_LOG, call from the main loop
+void usr_evlog_process(void);
+
+#endif
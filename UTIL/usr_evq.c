@@ -0,0 +1,141 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_evq.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Lock-free event queues of the main loop, one per event class
+ *
+ *               Single producer, single consumer rings of handlers. The
+ *               producer only writes head, the main loop only writes tail,
+ *               both are published with nrf_atomic after the entry is
+ *               written or read. No critical region and no event data copy,
+ *               unlike app_scheduler.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_evq.h"
+
+#include "app_util_platform.h"
+#include "nrf_atomic.h"
+#include "nordic_common.h"
+#include "usr_evlog.h"
+
+#if (USR_FREERTOS == 1)
+#include "usr_rtos.h"
+#endif
+
+
+#if (USR_FREERTOS == 1)
+
+ret_code_t usr_evq_put(usr_evq_class_t cls, app_sched_event_handler_t handler)
+{
+    ret_code_t err_code = app_sched_event_put(NULL, 0, handler);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        usr_rtos_notify(USR_RTOS_TASK_HOUSEKEEPING);
+    }
+
+    return err_code;
+}
+
+uint16_t usr_evq_max_pending_get(void)
+{
+    return app_sched_queue_utilization_get();
+}
+
+#else
+
+#define EVQ_MASK                    (USR_EVQ_SIZE - 1)
+
+STATIC_ASSERT((USR_EVQ_SIZE & EVQ_MASK) == 0);
+
+typedef struct
+{
+    app_sched_event_handler_t handlers[USR_EVQ_SIZE];
+    nrf_atomic_u32_t head;          // Producer
+    nrf_atomic_u32_t tail;          // Main loop
+    uint16_t max_pending;           // Producer
+} evq_ring_t;
+
+static evq_ring_t m_rings[USR_EVQ_CLASSES];
+
+ret_code_t usr_evq_put(usr_evq_class_t cls, app_sched_event_handler_t handler)
+{
+    evq_ring_t * p_ring = &m_rings[cls];
+    uint32_t head = p_ring->head;
+    uint32_t pending = head - p_ring->tail;
+
+    if (pending >= USR_EVQ_SIZE)
+    {
+        usr_evlog(USR_EVLOG_EVQ_FULL, cls, 0);
+        return NRF_ERROR_NO_MEM;
+    }
+
+    p_ring->handlers[head & EVQ_MASK] = handler;
+    p_ring->max_pending = MAX(p_ring->max_pending, pending + 1);
+
+    // The main loop sees the entry with the new head
+    (void) nrf_atomic_u32_store(&p_ring->head, head + 1);
+
+    return NRF_SUCCESS;
+}
+
+static uint8_t ring_run(evq_ring_t * p_ring, uint8_t max)
+{
+    uint8_t count = 0;
+    uint32_t tail = p_ring->tail;
+
+    while ((tail != p_ring->head) && (count < max))
+    {
+        app_sched_event_handler_t handler = p_ring->handlers[tail & EVQ_MASK];
+
+        // Free the entry before the handler runs, it may queue the next event
+        tail++;
+        (void) nrf_atomic_u32_store(&p_ring->tail, tail);
+
+        handler(NULL, 0);
+        count++;
+    }
+
+    return count;
+}
+
+void usr_evq_execute(void)
+{
+    uint8_t cls = 0;
+
+    // After every batch the higher classes go first again: a burst of data does not hold up commands
+    while (cls < USR_EVQ_CLASSES)
+    {
+        cls = (ring_run(&m_rings[cls], USR_EVQ_BATCH) > 0) ? 0 : cls + 1;
+    }
+}
+
+uint16_t usr_evq_max_pending_get(void)
+{
+    uint16_t max_pending = 0;
+
+    for (uint8_t cls = 0; cls < USR_EVQ_CLASSES; cls++)
+    {
+        max_pending = MAX(max_pending, m_rings[cls].max_pending);
+    }
+
+    return max_pending;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_evq.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Lock-free event queues of the main loop, one per event class
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_EVQ_H_
+#define _USR_EVQ_H_
+
+#include <stdint.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+#include "app_scheduler.h"
+
+// Events per class (power of two)
+#define USR_EVQ_SIZE                16
+// Events of one class run before the higher classes are checked again
+#define USR_EVQ_BATCH               4
+
+// Highest priority first. Every class has one producer context, the main loop consumes.
+typedef enum
+{
+    USR_EVQ_RX = 0,                 // UART RX (UART interrupt)
+    USR_EVQ_DATA,                   // Received sensor data, text output (BLE event interrupt)
+    USR_EVQ_TIMER,                  // Periodic reports and pacing (app_timer interrupt)
+    USR_EVQ_CLASSES
+} usr_evq_class_t;
+
+// Queue an event, NRF_ERROR_NO_MEM when the class is full (logged in usr_evlog).
+// The handler is called with (NULL, 0).
+// In the FreeRTOS build every class goes to app_scheduler in the housekeeping task.
+ret_code_t usr_evq_put(usr_evq_class_t cls, app_sched_event_handler_t handler);
+
+#if (USR_FREERTOS == 0)
+// Main loop: run the queued events by class priority, in batches
+void usr_evq_execute(void);
+#endif
+
+// High-water mark of the fullest class (events), app_scheduler in the FreeRTOS build
+uint16_t usr_evq_max_pending_get(void);
+
+#endif
@@ -0,0 +1,227 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_frame.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Framing of the STM32 UART protocol, without SDK dependencies
+ *
+ *               The data path hot spots (CS, DATA frame encoding, fixed point
+ *               conversions, RX frame checks) live here so they can be built
+ *               and measured on a host. usr_internal_comm.c adds the SDK side
+ *               (UART, backlog, logging).
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_frame.h"
+
+#include <string.h>
+
+#define BATTERY_MV_RANGE            (USR_FRAME_BATTERY_MV_MAX - USR_FRAME_BATTERY_MV_MIN)
+// Smallest battery level at or above a voltage
+#define BATTERY_MV_TO_RAW(mv)       ((uint8_t) ((((mv) - USR_FRAME_BATTERY_MV_MIN) * 255 + BATTERY_MV_RANGE - 1) / BATTERY_MV_RANGE))
+
+typedef struct
+{
+    uint8_t raw_min;
+    uint8_t percent;
+} battery_step_t;
+
+// Discharge curve of the sensor battery, highest step first
+static battery_step_t const m_battery_steps[] =
+{
+    { BATTERY_MV_TO_RAW(4100), 100 },
+    { BATTERY_MV_TO_RAW(4000),  90 },
+    { BATTERY_MV_TO_RAW(3900),  70 },
+    { BATTERY_MV_TO_RAW(3800),  50 },
+    { BATTERY_MV_TO_RAW(3700),  30 },
+    { BATTERY_MV_TO_RAW(3500),  20 },
+    { BATTERY_MV_TO_RAW(3300),  10 },
+};
+
+static uint8_t * frame_begin(uint8_t * p_out, uint8_t sensor_nr, uint8_t type)
+{
+    p_out[0] = START_BYTE;
+    p_out[2] = DATA;
+    p_out[3] = sensor_nr;
+    p_out[4] = type;
+
+    return p_out + PACKET_DATA_PLACEHOLDER;
+}
+
+static uint32_t frame_end(uint8_t * p_out, uint8_t const * p_end)
+{
+    uint32_t len = (uint32_t) (p_end - p_out) + CS_LEN;
+
+    p_out[1] = (uint8_t) len;
+    p_out[len-1] = usr_frame_cs(p_out, len);
+
+    return len;
+}
+
+uint8_t usr_frame_cs(uint8_t const * p_data, uint32_t len)
+{
+    uint8_t cs = 0x00;
+
+    for (uint32_t i = 0; i < (len - CS_LEN); i++)
+    {
+        cs ^= p_data[i];
+    }
+
+    return cs;
+}
+
+uint64_t usr_frame_total_time(uint64_t real_time, uint32_t offset, uint64_t local_time)
+{
+    return real_time + local_time + offset;
+}
+
+float usr_frame_q_to_float(int32_t value, uint8_t fractional_bits)
+{
+    return (float) value / (float) (1UL << fractional_bits);
+}
+
+int16_t usr_frame_centideg(int32_t q16)
+{
+    int32_t centi = (int32_t) (((int64_t) q16 * 100 + (1 << 15)) >> 16);
+
+    centi %= 2*EULER_CENTIDEG_HALF_TURN;
+    if (centi > EULER_CENTIDEG_HALF_TURN) centi -= 2*EULER_CENTIDEG_HALF_TURN;
+    else if (centi < -EULER_CENTIDEG_HALF_TURN) centi += 2*EULER_CENTIDEG_HALF_TURN;
+
+    return (int16_t) centi;
+}
+
+uint16_t usr_frame_battery_mv(uint8_t raw)
+{
+    return USR_FRAME_BATTERY_MV_MIN + ((uint32_t) raw * BATTERY_MV_RANGE) / 255;
+}
+
+uint8_t usr_frame_battery_percent(uint8_t raw)
+{
+    for (uint8_t i = 0; i < sizeof(m_battery_steps) / sizeof(m_battery_steps[0]); i++)
+    {
+        if (raw >= m_battery_steps[i].raw_min)
+        {
+            return m_battery_steps[i].percent;
+        }
+    }
+    return 0;
+}
+
+uint16_t usr_frame_rate(uint32_t count, uint32_t window_ms)
+{
+    uint32_t rate = (window_ms == 0) ? 0 : (uint32_t) (((uint64_t) count * 1000) / window_ms);
+    return (rate > UINT16_MAX) ? UINT16_MAX : rate;
+}
+
+uint32_t usr_frame_ns_per_sample(uint32_t cycles, uint32_t cycles_per_us, uint32_t samples)
+{
+    if ((samples == 0) || (cycles_per_us == 0))
+    {
+        return 0;
+    }
+    return (uint32_t) (((uint64_t) cycles * 1000) / cycles_per_us / samples);
+}
+
+uint32_t usr_frame_quat(uint8_t * p_out, uint8_t sensor_nr, stm32_quat_t const * p_quat, uint64_t time)
+{
+    uint8_t * p_data = frame_begin(p_out, sensor_nr, QUATERNIONS);
+
+    memcpy(p_data, p_quat, sizeof(stm32_quat_t));
+    p_data += sizeof(stm32_quat_t);
+    memcpy(p_data, &time, sizeof(time));
+    p_data += sizeof(time);
+
+    return frame_end(p_out, p_data);
+}
+
+uint32_t usr_frame_euler(uint8_t * p_out, uint8_t sensor_nr, int32_t const q16[3], uint64_t time)
+{
+    uint8_t * p_data = frame_begin(p_out, sensor_nr, EULER);
+    int16_t angles[3] = { usr_frame_centideg(q16[0]), usr_frame_centideg(q16[1]), usr_frame_centideg(q16[2]) };
+
+    memcpy(p_data, angles, sizeof(angles));
+    p_data += sizeof(angles);
+    memcpy(p_data, &time, sizeof(time));
+    p_data += sizeof(time);
+
+    return frame_end(p_out, p_data);
+}
+
+uint32_t usr_frame_raw(uint8_t * p_out, uint8_t sensor_nr, stm32_raw_t const * p_raw, uint64_t time)
+{
+    uint8_t * p_data = frame_begin(p_out, sensor_nr, RAW);
+
+    memcpy(p_data, p_raw, sizeof(stm32_raw_t));
+    p_data += sizeof(stm32_raw_t);
+    memcpy(p_data, &time, sizeof(time));
+    p_data += sizeof(time);
+
+    return frame_end(p_out, p_data);
+}
+
+uint32_t usr_frame_emg(uint8_t * p_out, uint8_t sensor_nr, uint64_t time, uint32_t const * p_samples, uint8_t first, uint8_t count)
+{
+    // | timestamp | first | count | sample_bytes | samples |
+    uint8_t * p_data = frame_begin(p_out, sensor_nr, EMG);
+
+    memcpy(p_data, &time, sizeof(time));
+    p_data += sizeof(time);
+    *p_data++ = first;
+    *p_data++ = count;
+    *p_data++ = EMG_SAMPLE_BYTES;
+
+    for (uint8_t i = first; i < first + count; i++)
+    {
+        uint32_t sample = p_samples[i];
+        #if (EMG_SAMPLE_BYTES == 2)
+        sample = (sample > UINT16_MAX) ? UINT16_MAX : sample;
+        #endif
+
+        for (uint8_t b = 0; b < EMG_SAMPLE_BYTES; b++)
+        {
+            *p_data++ = (uint8_t) (sample >> (8*b));
+        }
+    }
+
+    return frame_end(p_out, p_data);
+}
+
+usr_frame_rx_status_t usr_frame_rx_check(uint8_t const * p_rx, uint32_t len)
+{
+    if ((len == 0) || (p_rx[0] != START_BYTE))
+    {
+        return USR_FRAME_RX_START;
+    }
+
+    if ((len <= CONFIG_PACKET_DATA_OFFSET) || (p_rx[1] != len))
+    {
+        return USR_FRAME_RX_LEN;
+    }
+
+    if (usr_frame_cs(p_rx, len) != p_rx[len - CS_LEN])
+    {
+        return USR_FRAME_RX_CS;
+    }
+
+    if (p_rx[2] != CONFIG)
+    {
+        return USR_FRAME_RX_COMMAND;
+    }
+
+    return USR_FRAME_RX_OK;
+}
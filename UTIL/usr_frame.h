@@ -0,0 +1,85 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_frame.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Framing of the STM32 UART protocol, without SDK dependencies
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_FRAME_H_
+#define _USR_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "internal_comm_protocol.h"
+
+// Bytes of one DATA frame, including start byte, length and CS
+#define USR_FRAME_QUAT_LEN          (OVERHEAD_BYTES + sizeof(stm32_quat_t) + sizeof(uint64_t))
+#define USR_FRAME_EULER_LEN         (OVERHEAD_BYTES + 3*sizeof(int16_t) + sizeof(uint64_t))
+#define USR_FRAME_RAW_LEN           (OVERHEAD_BYTES + sizeof(stm32_raw_t) + sizeof(uint64_t))
+#define USR_FRAME_EMG_LEN(count)    (OVERHEAD_BYTES + sizeof(uint64_t) + 3 + (count)*EMG_SAMPLE_BYTES)
+
+// The sensors send their battery voltage as 0-255 over this range
+#define USR_FRAME_BATTERY_MV_MIN    2800
+#define USR_FRAME_BATTERY_MV_MAX    4200
+
+// Result of the checks on a received frame
+typedef enum
+{
+    USR_FRAME_RX_OK,
+    USR_FRAME_RX_START,             // Start byte not correct
+    USR_FRAME_RX_LEN,               // Length byte does not match the received length
+    USR_FRAME_RX_CS,
+    USR_FRAME_RX_COMMAND            // Not a CONFIG frame
+} usr_frame_rx_status_t;
+
+// XOR of the frame, the CS byte (last byte) not included
+uint8_t usr_frame_cs(uint8_t const * p_data, uint32_t len);
+
+// STM32 time of a sample: start time + sensor time since the start + offset to the actual start
+uint64_t usr_frame_total_time(uint64_t real_time, uint32_t offset, uint64_t local_time);
+
+// Sensor Q format to float
+float usr_frame_q_to_float(int32_t value, uint8_t fractional_bits);
+
+// Q16 degrees to 0.01 degrees, rounded and wrapped to -180.00 .. 180.00
+int16_t usr_frame_centideg(int32_t q16);
+
+// Battery level of a sensor to mV and to the percentage of the discharge curve, integer only
+uint16_t usr_frame_battery_mv(uint8_t raw);
+uint8_t usr_frame_battery_percent(uint8_t raw);
+
+// Per second rate of count over window_ms, limited to UINT16_MAX (0 for an empty window)
+uint16_t usr_frame_rate(uint32_t count, uint32_t window_ms);
+
+// Average time per sample in ns of cycles CPU cycles (0 without samples)
+uint32_t usr_frame_ns_per_sample(uint32_t cycles, uint32_t cycles_per_us, uint32_t samples);
+
+// DATA frames, written to p_out (USR_INTERNAL_COMM_MAX_LEN bytes). Return the frame length.
+uint32_t usr_frame_quat(uint8_t * p_out, uint8_t sensor_nr, stm32_quat_t const * p_quat, uint64_t time);
+// Roll, pitch, yaw in Q16 degrees
+uint32_t usr_frame_euler(uint8_t * p_out, uint8_t sensor_nr, int32_t const q16[3], uint64_t time);
+uint32_t usr_frame_raw(uint8_t * p_out, uint8_t sensor_nr, stm32_raw_t const * p_raw, uint64_t time);
+// Samples p_samples[first] .. p_samples[first + count - 1]
+uint32_t usr_frame_emg(uint8_t * p_out, uint8_t sensor_nr, uint64_t time, uint32_t const * p_samples, uint8_t first, uint8_t count);
+
+// Start byte, length, CS and command of a frame received from the STM32
+usr_frame_rx_status_t usr_frame_rx_check(uint8_t const * p_rx, uint32_t len);
+
+#endif
@@ -26,6 +26,26 @@
 #include "usr_uart.h"
 #include "usr_ble.h"
 #include "usr_time_sync.h"
+#include "usr_conn_params.h"
+#include "usr_link_negotiation.h"
+#include "usr_link_stats.h"
+#include "usr_gatt_sched.h"
+#include "usr_battery.h"
+#include "usr_backlog.h"
+#include "usr_spool.h"
+#include "usr_frame.h"
+#include "usr_sim.h"
+#include "usr_trace.h"
+#include "usr_latency.h"
+#include "usr_prof.h"
+#include "usr_telemetry.h"
+#include "usr_evlog.h"
+#include "usr_rtos.h"
+#include "usr_evq.h"
+#include "usr_boot.h"
+#include "usr_warm.h"
+#include "usr_util.h"
+#include "ble_conn_state.h"
 
 #include "internal_comm_protocol.h"
 
@@ -33,7 +53,9 @@
 // Logging
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "settings.h"
 #define NRF_LOG_MODULE_NAME usr_internal_comm_c
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_COMM
 #include "nrf_log.h"
 NRF_LOG_MODULE_REGISTER();
 
@@ -41,38 +63,76 @@ NRF_LOG_MODULE_REGISTER();
 stm32_time_t global_time = 0;
 uint32_t offset_time = 0;
 
+// Device list received in pages (COMM_CMD_SET_CONN_DEV_LIST_PAGE)
+static dcu_conn_dev_t m_conn_dev_pending[NRF_BLE_SCAN_ADDRESS_CNT];
+static uint8_t m_conn_dev_pending_next = 0;     // first of the next page, 0 before a list is started
+
+// Data frames that did not fit the UART FIFO, they are still in the backlog
+static uint32_t m_live_dropped = 0;
+static uint32_t m_live_frames = 0;
+static uint32_t m_live_bytes = 0;
+// Per sensor_nr (device list slot)
+static uint32_t m_live_dropped_sensor[USR_BACKLOG_SENSORS];
+// STM32 has no credits for live data (COMM_CMD_FLOW)
+static bool m_flow_paused = false;
+static uint16_t m_flow_pauses = 0;
+// Event log entries already sent to the STM32
+static uint32_t m_evlog_cursor = 0;
+// Notification replayed from a trace, assembled from COMM_CMD_TRACE_INJECT parts
+static uint8_t m_inject_buf[UINT8_MAX];
+static uint8_t m_inject_len = 0;
+// Counters at the start of the simulation (COMM_CMD_SIM)
+static uint32_t m_sim_frames_start = 0;
+static uint32_t m_sim_bytes_start = 0;
+static uint32_t m_sim_dropped_start = 0;
+
+
+// Frames other than live data: dropped when the STM32 does not read and the UART FIFO is full,
+// the STM32 asks again or gets the next periodic report
+static void comm_tx(uint8_t * data_out, uint32_t * data_len)
+{
+    if(uart_queued_tx_try(data_out, data_len) != NRF_SUCCESS)
+    {
+        usr_evlog(USR_EVLOG_UART_TX_DROP, data_out[3], *data_len);
+    }
+}
 
 static void decode_meas(uint8_t data)
 {
+    ret_code_t err_code;
+
     switch (data)
     {
     case COMM_CMD_MEAS_RAW:
         NRF_LOG_INFO("COMM_CMD_MEAS_RAW");
-        set_config_raw_enable(1);
-        comm_send_ok(COMM_CMD_MEAS);
         break;
 
     case COMM_CMD_MEAS_QUAT6:
         NRF_LOG_INFO("COMM_CMD_MEAS_QUAT6");
-        set_config_quat6_enable(1);
-        comm_send_ok(COMM_CMD_MEAS);
         break;
 
     case COMM_CMD_MEAS_QUAT9:
         NRF_LOG_INFO("COMM_CMD_MEAS_QUAT9");
-        set_config_quat9_enable(1);
-        comm_send_ok(COMM_CMD_MEAS);
         break;
 
     case COMM_CMD_MEAS_WOM:
         NRF_LOG_INFO("COMM_CMD_MEAS_WOM");
-        set_config_wom_enable(1);
-        comm_send_ok(COMM_CMD_MEAS);
         break;
 
-    default:
+    case COMM_CMD_MEAS_OFF:
+        NRF_LOG_INFO("COMM_CMD_MEAS_OFF");
+        break;
+
+    case COMM_CMD_MEAS_EULER:
+        NRF_LOG_INFO("COMM_CMD_MEAS_EULER");
         break;
+
+    default:
+        return;
     }
+
+    err_code = config_meas_update(USR_SENSOR_MASK_DEFAULT, data);
+    comm_send_status(COMM_CMD_MEAS, err_code);
 }
 
 static void decode_sync(uint8_t data)
@@ -101,21 +161,20 @@ static void decode_sync(uint8_t data)
 
 static void decode_frequency(uint8_t data)
 {
-    set_config_frequency(data);
+    ret_code_t err_code;
+
+    err_code = config_frequency_update(USR_SENSOR_MASK_DEFAULT, data);
+    comm_send_status(COMM_CMD_FREQUENCY, err_code);
 }
 
-void send_battery_voltages()
+void uart_send_conn_dev(dcu_connected_devices_t* dev, uint32_t len)
 {
-    // | START_BYTE | packet_len | command (DATA_BYTE) |  sensor_nr |  data_type | data | CS |
-    // | ----------- |-----------|-----------|------------|-----------|----------------|---|
-    // | 1 byte     | 1 byte     | 1 byte               | 1 byte    | 1 byte    | k bytes | 1 byte |
+    // | START_BYTE | packet_len | command (DATA_BYTE)  |  data_type | data    |   CS    |
+    // | ----------- |-----------|----------------------|------------|---------|---------|
+    // | 1 byte     | 1 byte     | 1 byte               |   1 byte    | k bytes | 1 byte |
 
     ret_code_t err_code;
 
-    BATTERY_ARRAY bat;
-    uint32_t len;
-    get_battery(&bat, &len);
-
     uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN]; //64 bytes long is more than enough for a data packet
     uint32_t data_len;
     data_type_byte_t type_byte;
@@ -136,10 +195,10 @@ void send_battery_voltages()
 
     data_out[2] = command_byte;
     // data_out[3] = sensor_nr;
-    data_out[3] = COMM_CMD_REQ_BATTERY_LEVEL;
+    data_out[3] = COMM_CMD_REQ_CONN_DEV_LIST;
 
     // Copy data to packet
-    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1), &bat, len);
+    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1), dev, len);
 
     // Set data len
     data_len += len;
@@ -153,13 +212,50 @@ void send_battery_voltages()
     check_buffer_overflow(&data_len);
 
     // Send over UART to STM32
-    uart_queued_tx(data_out, &data_len);
-    // NRF_LOG_INFO("Data send");  
+    comm_tx(data_out, &data_len);
+    // NRF_LOG_INFO("Data send");   
 }
 
+static void uart_send_conn_dev_page(dcu_connected_devices_t* dev, uint8_t first, uint8_t count)
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_CONN_DEV_LIST_PAGE | first | count | entries | CS |
+
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
+
+    data_out[0] = START_BYTE;
+    data_out[2] = CONFIG;
+    data_out[3] = COMM_CMD_REQ_CONN_DEV_LIST_PAGE;
+    data_out[PACKET_DATA_PLACEHOLDER-1] = first;
+    data_out[PACKET_DATA_PLACEHOLDER] = count;
 
+    memcpy(&data_out[PACKET_DATA_PLACEHOLDER + 1], &dev[first], count*sizeof(dcu_connected_devices_t));
 
-void uart_send_conn_dev(dcu_connected_devices_t* dev, uint32_t len)
+    data_len = OVERHEAD_BYTES + 1 + count*sizeof(dcu_connected_devices_t);
+    data_out[1] = (uint8_t) data_len;
+
+    // Checksum
+    data_out[data_len-1] = calculate_cs(data_out, &data_len);
+
+    // check for buffer overflows
+    check_buffer_overflow(&data_len);
+
+    // Send over UART to STM32
+    comm_tx(data_out, &data_len);
+}
+
+// Connected device list in pages of COMM_CMD_REQ_CONN_DEV_LIST_PAGE
+static void uart_send_conn_dev_pages(dcu_connected_devices_t* dev, uint8_t count)
+{
+    uint8_t page_count = (USR_INTERNAL_COMM_MAX_LEN - 1 - OVERHEAD_BYTES - 1) / sizeof(dcu_connected_devices_t);
+
+    for(uint8_t first = 0; first < count; first += page_count)
+    {
+        uart_send_conn_dev_page(dev, first, MIN(page_count, count - first));
+    }
+}
+
+void uart_send_conn_dev_update(ble_gap_addr_t* dev, uint32_t len, command_type_conn_dev_update_byte_t state)
 {
     // | START_BYTE | packet_len | command (DATA_BYTE)  |  data_type | data    |   CS    |
     // | ----------- |-----------|----------------------|------------|---------|---------|
@@ -187,334 +283,1662 @@ void uart_send_conn_dev(dcu_connected_devices_t* dev, uint32_t len)
 
     data_out[2] = command_byte;
     // data_out[3] = sensor_nr;
-    data_out[3] = COMM_CMD_REQ_CONN_DEV_LIST;
+    data_out[3] = COMM_CMD_CONN_DEV_UPDATE;
 
     // Copy data to packet
-    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1), dev, len);
+    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1), &state, sizeof(state));
+    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1 + sizeof(state)), dev, len);
 
     // Set data len
     data_len += len;
+    data_len += sizeof(state);
     data_out[1] = (uint8_t) data_len;
 
     // Checksum
     uint8_t cs = calculate_cs(data_out, &data_len);
-    data_out[PACKET_DATA_PLACEHOLDER-1 + len] = cs;
+    data_out[PACKET_DATA_PLACEHOLDER-1 + len + sizeof(command_type_conn_dev_update_byte_t)] = cs;
 
     // check for buffer overflows
     check_buffer_overflow(&data_len);
 
     // Send over UART to STM32
-    uart_queued_tx(data_out, &data_len);
+    comm_tx(data_out, &data_len);
     // NRF_LOG_INFO("Data send");   
 }
 
-void uart_send_conn_dev_update(ble_gap_addr_t* dev, uint32_t len, command_type_conn_dev_update_byte_t state)
+// Data frames are stored for a replay and sent live when the UART FIFO has room,
+// frames that could not be sent live go to the flash spool as well.
+// key: sensor_nr of the sensor, or USR_BACKLOG_KEY_PAIR for joint data.
+static void comm_data_tx(uint8_t * data_out, uint32_t * data_len, stm32_time_t time, uint8_t key)
 {
-    // | START_BYTE | packet_len | command (DATA_BYTE)  |  data_type | data    |   CS    |
-    // | ----------- |-----------|----------------------|------------|---------|---------|
-    // | 1 byte     | 1 byte     | 1 byte               |   1 byte    | k bytes | 1 byte |
+    uint32_t seq = usr_backlog_put(key, time, data_out, (uint8_t) *data_len);
 
-    ret_code_t err_code;
+    usr_boot_on_sample();
 
-    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN]; //64 bytes long is more than enough for a data packet
+    if(m_flow_paused || (uart_queued_tx_try(data_out, data_len) != NRF_SUCCESS))
+    {
+        m_live_dropped++;
+        if(key < USR_BACKLOG_SENSORS)
+        {
+            m_live_dropped_sensor[key]++;
+        }
+        usr_spool_put(seq, data_out, (uint8_t) *data_len);
+    }
+    else
+    {
+        m_live_frames++;
+        m_live_bytes += *data_len;
+    }
+}
+
+static void uart_send_report_frame(uint8_t * data_out, uint8_t cmd, uint8_t count, uint8_t entry_len)
+{
     uint32_t data_len;
-    data_type_byte_t type_byte;
-    command_byte_t command_byte;
 
-    // Fill configuration bytes
     data_out[0] = START_BYTE;
+    data_out[2] = CONFIG;
+    data_out[3] = cmd;
+    data_out[PACKET_DATA_PLACEHOLDER-1] = count;
 
-    data_len = 0;
-    // Length of frame
-    data_len += OVERHEAD_BYTES-1;
+    data_len = OVERHEAD_BYTES + count*entry_len;
+    data_out[1] = (uint8_t) data_len;
 
-    // Tell the receiver its data we're sending
-    command_byte = CONFIG;
+    // Checksum
+    data_out[data_len-1] = calculate_cs(data_out, &data_len);
 
-    // TODO match this to the MAC address - keep track of list of MAC addresses
-    // uint8_t sensor_nr = 0;
+    // check for buffer overflows
+    check_buffer_overflow(&data_len);
 
-    data_out[2] = command_byte;
-    // data_out[3] = sensor_nr;
-    data_out[3] = COMM_CMD_CONN_DEV_UPDATE;
+    // Send over UART to STM32
+    comm_tx(data_out, &data_len);
+}
 
-    // Copy data to packet
-    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1), &state, sizeof(state));
-    memcpy((data_out + PACKET_DATA_PLACEHOLDER-1 + sizeof(state)), dev, len);
+// Single struct CONFIG frame
+// | START_BYTE | packet_len | command (CONFIG) | cmd | struct | CS |
+static void uart_send_config_struct(uint8_t cmd, void const * p_struct, uint8_t len)
+{
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
 
-    // Set data len
-    data_len += len;
-    data_len += sizeof(state);
+    data_out[0] = START_BYTE;
+    data_out[2] = CONFIG;
+    data_out[3] = cmd;
+    memcpy(&data_out[PACKET_DATA_PLACEHOLDER-1], p_struct, len);
+
+    data_len = OVERHEAD_BYTES-1 + len;
     data_out[1] = (uint8_t) data_len;
 
     // Checksum
-    uint8_t cs = calculate_cs(data_out, &data_len);
-    data_out[PACKET_DATA_PLACEHOLDER-1 + len + sizeof(command_type_conn_dev_update_byte_t)] = cs;
+    data_out[data_len-1] = calculate_cs(data_out, &data_len);
 
     // check for buffer overflows
     check_buffer_overflow(&data_len);
 
     // Send over UART to STM32
-    uart_queued_tx(data_out, &data_len);
-    // NRF_LOG_INFO("Data send");   
+    comm_tx(data_out, &data_len);
 }
 
-void comm_rx_process(void *p_event_data, uint16_t event_size)
+// Report frames (| count | entries |) filled one entry at a time,
+// more entries than fit in one frame are sent in consecutive frames
+typedef struct
 {
-    //| START_BYTE | packet_len | command (CONFIG_BYTE) |  config_data | CS    |
-    //| ----------- |-----------|---------           --|------------- |-----  -|
-    //| 1 byte        | 1 byte  |               1 byte |      k bytes |  1 byte |
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint8_t cmd;
+    uint8_t entry_len;
+    uint8_t max_count;
+    uint8_t count;
+    bool    sent;
+} report_pager_t;
+
+static void report_begin(report_pager_t * p_pager, uint8_t cmd, uint8_t entry_len)
+{
+    p_pager->cmd = cmd;
+    p_pager->entry_len = entry_len;
+    p_pager->max_count = (USR_INTERNAL_COMM_MAX_LEN - 1 - OVERHEAD_BYTES) / entry_len;
+    p_pager->count = 0;
+    p_pager->sent = false;
+}
 
-    NRF_LOG_HEXDUMP_INFO(p_event_data, event_size);
+static void report_add(report_pager_t * p_pager, void const * p_entry)
+{
+    memcpy(&p_pager->data_out[PACKET_DATA_PLACEHOLDER + p_pager->count*p_pager->entry_len], p_entry, p_pager->entry_len);
+    p_pager->count++;
 
-    // Get data from buffer - store in var rx_data
-    uint8_t p_byte;
-    uint8_t rx_data[USR_INTERNAL_COMM_MAX_LEN];
-    uint8_t i = 0;
-    while ((uart_rx_buff_get(&p_byte) != NRF_ERROR_NOT_FOUND))
+    if(p_pager->count == p_pager->max_count)
     {
-        rx_data[i] = p_byte;
-        i++;
+        uart_send_report_frame(p_pager->data_out, p_pager->cmd, p_pager->count, p_pager->entry_len);
+        p_pager->count = 0;
+        p_pager->sent = true;
+    }
+}
+
+// Send the last entries, answer_empty: a frame with count 0 when there were no entries
+static void report_end(report_pager_t * p_pager, bool answer_empty)
+{
+    if(p_pager->count > 0 || (!p_pager->sent && answer_empty))
+    {
+        uart_send_report_frame(p_pager->data_out, p_pager->cmd, p_pager->count, p_pager->entry_len);
+    }
+}
+
+void uart_send_battery(bool changed_only)
+{
+    // | START_BYTE | packet_len | command (CONFIG)  | COMM_CMD_REQ_BATTERY_LEVEL | count | entries | CS |
+    // More sensors than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_REQ_BATTERY_LEVEL, sizeof(stm32_battery_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_battery_t battery;
+
+        if((usr_battery_get(conn_handle, &battery) != NRF_SUCCESS) || (changed_only && !battery.changed))
+        {
+            continue;
+        }
+
+        stm32_battery_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.percent = battery.percent;
+        entry.voltage_mv = usr_frame_battery_mv(battery.raw);
+
+        report_add(&pager, &entry);
+        usr_battery_reported(conn_handle);
+    }
+
+    // A request is always answered, a periodic report only with changes
+    report_end(&pager, !changed_only);
+}
+
+void uart_send_battery_changes()
+{
+    uart_send_battery(true);
+}
+
+void uart_send_conn_params()
+{
+    // | START_BYTE | packet_len | command (CONFIG)  | COMM_CMD_REQ_CONN_PARAMS | count | entries | CS |
+    // More sensors than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_REQ_CONN_PARAMS, sizeof(stm32_conn_params_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_conn_link_report_t report;
+
+        if(usr_conn_params_report_get(conn_handle, &report, true) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_conn_params_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.interval = report.interval;
+        entry.current_interval = report.current_interval;
+        entry.predicted_bytes = report.predicted_bytes;
+        entry.capacity_bytes = report.capacity_bytes;
+        entry.achieved_bytes = report.achieved_bytes;
+
+        report_add(&pager, &entry);
+    }
+    usr_conn_params_report_reset();
+
+    // Always answer, also without connected sensors
+    report_end(&pager, true);
+}
+
+void uart_send_link_caps()
+{
+    // | START_BYTE | packet_len | command (CONFIG)  | COMM_CMD_REQ_LINK_CAPS | count | entries | CS |
+    // More sensors than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_REQ_LINK_CAPS, sizeof(stm32_link_caps_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_link_caps_t caps;
+
+        if(usr_link_caps_get(conn_handle, &caps) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_link_caps_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.state = caps.state;
+        entry.att_mtu = caps.att_mtu;
+        entry.data_length = caps.data_length;
+        entry.tx_phy = caps.tx_phy;
+        entry.rx_phy = caps.rx_phy;
+        entry.fallback = caps.fallback;
+        entry.max_notif_len = usr_link_max_notif_len(conn_handle);
+
+        report_add(&pager, &entry);
+    }
+
+    // Always answer, also without connected sensors
+    report_end(&pager, true);
+}
+
+void uart_send_link_stats()
+{
+    // | START_BYTE | packet_len | command (CONFIG)  | COMM_CMD_REQ_LINK_STATS | count | entries | CS |
+    // More sensors than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_REQ_LINK_STATS, sizeof(stm32_link_stats_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_link_stats_t stats;
+
+        if(usr_link_stats_get(conn_handle, &stats, true) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_link_stats_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.rssi = stats.rssi;
+        entry.notif_rate = usr_frame_rate(stats.notifs, stats.window_ms);
+        entry.sample_rate = usr_frame_rate(stats.samples, stats.window_ms);
+        entry.bytes = stats.bytes;
+        entry.gaps = stats.gaps;
+        entry.max_gap_ms = stats.max_gap_ms;
+        entry.conn_events = stats.conn_events;
+        entry.disconnects = stats.disconnects;
+        entry.disconnect_reason = stats.disconnect_reason;
+        entry.discovery_ms = stats.discovery_ms;
+
+        report_add(&pager, &entry);
+    }
+
+    // Always answer, also without connected sensors
+    report_end(&pager, true);
+}
+
+void uart_send_telemetry()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_TELEMETRY | stm32_telemetry_t | CS |
+    // followed by | COMM_CMD_TELEMETRY_LINKS | count | entries | report frames
+
+    stm32_telemetry_t report;
+    usr_prof_cpu_t cpu;
+    uart_stats_t uart;
+    usr_backlog_status_t backlog;
+    ts_status_t ts;
+    usr_boot_status_t boot;
+
+    usr_prof_cpu_get(&cpu);
+    uart_stats_get(&uart);
+    usr_backlog_status_get(&backlog);
+    ts_status_get(&ts);
+    usr_boot_status_get(&boot);
+
+    report.version = TELEMETRY_VERSION;
+    report.seq = usr_telemetry_seq_next();
+    report.time_ms = (uint32_t) (usr_ts_timestamp_get_ticks_u64() / 16000);
+    report.reset_reason = usr_reset_reason_get();
+    report.cpu_busy_permille = cpu.busy_permille;
+    report.cpu_idle_permille = cpu.idle_permille;
+    report.sched_max = usr_evq_max_pending_get();
+    report.uart_tx_max = (uint16_t) uart.tx_max_pending;
+    report.uart_tx_bytes = uart.tx_bytes;
+    report.uart_tx_full = uart.tx_full;
+    report.uart_rx_errors = (uint16_t) MIN(uart.rx_errors, UINT16_MAX);
+    report.flow_pauses = m_flow_pauses;
+    report.live_dropped = m_live_dropped;
+    report.backlog_used = backlog.used;
+    report.ts_flags = (ts.session_open ? TELEMETRY_TS_SESSION_OPEN : 0) |
+                      (ts.transmitting ? TELEMETRY_TS_TRANSMITTING : 0) |
+                      (ts.synchronized ? TELEMETRY_TS_SYNCHRONIZED : 0);
+    report.ts_sync_packets = ts.sync_packets;
+    report.ts_blocked = ts.blocked_cancelled;
+    report.boot_flags = (boot.restored ? TELEMETRY_BOOT_RESTORED : 0) |
+                        (boot.ready ? TELEMETRY_BOOT_READY : 0) |
+                        (boot.sampled ? TELEMETRY_BOOT_SAMPLED : 0);
+    report.boot_ready_ms = boot.ready_ms;
+    report.boot_sample_ms = boot.first_sample_ms;
+
+    uart_send_config_struct(COMM_CMD_REQ_TELEMETRY, &report, sizeof(report));
+
+    // Links, more sensors than fit in one frame are sent in consecutive frames
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_TELEMETRY_LINKS, sizeof(stm32_telemetry_link_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_link_stats_t stats;
+        usr_gatt_stats_t gatt;
+
+        if(usr_link_stats_get(conn_handle, &stats, false) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_telemetry_link_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.rssi = stats.rssi;
+        entry.samples = stats.samples_total;
+        entry.gaps = stats.gaps_total;
+        entry.live_dropped = (entry.sensor_nr < USR_BACKLOG_SENSORS) ? m_live_dropped_sensor[entry.sensor_nr] : 0;
+        entry.gatt_max_depth = (usr_gatt_stats_get(conn_handle, &gatt) == NRF_SUCCESS) ? gatt.max_depth : 0;
+        entry.disconnects = stats.disconnects;
+
+        report_add(&pager, &entry);
+    }
+
+    // Always sent, the STM32 knows the snapshot is complete
+    report_end(&pager, true);
+}
+
+void uart_send_evlog()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_EVLOG | count | entries | CS |
+    // More entries than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+    usr_evlog_entry_t entries[(USR_INTERNAL_COMM_MAX_LEN - 1 - OVERHEAD_BYTES) / sizeof(stm32_evlog_t)];
+    uint8_t count;
+    uint32_t lost;
+
+    report_begin(&pager, COMM_CMD_REQ_EVLOG, sizeof(stm32_evlog_t));
+
+    do
+    {
+        count = usr_evlog_read(&m_evlog_cursor, entries, ARRAY_SIZE(entries), &lost);
+
+        // Count of overwritten entries before the entries that were read
+        if(lost > 0)
+        {
+            stm32_evlog_t entry = { .id = USR_EVLOG_LOST, .a = 0, .b = lost, .ticks = 0 };
+            report_add(&pager, &entry);
+        }
+
+        for(uint8_t i = 0; i < count; i++)
+        {
+            stm32_evlog_t entry = { .id = (uint8_t) entries[i].id, .a = entries[i].a, .b = entries[i].b, .ticks = entries[i].time };
+            report_add(&pager, &entry);
+        }
+
+    } while(count == ARRAY_SIZE(entries));
+
+    report_end(&pager, true);
+}
+
+void uart_send_ready()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_READY | stm32_ready_t | CS |
+
+    stm32_ready_t ready;
+    usr_boot_status_t boot;
+    usr_warm_status_t warm;
+
+    usr_boot_status_get(&boot);
+    usr_warm_status_get(&warm);
+
+    ready.reset_reason = usr_reset_reason_get();
+    ready.flags = (boot.restored ? READY_FLAG_RESTORED : 0) |
+                  (warm.warm ? READY_FLAG_WARM : 0);
+    ready.devices = boot.devices;
+    ready.time_ms = (uint32_t) (usr_ts_timestamp_get_ticks_u64() / 16000);
+
+    uart_send_config_struct(COMM_CMD_READY, &ready, sizeof(ready));
+}
+
+void uart_send_warm_restart()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_WARM_RESTART | stm32_warm_restart_t | CS |
+
+    stm32_warm_restart_t restart;
+    usr_warm_status_t warm;
+
+    usr_warm_status_get(&warm);
+
+    restart.reset_reason = warm.reset_reason;
+    restart.restarts = warm.restarts;
+    restart.last_ms = warm.last_ms;
+    restart.resume_ms = warm.resume_ms;
+    restart.gap_ms = warm.gap_ms;
+    restart.uncertainty_ms = warm.uncertainty_ms;
+
+    uart_send_config_struct(COMM_CMD_WARM_RESTART, &restart, sizeof(restart));
+}
+
+STATIC_ASSERT(USR_GATT_PRIO_COUNT == 3);
+
+void uart_send_gatt_stats()
+{
+    // | START_BYTE | packet_len | command (CONFIG)  | COMM_CMD_REQ_GATT_STATS | count | entries | CS |
+    // More sensors than fit in one frame are sent in consecutive frames
+
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_REQ_GATT_STATS, sizeof(stm32_gatt_stats_t));
+
+    ble_conn_state_conn_handle_list_t conn_central_handles = ble_conn_state_central_handles();
+
+    for (uint32_t i = 0; i < conn_central_handles.len; i++)
+    {
+        uint16_t conn_handle = conn_central_handles.conn_handles[i];
+        usr_gatt_stats_t stats;
+
+        if(usr_gatt_stats_get(conn_handle, &stats) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_gatt_stats_t entry;
+        entry.sensor_nr = usr_ble_sensor_slot_get(conn_handle);
+        entry.depth = stats.depth;
+        entry.max_depth = stats.max_depth;
+        entry.retries = stats.retries;
+        entry.errors = stats.errors;
+        entry.dropped = stats.dropped;
+        for (uint8_t p = 0; p < USR_GATT_PRIO_COUNT; p++)
+        {
+            entry.latency[p].avg_ms = stats.latency[p].avg_ms;
+            entry.latency[p].max_ms = stats.latency[p].max_ms;
+        }
+
+        report_add(&pager, &entry);
     }
 
-    // Store the received packet length
-    uint32_t len = i;
+    // Always answer, also without connected sensors
+    report_end(&pager, true);
+}
+
+void uart_send_commissioning()
+{
+    usr_commissioning_t commissioning;
+    stm32_commissioning_t report;
+
+    usr_ble_commissioning_get(&commissioning);
+
+    report.listed = commissioning.listed;
+    report.connected = commissioning.connected;
+    report.done = commissioning.done;
+    report.time_ms = commissioning.time_ms;
+    report.scan_mode = commissioning.scan_mode;
+    report.whitelist = commissioning.whitelist;
+
+    uart_send_config_struct(COMM_CMD_REQ_COMMISSIONING, &report, sizeof(report));
+}
+
+void uart_send_rejoin(uint8_t sensor_nr, uint32_t latency_ms, bool config_pushed, uint8_t scan_level)
+{
+    stm32_rejoin_t report;
+
+    report.sensor_nr = sensor_nr;
+    report.config_pushed = config_pushed;
+    report.scan_level = scan_level;
+    report.latency_ms = latency_ms;
+
+    uart_send_config_struct(COMM_CMD_SENSOR_REJOINED, &report, sizeof(report));
+}
+
+void uart_send_joint(usr_joint_result_t const * p_result)
+{
+    // | START_BYTE | packet_len | command (DATA) | pair | JOINT_QUAT / JOINT_ANGLES | data | timestamp | CS |
+
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
+
+    stm32_time_t time = calculate_total_time(p_result->timestamp_ms);
+
+    data_out[0] = START_BYTE;
+    data_out[2] = DATA;
+    data_out[3] = p_result->pair;
+
+    if(p_result->outputs & USR_JOINT_OUT_QUAT)
+    {
+        data_len = OVERHEAD_BYTES + sizeof(usr_quat_q30_t) + sizeof(stm32_time_t);
+        data_out[1] = (uint8_t) data_len;
+        data_out[4] = JOINT_QUAT;
+
+        memcpy((data_out + PACKET_DATA_PLACEHOLDER), &p_result->q, sizeof(usr_quat_q30_t));
+        memcpy((data_out + PACKET_DATA_PLACEHOLDER + sizeof(usr_quat_q30_t)), &time, sizeof(stm32_time_t));
+
+        data_out[data_len-1] = calculate_cs(data_out, &data_len);
+        check_buffer_overflow(&data_len);
+        comm_data_tx(data_out, &data_len, time, USR_BACKLOG_KEY_PAIR(p_result->pair));
+    }
+
+    if(p_result->outputs & USR_JOINT_OUT_ANGLES)
+    {
+        data_len = OVERHEAD_BYTES + sizeof(p_result->angles) + sizeof(stm32_time_t);
+        data_out[1] = (uint8_t) data_len;
+        data_out[4] = JOINT_ANGLES;
+
+        memcpy((data_out + PACKET_DATA_PLACEHOLDER), p_result->angles, sizeof(p_result->angles));
+        memcpy((data_out + PACKET_DATA_PLACEHOLDER + sizeof(p_result->angles)), &time, sizeof(stm32_time_t));
+
+        data_out[data_len-1] = calculate_cs(data_out, &data_len);
+        check_buffer_overflow(&data_len);
+        comm_data_tx(data_out, &data_len, time, USR_BACKLOG_KEY_PAIR(p_result->pair));
+    }
+}
+
+void uart_send_backlog()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_BACKLOG | stm32_backlog_t | CS |
+    // followed by the watermarks in COMM_CMD_BACKLOG_MARKS report frames
+
+    usr_backlog_status_t status;
+    stm32_backlog_t report;
+
+    usr_backlog_status_get(&status);
+    report.size = status.size;
+    report.used = status.used;
+    report.oldest_seq = status.oldest_seq;
+    report.next_seq = status.next_seq;
+    report.replay_seq = status.replay_seq;
+    report.lost = status.lost;
+    report.live_dropped = m_live_dropped;
+    report.replaying = status.replaying;
+
+    uart_send_config_struct(COMM_CMD_REQ_BACKLOG, &report, sizeof(report));
+
+    // Watermarks, more sensors than fit in one frame are sent in consecutive frames
+    report_pager_t pager;
+
+    report_begin(&pager, COMM_CMD_BACKLOG_MARKS, sizeof(stm32_backlog_mark_t));
+
+    for(uint8_t key = 0; key < USR_BACKLOG_KEYS; key++)
+    {
+        usr_backlog_mark_t mark;
+
+        if(usr_backlog_mark_get(key, &mark) != NRF_SUCCESS)
+        {
+            continue;
+        }
+
+        stm32_backlog_mark_t entry;
+        entry.sensor_nr = (key < USR_BACKLOG_SENSORS) ? key : (BACKLOG_MARK_PAIR | (key - USR_BACKLOG_SENSORS));
+        entry.records = mark.records;
+        entry.newest_seq = mark.newest_seq;
+        entry.newest_time = mark.newest_time;
+
+        report_add(&pager, &entry);
+    }
+
+    report_end(&pager, true);
+}
+
+// Send stored frames wrapped in COMM_CMD_REPLAY, paced so live data goes first.
+// False when next has no frames left.
+static bool uart_send_stored(bool (*next)(uint32_t *, uint8_t *, uint8_t *))
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REPLAY | seq | stored DATA frame | CS |
+
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
+    uint32_t sent = 0;
+
+    // Only fill up the FIFO to the threshold
+    while((sent < USR_BACKLOG_REPLAY_BYTES) &&
+          (uart_tx_pending() + USR_INTERNAL_COMM_MAX_LEN <= USR_BACKLOG_REPLAY_FIFO_MAX))
+    {
+        uint32_t seq;
+        uint8_t frame_len;
+
+        if(!next(&seq, &data_out[PACKET_DATA_PLACEHOLDER-1+sizeof(seq)], &frame_len))
+        {
+            return false;
+        }
+
+        data_out[0] = START_BYTE;
+        data_out[2] = CONFIG;
+        data_out[3] = COMM_CMD_REPLAY;
+        memcpy(&data_out[PACKET_DATA_PLACEHOLDER-1], &seq, sizeof(seq));
+
+        data_len = OVERHEAD_BYTES-1 + sizeof(seq) + frame_len;
+        data_out[1] = (uint8_t) data_len;
+
+        // Checksum
+        data_out[data_len-1] = calculate_cs(data_out, &data_len);
+
+        // check for buffer overflows
+        check_buffer_overflow(&data_len);
+
+        // Send over UART to STM32
+        comm_tx(data_out, &data_len);
+
+        sent += data_len;
+    }
+
+    return true;
+}
+
+void uart_send_replay()
+{
+    if(!uart_send_stored(usr_backlog_next))
+    {
+        // Replay finished, report where it ended
+        uart_send_backlog();
+    }
+}
+
+void uart_send_spool()
+{
+    // Drain once the STM32 accepts data again
+    if(!m_flow_paused)
+    {
+        (void) uart_send_stored(usr_spool_next);
+    }
+}
+
+void uart_send_spool_stats()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_SPOOL | stm32_spool_t | CS |
+
+    usr_spool_stats_t stats;
+    stm32_spool_t report;
+
+    usr_spool_stats_get(&stats);
+    report.pages = stats.pages;
+    report.pages_written = stats.pages_written;
+    report.bytes_spooled = stats.bytes_spooled;
+    report.bytes_drained = stats.bytes_drained;
+    report.overruns = stats.overruns;
+    report.lost = stats.lost;
+    report.errors = stats.errors;
+    report.write_ms_avg = stats.write_ms_avg;
+    report.write_ms_max = stats.write_ms_max;
+    report.flow_paused = m_flow_paused;
+
+    uart_send_config_struct(COMM_CMD_REQ_SPOOL, &report, sizeof(report));
+}
+
+void uart_send_sim_stats()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_SIM | stm32_sim_t | CS |
+
+    usr_sim_config_t config;
+    usr_sim_stats_t stats;
+    stm32_sim_t report;
+
+    usr_sim_config_get(&config);
+    usr_sim_stats_get(&stats);
+
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+
+    report.sensors = config.sensors;
+    report.data_type = config.type;
+    report.rate = config.rate_hz;
+    report.running = usr_sim_running();
+    report.elapsed_ms = stats.elapsed_ms;
+    report.notifications = stats.notifications;
+    report.samples = stats.samples;
+    report.lost = stats.lost;
+    report.late = stats.late;
+    report.frames = m_live_frames - m_sim_frames_start;
+    report.bytes = m_live_bytes - m_sim_bytes_start;
+    report.live_dropped = m_live_dropped - m_sim_dropped_start;
+    report.uart_pending_max = (uint16_t) MIN(stats.uart_pending_max, UINT16_MAX);
+    report.ns_per_sample = usr_frame_ns_per_sample(stats.cycles_total, cycles_per_us, stats.samples);
+    report.notif_us_max = stats.cycles_max / cycles_per_us;
+
+    uart_send_config_struct(COMM_CMD_REQ_SIM, &report, sizeof(report));
+}
+
+void uart_send_trace()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_TRACE_DATA | offset | trace bytes | CS |
+
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
+    uint32_t sent = 0;
+
+    // Only fill up the FIFO to the threshold, live data goes first
+    while((sent < USR_TRACE_DRAIN_BYTES) &&
+          (uart_tx_pending() + USR_INTERNAL_COMM_MAX_LEN <= USR_TRACE_DRAIN_FIFO_MAX))
+    {
+        uint32_t offset;
+        uint32_t len = usr_trace_read(&data_out[PACKET_DATA_PLACEHOLDER-1+TRACE_OFFSET_LEN], TRACE_CHUNK_MAX, &offset);
+
+        if(len == 0)
+        {
+            break;
+        }
+
+        data_out[0] = START_BYTE;
+        data_out[2] = CONFIG;
+        data_out[3] = COMM_CMD_TRACE_DATA;
+        memcpy(&data_out[PACKET_DATA_PLACEHOLDER-1], &offset, TRACE_OFFSET_LEN);
+
+        data_len = OVERHEAD_BYTES-1 + TRACE_OFFSET_LEN + len;
+        data_out[1] = (uint8_t) data_len;
+
+        // Checksum
+        data_out[data_len-1] = calculate_cs(data_out, &data_len);
+
+        // check for buffer overflows
+        check_buffer_overflow(&data_len);
+
+        // Send over UART to STM32
+        comm_tx(data_out, &data_len);
+
+        sent += data_len;
+    }
+}
+
+void uart_send_trace_status()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_TRACE | stm32_trace_t | CS |
+
+    usr_trace_status_t status;
+    stm32_trace_t report;
+
+    usr_trace_status_get(&status);
+    report.capturing = status.capturing;
+    report.records = status.records;
+    report.bytes = status.bytes;
+    report.dropped = status.dropped;
+    report.pending = status.pending;
+
+    uart_send_config_struct(COMM_CMD_TRACE, &report, sizeof(report));
+}
+
+void uart_send_latency(uint8_t sensor_nr)
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_LATENCY | stm32_latency_t | CS |
+
+    for(uint8_t stage = 0; stage < USR_LATENCY_STAGES; stage++)
+    {
+        usr_latency_hist_t hist;
+        stm32_latency_t report;
+
+        if(usr_latency_hist_get(sensor_nr, (usr_latency_stage_t) stage, &hist) != NRF_SUCCESS)
+        {
+            comm_send_rejected(COMM_CMD_REQ_LATENCY);
+            return;
+        }
+
+        report.sensor_nr = sensor_nr;
+        report.stage = stage;
+        report.count = hist.count;
+        report.avg_us = hist.avg_us;
+        report.max_us = hist.max_us;
+        report.untracked = usr_latency_untracked_get();
+        memcpy(report.bins, hist.bins, sizeof(report.bins));
+
+        uart_send_config_struct(COMM_CMD_REQ_LATENCY, &report, sizeof(report));
+    }
+}
+
+void uart_send_prof()
+{
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_REQ_PROF | stm32_prof_t | CS |
+    // | START_BYTE | packet_len | command (CONFIG) | COMM_CMD_CPU_LOAD | stm32_cpu_load_t | CS |
+
+    for(uint8_t handler = 0; handler < USR_PROF_HANDLERS; handler++)
+    {
+        usr_prof_stats_t stats;
+        stm32_prof_t report;
+
+        APP_ERROR_CHECK(usr_prof_stats_get((usr_prof_handler_t) handler, &stats));
+
+        report.handler = handler;
+        report.calls = stats.calls;
+        report.min_cycles = stats.min_cycles;
+        report.avg_cycles = stats.avg_cycles;
+        report.max_cycles = stats.max_cycles;
+
+        uart_send_config_struct(COMM_CMD_REQ_PROF, &report, sizeof(report));
+    }
+
+    usr_prof_cpu_t cpu;
+    stm32_cpu_load_t load;
+
+    usr_prof_cpu_get(&cpu);
+    load.window_ms = cpu.window_ms;
+    load.busy_permille = cpu.busy_permille;
+    load.idle_permille = cpu.idle_permille;
+
+    uart_send_config_struct(COMM_CMD_CPU_LOAD, &load, sizeof(load));
+}
+
+// Part of a notification replayed from a trace, false when the part is invalid
+static bool comm_trace_inject(uint8_t const * p_part)
+{
+    uint8_t conn_handle = p_part[0];
+    uint8_t evt_type = p_part[1];
+    uint8_t total_len = p_part[2];
+    uint8_t offset = p_part[3];
+    uint8_t count = p_part[4];
+
+    // The data path is fed by the BLE event interrupt while sensors are connected, it is not reentrant
+    if(ble_conn_state_central_conn_count() > 0)
+    {
+        m_inject_len = 0;
+        return false;
+    }
+
+    // Parts arrive in order
+    if((offset != m_inject_len) || (offset + count > total_len))
+    {
+        m_inject_len = 0;
+        return false;
+    }
+
+    memcpy(&m_inject_buf[offset], &p_part[TRACE_INJECT_HEADER_LEN], count);
+    m_inject_len = offset + count;
+
+    if(m_inject_len < total_len)
+    {
+        return true;
+    }
+
+    m_inject_len = 0;
+
+    // Same decoding as a notification received over BLE
+    ble_imu_service_c_evt_t evt;
+    if(ble_imu_service_c_notif_decode((ble_imu_service_c_evt_type_t) evt_type, m_inject_buf, total_len, &evt) != NRF_SUCCESS)
+    {
+        return false;
+    }
+
+    evt.conn_handle = conn_handle;
+    imu_service_c_evt_handler(NULL, &evt);
+
+    return true;
+}
+
+void comm_rx_process(void *p_event_data, uint16_t event_size)
+{
+    USR_PROF_ENTER();
+    usr_latency_cmd_begin();
+
+    //| START_BYTE | packet_len | command (CONFIG_BYTE) |  config_data | CS    |
+    //| ----------- |-----------|---------           --|------------- |-----  -|
+    //| 1 byte        | 1 byte  |               1 byte |      k bytes |  1 byte |
+
+    NRF_LOG_HEXDUMP_INFO(p_event_data, event_size);
+
+    // Get data from buffer - store in var rx_data
+    uint8_t p_byte;
+    uint8_t rx_data[USR_INTERNAL_COMM_MAX_LEN];
+    uint8_t i = 0;
+    while ((uart_rx_buff_get(&p_byte) != NRF_ERROR_NOT_FOUND))
+    {
+        rx_data[i] = p_byte;
+        i++;
+    }
+
+    // Store the received packet length
+    uint32_t len = i;
+
+    // Start byte, packet len, checksum (not including last CS byte) and command dataframe
+    uint32_t len_no_cs = len - CS_LEN;
+    usr_frame_rx_status_t rx_status = usr_frame_rx_check(rx_data, len);
+
+    if(rx_status != USR_FRAME_RX_OK)
+    {
+        NRF_LOG_INFO("Invalid RX packet received");
+
+        switch (rx_status)
+        {
+        case USR_FRAME_RX_START:
+            NRF_LOG_INFO("Start byte not correct");
+            break;
+        case USR_FRAME_RX_LEN:
+            NRF_LOG_INFO("Invalid RX packet len");
+            break;
+        case USR_FRAME_RX_CS:
+            NRF_LOG_INFO("Correct CS: 0x%X - Received CS: 0x%X", usr_frame_cs(rx_data, len), rx_data[len_no_cs]);
+            NRF_LOG_INFO("len: %d - 0x%X", len, len);
+            NRF_LOG_INFO("Invalid RX packet CS");
+            break;
+        default:
+            NRF_LOG_INFO("Invalid COMMAND received");
+            break;
+        }
+        usr_evlog(USR_EVLOG_RX_INVALID, rx_status, len);
+        usr_latency_cmd_end();
+        USR_PROF_EXIT(USR_PROF_COMM_RX);
+        return;
+    }
+
+    NRF_LOG_INFO("Correct payload packet received");
+
+    // Any valid frame shows the STM32 is up
+    usr_boot_on_rx();
+
+    // Decode payload
+    uint8_t remaining_data_len = len_no_cs - CONFIG_PACKET_DATA_OFFSET;
+    uint8_t j = CONFIG_PACKET_DATA_OFFSET;
+    
+    while(remaining_data_len >=1) // Keep processing when there is data available
+    {
+        NRF_LOG_INFO("remaining_data_len: %d", remaining_data_len);
+
+        uint8_t config_data = rx_data[j]; // Get packet
+        NRF_LOG_INFO("Config data: 0x%X", config_data);
+
+        switch (config_data)
+        {
+        case COMM_CMD_SET_CONN_DEV_LIST: // WORKING
+        {
+
+            NRF_LOG_INFO("COMM_CMD_SET_CONN_DEV_LIST");
+            
+            dcu_conn_dev_t conn_dev[NRF_BLE_SCAN_ADDRESS_CNT];
+
+            // | command | count x address |, the rest of the list is cleared
+            // Lists that do not fit one frame use COMM_CMD_SET_CONN_DEV_LIST_PAGE
+            uint8_t list_len = remaining_data_len - 1;
+            uint8_t count = list_len / sizeof(dcu_conn_dev_t);
+            if((list_len % sizeof(dcu_conn_dev_t)) != 0 || count > NRF_BLE_SCAN_ADDRESS_CNT)
+            {
+                NRF_LOG_INFO("Device list length %d invalid", list_len);
+                comm_send_rejected(COMM_CMD_SET_CONN_DEV_LIST);
+                remaining_data_len = 0;
+                break;
+            }
+
+            // Copy data into buffer
+            memcpy(conn_dev, &rx_data[j+1], count*sizeof(dcu_conn_dev_t));
+
+            // Entries from count on are set to the FF placeholder
+            set_conn_dev_mask(conn_dev, count);
+
+            remaining_data_len = remaining_data_len - list_len - 1;
+            // j++;
+
+            comm_send_ok(COMM_CMD_SET_CONN_DEV_LIST);
+
+        }break;
+
+        case COMM_CMD_SET_CONN_DEV_LIST_PAGE:
+        {
+            NRF_LOG_INFO("COMM_CMD_SET_CONN_DEV_LIST_PAGE");
+
+            // | command | first | count | total | count x address |
+            uint8_t first = rx_data[j+1];
+            uint8_t count = rx_data[j+2];
+            uint8_t total = rx_data[j+3];
+            uint32_t page_len = 1 + CONN_DEV_SET_PAGE_HEADER_LEN + count*sizeof(dcu_conn_dev_t);
+
+            if((remaining_data_len < 1 + CONN_DEV_SET_PAGE_HEADER_LEN) || (remaining_data_len < page_len) ||
+               (total > NRF_BLE_SCAN_ADDRESS_CNT) || (first + count > total) ||
+               ((first != 0) && (first != m_conn_dev_pending_next)))
+            {
+                NRF_LOG_INFO("Invalid device list page");
+                comm_send_rejected(COMM_CMD_SET_CONN_DEV_LIST_PAGE);
+                remaining_data_len = 0;
+                break;
+            }
+
+            if(first == 0)
+            {
+                // Entries that are not sent hold the FF placeholder address, as in usr_ble
+                memset(m_conn_dev_pending, 0xFF, sizeof(m_conn_dev_pending));
+            }
+            memcpy(&m_conn_dev_pending[first], &rx_data[j+1+CONN_DEV_SET_PAGE_HEADER_LEN], count*sizeof(dcu_conn_dev_t));
+            m_conn_dev_pending_next = first + count;
+
+            // Apply once the last device is received
+            if(first + count == total)
+            {
+                set_conn_dev_mask(m_conn_dev_pending, total);
+                m_conn_dev_pending_next = 0;
+            }
+
+            comm_send_ok(COMM_CMD_SET_CONN_DEV_LIST_PAGE);
+
+            remaining_data_len -= page_len;
+            j += page_len;
+        } break;
+
+        case COMM_CMD_REQ_CONN_DEV_LIST: // WORKING
+        {
+            NRF_LOG_INFO("COMM_CMD_REQ_CONN_DEV_LIST");
+
+            dcu_connected_devices_t dev[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+            get_connected_devices(dev, sizeof(dev));
+            
+            if(OVERHEAD_BYTES + sizeof(dev) < USR_INTERNAL_COMM_MAX_LEN)
+            {
+                uart_send_conn_dev(dev, sizeof(dev));
+            }else
+            {
+                uart_send_conn_dev_pages(dev, NRF_SDH_BLE_CENTRAL_LINK_COUNT);
+            }
+
+            remaining_data_len--;
+            j++;
+
+        } break;
+
+        case COMM_CMD_START: // WORKING
+
+            NRF_LOG_INFO("COMM_CMD_START with time");
+
+            // Handle epoch time from STM32
+            uint8_t *temp_time1 = &rx_data[j+1];
+            stm32_time_t epoch_time1;
+            NRF_LOG_INFO("epoch time: %d %X", epoch_time1, epoch_time1);
+            memcpy(&epoch_time1, temp_time1, sizeof(epoch_time1));
+
+            // Send the configuration to all sensors
+            uint32_t offset = config_send();
+
+            set_stm32_real_time(epoch_time1, offset);
+
+            // remaining_data_len--;
+            // j++;
+            remaining_data_len--;
+            remaining_data_len -= 8;
+            j++;
+            j += 8;
+            break;
+
+        case COMM_CMD_STOP:
+
+            NRF_LOG_INFO("COMM_CMD_STOP");
+
+            config_send_stop();
+            // set_config_reset();
+            // config_send();
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_MEAS: // WORKING
+
+            NRF_LOG_INFO("COMM_CMD_MEAS");
+
+            // Check which measurement to start
+            config_data = rx_data[j+1]; // Peek the next byte
+
+            // Decode meas payload
+            decode_meas(config_data);
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
+            break;
+        
+        case COMM_CMD_SYNC: // WORKING
+
+            NRF_LOG_INFO("COMM_CMD_SYNC");
+            
+            config_data = rx_data[j+1];
+            
+            decode_sync(config_data);
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
+            break;
+
+        case COMM_CMD_FREQUENCY: // WORKING
+
+            NRF_LOG_INFO("COMM_CMD_FREQUENCY");
+
+            config_data = rx_data[j+1];
+
+            decode_frequency(config_data);
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
+            break;
+
+        case COMM_CMD_CALIBRATE:
+
+            NRF_LOG_INFO("COMM_CMD_CALIBRATE");
+
+            set_config_start_calibration(1);
+            config_send();
+            set_config_start_calibration(0);
+
+            remaining_data_len--;
+            j++;
+
+            break;
+
+        case COMM_CMD_RESET:
+
+            NRF_LOG_INFO("COMM_CMD_RESET");
+
+            set_config_reset();
+            comm_send_ok(COMM_CMD_RESET);
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_REQ_BATTERY_LEVEL: // WORKING
+
+            NRF_LOG_INFO("COMM_CMD_REQ_BATTERY_LEVEL");
+
+            uart_send_battery(false);
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_TIME:;
+            
+            NRF_LOG_INFO("COMM_CMD_TIME");
+
+            NRF_LOG_INFO("%X", rx_data[j+1]);
+            NRF_LOG_INFO("%X", rx_data[j+2]);
+            NRF_LOG_INFO("%X", rx_data[j+3]);
+            NRF_LOG_INFO("%X", rx_data[j+4]);
+            NRF_LOG_INFO("%X", rx_data[j+5]);
+            NRF_LOG_INFO("%X", rx_data[j+6]);
+            NRF_LOG_INFO("%X", rx_data[j+7]);
+            NRF_LOG_INFO("%X", rx_data[j+8]);
+
+            uint8_t *temp_time = &rx_data[j+1];
+            stm32_time_t epoch_time;
+            NRF_LOG_INFO("epoch time: %d %X", epoch_time, epoch_time);
+            memcpy(&epoch_time, temp_time, sizeof(epoch_time));
+
+            // TODO: offset assumed 0 for now, this introduces an error of the time needed to transmit this value to the sensors and start the measurement
+            set_stm32_real_time(epoch_time, 0);
+
+            remaining_data_len--;
+            remaining_data_len -= 8;
+            j++;
+            j += 8;
+            break;
+
+        case COMM_CMD_REQ_CONN_DEV_LIST_PAGE:
+        {
+            NRF_LOG_INFO("COMM_CMD_REQ_CONN_DEV_LIST_PAGE");
+
+            dcu_connected_devices_t dev[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
+            get_connected_devices(dev, sizeof(dev));
+
+            uart_send_conn_dev_pages(dev, NRF_SDH_BLE_CENTRAL_LINK_COUNT);
+
+            remaining_data_len--;
+            j++;
+        } break;
+
+        case COMM_CMD_REQ_CONN_PARAMS:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_CONN_PARAMS");
+
+            uart_send_conn_params();
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_REQ_LINK_CAPS:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_LINK_CAPS");
+
+            uart_send_link_caps();
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_REQ_LINK_STATS:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_LINK_STATS");
+
+            uart_send_link_stats();
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_REQ_GATT_STATS:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_GATT_STATS");
+
+            uart_send_gatt_stats();
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_BATTERY_PERIOD:
+
+            NRF_LOG_INFO("COMM_CMD_BATTERY_PERIOD");
+
+            // | command | period |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_BATTERY_PERIOD);
+                remaining_data_len = 0;
+                break;
+            }
+
+            config_data = rx_data[j+1];
+
+            comm_send_status(COMM_CMD_BATTERY_PERIOD, usr_battery_period_set(config_data));
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
+            break;
+
+        case COMM_CMD_SET_JOINT_PAIRS:
+        {
+            NRF_LOG_INFO("COMM_CMD_SET_JOINT_PAIRS");
+
+            // | command | count | count x (sensor_a, sensor_b, outputs) |
+            uint8_t count = rx_data[j+1];
+            uint32_t pairs_len = 2 + count*JOINT_PAIR_LEN;
+
+            if((remaining_data_len < 2) || (remaining_data_len < pairs_len))
+            {
+                NRF_LOG_INFO("Joint pairs too short");
+                comm_send_rejected(COMM_CMD_SET_JOINT_PAIRS);
+                remaining_data_len = 0;
+                break;
+            }
+
+            usr_joint_pair_t pairs[USR_JOINT_PAIRS_MAX];
+            bool valid = (count <= USR_JOINT_PAIRS_MAX);
+
+            for(uint8_t i = 0; valid && (i < count); i++)
+            {
+                pairs[i].slot_a = rx_data[j+2+i*JOINT_PAIR_LEN];
+                pairs[i].slot_b = rx_data[j+3+i*JOINT_PAIR_LEN];
+                pairs[i].outputs = rx_data[j+4+i*JOINT_PAIR_LEN];
+            }
+
+            if(valid && usr_joint_pairs_set(pairs, count, NRF_SDH_BLE_CENTRAL_LINK_COUNT))
+            {
+                comm_send_ok(COMM_CMD_SET_JOINT_PAIRS);
+            }else
+            {
+                comm_send_rejected(COMM_CMD_SET_JOINT_PAIRS);
+            }
+
+            remaining_data_len -= pairs_len;
+            j += pairs_len;
+        } break;
+
+        case COMM_CMD_RESUME:
+        {
+            NRF_LOG_INFO("COMM_CMD_RESUME");
+
+            // | command | mode | seq / time (8 bytes) |
+            if(remaining_data_len < 2 + RESUME_VALUE_LEN)
+            {
+                NRF_LOG_INFO("Resume too short");
+                comm_send_rejected(COMM_CMD_RESUME);
+                remaining_data_len = 0;
+                break;
+            }
 
-    // Check if start byte is correct
-    if(rx_data[0] != START_BYTE)
-    {
-        NRF_LOG_INFO("Invalid RX packet received");
-        NRF_LOG_INFO("Start byte not correct");
-        return;
-    }
+            uint64_t value;
+            memcpy(&value, &rx_data[j+2], RESUME_VALUE_LEN);
 
-    // Check if packet len == received packet len
-    if(rx_data[1] != len)
-    {
-        NRF_LOG_INFO("Invalid RX packet received");
-        NRF_LOG_INFO("Invalid RX packet len");
-        return;
-    }
-    
-    // Check checksum (not including last CS byte)
-    uint32_t len_no_cs = len - CS_LEN;
-    uint8_t cs = calculate_cs(rx_data, &len);
+            ret_code_t err_code;
 
-    if(cs != rx_data[len_no_cs])
-    {
-        NRF_LOG_INFO("Correct CS: 0x%X - Received CS: 0x%X", cs, rx_data[len_no_cs]);
-        NRF_LOG_INFO("len: %d - 0x%X", len, len);
+            switch(rx_data[j+1])
+            {
+                case COMM_CMD_RESUME_SEQ:
+                    err_code = usr_backlog_replay_seq((uint32_t) value);
+                    break;
 
-        NRF_LOG_INFO("Invalid RX packet received");
-        NRF_LOG_INFO("Invalid RX packet CS");
-        return;
-    }
+                case COMM_CMD_RESUME_TIME:
+                    err_code = usr_backlog_replay_time(value);
+                    break;
 
-    // Check for command dataframe
-    command_byte_t command = rx_data[2];
-    if(command !=  CONFIG)
-    {
-        NRF_LOG_INFO("Invalid RX packet received");
-        NRF_LOG_INFO("Invalid COMMAND received");
-        return;
-    }
+                case COMM_CMD_RESUME_STOP:
+                    usr_backlog_replay_stop();
+                    err_code = NRF_SUCCESS;
+                    break;
 
-    NRF_LOG_INFO("Correct payload packet received");
-    NRF_LOG_FLUSH();
+                default:
+                    err_code = NRF_ERROR_INVALID_PARAM;
+                    break;
+            }
 
-    // Decode payload
-    uint8_t remaining_data_len = len_no_cs - CONFIG_PACKET_DATA_OFFSET;
-    uint8_t j = CONFIG_PACKET_DATA_OFFSET;
-    
-    while(remaining_data_len >=1) // Keep processing when there is data available
-    {
-        NRF_LOG_INFO("remaining_data_len: %d", remaining_data_len);
+            comm_send_status(COMM_CMD_RESUME, err_code);
+            uart_send_backlog();
 
-        uint8_t config_data = rx_data[j]; // Get packet
-        NRF_LOG_INFO("Config data: 0x%X", config_data);
-        NRF_LOG_FLUSH();
+            remaining_data_len -= 2 + RESUME_VALUE_LEN;
+            j += 2 + RESUME_VALUE_LEN;
+        } break;
 
-        switch (config_data)
+        case COMM_CMD_SIM:
         {
-        case COMM_CMD_SET_CONN_DEV_LIST: // WORKING
+            NRF_LOG_INFO("COMM_CMD_SIM");
+
+            // | command | sensors | data_type | rate (2 bytes) | jitter | loss |
+            if(remaining_data_len < 1 + SIM_CONFIG_LEN)
+            {
+                NRF_LOG_INFO("Simulation config too short");
+                comm_send_rejected(COMM_CMD_SIM);
+                remaining_data_len = 0;
+                break;
+            }
+
+            usr_sim_config_t config;
+            config.sensors = rx_data[j+1];
+            config.type = rx_data[j+2];
+            config.rate_hz = (uint16_t) (rx_data[j+3] | (rx_data[j+4] << 8));
+            config.jitter_ms = rx_data[j+5];
+            config.loss_pct = rx_data[j+6];
+
+            m_sim_frames_start = m_live_frames;
+            m_sim_bytes_start = m_live_bytes;
+            m_sim_dropped_start = m_live_dropped;
+
+            ret_code_t err_code = usr_sim_start(&config);
+            comm_send_status(COMM_CMD_SIM, err_code);
+
+            remaining_data_len -= 1 + SIM_CONFIG_LEN;
+            j += 1 + SIM_CONFIG_LEN;
+        } break;
+
+        case COMM_CMD_REQ_SIM:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_SIM");
+
+            uart_send_sim_stats();
+
+            remaining_data_len--;
+            j++;
+            break;
+
+        case COMM_CMD_TRACE:
         {
+            NRF_LOG_INFO("COMM_CMD_TRACE");
 
-            NRF_LOG_INFO("COMM_CMD_SET_CONN_DEV_LIST");
-            
-            dcu_conn_dev_t conn_dev[NRF_BLE_SCAN_ADDRESS_CNT];
-             // Init with zeros
-            memset(conn_dev, 0, sizeof(conn_dev));
+            // | command | operation |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_TRACE);
+                remaining_data_len = 0;
+                break;
+            }
 
-            // Copy data into buffer
-            memcpy(conn_dev, &rx_data[j+1], sizeof(conn_dev));
+            ret_code_t err_code = NRF_SUCCESS;
+            config_data = rx_data[j+1];
 
-            // Return packet with connected devices
-            set_conn_dev_mask(conn_dev, sizeof(conn_dev));
+            switch(config_data)
+            {
+                case COMM_CMD_TRACE_STOP:
+                    usr_trace_stop();
+                    break;
 
-            remaining_data_len = remaining_data_len - sizeof(conn_dev) - 1;
-            // j++;
+                case COMM_CMD_TRACE_START:
+                    err_code = usr_trace_start();
+                    break;
 
-            comm_send_ok(COMM_CMD_SET_CONN_DEV_LIST);
+                case COMM_CMD_TRACE_STATUS:
+                    break;
 
-        }break;
+                default:
+                    err_code = NRF_ERROR_INVALID_PARAM;
+                    break;
+            }
 
-        case COMM_CMD_REQ_CONN_DEV_LIST: // WORKING
+            comm_send_status(COMM_CMD_TRACE, err_code);
+            uart_send_trace_status();
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
+        } break;
+
+        case COMM_CMD_TRACE_INJECT:
         {
-            NRF_LOG_INFO("COMM_CMD_REQ_CONN_DEV_LIST");
+            // | command | conn_handle | evt_type | total_len | offset | count | payload |
+            if((remaining_data_len < 1 + TRACE_INJECT_HEADER_LEN) ||
+               (remaining_data_len < 1 + TRACE_INJECT_HEADER_LEN + rx_data[j+TRACE_INJECT_HEADER_LEN]))
+            {
+                NRF_LOG_INFO("Trace part too short");
+                comm_send_rejected(COMM_CMD_TRACE_INJECT);
+                remaining_data_len = 0;
+                break;
+            }
 
-            dcu_connected_devices_t dev[NRF_SDH_BLE_CENTRAL_LINK_COUNT];
-            get_connected_devices(dev, sizeof(dev));
-            
-            uart_send_conn_dev(dev, sizeof(dev));
+            uint8_t part_len = 1 + TRACE_INJECT_HEADER_LEN + rx_data[j+TRACE_INJECT_HEADER_LEN];
 
-            remaining_data_len--;
-            j++;
+            if(!comm_trace_inject(&rx_data[j+1]))
+            {
+                comm_send_rejected(COMM_CMD_TRACE_INJECT);
+            }
 
+            remaining_data_len -= part_len;
+            j += part_len;
         } break;
 
-        case COMM_CMD_START: // WORKING
+        case COMM_CMD_READY:
 
-            NRF_LOG_INFO("COMM_CMD_START with time");
-            NRF_LOG_FLUSH();
+            NRF_LOG_INFO("COMM_CMD_READY");
 
-            // Handle epoch time from STM32
-            uint8_t *temp_time1 = &rx_data[j+1];
-            stm32_time_t epoch_time1;
-            NRF_LOG_INFO("epoch time: %d %X", epoch_time1, epoch_time1);
-            NRF_LOG_FLUSH();
-            memcpy(&epoch_time1, temp_time1, sizeof(epoch_time1));
+            // Handshake ended by usr_boot_on_rx above
+            remaining_data_len--;
+            j++;
+            break;
 
-            // Send the configuration to all sensors
-            uint32_t offset = config_send();
+        case COMM_CMD_REQ_EVLOG:
 
-            set_stm32_real_time(epoch_time1, offset);
+            NRF_LOG_INFO("COMM_CMD_REQ_EVLOG");
+
+            uart_send_evlog();
 
-            // remaining_data_len--;
-            // j++;
             remaining_data_len--;
-            remaining_data_len -= 8;
             j++;
-            j += 8;
             break;
 
-        case COMM_CMD_STOP:
+        case COMM_CMD_REQ_TELEMETRY:
 
-            NRF_LOG_INFO("COMM_CMD_STOP");
+            NRF_LOG_INFO("COMM_CMD_REQ_TELEMETRY");
+
+            uart_send_telemetry();
 
-            config_send_stop();
-            // set_config_reset();
-            // config_send();
             remaining_data_len--;
             j++;
             break;
 
-        case COMM_CMD_MEAS: // WORKING
+        case COMM_CMD_TELEMETRY_PERIOD:
 
-            NRF_LOG_INFO("COMM_CMD_MEAS");
+            NRF_LOG_INFO("COMM_CMD_TELEMETRY_PERIOD");
 
-            // Check which measurement to start
-            config_data = rx_data[j+1]; // Peek the next byte
+            // | command | period |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_TELEMETRY_PERIOD);
+                remaining_data_len = 0;
+                break;
+            }
 
-            // Decode meas payload
-            decode_meas(config_data);
+            config_data = rx_data[j+1];
+
+            comm_send_status(COMM_CMD_TELEMETRY_PERIOD, usr_telemetry_period_set(config_data));
 
             remaining_data_len = remaining_data_len-2;
             j=j+2;
             break;
-        
-        case COMM_CMD_SYNC: // WORKING
 
-            NRF_LOG_INFO("COMM_CMD_SYNC");
-            
+        case COMM_CMD_REQ_PROF:
+
+            NRF_LOG_INFO("COMM_CMD_REQ_PROF");
+
+            // | command | reset |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_REQ_PROF);
+                remaining_data_len = 0;
+                break;
+            }
+
             config_data = rx_data[j+1];
-            
-            decode_sync(config_data);
+
+            uart_send_prof();
+            if(config_data == 1)
+            {
+                usr_prof_reset();
+            }
 
             remaining_data_len = remaining_data_len-2;
             j=j+2;
             break;
 
-        case COMM_CMD_FREQUENCY: // WORKING
+        case COMM_CMD_REQ_LATENCY:
 
-            NRF_LOG_INFO("COMM_CMD_FREQUENCY");
+            NRF_LOG_INFO("COMM_CMD_REQ_LATENCY");
+
+            // | command | sensor_nr | reset |
+            if(remaining_data_len < 3)
+            {
+                comm_send_rejected(COMM_CMD_REQ_LATENCY);
+                remaining_data_len = 0;
+                break;
+            }
+
+            uart_send_latency(rx_data[j+1]);
+            if(rx_data[j+2] == 1)
+            {
+                usr_latency_reset();
+            }
+
+            remaining_data_len = remaining_data_len-3;
+            j=j+3;
+            break;
+
+        case COMM_CMD_FLOW:
+
+            NRF_LOG_INFO("COMM_CMD_FLOW");
+
+            // | command | credits |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_FLOW);
+                remaining_data_len = 0;
+                break;
+            }
 
             config_data = rx_data[j+1];
 
-            decode_frequency(config_data);
-            comm_send_ok(COMM_CMD_FREQUENCY);
+            // 0: no credits, live data frames only go to the backlog and the spool
+            if((config_data == 0) && !m_flow_paused)
+            {
+                m_flow_pauses++;
+            }
+            m_flow_paused = (config_data == 0);
+            comm_send_ok(COMM_CMD_FLOW);
 
             remaining_data_len = remaining_data_len-2;
             j=j+2;
             break;
 
-        case COMM_CMD_CALIBRATE:
+        case COMM_CMD_REQ_SPOOL:
 
-            NRF_LOG_INFO("COMM_CMD_CALIBRATE");
+            NRF_LOG_INFO("COMM_CMD_REQ_SPOOL");
 
-            set_config_start_calibration(1);
-            config_send();
-            set_config_start_calibration(0);
+            uart_send_spool_stats();
 
             remaining_data_len--;
             j++;
-
             break;
 
-        case COMM_CMD_RESET:
+        case COMM_CMD_REQ_BACKLOG:
 
-            NRF_LOG_INFO("COMM_CMD_RESET");
+            NRF_LOG_INFO("COMM_CMD_REQ_BACKLOG");
 
-            set_config_reset();
-            comm_send_ok(COMM_CMD_RESET);
+            uart_send_backlog();
 
             remaining_data_len--;
             j++;
             break;
 
-        case COMM_CMD_REQ_BATTERY_LEVEL: // WORKING
+        case COMM_CMD_REQ_COMMISSIONING:
 
-            NRF_LOG_INFO("COMM_CMD_REQ_BATTERY_LEVEL");
+            NRF_LOG_INFO("COMM_CMD_REQ_COMMISSIONING");
 
-            // TODO return battery level packet
-            send_battery_voltages();
+            uart_send_commissioning();
 
             remaining_data_len--;
             j++;
             break;
 
-        case COMM_CMD_TIME:;
-            
-            NRF_LOG_INFO("COMM_CMD_TIME");
+        case COMM_CMD_LINK_STATS_PERIOD:
 
-            NRF_LOG_INFO("%X", rx_data[j+1]);
-            NRF_LOG_INFO("%X", rx_data[j+2]);
-            NRF_LOG_INFO("%X", rx_data[j+3]);
-            NRF_LOG_INFO("%X", rx_data[j+4]);
-            NRF_LOG_INFO("%X", rx_data[j+5]);
-            NRF_LOG_INFO("%X", rx_data[j+6]);
-            NRF_LOG_INFO("%X", rx_data[j+7]);
-            NRF_LOG_INFO("%X", rx_data[j+8]);
+            NRF_LOG_INFO("COMM_CMD_LINK_STATS_PERIOD");
 
-            uint8_t *temp_time = &rx_data[j+1];
-            stm32_time_t epoch_time;
-            NRF_LOG_INFO("epoch time: %d %X", epoch_time, epoch_time);
-            memcpy(&epoch_time, temp_time, sizeof(epoch_time));
+            // | command | period |
+            if(remaining_data_len < 2)
+            {
+                comm_send_rejected(COMM_CMD_LINK_STATS_PERIOD);
+                remaining_data_len = 0;
+                break;
+            }
 
-            // TODO: offset assumed 0 for now, this introduces an error of the time needed to transmit this value to the sensors and start the measurement
-            set_stm32_real_time(epoch_time, 0);
+            config_data = rx_data[j+1];
 
-            remaining_data_len--;
-            remaining_data_len -= 8;
-            j++;
-            j += 8;
+            comm_send_status(COMM_CMD_LINK_STATS_PERIOD, usr_link_stats_period_set(config_data));
+
+            remaining_data_len = remaining_data_len-2;
+            j=j+2;
             break;
 
+        case COMM_CMD_MEAS_SENSOR:
+        case COMM_CMD_FREQUENCY_SENSOR:
+        {
+            NRF_LOG_INFO("COMM_CMD_MEAS_SENSOR / COMM_CMD_FREQUENCY_SENSOR");
+
+            // | command | sensor_mask (4 bytes) | meas / freq |
+            if(remaining_data_len < 2 + SENSOR_MASK_LEN)
+            {
+                NRF_LOG_INFO("Sensor config too short");
+                comm_send_rejected(config_data);
+                remaining_data_len = 0;
+                break;
+            }
+
+            uint32_t sensor_mask;
+            memcpy(&sensor_mask, &rx_data[j+1], SENSOR_MASK_LEN);
+            uint8_t value = rx_data[j+1+SENSOR_MASK_LEN];
+
+            ret_code_t err_code;
+            if(config_data == COMM_CMD_MEAS_SENSOR)
+            {
+                err_code = config_meas_update(sensor_mask, value);
+            }else
+            {
+                err_code = config_frequency_update(sensor_mask, value);
+            }
+            comm_send_status(config_data, err_code);
+
+            remaining_data_len -= 2 + SENSOR_MASK_LEN;
+            j += 2 + SENSOR_MASK_LEN;
+        } break;
+
         default:
             break;
         }
     }
 
     check_not_negative_uint8(&remaining_data_len);
+
+    usr_latency_cmd_end();
+    USR_PROF_EXIT(USR_PROF_COMM_RX);
 }
 
 
@@ -523,6 +1947,11 @@ stm32_time_t get_stm32_real_time()
     return global_time;
 }
 
+uint32_t get_stm32_offset_time()
+{
+    return offset_time;
+}
+
 void set_stm32_real_time(stm32_time_t time, uint32_t this_offset)
 {
     global_time = time;
@@ -534,37 +1963,23 @@ void set_stm32_real_time(stm32_time_t time, uint32_t this_offset)
     NRF_LOG_INFO("Time updated, global time is now: ");
     NRF_LOG_INFO("time: %s", (uint32_t) string);
     NRF_LOG_INFO("Offset to start of measurement: %d", offset_time);
+
+    usr_ble_warm_save();
 }
 
 stm32_time_t calculate_total_time(stm32_time_t local_time)
 {
-    stm32_time_t total_time;
-    stm32_time_t real_time = get_stm32_real_time();
-    uint32_t offset = offset_time;
-
-    // Calculate
-    // -------- = Start time + Time since start of measurement + offset time to wait before measurement has actually started
-    total_time = real_time + local_time + offset;
-
-    return total_time;
+    // Start time + Time since start of measurement + offset time to wait before measurement has actually started
+    return usr_frame_total_time(get_stm32_real_time(), offset_time, local_time);
 }
 
 
 static uint8_t calculate_cs(uint8_t * data, uint32_t * len) //tested
 {
-    // Init to zero
-    uint8_t cs = 0x00;
-
-    for (uint32_t i=0; i<(*len-1); i++)
-    {
-        // XOR
-        cs ^= data[i];
-    }
-
-    return cs;
+    return usr_frame_cs(data, *len);
 }
 
-void comm_send_ok(command_type_byte_t command_type)
+static void comm_send_ack(command_type_byte_t ack, command_type_byte_t command_type)
 {
     // | START_BYTE | packet_len | command (DATA_BYTE) |  sensor_nr |  data_type | data | CS |
     // | ----------- |-----------|-----------|------------|-----------|----------------|---|
@@ -594,7 +2009,7 @@ void comm_send_ok(command_type_byte_t command_type)
     uint8_t sensor_nr = 0xFF;
 
     data_out[2] = command_byte;
-    data_out[3] = COMM_CMD_OK;
+    data_out[3] = ack;
     data_out[4] = sensor_nr;
 
     data_len += sizeof(command_type); // No data to be added to OK packet
@@ -611,13 +2026,81 @@ void comm_send_ok(command_type_byte_t command_type)
     check_buffer_overflow(&data_len);
 
     // Send over UART to STM32
-    uart_queued_tx(data_out, &data_len);
+    comm_tx(data_out, &data_len);
+}
+
+void comm_send_ok(command_type_byte_t command_type)
+{
+    comm_send_ack(COMM_CMD_OK, command_type);
 }
 
+void comm_send_rejected(command_type_byte_t command_type)
+{
+    comm_send_ack(COMM_CMD_REJECTED, command_type);
+}
+
+void comm_send_status(command_type_byte_t command_type, ret_code_t err_code)
+{
+    if(err_code == NRF_SUCCESS)
+    {
+        comm_send_ok(command_type);
+    }else
+    {
+        comm_send_rejected(command_type);
+    }
+}
+
+
+// sensor_nr of the frames of a notification: the device list slot, as in the reports.
+// Simulated sensors have no connection, their handle is their slot.
+static uint8_t data_sensor_nr(uint16_t conn_handle)
+{
+    return usr_sim_running() ? (uint8_t) conn_handle : usr_ble_sensor_slot_get(conn_handle);
+}
+
+static void comm_send_emg(ble_imu_service_c_evt_t * data_in, uint8_t sensor_nr)
+{
+    // | START_BYTE | packet_len | command (DATA) | sensor_nr | EMG | timestamp | first | count | sample_bytes | samples | CS |
+
+    ble_imu_service_adc_t *adc = &data_in->params.value.adc_data;
+
+    uint8_t data_out[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t data_len;
+
+    // One timestamp for the whole notification
+    stm32_time_t time = calculate_total_time(adc->timestamp_ms);
+
+    for(uint8_t first = 0; first < BLE_IMU_SERVICE_ADC_SAMPLES; first += EMG_FRAME_SAMPLES)
+    {
+        uint8_t count = MIN(EMG_FRAME_SAMPLES, BLE_IMU_SERVICE_ADC_SAMPLES - first);
+
+        data_len = usr_frame_emg(data_out, sensor_nr, time, adc->raw, first, count);
+
+        // check for buffer overflows
+        check_buffer_overflow(&data_len);
+
+        // Store and send over UART to STM32
+        comm_data_tx(data_out, &data_len, time, sensor_nr);
+    }
+}
+
+void comm_ingest(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * data_in)
+{
+    #if (USR_FREERTOS == 1)
+    // The BLE task only copies the notification, a burst does not hold up the other tasks
+    if(!usr_rtos_encode_put(type, data_in))
+    {
+        usr_evlog(USR_EVLOG_ENCODE_FULL, type, data_in->conn_handle);
+    }
+    #else
+    comm_process(type, data_in);
+    #endif
+}
 
-// Tested and working
 void comm_process(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * data_in)
 {
+    USR_PROF_ENTER();
+
     // | START_BYTE | packet_len | command (DATA_BYTE) |  sensor_nr |  data_type | data | CS |
     // | ----------- |-----------|-----------|------------|-----------|----------------|---|
     // | 1 byte     | 1 byte     | 1 byte               | 1 byte    | 1 byte    | k bytes | 1 byte |
@@ -629,6 +2112,14 @@ void comm_process(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * d
     data_type_byte_t type_byte;
     command_byte_t command_byte;
 
+    uint8_t sensor_nr = data_sensor_nr(data_in->conn_handle);
+    if(sensor_nr == USR_SENSOR_SLOT_INVALID)
+    {
+        usr_evlog(USR_EVLOG_DATA_NO_SLOT, type, data_in->conn_handle);
+        USR_PROF_EXIT(USR_PROF_COMM_PROCESS);
+        return;
+    }
+
     // Fill configuration bytes
     data_out[0] = START_BYTE;
 
@@ -644,9 +2135,6 @@ void comm_process(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * d
         // Tell the receiver its config we're sending
         command_byte = CONFIG;
 
-        // TODO match this to the MAC address - keep track of list of MAC addresses
-        uint8_t sensor_nr = data_in->conn_handle;
-
         data_out[2] = command_byte;
         
         data_out[4] = sensor_nr;
@@ -692,119 +2180,80 @@ void comm_process(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * d
         // NRF_LOG_HEXDUMP_INFO(data_out, data_len);
 
         // Send over UART to STM32
-        uart_queued_tx(data_out, &data_len);
+        comm_tx(data_out, &data_len);
         // NRF_LOG_INFO("Data send");
 
-    }else{ // Else it's DATA
+    }else if(type == BLE_IMU_SERVICE_EVT_ADC){ // EMG blocks are packed in their own frames
 
-    // BLE_PACKET_BUFFER_COUNT bytes in 1 BLE packet
-    for(uint8_t i=0; i<BLE_PACKET_BUFFER_COUNT; i++)
-    {
-        data_len = 0;
-        // Length of frame
-        data_len += OVERHEAD_BYTES;
+        comm_send_emg(data_in, sensor_nr);
+
+    }else{ // Else it's DATA
 
-        // Tell the receiver its data we're sending
-        command_byte = DATA;
+    // BLE_PACKET_BUFFER_COUNT bytes in 1 BLE packet, Euler angles are sent one per packet
+    uint8_t samples = (type == BLE_IMU_SERVICE_EVT_EULER) ? 1 : BLE_PACKET_BUFFER_COUNT;
 
-        uint8_t sensor_nr = data_in->conn_handle;
+    for(uint8_t i=0; i<samples; i++)
+    {
+        stm32_time_t time = 0;
 
-        data_out[2] = command_byte;
-        data_out[3] = sensor_nr;
+        data_len = 0;
 
         switch (type)
         {
             case BLE_IMU_SERVICE_EVT_QUAT:
             {
                 ble_imu_service_quat_t *quat = &data_in->params.value.quat_data;
+                stm32_quat_t q = { quat->quat[i].w, quat->quat[i].x, quat->quat[i].y, quat->quat[i].z };
 
-                data_len += (4*sizeof(int32_t))/sizeof(uint8_t);
-                data_len += sizeof(stm32_time_t)/sizeof(uint8_t);
+                time = calculate_total_time(quat->quat[i].timestamp_ms);
+                data_len = usr_frame_quat(data_out, sensor_nr, &q, time); //30 bytes
 
-                data_out[1] = (uint8_t) data_len; //22
-
-                type_byte = QUATERNIONS;
-                data_out[4] = type_byte;
-
-                // Copy data to packet
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER), &quat->quat[i].w, sizeof(int32_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + sizeof(int32_t)), &quat->quat[i].x, sizeof(int32_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 2*sizeof(int32_t)), &quat->quat[i].y, sizeof(int32_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 3*sizeof(int32_t)), &quat->quat[i].z, sizeof(int32_t));
-                
-                // Timestamp ms
-                stm32_time_t time = calculate_total_time(quat->quat[i].timestamp_ms);
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 4*sizeof(int32_t)), &time, sizeof(stm32_time_t));
-
-                // Checksum
-                uint8_t cs = calculate_cs(data_out, &data_len);
-                data_out[PACKET_DATA_PLACEHOLDER + 4*sizeof(int32_t) + sizeof(stm32_time_t)] = cs;
-
-
-                NRF_LOG_INFO("Time diff: %d", quat->quat[i].timestamp_ms);
+                NRF_LOG_DEBUG("Time diff: %d", quat->quat[i].timestamp_ms);
 
             }break;
 
             case BLE_IMU_SERVICE_EVT_EULER:
             {
-                NRF_LOG_INFO("Not implemented yet");
-                
-                
+                ble_imu_service_euler_t *euler = &data_in->params.value.euler_data;
+                int32_t q16[3] = { euler->roll, euler->pitch, euler->yaw };
+
+                time = calculate_total_time(euler->timestamp_ms);
+                data_len = usr_frame_euler(data_out, sensor_nr, q16, time); //20 bytes
+
             }break;
             case BLE_IMU_SERVICE_EVT_RAW:
             {
-                ble_imu_service_raw_t *raw = &data_in->params.value.raw_data;
-
-                data_len += (3*3*sizeof(int16_t))/sizeof(uint8_t);
-                data_len += sizeof(stm32_time_t)/sizeof(uint8_t);
+                ble_imu_service_single_raw_t *single = &data_in->params.value.raw_data.single_raw[i];
+                stm32_raw_t raw = { { single->accel.x, single->accel.y, single->accel.z },
+                                    { single->gyro.x, single->gyro.y, single->gyro.z },
+                                    { single->compass.x, single->compass.y, single->compass.z } };
 
-                type_byte = RAW;
-                data_out[4] = type_byte;
-                data_out[1] = (uint8_t) data_len; //24 bytes
-
-                // Copy data to packet
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER), &raw->single_raw[i].accel.x, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + sizeof(int16_t)), &raw->single_raw[i].accel.y, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 2*sizeof(int16_t)), &raw->single_raw[i].accel.z, sizeof(int16_t));
-
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 3*sizeof(int16_t)), &raw->single_raw[i].gyro.x, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 4*sizeof(int16_t)), &raw->single_raw[i].gyro.y, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 5*sizeof(int16_t)), &raw->single_raw[i].gyro.z, sizeof(int16_t));
-
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 6*sizeof(int16_t)), &raw->single_raw[i].compass.x, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 7*sizeof(int16_t)), &raw->single_raw[i].compass.y, sizeof(int16_t));
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 8*sizeof(int16_t)), &raw->single_raw[i].compass.z, sizeof(int16_t));
-
-                // Timestamp ms
-                stm32_time_t time = calculate_total_time(raw->single_raw[i].timestamp_ms);
-                memcpy((data_out + PACKET_DATA_PLACEHOLDER + 9*sizeof(int16_t)), &time, sizeof(stm32_time_t));
-                NRF_LOG_INFO("time diff: %d", raw->single_raw[i].timestamp_ms);
-
-                // Checksum
-                uint8_t cs = calculate_cs(data_out, &data_len);
-                data_out[PACKET_DATA_PLACEHOLDER + 3*3*sizeof(int16_t) + sizeof(stm32_time_t)] = cs;
+                time = calculate_total_time(single->timestamp_ms);
+                data_len = usr_frame_raw(data_out, sensor_nr, &raw, time); //32 bytes
+                NRF_LOG_DEBUG("time diff: %d", single->timestamp_ms);
 
             }break;
 
             default:
             {
 
-                NRF_LOG_INFO("default");
-                NRF_LOG_FLUSH();
+                usr_evlog(USR_EVLOG_DATA_UNKNOWN, type, 0);
 
-            }break;
+            }continue;
         }
 
         // check for buffer overflows
         check_buffer_overflow(&data_len);
 
-        // Send over UART to STM32
-        uart_queued_tx(data_out, &data_len);
+        // Store and send over UART to STM32
+        comm_data_tx(data_out, &data_len, time, sensor_nr);
         // NRF_LOG_INFO("Data send");
 
     }
 
     }
+
+    USR_PROF_EXIT(USR_PROF_COMM_PROCESS);
 }
 
 // Error checking helper functions
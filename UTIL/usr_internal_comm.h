@@ -32,6 +32,7 @@
 
 #include "ble_imu_service_c.h"
 #include "internal_comm_protocol.h"
+#include "usr_joint.h"
 
 // #include "usr_ble.h"
 
@@ -42,11 +43,25 @@ typedef struct
 
 typedef uint64_t stm32_time_t;
 
+// EMG DATA frames: timestamp | first | count | sample_bytes
+#define EMG_HEADER_LEN                  (sizeof(stm32_time_t) + 3)
+#define EMG_FRAME_MAX_SAMPLES           ((USR_INTERNAL_COMM_MAX_LEN - 1 - OVERHEAD_BYTES - EMG_HEADER_LEN) / EMG_SAMPLE_BYTES)
+// Frames per notification, samples are spread evenly over them
+#define EMG_FRAMES                      ((BLE_IMU_SERVICE_ADC_SAMPLES + EMG_FRAME_MAX_SAMPLES - 1) / EMG_FRAME_MAX_SAMPLES)
+#define EMG_FRAME_SAMPLES               ((BLE_IMU_SERVICE_ADC_SAMPLES + EMG_FRAMES - 1) / EMG_FRAMES)
+
 // Process data received by BLE service
 void comm_process(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * data_in);
+// Notification from the BLE event handler: processed right away in the superloop build,
+// copied to the encoding task in the FreeRTOS build
+void comm_ingest(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t * data_in);
 
 // Send ACK to STM32
 void comm_send_ok(command_type_byte_t command_type);
+// Send NACK to STM32 (configuration not accepted)
+void comm_send_rejected(command_type_byte_t command_type);
+// Send ACK or NACK depending on err_code
+void comm_send_status(command_type_byte_t command_type, ret_code_t err_code);
 
 // Event hander for RX data
 void comm_rx_process(void *p_event_data, uint16_t event_size);
@@ -61,8 +76,73 @@ static void check_not_negative_uint8(uint8_t* data);
 // Time synchronization between nRF52 and STM32
 void set_stm32_real_time(stm32_time_t time, uint32_t this_offset);
 stm32_time_t get_stm32_real_time();
+uint32_t get_stm32_offset_time();
 stm32_time_t calculate_total_time(stm32_time_t local_time);
 
+// Connection plan and throughput of every connected sensor
+void uart_send_conn_params();
+
+// Negotiated MTU, data length and PHY of every connected sensor
+void uart_send_link_caps();
+
+// Reception statistics of every connected sensor
+void uart_send_link_stats();
+
+// Battery level of every connected sensor (changed_only: only levels changed since the last report)
+void uart_send_battery(bool changed_only);
+void uart_send_battery_changes();
+
+// GATT request queue depth and latency of every connected sensor
+void uart_send_gatt_stats();
+
+// Commissioning time and scan state of the device list
+void uart_send_commissioning();
+
+// Sensor that was lost is connected again
+void uart_send_rejoin(uint8_t sensor_nr, uint32_t latency_ms, bool config_pushed, uint8_t scan_level);
+
+// Relative orientation of a sensor pair
+void uart_send_joint(usr_joint_result_t const * p_result);
+
+// Backlog status and watermarks
+void uart_send_backlog();
+
+// Next part of the backlog replay, called every replay interval
+void uart_send_replay();
+
+// Next part of the flash spool, called every drain interval
+void uart_send_spool();
+
+// Flash spool statistics
+void uart_send_spool_stats();
+
+// Statistics of the simulated sensor fleet
+void uart_send_sim_stats();
+
+// Next part of the captured trace, called every drain interval
+void uart_send_trace();
+
+// Trace capture status
+void uart_send_trace_status();
+
+// Radio to UART latency histograms of one sensor (0xFF: all sensors)
+void uart_send_latency(uint8_t sensor_nr);
+
+// Handler profile and CPU load
+void uart_send_prof();
+
+// Telemetry frame and its link entries
+void uart_send_telemetry();
+
+// Event log entries logged since the previous call
+void uart_send_evlog();
+
+// Ready handshake, repeated by usr_boot until the STM32 answers
+void uart_send_ready();
+
+// Warm restart and the gap in the measurement, once after usr_ble_warm_restore
+void uart_send_warm_restart();
+
 // void uart_send_conn_dev(dcu_connected_devices_t* dev, uint32_t len);
 // void uart_send_conn_dev_update(ble_gap_addr_t* dev, uint32_t len, command_type_conn_dev_update_byte_t state);
 #endif
\ No newline at end of file
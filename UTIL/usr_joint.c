@@ -0,0 +1,288 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_joint.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Relative orientation (joint angles) between sensor pairs
+ *
+ *               Samples of both sensors are matched on their (synchronised)
+ *               timestamps. The quaternion product is done in Q30 with 64 bit
+ *               intermediates, only the angle decomposition uses the FPU.
+ *               No SDK dependencies, so the math can be checked on a host.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_joint.h"
+
+#include <string.h>
+#include <math.h>
+
+#define SIDE_A                      0
+#define SIDE_B                      1
+#define RAD_TO_CENTIDEG             (18000.0f / 3.14159265f)
+#define OUT_MASK                    (USR_JOINT_OUT_QUAT | USR_JOINT_OUT_ANGLES)
+
+// Last samples of one sensor of a pair, ring buffer
+typedef struct
+{
+    usr_joint_sample_t samples[USR_JOINT_HISTORY];
+    uint8_t head;               // Next write
+    uint8_t count;
+} history_t;
+
+typedef struct
+{
+    usr_joint_pair_t pair;
+    history_t side[2];
+    bool      emitted;          // last_ms is valid
+    uint32_t  last_ms;          // Last sample of sensor b that was handled
+} pair_state_t;
+
+static pair_state_t m_pairs[USR_JOINT_PAIRS_MAX];
+static uint8_t m_pair_count = 0;
+static usr_joint_handler_t m_handler = NULL;
+
+
+static void history_push(history_t * p_hist, usr_joint_sample_t const * p_sample)
+{
+    p_hist->samples[p_hist->head] = *p_sample;
+    p_hist->head = (p_hist->head + 1) % USR_JOINT_HISTORY;
+    if (p_hist->count < USR_JOINT_HISTORY)
+    {
+        p_hist->count++;
+    }
+}
+
+// i = 0 is the oldest sample
+static usr_joint_sample_t const * history_at(history_t const * p_hist, uint8_t i)
+{
+    return &p_hist->samples[(p_hist->head + USR_JOINT_HISTORY - p_hist->count + i) % USR_JOINT_HISTORY];
+}
+
+static int32_t time_diff(uint32_t a, uint32_t b)
+{
+    return (int32_t) (a - b);
+}
+
+static int32_t q30_round(int64_t v)
+{
+    v = (v + (1LL << 29)) >> 30;
+
+    // -INT32_MAX keeps the result negatable
+    if (v > INT32_MAX) return INT32_MAX;
+    if (v < -INT32_MAX) return -INT32_MAX;
+    return (int32_t) v;
+}
+
+void usr_joint_relative(usr_quat_q30_t const * p_a, usr_quat_q30_t const * p_b, usr_quat_q30_t * p_rel)
+{
+    // Conjugate of a, the inverse of a unit quaternion
+    int64_t aw = p_a->w, ax = -(int64_t) p_a->x, ay = -(int64_t) p_a->y, az = -(int64_t) p_a->z;
+    int64_t bw = p_b->w, bx = p_b->x, by = p_b->y, bz = p_b->z;
+
+    // Q30 x Q30 = Q60, four terms stay below 2^63
+    p_rel->w = q30_round(aw*bw - ax*bx - ay*by - az*bz);
+    p_rel->x = q30_round(aw*bx + ax*bw + ay*bz - az*by);
+    p_rel->y = q30_round(aw*by - ax*bz + ay*bw + az*bx);
+    p_rel->z = q30_round(aw*bz + ax*by - ay*bx + az*bw);
+
+    // q and -q are the same rotation, keep the one with w >= 0
+    if (p_rel->w < 0)
+    {
+        p_rel->w = -p_rel->w;
+        p_rel->x = -p_rel->x;
+        p_rel->y = -p_rel->y;
+        p_rel->z = -p_rel->z;
+    }
+}
+
+void usr_joint_angles(usr_quat_q30_t const * p_q, int16_t angles[3])
+{
+    float w = (float) p_q->w / (float) USR_JOINT_Q30_ONE;
+    float x = (float) p_q->x / (float) USR_JOINT_Q30_ONE;
+    float y = (float) p_q->y / (float) USR_JOINT_Q30_ONE;
+    float z = (float) p_q->z / (float) USR_JOINT_Q30_ONE;
+
+    float sin_roll_cos = 2.0f * (w*x + y*z);
+    float cos_roll_cos = 1.0f - 2.0f * (x*x + y*y);
+    float sin_pitch = 2.0f * (w*y - z*x);
+
+    float roll = atan2f(sin_roll_cos, cos_roll_cos);
+    // asinf loses 0.02 degrees near +-90, cos(pitch) from the roll terms does not
+    float pitch = atan2f(sin_pitch, sqrtf(sin_roll_cos*sin_roll_cos + cos_roll_cos*cos_roll_cos));
+    float yaw = atan2f(2.0f * (w*z + x*y), 1.0f - 2.0f * (y*y + z*z));
+
+    angles[0] = (int16_t) lroundf(roll * RAD_TO_CENTIDEG);
+    angles[1] = (int16_t) lroundf(pitch * RAD_TO_CENTIDEG);
+    angles[2] = (int16_t) lroundf(yaw * RAD_TO_CENTIDEG);
+}
+
+static void pair_emit(uint8_t index, usr_joint_sample_t const * p_a, usr_joint_sample_t const * p_b)
+{
+    usr_joint_result_t result;
+
+    result.pair = index;
+    result.outputs = m_pairs[index].pair.outputs;
+    result.timestamp_ms = p_b->timestamp_ms;
+
+    usr_joint_relative(&p_a->q, &p_b->q, &result.q);
+
+    if (result.outputs & USR_JOINT_OUT_ANGLES)
+    {
+        usr_joint_angles(&result.q, result.angles);
+    }
+    else
+    {
+        memset(result.angles, 0, sizeof(result.angles));
+    }
+
+    if (m_handler != NULL)
+    {
+        m_handler(&result);
+    }
+}
+
+// Match every new sample of sensor b with the closest sample of sensor a
+static void pair_process(uint8_t index)
+{
+    pair_state_t * p_state = &m_pairs[index];
+    history_t const * p_a = &p_state->side[SIDE_A];
+    history_t const * p_b = &p_state->side[SIDE_B];
+
+    if (p_a->count == 0)
+    {
+        return;
+    }
+
+    usr_joint_sample_t const * p_newest_a = history_at(p_a, p_a->count - 1);
+
+    for (uint8_t i = 0; i < p_b->count; i++)
+    {
+        usr_joint_sample_t const * p_sample_b = history_at(p_b, i);
+
+        if (p_state->emitted && (time_diff(p_sample_b->timestamp_ms, p_state->last_ms) <= 0))
+        {
+            continue;
+        }
+
+        usr_joint_sample_t const * p_best = NULL;
+        uint32_t best_skew = UINT32_MAX;
+
+        for (uint8_t k = 0; k < p_a->count; k++)
+        {
+            usr_joint_sample_t const * p_sample_a = history_at(p_a, k);
+            int32_t diff = time_diff(p_sample_a->timestamp_ms, p_sample_b->timestamp_ms);
+            uint32_t skew = (diff < 0) ? (uint32_t) -diff : (uint32_t) diff;
+
+            if (skew < best_skew)
+            {
+                best_skew = skew;
+                p_best = p_sample_a;
+            }
+        }
+
+        if (best_skew <= USR_JOINT_MAX_SKEW_MS)
+        {
+            pair_emit(index, p_best, p_sample_b);
+        }
+        else if (time_diff(p_newest_a->timestamp_ms, p_sample_b->timestamp_ms) <= USR_JOINT_MAX_SKEW_MS)
+        {
+            // Sensor a is behind, a match can still arrive
+            break;
+        }
+
+        p_state->emitted = true;
+        p_state->last_ms = p_sample_b->timestamp_ms;
+    }
+}
+
+void usr_joint_init(usr_joint_handler_t handler)
+{
+    m_handler = handler;
+    m_pair_count = 0;
+    memset(m_pairs, 0, sizeof(m_pairs));
+}
+
+bool usr_joint_pairs_set(usr_joint_pair_t const * p_pairs, uint8_t count, uint8_t slot_count)
+{
+    if (count > USR_JOINT_PAIRS_MAX)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if ((p_pairs[i].slot_a >= slot_count) || (p_pairs[i].slot_b >= slot_count) ||
+            (p_pairs[i].slot_a == p_pairs[i].slot_b) ||
+            (p_pairs[i].outputs == 0) || (p_pairs[i].outputs & ~OUT_MASK))
+        {
+            return false;
+        }
+    }
+
+    memset(m_pairs, 0, sizeof(m_pairs));
+    for (uint8_t i = 0; i < count; i++)
+    {
+        m_pairs[i].pair = p_pairs[i];
+    }
+    m_pair_count = count;
+
+    return true;
+}
+
+void usr_joint_on_quat(uint8_t slot, usr_joint_sample_t const * p_samples, uint8_t count)
+{
+    for (uint8_t i = 0; i < m_pair_count; i++)
+    {
+        pair_state_t * p_state = &m_pairs[i];
+        uint8_t side;
+
+        if (p_state->pair.slot_a == slot)
+        {
+            side = SIDE_A;
+        }
+        else if (p_state->pair.slot_b == slot)
+        {
+            side = SIDE_B;
+        }
+        else
+        {
+            continue;
+        }
+
+        for (uint8_t k = 0; k < count; k++)
+        {
+            history_push(&p_state->side[side], &p_samples[k]);
+        }
+
+        pair_process(i);
+    }
+}
+
+void usr_joint_forget(uint8_t slot)
+{
+    for (uint8_t i = 0; i < m_pair_count; i++)
+    {
+        pair_state_t * p_state = &m_pairs[i];
+
+        if ((p_state->pair.slot_a == slot) || (p_state->pair.slot_b == slot))
+        {
+            memset(p_state->side, 0, sizeof(p_state->side));
+            p_state->emitted = false;
+        }
+    }
+}
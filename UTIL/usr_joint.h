@@ -0,0 +1,95 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_joint.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Relative orientation (joint angles) between sensor pairs
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_JOINT_H_
+#define _USR_JOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define USR_JOINT_PAIRS_MAX         4
+// Quaternion samples kept per sensor of a pair, at least two notifications
+#define USR_JOINT_HISTORY           10
+// Samples of both sensors further apart than this are not combined
+#define USR_JOINT_MAX_SKEW_MS       5
+
+// Quaternions are Q30 fixed point, as sent by the sensors
+#define USR_JOINT_Q30_ONE           (1L << 30)
+
+// Outputs of a pair
+#define USR_JOINT_OUT_QUAT          (1 << 0)    // Relative quaternion
+#define USR_JOINT_OUT_ANGLES        (1 << 1)    // Roll, pitch, yaw of the relative quaternion
+
+// Sensor b relative to sensor a (e.g. a = thigh, b = shank), by sensor index (device list position)
+typedef struct
+{
+    uint8_t slot_a;
+    uint8_t slot_b;
+    uint8_t outputs;                // USR_JOINT_OUT_*
+} usr_joint_pair_t;
+
+typedef struct
+{
+    int32_t w;
+    int32_t x;
+    int32_t y;
+    int32_t z;
+} usr_quat_q30_t;
+
+typedef struct
+{
+    usr_quat_q30_t q;
+    uint32_t timestamp_ms;
+} usr_joint_sample_t;
+
+typedef struct
+{
+    uint8_t        pair;            // Index in the configured pairs
+    uint8_t        outputs;         // USR_JOINT_OUT_*
+    usr_quat_q30_t q;               // q_a^-1 * q_b
+    int16_t        angles[3];       // Roll, pitch, yaw (0.01 degrees)
+    uint32_t       timestamp_ms;    // Timestamp of the sample of sensor b
+} usr_joint_result_t;
+
+// Called for every time-aligned pair of samples
+typedef void (*usr_joint_handler_t)(usr_joint_result_t const * p_result);
+
+void usr_joint_init(usr_joint_handler_t handler);
+
+// Replace the configured pairs, count 0 disables the computation.
+// False when a pair is invalid, the previous pairs are kept then.
+bool usr_joint_pairs_set(usr_joint_pair_t const * p_pairs, uint8_t count, uint8_t slot_count);
+
+// Quaternion samples of a sensor, oldest first
+void usr_joint_on_quat(uint8_t slot, usr_joint_sample_t const * p_samples, uint8_t count);
+
+// Drop the samples of a sensor (disconnected, its clock restarts)
+void usr_joint_forget(uint8_t slot);
+
+// q_a^-1 * q_b for unit quaternions, with w >= 0
+void usr_joint_relative(usr_quat_q30_t const * p_a, usr_quat_q30_t const * p_b, usr_quat_q30_t * p_rel);
+
+// Roll, pitch, yaw (Z-Y-X) of a unit quaternion in 0.01 degrees
+void usr_joint_angles(usr_quat_q30_t const * p_q, int16_t angles[3]);
+
+#endif
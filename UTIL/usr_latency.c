@@ -0,0 +1,279 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_latency.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Latency of the data frames from the radio to the UART
+ *
+ *               Every DATA frame put in the UART FIFO is followed by its end
+ *               position in the TX byte stream. The DMA transfer holding that
+ *               position and its TX_DONE close the frame. The processing stage
+ *               is timed with the DWT cycle counter (64 MHz), the later stages
+ *               with the app_timer RTC: the cycle counter stops while the CPU
+ *               sleeps, waiting for the UART. Both can be read in every interrupt
+ *               level, where the TimeSync timer capture is not reentrant.
+ *               Commands are timed from their first byte (UART interrupt) to
+ *               the end of comm_rx_process, to compare the superloop and the
+ *               FreeRTOS build.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_latency.h"
+
+#include <string.h>
+
+#include "nrf.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+#include "internal_comm_protocol.h"
+#include "usr_prof.h"
+
+#define CYCLES_PER_US               (SystemCoreClock / 1000000)
+#define INFLIGHT_MASK               (USR_LATENCY_INFLIGHT - 1)
+#define TICKS_TO_US(ticks)          ((uint32_t) (((uint64_t) (ticks) * 1000000) / APP_TIMER_TICKS(1000)))
+
+typedef struct
+{
+    uint32_t end_pos;               // Stream position after the last byte
+    uint32_t process_us;            // Notification to UART FIFO
+    uint32_t t_queued;              // RTC ticks
+    uint32_t t_dma;
+    uint8_t  sensor_nr;
+} frame_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t max_us;
+    uint32_t bins[USR_LATENCY_BINS];
+} stage_stats_t;
+
+static frame_t  m_frames[USR_LATENCY_INFLIGHT];
+static uint32_t m_head = 0;         // Next frame to add
+static uint32_t m_dma = 0;          // Oldest frame without DMA start
+static uint32_t m_tail = 0;         // Oldest frame not transmitted
+
+static uint32_t m_queued_pos = 0;   // Bytes put in the TX FIFO
+static uint32_t m_dma_pos = 0;      // Bytes handed to the DMA
+static uint32_t m_done_pos = 0;     // Bytes transmitted
+
+static bool     m_ingest_active = false;
+static uint32_t m_ingest_time;
+static uint32_t m_untracked = 0;
+
+static bool     m_rx_pending = false;
+static uint32_t m_rx_time;
+static bool     m_cmd_active = false;
+static uint32_t m_cmd_time;
+
+static stage_stats_t m_stats[USR_LATENCY_SENSORS][USR_LATENCY_COMMAND];
+static stage_stats_t m_cmd_stats;
+
+
+static uint32_t ticks_since(uint32_t t_start, uint32_t t_end)
+{
+    return TICKS_TO_US(app_timer_cnt_diff_compute(t_end, t_start));
+}
+
+// a is at or before b in the byte stream
+static bool pos_reached(uint32_t a, uint32_t b)
+{
+    return (int32_t) (a - b) <= 0;
+}
+
+static void stage_add(stage_stats_t * p_stage, uint32_t us)
+{
+    uint8_t bin = 0;
+
+    while ((bin < USR_LATENCY_BINS - 1) && ((us >> (bin + 1)) != 0))
+    {
+        bin++;
+    }
+
+    p_stage->count++;
+    p_stage->sum_us += us;
+    p_stage->max_us = MAX(p_stage->max_us, us);
+    p_stage->bins[bin]++;
+}
+
+static void frame_done(frame_t const * p_frame, uint32_t t_done)
+{
+    stage_stats_t * p_stats = m_stats[p_frame->sensor_nr];
+
+    stage_add(&p_stats[USR_LATENCY_PROCESS], p_frame->process_us);
+    stage_add(&p_stats[USR_LATENCY_QUEUE], ticks_since(p_frame->t_queued, p_frame->t_dma));
+    stage_add(&p_stats[USR_LATENCY_TX], ticks_since(p_frame->t_dma, t_done));
+    stage_add(&p_stats[USR_LATENCY_TOTAL], p_frame->process_us + ticks_since(p_frame->t_queued, t_done));
+}
+
+void usr_latency_ingest_begin(void)
+{
+    m_ingest_time = usr_prof_cycles();
+    m_ingest_active = true;
+}
+
+void usr_latency_ingest_end(void)
+{
+    m_ingest_active = false;
+}
+
+void usr_latency_on_rx(void)
+{
+    // The first bytes of a command start it
+    if (!m_rx_pending)
+    {
+        m_rx_time = app_timer_cnt_get();
+        m_rx_pending = true;
+    }
+}
+
+void usr_latency_cmd_begin(void)
+{
+    CRITICAL_REGION_ENTER();
+
+    // Bytes received from here on belong to the next command
+    m_cmd_active = m_rx_pending;
+    m_cmd_time = m_rx_time;
+    m_rx_pending = false;
+
+    CRITICAL_REGION_EXIT();
+}
+
+void usr_latency_cmd_end(void)
+{
+    if (!m_cmd_active)
+    {
+        return;
+    }
+
+    uint32_t us = ticks_since(m_cmd_time, app_timer_cnt_get());
+
+    CRITICAL_REGION_ENTER();
+    stage_add(&m_cmd_stats, us);
+    m_cmd_active = false;
+    CRITICAL_REGION_EXIT();
+}
+
+// Called with the UART FIFO write, in its critical region
+void usr_latency_on_queued(uint8_t const * p_data, uint32_t len)
+{
+    m_queued_pos += len;
+
+    // Joint data carries a pair index instead of a sensor_nr
+    if ((len <= PACKET_DATA_PLACEHOLDER) || (p_data[0] != START_BYTE) || (p_data[2] != DATA) ||
+        (p_data[3] >= USR_LATENCY_SENSORS) || (p_data[4] == JOINT_QUAT) || (p_data[4] == JOINT_ANGLES))
+    {
+        return;
+    }
+
+    if (m_head - m_tail == USR_LATENCY_INFLIGHT)
+    {
+        m_untracked++;
+        return;
+    }
+
+    frame_t * p_frame = &m_frames[m_head & INFLIGHT_MASK];
+    p_frame->end_pos = m_queued_pos;
+    p_frame->t_queued = app_timer_cnt_get();
+    // Frames not built from a notification (simulation, trace injection) start in the FIFO
+    p_frame->process_us = m_ingest_active ? (usr_prof_cycles() - m_ingest_time) / CYCLES_PER_US : 0;
+    p_frame->sensor_nr = p_data[3];
+    m_head++;
+}
+
+void usr_latency_on_dma(uint32_t len)
+{
+    uint32_t t = app_timer_cnt_get();
+
+    CRITICAL_REGION_ENTER();
+
+    m_dma_pos += len;
+    while ((m_dma != m_head) && pos_reached(m_frames[m_dma & INFLIGHT_MASK].end_pos, m_dma_pos))
+    {
+        m_frames[m_dma & INFLIGHT_MASK].t_dma = t;
+        m_dma++;
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+void usr_latency_on_tx_done(uint32_t len)
+{
+    uint32_t t = app_timer_cnt_get();
+
+    CRITICAL_REGION_ENTER();
+
+    m_done_pos += len;
+    while ((m_tail != m_dma) && pos_reached(m_frames[m_tail & INFLIGHT_MASK].end_pos, m_done_pos))
+    {
+        frame_done(&m_frames[m_tail & INFLIGHT_MASK], t);
+        m_tail++;
+    }
+
+    CRITICAL_REGION_EXIT();
+}
+
+ret_code_t usr_latency_hist_get(uint8_t sensor_nr, usr_latency_stage_t stage, usr_latency_hist_t * p_hist)
+{
+    if (((sensor_nr >= USR_LATENCY_SENSORS) && (sensor_nr != USR_LATENCY_ALL)) || (stage >= USR_LATENCY_STAGES))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t first = (sensor_nr == USR_LATENCY_ALL) ? 0 : sensor_nr;
+    uint8_t last = ((sensor_nr == USR_LATENCY_ALL) && (stage != USR_LATENCY_COMMAND)) ? USR_LATENCY_SENSORS - 1 : first;
+    uint64_t sum_us = 0;
+
+    memset(p_hist, 0, sizeof(usr_latency_hist_t));
+
+    CRITICAL_REGION_ENTER();
+
+    for (uint8_t i = first; i <= last; i++)
+    {
+        stage_stats_t const * p_stage = (stage == USR_LATENCY_COMMAND) ? &m_cmd_stats : &m_stats[i][stage];
+
+        p_hist->count += p_stage->count;
+        p_hist->max_us = MAX(p_hist->max_us, p_stage->max_us);
+        sum_us += p_stage->sum_us;
+        for (uint8_t bin = 0; bin < USR_LATENCY_BINS; bin++)
+        {
+            p_hist->bins[bin] += p_stage->bins[bin];
+        }
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    p_hist->avg_us = (p_hist->count > 0) ? (uint32_t) (sum_us / p_hist->count) : 0;
+
+    return NRF_SUCCESS;
+}
+
+uint32_t usr_latency_untracked_get(void)
+{
+    return m_untracked;
+}
+
+void usr_latency_reset(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(m_stats, 0, sizeof(m_stats));
+    memset(&m_cmd_stats, 0, sizeof(m_cmd_stats));
+    m_untracked = 0;
+    CRITICAL_REGION_EXIT();
+}
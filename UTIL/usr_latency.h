@@ -0,0 +1,83 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_latency.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Latency of the data frames from the radio to the UART
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_LATENCY_H_
+#define _USR_LATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_sdh_ble.h"
+
+// Statistics are kept per sensor_nr below this
+#define USR_LATENCY_SENSORS         NRF_SDH_BLE_TOTAL_LINK_COUNT
+// DATA frames followed between the UART FIFO and TX_DONE (power of two)
+#define USR_LATENCY_INFLIGHT        64
+// Histogram bin i counts latencies of 2^i .. 2^(i+1) - 1 us (bin 0 from 0 us), the last bin is open
+#define USR_LATENCY_BINS            16
+
+typedef enum
+{
+    USR_LATENCY_PROCESS = 0,        // Notification received (on_hvx) to frame in the UART FIFO
+    // Stages below in app_timer ticks (61 us at 16384 Hz)
+    USR_LATENCY_QUEUE,              // UART FIFO to the DMA transfer with the last byte of the frame
+    USR_LATENCY_TX,                 // DMA start to TX_DONE
+    USR_LATENCY_TOTAL,              // Notification received to TX_DONE
+    USR_LATENCY_COMMAND,            // UART RX to the command handled, not per sensor
+    USR_LATENCY_STAGES
+} usr_latency_stage_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t bins[USR_LATENCY_BINS];
+} usr_latency_hist_t;
+
+// Notification processing in the BLE event interrupt, frames queued in between belong to it
+void usr_latency_ingest_begin(void);
+void usr_latency_ingest_end(void);
+
+// Command handling: bytes received (UART interrupt), comm_rx_process start and end
+void usr_latency_on_rx(void);
+void usr_latency_cmd_begin(void);
+void usr_latency_cmd_end(void);
+
+// UART hooks: bytes put in the TX FIFO (a frame), handed to the DMA and transmitted
+void usr_latency_on_queued(uint8_t const * p_data, uint32_t len);
+void usr_latency_on_dma(uint32_t len);
+void usr_latency_on_tx_done(uint32_t len);
+
+// Histogram of one stage, of one sensor or of all sensors (sensor_nr USR_LATENCY_ALL).
+// The command stage is the same for every sensor_nr.
+#define USR_LATENCY_ALL             0xFF
+ret_code_t usr_latency_hist_get(uint8_t sensor_nr, usr_latency_stage_t stage, usr_latency_hist_t * p_hist);
+
+// Frames that were not followed, too many in flight
+uint32_t usr_latency_untracked_get(void);
+
+void usr_latency_reset(void);
+
+#endif
@@ -80,12 +80,11 @@ static void indication_led_timer_handler(void * p_context)
         nrf_gpio_pin_clear(dcu_led_list[usr_leds_ctr]);
     }
 
+    usr_leds_ctr++;
     if(usr_leds_ctr == USR_NR_OF_LEDS)
     {
         usr_leds_ctr = 0;
         leds_on_off = !leds_on_off;
-    }else{
-       usr_leds_ctr++; 
     }
 
 }
@@ -108,7 +107,7 @@ void create_timers()
 void dcu_leds_reset()
 {
 
-    for(uint8_t i = 0; i<=USR_NR_OF_LEDS; i++)
+    for(uint8_t i = 0; i<USR_NR_OF_LEDS; i++)
     {
         nrf_gpio_pin_clear(dcu_led_list[i]);
     }
@@ -143,7 +142,8 @@ void DCU_set_connection_leds(dcu_connected_devices_t evt[], uint8_t state)
         }
     }
 
-    for(uint16_t i=0; i<NRF_SDH_BLE_CENTRAL_LINK_COUNT; i++)
+    // One LED per sensor, sensors beyond the LED count have none
+    for(uint16_t i=0; i<MIN(NRF_SDH_BLE_CENTRAL_LINK_COUNT, USR_NR_OF_LEDS); i++)
     {
         if(evt[i].conn_handle != BLE_CONN_HANDLE_INVALID)
         {
@@ -0,0 +1,200 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_prof.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Cycle counter profiler of the event handlers and CPU load
+ *
+ *               Handlers are timed with the DWT cycle counter. Handlers nest
+ *               (interrupts, scheduler events), only the outermost one counts
+ *               as busy time. The window and the sleep are timed with the
+ *               app_timer RTC, the cycle counter stops while the CPU sleeps.
+ *               Interrupts that wake the CPU run before the sleep call returns,
+ *               their cycles are taken off the idle time.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_prof.h"
+
+#include <string.h>
+
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+
+#define CYCLES_PER_US               (SystemCoreClock / 1000000)
+#define TICKS_TO_US(ticks)          ((((uint64_t) (ticks)) * 1000000) / APP_TIMER_TICKS(1000))
+
+// Wall clock in app_timer ticks. In the FreeRTOS build the idle hooks run before the tick
+// count is corrected for the sleep, the RTC1 counter under it (1024 Hz) keeps running.
+#if (USR_FREERTOS == 1)
+#define WALL_NOW()                  (NRF_RTC1->COUNTER)
+#define WALL_DIFF(to, from)         (((to) - (from)) & RTC_COUNTER_COUNTER_Msk)
+#else
+#define WALL_NOW()                  app_timer_cnt_get()
+#define WALL_DIFF(to, from)         app_timer_cnt_diff_compute((to), (from))
+#endif
+
+typedef struct
+{
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+} handler_stats_t;
+
+static handler_stats_t m_stats[USR_PROF_HANDLERS];
+
+static volatile uint8_t m_depth = 0;    // Profiled handlers running, nested
+static uint64_t m_busy_cycles = 0;      // Outermost handlers
+static uint64_t m_idle_busy_cycles = 0; // Outermost handlers that ran during the sleep
+
+static bool     m_idle = false;
+static uint32_t m_idle_start;
+static uint32_t m_window_last;          // RTC, 24 bit: the window is accumulated every main loop pass
+static uint64_t m_window_ticks = 0;
+static uint64_t m_sleep_ticks = 0;
+
+
+static void stats_clear(void)
+{
+    memset(m_stats, 0, sizeof(m_stats));
+    for (uint8_t i = 0; i < USR_PROF_HANDLERS; i++)
+    {
+        m_stats[i].min_cycles = UINT32_MAX;
+    }
+
+    m_busy_cycles = 0;
+    m_idle_busy_cycles = 0;
+    m_window_ticks = 0;
+    m_sleep_ticks = 0;
+    m_window_last = WALL_NOW();
+}
+
+void usr_prof_init(void)
+{
+    // Not cleared, usr_warm times the boot with it
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    stats_clear();
+}
+
+uint32_t usr_prof_enter(void)
+{
+    // Nesting is strictly LIFO, an interrupt restores the depth before it returns
+    m_depth++;
+
+    return usr_prof_cycles();
+}
+
+void usr_prof_exit(usr_prof_handler_t handler, uint32_t start)
+{
+    uint32_t cycles = usr_prof_cycles() - start;
+    handler_stats_t * p_stats = &m_stats[handler];
+
+    CRITICAL_REGION_ENTER();
+
+    p_stats->calls++;
+    p_stats->sum_cycles += cycles;
+    p_stats->min_cycles = MIN(p_stats->min_cycles, cycles);
+    p_stats->max_cycles = MAX(p_stats->max_cycles, cycles);
+
+    if (m_depth == 1)
+    {
+        m_busy_cycles += cycles;
+        if (m_idle)
+        {
+            m_idle_busy_cycles += cycles;
+        }
+    }
+
+    m_depth--;
+
+    CRITICAL_REGION_EXIT();
+}
+
+void usr_prof_idle_enter(void)
+{
+    m_idle_start = WALL_NOW();
+    m_idle = true;
+}
+
+void usr_prof_idle_exit(void)
+{
+    uint32_t now = WALL_NOW();
+
+    CRITICAL_REGION_ENTER();
+
+    m_idle = false;
+    m_sleep_ticks += WALL_DIFF(now, m_idle_start);
+    m_window_ticks += WALL_DIFF(now, m_window_last);
+    m_window_last = now;
+
+    CRITICAL_REGION_EXIT();
+}
+
+ret_code_t usr_prof_stats_get(usr_prof_handler_t handler, usr_prof_stats_t * p_stats)
+{
+    if (handler >= USR_PROF_HANDLERS)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    handler_stats_t stats;
+
+    CRITICAL_REGION_ENTER();
+    stats = m_stats[handler];
+    CRITICAL_REGION_EXIT();
+
+    p_stats->calls = stats.calls;
+    p_stats->min_cycles = (stats.calls > 0) ? stats.min_cycles : 0;
+    p_stats->avg_cycles = (stats.calls > 0) ? (uint32_t) (stats.sum_cycles / stats.calls) : 0;
+    p_stats->max_cycles = stats.max_cycles;
+
+    return NRF_SUCCESS;
+}
+
+void usr_prof_cpu_get(usr_prof_cpu_t * p_cpu)
+{
+    uint64_t window_us;
+    uint64_t busy_us;
+    uint64_t sleep_us;
+    uint64_t idle_busy_us;
+
+    CRITICAL_REGION_ENTER();
+
+    window_us = TICKS_TO_US(m_window_ticks + WALL_DIFF(WALL_NOW(), m_window_last));
+    busy_us = m_busy_cycles / CYCLES_PER_US;
+    sleep_us = TICKS_TO_US(m_sleep_ticks);
+    idle_busy_us = m_idle_busy_cycles / CYCLES_PER_US;
+
+    CRITICAL_REGION_EXIT();
+
+    uint64_t idle_us = (sleep_us > idle_busy_us) ? sleep_us - idle_busy_us : 0;
+
+    p_cpu->window_ms = (uint32_t) (window_us / 1000);
+    p_cpu->busy_permille = (window_us > 0) ? (uint16_t) MIN(1000, busy_us * 1000 / window_us) : 0;
+    p_cpu->idle_permille = (window_us > 0) ? (uint16_t) MIN(1000, idle_us * 1000 / window_us) : 0;
+}
+
+void usr_prof_reset(void)
+{
+    CRITICAL_REGION_ENTER();
+    stats_clear();
+    CRITICAL_REGION_EXIT();
+}
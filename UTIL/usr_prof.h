@@ -0,0 +1,99 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_prof.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Cycle counter profiler of the event handlers and CPU load
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_PROF_H_
+#define _USR_PROF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+#include "nrf.h"
+
+typedef enum
+{
+    USR_PROF_BLE_EVT = 0,           // ble_evt_handler
+    USR_PROF_IMU_EVT,               // imu_service_c_evt_handler
+    USR_PROF_COMM_PROCESS,          // comm_process
+    USR_PROF_UART_EVT,              // uart_event_handler
+    USR_PROF_COMM_RX,               // comm_rx_process
+    USR_PROF_TS_EGU,                // TimeSync SWI3_EGU3_IRQHandler
+    USR_PROF_TS_RADIO,              // TimeSync RADIO_IRQHandler (timeslot)
+    USR_PROF_SCHED,                 // usr_evq_execute (app_sched_execute under FreeRTOS), one pass
+    USR_PROF_HANDLERS
+} usr_prof_handler_t;
+
+// Cycles (64 MHz) spent in one handler, nested handlers included
+typedef struct
+{
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t avg_cycles;
+    uint32_t max_cycles;
+} usr_prof_stats_t;
+
+// Share of the window spent in the profiled handlers and asleep, in 0.1 %.
+// The rest is SoftDevice, logging and the main loop itself.
+typedef struct
+{
+    uint32_t window_ms;
+    uint16_t busy_permille;
+    uint16_t idle_permille;
+} usr_prof_cpu_t;
+
+// The cycle counter stops while the CPU sleeps, only use it for spans without sleep
+static inline uint32_t usr_prof_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+// Enable the cycle counter and start the window, call after timer_init
+void usr_prof_init(void);
+
+uint32_t usr_prof_enter(void);
+void usr_prof_exit(usr_prof_handler_t handler, uint32_t start);
+
+// Around the sleep of the main loop
+void usr_prof_idle_enter(void);
+void usr_prof_idle_exit(void);
+
+ret_code_t usr_prof_stats_get(usr_prof_handler_t handler, usr_prof_stats_t * p_stats);
+void usr_prof_cpu_get(usr_prof_cpu_t * p_cpu);
+
+// Clear the statistics and restart the window
+void usr_prof_reset(void);
+
+#if (USR_PROF == 1)
+#define USR_PROF_ENTER()            uint32_t usr_prof_start = usr_prof_enter()
+#define USR_PROF_EXIT(handler)      usr_prof_exit((handler), usr_prof_start)
+#define USR_PROF_IDLE_ENTER()       usr_prof_idle_enter()
+#define USR_PROF_IDLE_EXIT()        usr_prof_idle_exit()
+#else
+#define USR_PROF_ENTER()
+#define USR_PROF_EXIT(handler)
+#define USR_PROF_IDLE_ENTER()
+#define USR_PROF_IDLE_EXIT()
+#endif
+
+#endif
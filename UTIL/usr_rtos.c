@@ -0,0 +1,232 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_rtos.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: FreeRTOS build, one task per stage of the data path
+ *
+ *               BLE ingest (SoftDevice task) -> message buffer -> encoding
+ *               task -> UART TX stream buffer -> egress task -> DMA.
+ *               UART RX stream buffer -> command task. Timers and reports
+ *               go through app_scheduler in the housekeeping task.
+ *               The idle task sleeps tickless (RTC1). Profiled handlers do
+ *               not block, so their spans still nest.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_rtos.h"
+
+#include "app_util_platform.h"
+#include "nordic_common.h"
+
+#if (USR_FREERTOS == 1)
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+#include "nrf_sdh_freertos.h"
+
+#include "usr_uart.h"
+#include "usr_internal_comm.h"
+#include "usr_latency.h"
+#include "usr_prof.h"
+#include "usr_evlog.h"
+
+#define NRF_LOG_MODULE_NAME usr_rtos_c
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+NRF_LOG_MODULE_REGISTER();
+
+// Stacks in words, comm_rx_process and the reports keep a frame or two on the stack
+#define STACK_EGRESS                128
+#define STACK_COMMAND               768
+#define STACK_ENCODE                512
+#define STACK_HOUSEKEEPING          768
+
+typedef struct
+{
+    ble_imu_service_c_evt_type_t type;
+    ble_imu_service_c_evt_t      evt;
+} encode_msg_t;
+
+// Every message carries its length (size_t)
+#define ENCODE_BUFFER_SIZE          (USR_RTOS_ENCODE_DEPTH * (sizeof(encode_msg_t) + sizeof(size_t)))
+
+static StackType_t  m_stack_egress[STACK_EGRESS];
+static StackType_t  m_stack_command[STACK_COMMAND];
+static StackType_t  m_stack_encode[STACK_ENCODE];
+static StackType_t  m_stack_housekeeping[STACK_HOUSEKEEPING];
+static StaticTask_t m_tcb[USR_RTOS_TASKS];
+static TaskHandle_t m_task[USR_RTOS_TASKS];
+
+static uint8_t m_encode_storage[ENCODE_BUFFER_SIZE + 1];
+static StaticMessageBuffer_t m_encode_buffer_struct;
+static MessageBufferHandle_t m_encode_buffer;
+
+// Idle and timer task, configSUPPORT_STATIC_ALLOCATION
+static StackType_t  m_stack_idle[configMINIMAL_STACK_SIZE];
+static StaticTask_t m_tcb_idle;
+static StackType_t  m_stack_timer[configTIMER_TASK_STACK_DEPTH];
+static StaticTask_t m_tcb_timer;
+
+
+static void egress_task(void * p_context)
+{
+    for (;;)
+    {
+        uart_tx_run();
+    }
+}
+
+static void command_task(void * p_context)
+{
+    for (;;)
+    {
+        // Every RX_DATA event notifies, all bytes received so far are handled in one go
+        if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 0)
+        {
+            uart_rx_dispatch();
+        }
+    }
+}
+
+static void encode_task(void * p_context)
+{
+    encode_msg_t msg;
+
+    for (;;)
+    {
+        if (xMessageBufferReceive(m_encode_buffer, &msg, sizeof(msg), portMAX_DELAY) == sizeof(msg))
+        {
+            // Process stage: from here to the UART stream buffer
+            usr_latency_ingest_begin();
+            comm_process(msg.type, &msg.evt);
+            usr_latency_ingest_end();
+        }
+    }
+}
+
+static void housekeeping_task(void * p_context)
+{
+    for (;;)
+    {
+        USR_PROF_ENTER();
+        app_sched_execute();
+        USR_PROF_EXIT(USR_PROF_SCHED);
+
+        usr_evlog_process();
+        while (NRF_LOG_PROCESS());
+
+        // Scheduler events notify, deferred logs do not
+        (void) ulTaskNotifyTake(pdTRUE, NRF_LOG_ENABLED ? pdMS_TO_TICKS(USR_RTOS_LOG_MS) : portMAX_DELAY);
+    }
+}
+
+static void task_create(usr_rtos_task_t task, TaskFunction_t function, char const * p_name,
+                        StackType_t * p_stack, uint32_t stack_size, UBaseType_t priority)
+{
+    m_task[task] = xTaskCreateStatic(function, p_name, stack_size, NULL, priority, p_stack, &m_tcb[task]);
+    if (m_task[task] == NULL)
+    {
+        APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+}
+
+static void softdevice_task_hook(void * p_context)
+{
+    // Runs in the SoftDevice task when it starts, the SDK creates it at priority 2
+    vTaskPrioritySet(NULL, USR_RTOS_PRIO_BLE);
+}
+
+void usr_rtos_init(void)
+{
+    m_encode_buffer = xMessageBufferCreateStatic(ENCODE_BUFFER_SIZE, m_encode_storage, &m_encode_buffer_struct);
+    if (m_encode_buffer == NULL)
+    {
+        APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+
+    task_create(USR_RTOS_TASK_EGRESS, egress_task, "UTX", m_stack_egress, STACK_EGRESS, USR_RTOS_PRIO_EGRESS);
+    task_create(USR_RTOS_TASK_COMMAND, command_task, "CMD", m_stack_command, STACK_COMMAND, USR_RTOS_PRIO_COMMAND);
+    task_create(USR_RTOS_TASK_ENCODE, encode_task, "ENC", m_stack_encode, STACK_ENCODE, USR_RTOS_PRIO_ENCODE);
+    task_create(USR_RTOS_TASK_HOUSEKEEPING, housekeeping_task, "HK", m_stack_housekeeping, STACK_HOUSEKEEPING,
+                USR_RTOS_PRIO_HOUSEKEEPING);
+}
+
+void usr_rtos_start(void)
+{
+    nrf_sdh_freertos_init(softdevice_task_hook, NULL);
+
+    NRF_LOG_INFO("FreeRTOS scheduler started");
+    NRF_LOG_FLUSH();
+
+    vTaskStartScheduler();
+
+    // Only returns when the idle or timer task could not be created
+    APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+}
+
+void usr_rtos_notify(usr_rtos_task_t task)
+{
+    if (m_task[task] == NULL)
+    {
+        return;
+    }
+
+    if (__get_IPSR() != 0)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(m_task[task], &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        (void) xTaskNotifyGive(m_task[task]);
+    }
+}
+
+bool usr_rtos_encode_put(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t const * p_evt)
+{
+    encode_msg_t msg;
+    size_t sent;
+
+    msg.type = type;
+    msg.evt = *p_evt;
+
+    // The SoftDevice task, trace injection and the simulation write, one at a time
+    vTaskSuspendAll();
+    sent = xMessageBufferSend(m_encode_buffer, &msg, sizeof(msg), 0);
+    (void) xTaskResumeAll();
+
+    return sent == sizeof(msg);
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t ** pp_tcb, StackType_t ** pp_stack, uint32_t * p_stack_size)
+{
+    *pp_tcb = &m_tcb_idle;
+    *pp_stack = m_stack_idle;
+    *p_stack_size = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t ** pp_tcb, StackType_t ** pp_stack, uint32_t * p_stack_size)
+{
+    *pp_tcb = &m_tcb_timer;
+    *pp_stack = m_stack_timer;
+    *p_stack_size = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif
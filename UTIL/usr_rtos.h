@@ -0,0 +1,75 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_rtos.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: FreeRTOS build, one task per stage of the data path
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_RTOS_H_
+#define _USR_RTOS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+#include "app_scheduler.h"
+#include "ble_imu_service_c.h"
+
+// Priorities (configMAX_PRIORITIES 6), higher runs first. The BLE ingest is the SoftDevice
+// task of the SDK, raised when it starts. Commands run above the encoding: a burst of
+// notifications does not delay them. The timer task (app_timer) runs at 2.
+#define USR_RTOS_PRIO_EGRESS        5
+#define USR_RTOS_PRIO_BLE           4
+#define USR_RTOS_PRIO_COMMAND       3
+#define USR_RTOS_PRIO_ENCODE        2
+#define USR_RTOS_PRIO_HOUSEKEEPING  1
+
+// Notifications waiting for the encoding task
+#define USR_RTOS_ENCODE_DEPTH       16
+// Deferred logs are processed at least this often (DEBUG builds)
+#define USR_RTOS_LOG_MS             100
+
+typedef enum
+{
+    USR_RTOS_TASK_EGRESS = 0,       // UART TX stream buffer to the DMA
+    USR_RTOS_TASK_COMMAND,          // UART RX stream buffer to comm_rx_process
+    USR_RTOS_TASK_ENCODE,           // Notifications (message buffer) to DATA frames
+    USR_RTOS_TASK_HOUSEKEEPING,     // app_scheduler events (timers, reports) and logging
+    USR_RTOS_TASKS
+} usr_rtos_task_t;
+
+#if (USR_FREERTOS == 1)
+
+// Create the tasks and the encoding buffer, they run once usr_rtos_start is called.
+// Call before the UART and BLE are enabled.
+void usr_rtos_init(void);
+
+// Start the SoftDevice task and the scheduler, does not return
+void usr_rtos_start(void);
+
+// Wake a task, from a task or an interrupt
+void usr_rtos_notify(usr_rtos_task_t task);
+
+// Copy a notification to the encoding task, false when it is full
+bool usr_rtos_encode_put(ble_imu_service_c_evt_type_t type, ble_imu_service_c_evt_t const * p_evt);
+
+#endif
+
+#endif
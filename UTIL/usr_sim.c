@@ -0,0 +1,321 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_sim.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Simulated sensor fleet for load tests of the data path
+ *
+ *               Notifications of up to USR_SIM_SENSORS_MAX sensors are fed to
+ *               imu_service_c_evt_handler, as if they arrived over BLE, so
+ *               everything behind the IMU service client (joint angles,
+ *               framing, backlog, spool, UART) runs as in a measurement.
+ *               The notifications are generated from the app_timer interrupt,
+ *               the real ones arrive from the SoftDevice event interrupt.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_sim.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ble_conn_state.h"
+#include "nrf.h"
+#include "usr_ble.h"
+#include "usr_uart.h"
+#include "usr_prof.h"
+#include "internal_comm_protocol.h"
+
+#define NRF_LOG_MODULE_NAME usr_sim_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#if (USR_SIM == 1)
+
+typedef struct
+{
+    uint64_t base_us;           // Nominal time of the next notification
+    uint32_t due_ms;            // Including the jitter
+    uint32_t sample_nr;
+} sim_sensor_t;
+
+static usr_sim_config_t m_config;
+static usr_sim_stats_t  m_stats;
+static sim_sensor_t     m_sensors[USR_SIM_SENSORS_MAX];
+static bool             m_running = false;
+
+static uint32_t m_interval_us;          // Between two notifications of a sensor
+static uint32_t m_sample_us;
+static uint8_t  m_samples_per_notif;
+static uint32_t m_rand = 0x2545F491;
+
+static ble_imu_service_c_evt_t m_evt;
+
+APP_TIMER_DEF(m_sim_timer);
+
+
+// xorshift32, good enough for jitter and loss
+static uint32_t sim_rand(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+static uint8_t samples_per_notif(uint8_t type)
+{
+    switch (type)
+    {
+    case QUATERNIONS:
+    case RAW:
+        return BLE_PACKET_BUFFER_COUNT;
+    case EULER:
+        return 1;
+    case EMG:
+        return BLE_IMU_SERVICE_ADC_SAMPLES;
+    default:
+        return 0;
+    }
+}
+
+static void sensor_schedule(sim_sensor_t * p_sensor)
+{
+    uint32_t jitter = (m_config.jitter_ms > 0) ? (sim_rand() % (m_config.jitter_ms + 1)) : 0;
+
+    p_sensor->due_ms = (uint32_t) (p_sensor->base_us / 1000) + jitter;
+}
+
+// Fill the notification of one sensor, sample timestamps as the sensor would set them
+static void notif_fill(uint8_t sensor, sim_sensor_t * p_sensor)
+{
+    uint32_t time_ms = (uint32_t) (p_sensor->base_us / 1000);
+
+    m_evt.conn_handle = sensor;
+
+    switch (m_config.type)
+    {
+    case QUATERNIONS:
+        m_evt.evt_type = BLE_IMU_SERVICE_EVT_QUAT;
+        for (uint8_t i = 0; i < BLE_PACKET_BUFFER_COUNT; i++)
+        {
+            ble_imu_service_single_quat_t * p_quat = &m_evt.params.value.quat_data.quat[i];
+            p_quat->w = 1L << 30;
+            p_quat->x = p_sensor->sample_nr + i;
+            p_quat->y = sensor;
+            p_quat->z = 0;
+            p_quat->timestamp_ms = time_ms + (i * m_sample_us) / 1000;
+        }
+        break;
+
+    case RAW:
+        m_evt.evt_type = BLE_IMU_SERVICE_EVT_RAW;
+        for (uint8_t i = 0; i < BLE_PACKET_BUFFER_COUNT; i++)
+        {
+            ble_imu_service_single_raw_t * p_raw = &m_evt.params.value.raw_data.single_raw[i];
+            memset(p_raw, 0, sizeof(ble_imu_service_single_raw_t));
+            p_raw->accel.z = 2048;
+            p_raw->gyro.x = (int16_t) (p_sensor->sample_nr + i);
+            p_raw->timestamp_ms = time_ms + (i * m_sample_us) / 1000;
+        }
+        break;
+
+    case EULER:
+        m_evt.evt_type = BLE_IMU_SERVICE_EVT_EULER;
+        m_evt.params.value.euler_data.roll = 0;
+        m_evt.params.value.euler_data.pitch = 0;
+        m_evt.params.value.euler_data.yaw = (int32_t) (p_sensor->sample_nr % 360) << 16;
+        m_evt.params.value.euler_data.timestamp_ms = time_ms;
+        break;
+
+    default: // EMG
+        m_evt.evt_type = BLE_IMU_SERVICE_EVT_ADC;
+        for (uint8_t i = 0; i < BLE_IMU_SERVICE_ADC_SAMPLES; i++)
+        {
+            m_evt.params.value.adc_data.raw[i] = (p_sensor->sample_nr + i) & 0xFFFFFF;
+        }
+        m_evt.params.value.adc_data.timestamp_ms = time_ms;
+        break;
+    }
+}
+
+static void notif_handle(uint8_t sensor, sim_sensor_t * p_sensor)
+{
+    if ((m_config.loss_pct > 0) && ((sim_rand() % 100) < m_config.loss_pct))
+    {
+        m_stats.lost++;
+    }
+    else
+    {
+        notif_fill(sensor, p_sensor);
+
+        uint32_t start = usr_prof_cycles();
+        imu_service_c_evt_handler(NULL, &m_evt);
+        uint32_t cycles = usr_prof_cycles() - start;
+
+        m_stats.notifications++;
+        m_stats.samples += m_samples_per_notif;
+        m_stats.cycles_total += cycles;
+        m_stats.cycles_max = MAX(m_stats.cycles_max, cycles);
+        m_stats.uart_pending_max = MAX(m_stats.uart_pending_max, uart_tx_pending());
+    }
+
+    p_sensor->sample_nr += m_samples_per_notif;
+    p_sensor->base_us += m_interval_us;
+    sensor_schedule(p_sensor);
+}
+
+static void sim_timer_handler(void * p_context)
+{
+    m_stats.elapsed_ms += USR_SIM_TICK_MS;
+
+    for (uint8_t sensor = 0; sensor < m_config.sensors; sensor++)
+    {
+        sim_sensor_t * p_sensor = &m_sensors[sensor];
+        uint8_t handled = 0;
+
+        while ((int32_t) (m_stats.elapsed_ms - p_sensor->due_ms) >= 0)
+        {
+            if (handled == USR_SIM_CATCH_UP_MAX)
+            {
+                // Skip what could not be generated in time
+                m_stats.late++;
+                p_sensor->sample_nr += m_samples_per_notif;
+                p_sensor->base_us += m_interval_us;
+                sensor_schedule(p_sensor);
+                continue;
+            }
+
+            notif_handle(sensor, p_sensor);
+            handled++;
+        }
+    }
+}
+
+#endif
+
+void usr_sim_init(void)
+{
+    #if (USR_SIM == 1)
+
+    ret_code_t err_code = app_timer_create(&m_sim_timer, APP_TIMER_MODE_REPEATED, sim_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    #endif
+}
+
+ret_code_t usr_sim_start(usr_sim_config_t const * p_config)
+{
+    #if (USR_SIM == 1)
+
+    uint8_t samples = samples_per_notif(p_config->type);
+
+    usr_sim_stop();
+
+    if (p_config->sensors == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    if ((p_config->sensors > USR_SIM_SENSORS_MAX) || (p_config->rate_hz == 0) ||
+        (samples == 0) || (p_config->loss_pct > 100))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Simulated sensors take the connection handles of real ones
+    if (ble_conn_state_central_conn_count() > 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    m_config = *p_config;
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(m_sensors, 0, sizeof(m_sensors));
+
+    m_samples_per_notif = samples;
+    m_sample_us = 1000000UL / p_config->rate_hz;
+    m_interval_us = (uint32_t) ((1000000ULL * samples) / p_config->rate_hz);
+
+    // Spread the sensors over one interval, like connections with different anchor points
+    for (uint8_t sensor = 0; sensor < m_config.sensors; sensor++)
+    {
+        m_sensors[sensor].base_us = USR_SIM_TICK_MS * 1000 + ((uint64_t) m_interval_us * sensor) / m_config.sensors;
+        sensor_schedule(&m_sensors[sensor]);
+    }
+
+    NRF_LOG_INFO("Simulation: %d sensors, type %d, %d Hz", m_config.sensors, m_config.type, m_config.rate_hz);
+
+    m_running = true;
+    return app_timer_start(m_sim_timer, APP_TIMER_TICKS(USR_SIM_TICK_MS), NULL);
+
+    #else
+
+    return NRF_ERROR_NOT_SUPPORTED;
+
+    #endif
+}
+
+void usr_sim_stop(void)
+{
+    #if (USR_SIM == 1)
+
+    if (m_running)
+    {
+        (void) app_timer_stop(m_sim_timer);
+        m_running = false;
+
+        NRF_LOG_INFO("Simulation stopped: %d notifications, %d late", m_stats.notifications, m_stats.late);
+    }
+
+    #endif
+}
+
+bool usr_sim_running(void)
+{
+    #if (USR_SIM == 1)
+    return m_running;
+    #else
+    return false;
+    #endif
+}
+
+void usr_sim_config_get(usr_sim_config_t * p_config)
+{
+    #if (USR_SIM == 1)
+    *p_config = m_config;
+    #else
+    memset(p_config, 0, sizeof(usr_sim_config_t));
+    #endif
+}
+
+void usr_sim_stats_get(usr_sim_stats_t * p_stats)
+{
+    #if (USR_SIM == 1)
+
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+
+    #else
+
+    memset(p_stats, 0, sizeof(usr_sim_stats_t));
+
+    #endif
+}
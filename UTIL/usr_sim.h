@@ -0,0 +1,77 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_sim.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Simulated sensor fleet for load tests of the data path
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_SIM_H_
+#define _USR_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+#include "nrf_sdh_ble.h"
+
+// Simulated sensors use the connection handles 0 .. sensors-1
+#define USR_SIM_SENSORS_MAX         NRF_SDH_BLE_CENTRAL_LINK_COUNT
+// Notifications are generated from a 1 ms timer
+#define USR_SIM_TICK_MS             1
+// Notifications of one sensor handled per tick, more are counted as late
+#define USR_SIM_CATCH_UP_MAX        4
+
+typedef struct
+{
+    uint8_t  sensors;
+    uint8_t  type;              // data_type_byte_t: QUATERNIONS, EULER, RAW or EMG
+    uint16_t rate_hz;           // Samples per second per sensor
+    uint8_t  jitter_ms;         // Notifications are delayed by 0 .. jitter_ms
+    uint8_t  loss_pct;          // Notifications dropped (lost over the air)
+} usr_sim_config_t;
+
+typedef struct
+{
+    uint32_t elapsed_ms;
+    uint32_t notifications;     // Handled by the data path
+    uint32_t samples;
+    uint32_t lost;              // Dropped on purpose (loss_pct)
+    uint32_t late;              // Not generated in time, the data path is saturated
+    uint32_t uart_pending_max;  // UART TX FIFO occupancy (bytes)
+    uint32_t cycles_total;      // CPU cycles spent in the data path
+    uint32_t cycles_max;        // Longest notification
+} usr_sim_stats_t;
+
+// Create the simulation timer, call after timer_init
+void usr_sim_init(void);
+
+// Start (or restart) the simulation, 0 sensors stops it. NRF_ERROR_INVALID_PARAM for an invalid configuration,
+// NRF_ERROR_INVALID_STATE while real sensors are connected, NRF_ERROR_NOT_SUPPORTED when
+// compiled without USR_SIM.
+ret_code_t usr_sim_start(usr_sim_config_t const * p_config);
+
+void usr_sim_stop(void);
+
+bool usr_sim_running(void);
+
+void usr_sim_config_get(usr_sim_config_t * p_config);
+void usr_sim_stats_get(usr_sim_stats_t * p_stats);
+
+#endif
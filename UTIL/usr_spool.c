@@ -0,0 +1,403 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_spool.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Flash spool for data frames that could not be sent live
+ *
+ *               Frames are collected in a RAM page buffer, a full buffer is
+ *               erased + programmed as one page while the other buffer fills.
+ *               Pages are used round robin (wear leveling), every page starts
+ *               with a header carrying an increasing page sequence number.
+ *               Frames are put from the BLE event interrupt, flash events
+ *               arrive in the same interrupt, the drain runs from the scheduler.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_spool.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_sd.h"
+
+#define NRF_LOG_MODULE_NAME usr_spool_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#if USR_SPOOL_ACTIVE
+
+#define PAGE_MAGIC                  0x4C4F5053  // "SPOL"
+#define PAGE_ADDR(page)             (USR_SPOOL_START + (uint32_t) (page) * USR_SPOOL_PAGE_SIZE)
+#define TICKS_TO_MS(ticks)          ((uint32_t) (((uint64_t) (ticks) * 1000) / APP_TIMER_TICKS(1000)))
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t page_seq;
+    uint16_t used;          // Bytes including this header
+    uint16_t records;
+} page_hdr_t;
+
+typedef struct __attribute__((packed))
+{
+    uint8_t  len;
+    uint32_t seq;
+} record_hdr_t;
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt);
+
+NRF_FSTORAGE_DEF(nrf_fstorage_t m_spool_fs) =
+{
+    .evt_handler = fstorage_evt_handler,
+    .start_addr  = USR_SPOOL_START,
+    .end_addr    = USR_SPOOL_END,
+};
+
+// Page buffers, word aligned for the flash
+static uint32_t m_buf[2][USR_SPOOL_PAGE_SIZE / sizeof(uint32_t)];
+static uint8_t  m_active = 0;       // Buffer being filled
+static uint16_t m_fill;             // Bytes used in the active buffer
+static uint16_t m_fill_records;
+static uint16_t m_buf_read;         // Drained part of the active buffer
+
+static bool     m_busy = false;     // The other buffer is being programmed
+static uint16_t m_busy_page;
+static uint16_t m_busy_read;        // Drained part of that buffer
+static uint32_t m_busy_start;
+
+static uint32_t m_page_seq = 0;
+static uint16_t m_write_page = 0;   // Next page to program
+static uint16_t m_read_page = 0;    // Oldest programmed page
+static uint16_t m_read_offset;
+
+static bool     m_draining = false;
+static uint32_t m_write_ms_total = 0;
+static uint32_t m_pages_timed = 0;  // stats.pages_written wraps
+
+static usr_spool_stats_t m_stats;
+static usr_spool_drain_handler_t m_drain_handler = NULL;
+
+APP_TIMER_DEF(m_drain_timer);
+
+
+static uint8_t * active_buf(void)
+{
+    return (uint8_t *) m_buf[m_active];
+}
+
+static void drain_start(void)
+{
+    if (!m_draining)
+    {
+        m_draining = (app_timer_start(m_drain_timer, APP_TIMER_TICKS(USR_SPOOL_DRAIN_INTERVAL_MS), NULL) == NRF_SUCCESS);
+    }
+}
+
+static void page_hdr_read(uint16_t page, page_hdr_t * p_hdr)
+{
+    ret_code_t err_code = nrf_fstorage_read(&m_spool_fs, PAGE_ADDR(page), p_hdr, sizeof(page_hdr_t));
+    APP_ERROR_CHECK(err_code);
+}
+
+// Spool full, the oldest page is given up
+static void page_drop_oldest(void)
+{
+    page_hdr_t hdr;
+    page_hdr_read(m_read_page, &hdr);
+
+    m_stats.lost += hdr.records;
+    m_read_page = (m_read_page + 1) % USR_SPOOL_PAGES;
+    m_read_offset = sizeof(page_hdr_t);
+    m_stats.pages--;
+}
+
+static void flush(void)
+{
+    if (m_busy || (m_fill_records == 0))
+    {
+        return;
+    }
+
+    if (m_stats.pages == USR_SPOOL_PAGES)
+    {
+        page_drop_oldest();
+    }
+
+    page_hdr_t hdr = { .magic = PAGE_MAGIC, .page_seq = m_page_seq++, .used = m_fill, .records = m_fill_records };
+    memcpy(active_buf(), &hdr, sizeof(hdr));
+    // Unused tail stays erased
+    memset(active_buf() + m_fill, 0xFF, USR_SPOOL_PAGE_SIZE - m_fill);
+
+    m_busy = true;
+    m_busy_page = m_write_page;
+    m_busy_read = m_buf_read;
+    m_busy_start = app_timer_cnt_get();
+
+    m_active ^= 1;
+    m_fill = sizeof(page_hdr_t);
+    m_fill_records = 0;
+    m_buf_read = sizeof(page_hdr_t);
+
+    ret_code_t err_code = nrf_fstorage_erase(&m_spool_fs, PAGE_ADDR(m_busy_page), 1, NULL);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Spool erase failed: %d", err_code);
+        m_stats.errors++;
+        m_busy = false;
+    }
+}
+
+static void page_done(bool ok)
+{
+    m_busy = false;
+
+    if (!ok)
+    {
+        m_stats.errors++;
+        return;
+    }
+
+    uint32_t ms = TICKS_TO_MS(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_busy_start));
+    m_stats.pages_written++;
+    m_pages_timed++;
+    m_write_ms_total += ms;
+    m_stats.write_ms_avg = m_write_ms_total / m_pages_timed;
+    m_stats.write_ms_max = MAX(m_stats.write_ms_max, ms);
+
+    m_write_page = (m_busy_page + 1) % USR_SPOOL_PAGES;
+
+    page_hdr_t const * p_hdr = (page_hdr_t const *) m_buf[m_active ^ 1];
+    if (m_busy_read >= p_hdr->used)
+    {
+        // Drained from RAM already
+        return;
+    }
+
+    if (m_stats.pages == 0)
+    {
+        m_read_page = m_busy_page;
+        m_read_offset = m_busy_read;
+    }
+    m_stats.pages++;
+
+    drain_start();
+}
+
+static void fstorage_evt_handler(nrf_fstorage_evt_t * p_evt)
+{
+    switch (p_evt->id)
+    {
+    case NRF_FSTORAGE_EVT_ERASE_RESULT:
+    {
+        if (p_evt->result != NRF_SUCCESS)
+        {
+            page_done(false);
+            break;
+        }
+
+        ret_code_t err_code = nrf_fstorage_write(&m_spool_fs, PAGE_ADDR(m_busy_page), m_buf[m_active ^ 1], USR_SPOOL_PAGE_SIZE, NULL);
+        if (err_code != NRF_SUCCESS)
+        {
+            page_done(false);
+        }
+    }
+    break;
+
+    case NRF_FSTORAGE_EVT_WRITE_RESULT:
+        page_done(p_evt->result == NRF_SUCCESS);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void drain_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_drain_handler != NULL)
+    {
+        m_drain_handler();
+    }
+}
+
+static void drain_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, drain_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Spool drain tick dropped: %d", err_code);
+    }
+}
+
+#endif
+
+void usr_spool_init(usr_spool_drain_handler_t drain_handler)
+{
+    #if USR_SPOOL_ACTIVE
+
+    ret_code_t err_code;
+
+    m_drain_handler = drain_handler;
+
+    err_code = app_timer_create(&m_drain_timer, APP_TIMER_MODE_REPEATED, drain_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_fstorage_init(&m_spool_fs, &nrf_fstorage_sd, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    // Continue after the newest page, so all pages wear evenly over reboots
+    for (uint16_t page = 0; page < USR_SPOOL_PAGES; page++)
+    {
+        page_hdr_t hdr;
+        page_hdr_read(page, &hdr);
+
+        if ((hdr.magic == PAGE_MAGIC) && (hdr.page_seq >= m_page_seq))
+        {
+            m_page_seq = hdr.page_seq + 1;
+            m_write_page = (page + 1) % USR_SPOOL_PAGES;
+        }
+    }
+
+    m_read_page = m_write_page;
+    m_read_offset = sizeof(page_hdr_t);
+    m_fill = sizeof(page_hdr_t);
+    m_buf_read = sizeof(page_hdr_t);
+
+    NRF_LOG_INFO("Spool: %d pages, continuing at page %d", USR_SPOOL_PAGES, m_write_page);
+
+    #endif
+}
+
+void usr_spool_put(uint32_t seq, uint8_t const * p_frame, uint8_t len)
+{
+    #if USR_SPOOL_ACTIVE
+
+    record_hdr_t hdr = { .len = len, .seq = seq };
+    uint32_t size = sizeof(hdr) + len;
+
+    if (m_fill + size > USR_SPOOL_PAGE_SIZE)
+    {
+        if (m_busy)
+        {
+            m_stats.overruns++;
+            return;
+        }
+        flush();
+    }
+
+    memcpy(active_buf() + m_fill, &hdr, sizeof(hdr));
+    memcpy(active_buf() + m_fill + sizeof(hdr), p_frame, len);
+    m_fill += size;
+    m_fill_records++;
+    m_stats.bytes_spooled += len;
+
+    drain_start();
+
+    #endif
+}
+
+bool usr_spool_next(uint32_t * p_seq, uint8_t * p_frame, uint8_t * p_len)
+{
+    bool found = false;
+
+    #if USR_SPOOL_ACTIVE
+
+    record_hdr_t hdr;
+
+    CRITICAL_REGION_ENTER();
+
+    // Programmed pages first, oldest to newest
+    while (m_stats.pages > 0)
+    {
+        page_hdr_t page;
+        page_hdr_read(m_read_page, &page);
+
+        if (m_read_offset + sizeof(hdr) > page.used)
+        {
+            m_read_page = (m_read_page + 1) % USR_SPOOL_PAGES;
+            m_read_offset = sizeof(page_hdr_t);
+            m_stats.pages--;
+            continue;
+        }
+
+        uint32_t addr = PAGE_ADDR(m_read_page) + m_read_offset;
+        APP_ERROR_CHECK(nrf_fstorage_read(&m_spool_fs, addr, &hdr, sizeof(hdr)));
+        APP_ERROR_CHECK(nrf_fstorage_read(&m_spool_fs, addr + sizeof(hdr), p_frame, hdr.len));
+        m_read_offset += sizeof(hdr) + hdr.len;
+        found = true;
+        break;
+    }
+
+    // Then the frames still in RAM, unless they are being programmed
+    if (!found && !m_busy && (m_buf_read < m_fill))
+    {
+        memcpy(&hdr, active_buf() + m_buf_read, sizeof(hdr));
+        memcpy(p_frame, active_buf() + m_buf_read + sizeof(hdr), hdr.len);
+        m_buf_read += sizeof(hdr) + hdr.len;
+        found = true;
+
+        // Reuse the buffer once it is drained completely
+        if (m_buf_read == m_fill)
+        {
+            m_fill = sizeof(page_hdr_t);
+            m_fill_records = 0;
+            m_buf_read = sizeof(page_hdr_t);
+        }
+    }
+
+    if (found)
+    {
+        *p_seq = hdr.seq;
+        *p_len = hdr.len;
+        m_stats.bytes_drained += hdr.len;
+    }
+    else if (!m_busy)
+    {
+        // Nothing left, restarted by the next put
+        (void) app_timer_stop(m_drain_timer);
+        m_draining = false;
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    #endif
+
+    return found;
+}
+
+void usr_spool_stats_get(usr_spool_stats_t * p_stats)
+{
+    #if USR_SPOOL_ACTIVE
+
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+
+    #else
+
+    memset(p_stats, 0, sizeof(usr_spool_stats_t));
+
+    #endif
+}
@@ -0,0 +1,82 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_spool.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Flash spool for data frames that could not be sent live
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_SPOOL_H_
+#define _USR_SPOOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "settings.h"
+#include "sdk_errors.h"
+
+#define USR_SPOOL_PAGE_SIZE         4096
+
+// Spool region, ends below the boot record (usr_boot) and the DFU app data area (3 pages) under the bootloader.
+// The application must stay below USR_SPOOL_START (see the linker script).
+#if defined(NRF52840_XXAA)
+#define USR_SPOOL_PAGES             31
+#define USR_SPOOL_START             0xD5000
+#else
+// No room next to the application on the nRF52832
+#define USR_SPOOL_PAGES             0
+#define USR_SPOOL_START             0
+#endif
+#define USR_SPOOL_END               (USR_SPOOL_START + USR_SPOOL_PAGES * USR_SPOOL_PAGE_SIZE)
+
+#define USR_SPOOL_ACTIVE            ((USR_SPOOL == 1) && (USR_SPOOL_PAGES > 0))
+
+// Drain pacing, same rules as the backlog replay
+#define USR_SPOOL_DRAIN_INTERVAL_MS 10
+
+// Flash limits (nRF52840 datasheet): page erase 85 ms, word write 41 us, so one page
+// takes up to ~127 ms (~32 kB/s) without radio activity. Frames arriving while both
+// page buffers are in use are counted as overruns.
+typedef struct
+{
+    uint16_t pages;             // Pages with undrained frames (programmed)
+    uint16_t pages_written;
+    uint32_t bytes_spooled;
+    uint32_t bytes_drained;
+    uint32_t overruns;          // Frames dropped, flash too slow
+    uint32_t lost;              // Frames dropped, spool full (oldest page overwritten)
+    uint16_t errors;            // Flash operations that failed
+    uint16_t write_ms_avg;      // Erase + write of one page
+    uint16_t write_ms_max;
+} usr_spool_stats_t;
+
+// Called from the scheduler every drain interval while the spool holds frames
+typedef void (*usr_spool_drain_handler_t)(void);
+
+// Find the page to continue on (wear leveling), frames of a previous boot are discarded
+void usr_spool_init(usr_spool_drain_handler_t drain_handler);
+
+// Spool a frame with its backlog sequence number
+void usr_spool_put(uint32_t seq, uint8_t const * p_frame, uint8_t len);
+
+// Oldest spooled frame, false when the spool is empty (or busy programming the last page)
+bool usr_spool_next(uint32_t * p_seq, uint8_t * p_frame, uint8_t * p_len);
+
+void usr_spool_stats_get(usr_spool_stats_t * p_stats);
+
+#endif
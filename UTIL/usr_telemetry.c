@@ -0,0 +1,86 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_telemetry.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Periodic binary telemetry of the DCU health for the STM32
+ *
+ *               Only the pacing lives here, the frame is filled in by the
+ *               report handler from the counters of the other modules.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_telemetry.h"
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+
+#define NRF_LOG_MODULE_NAME usr_telemetry_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static usr_telemetry_report_handler_t m_report_handler = NULL;
+static uint16_t m_seq = 0;
+
+APP_TIMER_DEF(m_report_timer);
+
+
+static void report_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_report_handler != NULL)
+    {
+        m_report_handler();
+    }
+}
+
+static void report_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, report_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Telemetry report dropped: %d", err_code);
+    }
+}
+
+void usr_telemetry_init(usr_telemetry_report_handler_t report_handler)
+{
+    ret_code_t err_code;
+
+    m_report_handler = report_handler;
+
+    err_code = app_timer_create(&m_report_timer, APP_TIMER_MODE_REPEATED, report_timer_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+ret_code_t usr_telemetry_period_set(uint8_t period_s)
+{
+    ret_code_t err_code = app_timer_stop(m_report_timer);
+    if ((err_code != NRF_SUCCESS) || (period_s == 0))
+    {
+        return err_code;
+    }
+
+    return app_timer_start(m_report_timer, APP_TIMER_TICKS((uint32_t) period_s * 1000), NULL);
+}
+
+uint16_t usr_telemetry_seq_next(void)
+{
+    return m_seq++;
+}
@@ -0,0 +1,43 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_telemetry.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Periodic binary telemetry of the DCU health for the STM32
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_TELEMETRY_H_
+#define _USR_TELEMETRY_H_
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+// Called from the scheduler at the configured period
+typedef void (*usr_telemetry_report_handler_t)(void);
+
+// Create the report timer, call after timer_init. Off until a period is set.
+void usr_telemetry_init(usr_telemetry_report_handler_t report_handler);
+
+// Periodic telemetry every period_s seconds, 0 stops it
+ret_code_t usr_telemetry_period_set(uint8_t period_s);
+
+// Sequence number of the next telemetry frame, gaps show lost frames
+uint16_t usr_telemetry_seq_next(void);
+
+#endif
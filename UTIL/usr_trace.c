@@ -0,0 +1,223 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_trace.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Capture of the raw notification stream
+ *
+ *               Notifications are recorded in the BLE event interrupt before
+ *               they are decoded, so a trace can be pushed through the same
+ *               decoding and framing again (COMM_CMD_TRACE_INJECT) and the
+ *               DATA frames compared byte for byte with the recorded session.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_trace.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_fifo.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
+#include "usr_evq.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+#include "usr_time_sync.h"
+
+#define NRF_LOG_MODULE_NAME usr_trace_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static uint8_t    m_buf[USR_TRACE_BUF_SIZE];
+static app_fifo_t m_fifo;
+
+static bool     m_capturing = false;
+static bool     m_draining = false;
+static bool     m_tick_valid = false;   // m_last_tick holds the tick of the previous record
+static uint64_t m_last_tick;
+static uint32_t m_records = 0;
+static uint32_t m_bytes = 0;
+static uint32_t m_dropped = 0;
+static uint32_t m_read_offset = 0;
+
+static usr_trace_drain_handler_t m_drain_handler = NULL;
+
+APP_TIMER_DEF(m_drain_timer);
+
+
+static void drain_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_drain_handler != NULL)
+    {
+        m_drain_handler();
+    }
+}
+
+static void drain_timer_handler(void * p_context)
+{
+    // UART frames are built in main context
+    ret_code_t err_code = usr_evq_put(USR_EVQ_TIMER, drain_scheduled);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_WARNING("Trace drain tick dropped: %d", err_code);
+    }
+}
+
+static uint32_t fifo_free(void)
+{
+    uint32_t available = 0;
+
+    // Without a buffer app_fifo_write returns the free space
+    (void) app_fifo_write(&m_fifo, NULL, &available);
+
+    return available;
+}
+
+static void fifo_write(void const * p_data, uint32_t len)
+{
+    uint32_t written = len;
+
+    (void) app_fifo_write(&m_fifo, p_data, &written);
+    m_bytes += written;
+}
+
+void usr_trace_init(usr_trace_drain_handler_t drain_handler)
+{
+    ret_code_t err_code;
+
+    m_drain_handler = drain_handler;
+
+    err_code = app_fifo_init(&m_fifo, m_buf, (uint16_t) sizeof(m_buf));
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_drain_timer, APP_TIMER_MODE_REPEATED, drain_timer_handler);
+    APP_ERROR_CHECK(err_code);
+}
+
+ret_code_t usr_trace_start(void)
+{
+    CRITICAL_REGION_ENTER();
+
+    (void) app_fifo_flush(&m_fifo);
+    m_tick_valid = false;
+    m_records = 0;
+    m_bytes = 0;
+    m_dropped = 0;
+    m_read_offset = 0;
+    m_capturing = true;
+
+    CRITICAL_REGION_EXIT();
+
+    NRF_LOG_INFO("Trace capture started");
+
+    if (m_draining)
+    {
+        return NRF_SUCCESS;
+    }
+
+    ret_code_t err_code = app_timer_start(m_drain_timer, APP_TIMER_TICKS(USR_TRACE_DRAIN_INTERVAL_MS), NULL);
+    m_draining = (err_code == NRF_SUCCESS);
+
+    return err_code;
+}
+
+void usr_trace_stop(void)
+{
+    m_capturing = false;
+
+    NRF_LOG_INFO("Trace capture stopped: %d records, %d dropped", m_records, m_dropped);
+}
+
+void usr_trace_on_notif(uint16_t conn_handle, uint8_t evt_type, uint8_t const * p_data, uint16_t len)
+{
+    if (!m_capturing)
+    {
+        return;
+    }
+
+    uint64_t tick = usr_ts_timestamp_get_ticks_u64();
+    uint64_t delta = tick - m_last_tick;
+    bool tick_record = !m_tick_valid || (delta > UINT32_MAX);
+    uint8_t rec_len = (uint8_t) MIN(len, UINT8_MAX);
+    uint32_t size = USR_TRACE_REC_HDR_LEN + rec_len + (tick_record ? USR_TRACE_REC_HDR_LEN + sizeof(tick) : 0);
+
+    // Whole records only, the stream stays decodable
+    if (fifo_free() < size)
+    {
+        m_dropped++;
+        return;
+    }
+
+    if (tick_record)
+    {
+        uint8_t hdr[USR_TRACE_REC_HDR_LEN] = { 0, 0, 0, 0, 0xFF, USR_TRACE_REC_TICK, sizeof(tick) };
+        fifo_write(hdr, sizeof(hdr));
+        fifo_write(&tick, sizeof(tick));
+        delta = 0;
+    }
+
+    uint32_t delta_ticks = (uint32_t) delta;
+    uint8_t hdr[USR_TRACE_REC_HDR_LEN];
+
+    memcpy(hdr, &delta_ticks, sizeof(delta_ticks));
+    hdr[4] = (uint8_t) conn_handle;
+    hdr[5] = evt_type;
+    hdr[6] = rec_len;
+
+    fifo_write(hdr, sizeof(hdr));
+    fifo_write(p_data, rec_len);
+
+    m_last_tick = tick;
+    m_tick_valid = true;
+    m_records++;
+}
+
+uint32_t usr_trace_read(uint8_t * p_buf, uint32_t size, uint32_t * p_offset)
+{
+    uint32_t len = size;
+
+    if (app_fifo_read(&m_fifo, p_buf, &len) != NRF_SUCCESS)
+    {
+        len = 0;
+    }
+
+    *p_offset = m_read_offset;
+    m_read_offset += len;
+
+    // Nothing left, the timer is restarted by the next trace
+    if ((len == 0) && !m_capturing)
+    {
+        (void) app_timer_stop(m_drain_timer);
+        m_draining = false;
+    }
+
+    return len;
+}
+
+void usr_trace_status_get(usr_trace_status_t * p_status)
+{
+    CRITICAL_REGION_ENTER();
+
+    p_status->capturing = m_capturing;
+    p_status->records = m_records;
+    p_status->bytes = m_bytes;
+    p_status->dropped = m_dropped;
+    (void) app_fifo_read(&m_fifo, NULL, &p_status->pending);
+
+    CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,82 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_trace.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Capture of the raw notification stream
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_TRACE_H_
+#define _USR_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+// Trace buffer, drained to the STM32 while capturing (power of two, app_fifo)
+#if defined(NRF52840_XXAA)
+#define USR_TRACE_BUF_SIZE          8192
+#else
+#define USR_TRACE_BUF_SIZE          2048
+#endif
+
+// Trace format, a byte stream of records:
+//  | delta_ticks (4 bytes) | conn_handle | evt_type | len | payload (len bytes) |
+// delta_ticks is the arrival time (usr_ts_timestamp_get_ticks_u64, 16 MHz) since the previous record.
+// The first record, and any record after a longer gap, is preceded by a tick record
+// (evt_type USR_TRACE_REC_TICK, conn_handle 0xFF) with the absolute tick as 8 byte payload.
+#define USR_TRACE_REC_HDR_LEN       7
+#define USR_TRACE_REC_TICK          0xFF
+
+// Drain pacing, same rules as the backlog replay
+#define USR_TRACE_DRAIN_INTERVAL_MS 10
+#define USR_TRACE_DRAIN_BYTES       512
+#define USR_TRACE_DRAIN_FIFO_MAX    512
+
+typedef struct
+{
+    bool     capturing;
+    uint32_t records;           // Notifications captured
+    uint32_t bytes;             // Trace bytes written, the stream offset of the next record
+    uint32_t dropped;           // Notifications not captured, trace buffer full
+    uint32_t pending;           // Bytes waiting to be drained
+} usr_trace_status_t;
+
+// Called from the scheduler every drain interval while the trace buffer holds data
+typedef void (*usr_trace_drain_handler_t)(void);
+
+// Create the drain timer, call after timer_init
+void usr_trace_init(usr_trace_drain_handler_t drain_handler);
+
+// Start a new trace (stream offset 0), buffered data of a previous trace is discarded
+ret_code_t usr_trace_start(void);
+
+// Stop capturing, the buffered part is still drained
+void usr_trace_stop(void);
+
+// Raw notification of characteristic evt_type (ble_imu_service_c_evt_type_t), from the BLE event interrupt
+void usr_trace_on_notif(uint16_t conn_handle, uint8_t evt_type, uint8_t const * p_data, uint16_t len);
+
+// Next part of the trace, up to size bytes. Returns the number of bytes, p_offset is the
+// stream offset of the first byte.
+uint32_t usr_trace_read(uint8_t * p_buf, uint32_t size, uint32_t * p_offset);
+
+void usr_trace_status_get(usr_trace_status_t * p_status);
+
+#endif
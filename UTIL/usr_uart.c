@@ -39,13 +39,30 @@
 
 // Application scheduler
 #include "app_scheduler.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+
+// Radio to UART latency, profiler
+#include "usr_latency.h"
+#include "usr_prof.h"
+#include "usr_evlog.h"
+#include "usr_rtos.h"
+#include "usr_evq.h"
+
+#if (USR_FREERTOS == 1)
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#endif
 
 // Logging
 // #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
 
+#include "settings.h"
 #define NRF_LOG_MODULE_NAME usr_uart_c
+#define NRF_LOG_LEVEL USR_LOG_LEVEL_UART
 #include "nrf_log.h"
 NRF_LOG_MODULE_REGISTER();
 
@@ -99,9 +116,32 @@ typedef struct uart_buffer
 // Initialization of uart buffer
 static uart_buffer_t buffer;
 
+// Counters for the telemetry
+static uart_stats_t m_stats;
+
+#if (USR_FREERTOS == 1)
+// FreeRTOS build: the FIFOs are stream buffers on the same storage, read by the egress
+// and the command task
+#define TX_CHUNK_MAX 255 // Same transfers as the superloop
+
+static StaticStreamBuffer_t m_tx_stream_struct;
+static StaticStreamBuffer_t m_rx_stream_struct;
+static StreamBufferHandle_t m_tx_stream;
+static StreamBufferHandle_t m_rx_stream;
+#endif
+
 
 static void uart_buffer_init()
 {
+    #if (USR_FREERTOS == 1)
+    // The storage holds one byte more than the stream
+    m_tx_stream = xStreamBufferCreateStatic(sizeof(buffer.tx_buff) - 1, 1, buffer.tx_buff, &m_tx_stream_struct);
+    m_rx_stream = xStreamBufferCreateStatic(sizeof(buffer.rx_buff) - 1, 1, buffer.rx_buff, &m_rx_stream_struct);
+    if ((m_tx_stream == NULL) || (m_rx_stream == NULL))
+    {
+        APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+    #else
     ret_code_t err_code;
 
     // Initialize FIFO for TX bytes
@@ -111,6 +151,7 @@ static void uart_buffer_init()
     // Initialize FIFO for RX bytes
     err_code = app_fifo_init(&buffer.uart_rx_buff_instance, buffer.rx_buff, (uint16_t)sizeof(buffer.rx_buff));
     APP_ERROR_CHECK(err_code);
+    #endif
 }
 
 bool uart_in_progress()
@@ -128,7 +169,8 @@ void uart_print(char msg[])
     uint8_t data[256];
     memcpy(data, msg, len[0]);
 
-    uart_queued_tx(data, len);
+    // Dropped when the FIFO is full
+    (void) uart_queued_tx_try(data, len);
 }
 
 
@@ -150,6 +192,8 @@ uint32_t uart_rx_to_cmd(uint8_t *command_in, uint8_t len)
 
 void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
 {
+    USR_PROF_ENTER();
+
     nrf_libuarte_async_t * p_libuarte = (nrf_libuarte_async_t *)context;
     ret_code_t err_code;
     uint16_t index = 0;
@@ -158,31 +202,37 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
     {
         case NRF_LIBUARTE_ASYNC_EVT_ERROR:
 
-            NRF_LOG_INFO("NRF_LIBUARTE_ASYNC_EVT_ERROR");
+            usr_evlog(USR_EVLOG_UART_ERROR, (uint16_t) p_evt->data.errorsrc, 0);
+            m_stats.rx_errors++;
 
             break;
 
         case NRF_LIBUARTE_ASYNC_EVT_OVERRUN_ERROR:
 
-            NRF_LOG_INFO("NRF_LIBUARTE_ASYNC_EVT_OVERRUN_ERROR");
+            usr_evlog(USR_EVLOG_UART_OVERRUN, 0, 0);
+            m_stats.rx_errors++;
 
             break;
 
         case NRF_LIBUARTE_ASYNC_EVT_RX_DATA:
 
-            NRF_LOG_INFO("NRF_LIBUARTE_ASYNC_EVT_RX_DATA");
+            NRF_LOG_DEBUG("NRF_LIBUARTE_ASYNC_EVT_RX_DATA");
 
             // if(p_evt->data.rxtx.length > 2)
             // {
             //     NRF_LOG_ERROR("Error");
             // }
 
+            #if (USR_FREERTOS == 1)
+            err_code = (xStreamBufferSendFromISR(m_rx_stream, p_evt->data.rxtx.p_data, p_evt->data.rxtx.length, NULL) ==
+                        p_evt->data.rxtx.length) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+            #else
             err_code = app_fifo_write(&buffer.uart_rx_buff_instance, p_evt->data.rxtx.p_data, (uint32_t *) &p_evt->data.rxtx.length);
+            #endif
             APP_ERROR_CHECK(err_code);
             if (err_code != NRF_SUCCESS)
             {
-                NRF_LOG_INFO("app_fifo_put in NRF_DRV_UART_EVT_RX_DONE failed %d", err_code);
-                NRF_LOG_FLUSH();
+                usr_evlog(USR_EVLOG_UART_RX_FULL, err_code, p_evt->data.rxtx.length);
             }
             
 
@@ -190,8 +240,14 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
 
             // NRF_LOG_INFO("FIFO put");
 
-            err_code = app_sched_event_put(0, 0, uart.uart_scheduled);
+            usr_latency_on_rx();
+
+            #if (USR_FREERTOS == 1)
+            usr_rtos_notify(USR_RTOS_TASK_COMMAND);
+            #else
+            err_code = usr_evq_put(USR_EVQ_RX, uart.uart_scheduled);
             APP_ERROR_CHECK(err_code);
+            #endif
 
             // Free RX memory: if not done correctly can cause memory overflows
             nrf_libuarte_async_rx_free(p_libuarte, p_evt->data.rxtx.p_data, p_evt->data.rxtx.length);
@@ -207,11 +263,20 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
 
             // NRF_LOG_INFO("buffer.uart_tx_buff changed in NRF_LIBUARTE_ASYNC_EVT_TX_DONE");
 
+            usr_latency_on_tx_done(p_evt->data.rxtx.length);
+            m_stats.tx_bytes += p_evt->data.rxtx.length;
+
+            #if (USR_FREERTOS == 1)
+            // The egress task starts the next transfer
+            uart.in_progress = 0;
+            usr_rtos_notify(USR_RTOS_TASK_EGRESS);
+            #else
             // Get next bytes from FIFO.
             err_code = app_fifo_read(&buffer.uart_tx_buff_instance, buffer.uart_tx_done_buff, &index);
             if (err_code == NRF_SUCCESS)
             {
                 buffer.uart_tx_done_buff_len = index;
+                usr_latency_on_dma(index);
 
                 // Notofy that there is still a TX transfer going on
                 uart.int_tx_in_progress = 1;
@@ -229,6 +294,7 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
             }else{
                 APP_ERROR_CHECK(err_code);
             }
+            #endif
 
             // NRF_LOG_INFO("TX_DONE - stop");
         }
@@ -236,6 +302,8 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt)
         default:
             break;
     }
+
+    USR_PROF_EXIT(USR_PROF_UART_EVT);
 }
 
 static void libuarte_clocks_init()
@@ -306,6 +374,101 @@ void uart_tx(uint8_t * p_data, size_t length)
     APP_ERROR_CHECK(err_code);
 }
 
+#if (USR_FREERTOS == 1)
+
+// Frames come from tasks only (BLE events run in the SoftDevice task), one writer at a time
+static ret_code_t tx_stream_put(uint8_t const * data, uint32_t len)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+
+    vTaskSuspendAll();
+
+    if (xStreamBufferSpacesAvailable(m_tx_stream) < len)
+    {
+        err_code = NRF_ERROR_NO_MEM;
+    }
+    else
+    {
+        // The egress task runs once the scheduler is resumed
+        (void) xStreamBufferSend(m_tx_stream, data, len, 0);
+
+        CRITICAL_REGION_ENTER();
+        usr_latency_on_queued(data, len);
+        m_stats.tx_max_pending = MAX(m_stats.tx_max_pending, uart_tx_pending());
+        CRITICAL_REGION_EXIT();
+    }
+
+    (void) xTaskResumeAll();
+
+    return err_code;
+}
+
+void uart_queued_tx(uint8_t * data, uint32_t * len)
+{
+    ret_code_t err_code = tx_stream_put(data, *len);
+
+    if (err_code == NRF_ERROR_NO_MEM)
+    {
+        NRF_LOG_INFO("UART FIFO BUFFER FULL!");
+    }
+    APP_ERROR_CHECK(err_code);
+}
+
+ret_code_t uart_queued_tx_try(uint8_t * data, uint32_t * len)
+{
+    ret_code_t err_code = tx_stream_put(data, *len);
+
+    if (err_code == NRF_ERROR_NO_MEM)
+    {
+        CRITICAL_REGION_ENTER();
+        m_stats.tx_full++;
+        CRITICAL_REGION_EXIT();
+    }
+
+    return err_code;
+}
+
+uint32_t uart_tx_pending()
+{
+    return xStreamBufferBytesAvailable(m_tx_stream);
+}
+
+void uart_tx_run(void)
+{
+    // Blocks until frames are queued, the stream fills up during the transfer
+    size_t len = xStreamBufferReceive(m_tx_stream, buffer.uart_tx_buff, TX_CHUNK_MAX, portMAX_DELAY);
+    if (len == 0)
+    {
+        return;
+    }
+
+    buffer.uart_tx_buff_len = len;
+    usr_latency_on_dma(len);
+    uart_tx(buffer.uart_tx_buff, len);
+
+    // TX_DONE notifies
+    while (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) == 0);
+}
+
+void uart_rx_dispatch(void)
+{
+    uart.uart_scheduled(NULL, 0);
+}
+
+ret_code_t uart_rx_buff_read(uint8_t * p_byte_array, uint32_t * p_size)
+{
+    *p_size = xStreamBufferReceive(m_rx_stream, p_byte_array, *p_size, 0);
+
+    return (*p_size > 0) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND;
+}
+
+ret_code_t uart_rx_buff_get(uint8_t * p_byte)
+{
+    return (xStreamBufferReceive(m_rx_stream, p_byte, 1, 0) == 1) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND;
+}
+
+#else
+
 void uart_queued_tx(uint8_t * data, uint32_t * len)
 {
     // NRF_LOG_INFO("uart_queued_tx - start");
@@ -315,9 +478,15 @@ void uart_queued_tx(uint8_t * data, uint32_t * len)
 
     memcpy(&string_len, len, sizeof(string_len));
 
+    // Frames are queued from the BLE event interrupt and from main context, the UARTE
+    // interrupt reads the FIFO: keep the write and the start of a transfer in one piece
+    CRITICAL_REGION_ENTER();
+
     // Put the data in FIFO buffer
     err_code = app_fifo_write(&buffer.uart_tx_buff_instance, data, len);
     APP_ERROR_CHECK(err_code);
+    usr_latency_on_queued(data, *len);
+    m_stats.tx_max_pending = MAX(m_stats.tx_max_pending, uart_tx_pending());
 
     if (err_code == NRF_ERROR_NO_MEM)
     {
@@ -346,6 +515,7 @@ void uart_queued_tx(uint8_t * data, uint32_t * len)
             if (err_code == NRF_SUCCESS)
             {
                 buffer.uart_tx_buff_len = string_len;
+                usr_latency_on_dma(string_len);
                 // NRF_LOG_INFO("uart tx len %d", buffer.uart_tx_buff_len);
 
                 // Transmit over uart
@@ -359,6 +529,43 @@ void uart_queued_tx(uint8_t * data, uint32_t * len)
         err_code = NRF_ERROR_INVALID_DATA;
         APP_ERROR_CHECK(err_code);
     }
+
+    CRITICAL_REGION_EXIT();
+}
+
+ret_code_t uart_queued_tx_try(uint8_t * data, uint32_t * len)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+    uint32_t available = 0;
+
+    CRITICAL_REGION_ENTER();
+
+    // Without a buffer app_fifo_write returns the free space
+    (void) app_fifo_write(&buffer.uart_tx_buff_instance, NULL, &available);
+
+    if (available < *len)
+    {
+        m_stats.tx_full++;
+        err_code = NRF_ERROR_NO_MEM;
+    }
+    else
+    {
+        uart_queued_tx(data, len);
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+uint32_t uart_tx_pending()
+{
+    uint32_t pending = 0;
+
+    // Without a buffer app_fifo_read returns the used space
+    (void) app_fifo_read(&buffer.uart_tx_buff_instance, NULL, &pending);
+
+    return pending;
 }
 
 ret_code_t uart_rx_buff_read(uint8_t * p_byte_array, uint32_t * p_size)
@@ -382,3 +589,12 @@ ret_code_t uart_rx_buff_get(uint8_t * p_byte)
     // Return in case of an error
     return err_code;
 }
+
+#endif
+
+void uart_stats_get(uart_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
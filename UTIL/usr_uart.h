@@ -87,6 +87,28 @@ void uart_event_handler(void * context, nrf_libuarte_async_evt_t * p_evt);
 // Uart transmitting
 void uart_print(char msg[]);
 void uart_queued_tx(uint8_t * data, uint32_t * len);
+// Queue only when the whole frame fits, NRF_ERROR_NO_MEM otherwise
+ret_code_t uart_queued_tx_try(uint8_t * data, uint32_t * len);
+// Bytes waiting in the TX FIFO
+uint32_t uart_tx_pending();
+
+#if (USR_FREERTOS == 1)
+// Egress task: one DMA transfer from the TX stream buffer, blocks until it is done
+void uart_tx_run(void);
+// Command task: run the RX handler passed to libuarte_init
+void uart_rx_dispatch(void);
+#endif
+
+// Since boot
+typedef struct
+{
+    uint32_t tx_bytes;          // Transmitted (TX_DONE)
+    uint32_t tx_max_pending;    // TX FIFO high-water mark (bytes)
+    uint32_t tx_full;           // Frames refused by uart_queued_tx_try, TX FIFO full (data and reports)
+    uint32_t rx_errors;         // Framing and overrun errors
+} uart_stats_t;
+
+void uart_stats_get(uart_stats_t * p_stats);
 
 // Conversions
 uint32_t uart_rx_to_cmd(uint8_t *command_in, uint8_t len);
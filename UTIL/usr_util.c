@@ -36,15 +36,13 @@
 #include "app_fifo.h"
 #include "app_scheduler.h"
 #include "usr_uart.h"
+#include "usr_prof.h"
 #include "usr_ble.h"
 #include "time_sync.h"
 #include "usr_time_sync.h"
 #include "nrf_pwr_mgmt.h"
 #include "bsp_btn_ble.h"
 
-
-extern BATTERY_ARRAY batt_array;
-
 /**
  * @brief Function for handling shutdown events.
  *
@@ -187,7 +185,9 @@ void idle_state_handle(void)
 {
     if (NRF_LOG_PROCESS() == false)
     {
+        USR_PROF_IDLE_ENTER();
         nrf_pwr_mgmt_run();
+        USR_PROF_IDLE_EXIT();
     }
 }
 
@@ -573,7 +573,6 @@ void uart_rx_scheduled(void *p_event_data, uint16_t event_size)
 
         default:
             NRF_LOG_INFO("DEFAULT");
-            NRF_LOG_FLUSH();
             uart_print("------------------------------------------\n");
             uart_print("Invalid command.\n");
             uart_print("------------------------------------------\n");
@@ -583,50 +582,24 @@ void uart_rx_scheduled(void *p_event_data, uint16_t event_size)
 }
 
 
-float usr_map_adc_to_uint8(uint8_t lvl)
-{
-    float voltage;
-    
-    // 1.4V range -> need to spread over uint8_t with max value 0xFF (255)
-    float range = 4.2 - 2.8;
-
-    voltage = (lvl / 255.0) * range;
-
-    // Add 2.8V from total voltage
-    // Measurement range of 2.8V - 4.2V
-    voltage += 2.8;
-
-    return voltage;
-}
-
-
-uint8_t usr_adc_voltage_to_percent(float voltage)
-{
-    if( voltage >= 4.1 ) return 100;
-    else if ( voltage >= 4.0 ) return 90;
-    else if ( voltage >= 3.9 ) return 70; 
-    else if ( voltage >= 3.8 ) return 50;
-    else if ( voltage >= 3.7 ) return 30;
-    else if ( voltage >= 3.5 ) return 20;
-    else if ( voltage >= 3.3 ) return 10;
-    else return 0;
-}
-
-
 #define RESET_REASON_HW_RESET   1
 #define RESET_REASON_SW_RESET   4
 
+// RESETREAS of this boot (telemetry)
+static uint32_t m_reset_reason = 0;
+
 void check_reset_reason()
 {
+    // Cleared, otherwise the reasons of all resets since power on add up
+    m_reset_reason = NRF_POWER->RESETREAS;
+    NRF_POWER->RESETREAS = 0xffffffff;
 
 #ifdef DEBUG
     // 1 -> HW reset
     // 4 -> Software reset
-    uint32_t reset_reason = NRF_POWER->RESETREAS;
+    uint32_t reset_reason = m_reset_reason;
     NRF_LOG_INFO("Reset: %d", reset_reason);
 
-    NRF_POWER->RESETREAS = 0xffffffff;
-
     switch (reset_reason)
     {
     case RESET_REASON_HW_RESET:
@@ -646,6 +619,11 @@ void check_reset_reason()
 #endif
 }
 
+uint32_t usr_reset_reason_get(void)
+{
+    return m_reset_reason;
+}
+
 void clocks_start(void)
 {
 
@@ -68,11 +68,9 @@ uint32_t calculate_string_len(char * string);
 // Buffering
 uint32_t usr_get_fifo_len(app_fifo_t * p_fifo);
 
-// Battery
-float usr_map_adc_to_uint8(uint8_t lvl);
-uint8_t usr_adc_voltage_to_percent(float voltage);
-
 // Debugging
 void check_reset_reason();
+// RESETREAS read at boot by check_reset_reason
+uint32_t usr_reset_reason_get(void);
 
 #endif
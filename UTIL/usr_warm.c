@@ -0,0 +1,250 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_warm.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Warm restart, measurement state kept in RAM over a soft or watchdog reset
+ *
+ *               The state lives in the .usr_retained section, which the start-up
+ *               code does not clear (see the linker script). A checksum tells a
+ *               kept state from the random RAM content after power on. The
+ *               TimeSync timers restart from zero, so the time is copied every
+ *               USR_WARM_TICK_MS into two slots that are written in turn, a
+ *               reset in the middle of a copy leaves the other one. The boot is
+ *               timed with the cycle counter (busy start-up), the master counter
+ *               offset of TimeSync then continues the old time base.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "usr_warm.h"
+
+#include <string.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nordic_common.h"
+#include "usr_evq.h"
+#include "usr_prof.h"
+#include "usr_time_sync.h"
+
+#define NRF_LOG_MODULE_NAME usr_warm_c
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define RETAINED_MAGIC              0x4D524157  // "WARM"
+#define TS_TICKS_PER_MS             16000
+#define CYCLES_TO_TS_TICKS(cycles)  (((uint64_t) (cycles) * 16) / (SystemCoreClock / 1000000))
+
+typedef struct
+{
+    usr_warm_state_t state;
+    uint16_t         restarts;
+} warm_data_t;
+
+typedef struct
+{
+    uint64_t ticks;
+    uint64_t ticks_inv;         // ~ticks, written last
+} warm_ticks_t;
+
+typedef struct
+{
+    uint32_t     magic;
+    uint32_t     checksum;      // Of data
+    warm_data_t  data;
+    warm_ticks_t ts[2];         // TimeSync time, outside the checksum
+} warm_retained_t;
+
+static warm_retained_t m_retained __attribute__((section(".usr_retained")));
+
+static usr_warm_state_t m_state;        // Kept before the reset
+static uint64_t m_last_ticks = 0;
+static uint8_t  m_ts_slot = 0;
+static bool     m_started = false;      // usr_warm_time_resume ran, the timer exists
+static bool     m_ticking = false;
+
+static usr_warm_status_t m_status;
+
+APP_TIMER_DEF(m_tick_timer);
+
+
+static uint32_t checksum(warm_data_t const * p_data)
+{
+    uint8_t const * p_byte = (uint8_t const *) p_data;
+    // Another layout after a firmware update does not pass
+    uint32_t sum = RETAINED_MAGIC ^ sizeof(warm_data_t);
+
+    for (uint32_t i = 0; i < sizeof(warm_data_t); i++)
+    {
+        sum = (sum * 33) ^ p_byte[i];
+    }
+    return sum;
+}
+
+static bool ticks_get(uint64_t * p_ticks)
+{
+    bool found = false;
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(m_retained.ts); i++)
+    {
+        warm_ticks_t const * p_ts = &m_retained.ts[i];
+
+        if ((p_ts->ticks == ~p_ts->ticks_inv) && (!found || (p_ts->ticks > *p_ticks)))
+        {
+            *p_ticks = p_ts->ticks;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void ticks_copy(void)
+{
+    uint64_t ticks = usr_ts_timestamp_get_ticks_u64();
+    warm_ticks_t * p_ts = &m_retained.ts[m_ts_slot];
+
+    p_ts->ticks = ticks;
+    p_ts->ticks_inv = ~ticks;
+    m_ts_slot ^= 1;
+}
+
+static void tick_scheduled(void * p_event_data, uint16_t event_size)
+{
+    if (m_ticking)
+    {
+        ticks_copy();
+    }
+}
+
+static void tick_timer_handler(void * p_context)
+{
+    // TimeSync capture is not reentrant, the copy runs in the main loop
+    (void) usr_evq_put(USR_EVQ_TIMER, tick_scheduled);
+}
+
+static void retained_clear(void)
+{
+    memset(&m_retained, 0, sizeof(m_retained));
+    m_retained.magic = RETAINED_MAGIC;
+    m_retained.checksum = checksum(&m_retained.data);
+}
+
+void usr_warm_init(void)
+{
+    // Timed until usr_warm_time_resume, the CPU does not sleep before the main loop
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Cleared later on in check_reset_reason
+    m_status.reset_reason = NRF_POWER->RESETREAS;
+
+    bool kept = (m_retained.magic == RETAINED_MAGIC) &&
+                (m_retained.checksum == checksum(&m_retained.data)) &&
+                ((m_status.reset_reason & USR_WARM_RESET_MASK) != 0);
+
+    if (kept && m_retained.data.state.meas_active && ticks_get(&m_last_ticks))
+    {
+        m_state = m_retained.data.state;
+        m_retained.data.restarts++;
+        m_retained.checksum = checksum(&m_retained.data);
+        m_status.warm = true;
+    }
+    else
+    {
+        retained_clear();
+    }
+
+    m_status.restarts = m_retained.data.restarts;
+}
+
+bool usr_warm_state_get(usr_warm_state_t * p_state)
+{
+    if (!m_status.warm)
+    {
+        return false;
+    }
+
+    *p_state = m_state;
+    return true;
+}
+
+void usr_warm_time_resume(void)
+{
+    ret_code_t err_code = app_timer_create(&m_tick_timer, APP_TIMER_MODE_REPEATED, tick_timer_handler);
+    APP_ERROR_CHECK(err_code);
+    m_started = true;
+
+    if (!m_status.warm)
+    {
+        return;
+    }
+
+    // The new time base started during the boot, it is behind the old one by more than the boot
+    uint64_t boot_ticks = CYCLES_TO_TS_TICKS(usr_prof_cycles());
+    uint64_t now_ticks = usr_ts_timestamp_get_ticks_u64();
+    uint64_t resume_ticks = m_last_ticks + boot_ticks;
+
+    ts_master_counter_offset_set((int32_t) ((resume_ticks - now_ticks + TS_TICKS_PER_MS / 2) / TS_TICKS_PER_MS));
+
+    now_ticks = usr_ts_timestamp_get_ticks_u64();
+
+    m_status.last_ms = (uint32_t) (m_last_ticks / TS_TICKS_PER_MS);
+    m_status.resume_ms = (uint32_t) (now_ticks / TS_TICKS_PER_MS);
+    m_status.gap_ms = m_status.resume_ms - m_status.last_ms;
+    // Copy interval, rounding to a counter period
+    m_status.uncertainty_ms = USR_WARM_TICK_MS + 1;
+
+    NRF_LOG_INFO("Warm restart %d: time base continued at %d ms, gap %d ms", m_status.restarts, m_status.resume_ms, m_status.gap_ms);
+}
+
+void usr_warm_save(usr_warm_state_t const * p_state)
+{
+    ret_code_t err_code;
+
+    // Not before the restore
+    if (!m_started)
+    {
+        return;
+    }
+
+    // Commands run in another task in the FreeRTOS build
+    CRITICAL_REGION_ENTER();
+    m_retained.data.state = *p_state;
+    m_retained.checksum = checksum(&m_retained.data);
+    CRITICAL_REGION_EXIT();
+
+    if (p_state->meas_active && !m_ticking)
+    {
+        ticks_copy();
+        m_ticking = true;
+        err_code = app_timer_start(m_tick_timer, APP_TIMER_TICKS(USR_WARM_TICK_MS), NULL);
+        APP_ERROR_CHECK(err_code);
+    }
+    else if (!p_state->meas_active && m_ticking)
+    {
+        m_ticking = false;
+        err_code = app_timer_stop(m_tick_timer);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+void usr_warm_status_get(usr_warm_status_t * p_status)
+{
+    *p_status = m_status;
+}
@@ -0,0 +1,80 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_warm.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Warm restart, measurement state kept in RAM over a soft or watchdog reset
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _USR_WARM_H_
+#define _USR_WARM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf.h"
+#include "settings.h"
+#include "ble_imu_service_c.h"
+#include "usr_boot.h"
+
+// TimeSync time is copied to the retained RAM at this interval during a measurement,
+// the time lost before the reset is at most one interval
+#define USR_WARM_TICK_MS            10
+
+// Resets that keep the RAM content (RESETREAS)
+#define USR_WARM_RESET_MASK         (POWER_RESETREAS_SREQ_Msk | POWER_RESETREAS_DOG_Msk | POWER_RESETREAS_LOCKUP_Msk)
+
+// Kept over a reset
+typedef struct
+{
+    usr_boot_state_t         boot;          // Device list, sensor specific configurations
+    ble_imu_service_config_t config;        // Default configuration, sync start time included
+    stm32_time_t             global_time;   // Set by the STM32
+    uint32_t                 offset_time;
+    bool                     meas_active;   // Only a running measurement is resumed
+} usr_warm_state_t;
+
+typedef struct
+{
+    bool     warm;              // This boot resumed a measurement
+    uint16_t restarts;          // Warm restarts since the last cold boot
+    uint32_t reset_reason;      // RESETREAS of this boot
+    uint32_t last_ms;           // TimeSync time (ms) of the last copy before the reset
+    uint32_t resume_ms;         // TimeSync time (ms) the time base continued at
+    uint32_t gap_ms;            // resume_ms - last_ms
+    uint16_t uncertainty_ms;    // The gap may be this much longer
+} usr_warm_status_t;
+
+// Check the retained state and start timing the boot. First call in main, before the clocks
+// and the reset reason are handled.
+void usr_warm_init(void);
+
+// State kept before the reset, false after a cold boot or without a running measurement
+bool usr_warm_state_get(usr_warm_state_t * p_state);
+
+// Continue the TimeSync time base of the previous boot (warm restart only). Call after every
+// boot right after sync_timer_init and before the beacons are sent.
+void usr_warm_time_resume(void);
+
+// Changed measurement state, copied right away. Copies the TimeSync time every
+// USR_WARM_TICK_MS while a measurement runs.
+void usr_warm_save(usr_warm_state_t const * p_state);
+
+void usr_warm_status_get(usr_warm_status_t * p_status);
+
+#endif
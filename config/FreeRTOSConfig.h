@@ -61,9 +61,11 @@
 #define configUSE_TICKLESS_IDLE_SIMPLE_DEBUG                                      1 /* See into vPortSuppressTicksAndSleep source code for explanation */
 #define configCPU_CLOCK_HZ                                                        ( SystemCoreClock )
 #define configTICK_RATE_HZ                                                        1024
-#define configMAX_PRIORITIES                                                      ( 3 )
+#define configMAX_PRIORITIES                                                      ( 6 )   /* usr_rtos.h */
 #define configMINIMAL_STACK_SIZE                                                  ( 60 )
-#define configTOTAL_HEAP_SIZE                                                     ( 4096 )
+#define configTOTAL_HEAP_SIZE                                                     ( 6144 )  /* SoftDevice task and app_timer, the own tasks are static */
+#define configSUPPORT_STATIC_ALLOCATION                                           1
+#define configSUPPORT_DYNAMIC_ALLOCATION                                          1
 #define configMAX_TASK_NAME_LEN                                                   ( 4 )
 #define configUSE_16_BIT_TICKS                                                    0
 #define configIDLE_SHOULD_YIELD                                                   1
@@ -189,6 +191,11 @@ standard names - or at least those used in the unmodified vector table. */
         #include <stdint.h>
         extern uint32_t SystemCoreClock;
     #endif
+
+    /* Sleep of the idle task in the CPU load of the profiler */
+    #include "usr_prof.h"
+    #define configPRE_SLEEP_PROCESSING( xExpectedIdleTime )     USR_PROF_IDLE_ENTER()
+    #define configPOST_SLEEP_PROCESSING( xExpectedIdleTime )    USR_PROF_IDLE_EXIT()
 #endif /* !assembler */
 
 /** Implementation note:  Use this with caution and set this to 1 ONLY for debugging
@@ -30,7 +30,8 @@ int main(void)
 {
     ret_code_t err_code;
 
-    nrf_delay_ms(2000);
+    // Warm restart: check the state kept in RAM and time the boot, before anything else
+    usr_warm_init();
 
     // Logging
     log_init();
@@ -47,9 +48,17 @@ int main(void)
     // Application timers
     timer_init();
 
-    // Application scheduler (soft interrupt like)
+    // Cycle counter profiler of the handlers, before any of them runs
+    usr_prof_init();
+
+    #if (USR_FREERTOS == 1)
+    // Application scheduler of the housekeeping task, the main loop uses usr_evq
     scheduler_init();
 
+    // Tasks of the data path, before the UART and BLE events can notify them
+    usr_rtos_init();
+    #endif
+
     // A better UART driver than nrf_uart_drv - asynchronous with DMA and QUEUE
     #ifdef USE_INTERNAL_COMM
     libuarte_init(comm_rx_process);
@@ -107,22 +116,55 @@ int main(void)
     // This is a temporary fix for a known bug where connection is constantly closed with error code 0x3E
     sync_timer_init();
 
+    // Continue the time base of the measurement that ran before a warm restart
+    usr_warm_time_resume();
+
     // Initialize pins for debugging
     usr_gpio_init();
     
     create_timers(); // Needs to be places after softdevice initialization
 
+    // Per-link statistics, reported to the STM32 on request or periodically
+    usr_link_stats_init(uart_send_link_stats);
+    usr_battery_init(uart_send_battery_changes);
+    usr_joint_init(uart_send_joint);
+    usr_backlog_init(uart_send_replay);
+    usr_spool_init(uart_send_spool);
+    usr_sim_init();
+    usr_trace_init(uart_send_trace);
+    usr_telemetry_init(uart_send_telemetry);
+
+    // Fast boot: reconnect the sensors of the stored device list, ready handshake instead of a fixed delay
+    usr_boot_init(uart_send_ready);
+
+    // A measurement that ran before a soft or watchdog reset resumes, otherwise the list in flash is used
+    if (usr_ble_warm_restore())
+    {
+        uart_send_warm_restart();
+    }else
+    {
+        usr_ble_boot_restore();
+    }
+
     #if USR_ADVERTISING == 1
     advertising_start(false);
     #endif
 
+    #if (USR_FREERTOS == 1)
+    // BLE ingest in the SoftDevice task, the housekeeping task runs the scheduler, the log and the sleep
+    // Does not return
+    usr_rtos_start();
+    #else
     // Enter main loop.
     for (;;)
     {
-        // App scheduler: handle events in buffer
-        app_sched_execute();
+        // Event queues: handle the queued events, highest class first
+        USR_PROF_ENTER();
+        usr_evq_execute();
+        USR_PROF_EXIT(USR_PROF_SCHED);
 
-        // RTT Logging
+        // RTT Logging, the only place where the log is flushed
+        usr_evlog_process();
         NRF_LOG_FLUSH();
 
         // Run power management - go to sleep
@@ -131,4 +173,5 @@ int main(void)
         // Toggle pin to check CPU activity
         // check_cpu_activity();
     }
+    #endif
 }
@@ -97,4 +97,20 @@
 
 #include "usr_leds.h"
 
+// Per-link statistics
+#include "usr_link_stats.h"
+#include "usr_battery.h"
+#include "usr_backlog.h"
+#include "usr_spool.h"
+#include "usr_sim.h"
+#include "usr_trace.h"
+#include "usr_latency.h"
+#include "usr_prof.h"
+#include "usr_telemetry.h"
+#include "usr_evlog.h"
+#include "usr_rtos.h"
+#include "usr_evq.h"
+#include "usr_boot.h"
+#include "usr_warm.h"
+
 #endif
@@ -193,7 +193,7 @@
 
 // <o> NRF_BLE_GQ_DATAPOOL_ELEMENT_COUNT - Default number of elements in the pool of memory objects. 
 #ifndef NRF_BLE_GQ_DATAPOOL_ELEMENT_COUNT
-#define NRF_BLE_GQ_DATAPOOL_ELEMENT_COUNT 8
+#define NRF_BLE_GQ_DATAPOOL_ELEMENT_COUNT NRF_SDH_BLE_CENTRAL_LINK_COUNT //8
 #endif
 
 // <o> NRF_BLE_GQ_GATTC_WRITE_MAX_DATA_LEN - Maximal size of the data inside GATTC write request (in bytes). 
@@ -299,7 +299,7 @@
 
 // <o> NRF_BLE_SCAN_NAME_CNT - Number of name filters. 
 #ifndef NRF_BLE_SCAN_NAME_CNT
-#define NRF_BLE_SCAN_NAME_CNT 4 //0
+#define NRF_BLE_SCAN_NAME_CNT 0 //4
 #endif
 
 // <o> NRF_BLE_SCAN_SHORT_NAME_CNT - Number of short name filters. 
@@ -308,8 +308,9 @@
 #endif
 
 // <o> NRF_BLE_SCAN_ADDRESS_CNT - Number of address filters. 
+// <i> One filter per sensor, follows NRF_SDH_BLE_CENTRAL_LINK_COUNT
 #ifndef NRF_BLE_SCAN_ADDRESS_CNT
-#define NRF_BLE_SCAN_ADDRESS_CNT 8//0
+#define NRF_BLE_SCAN_ADDRESS_CNT NRF_SDH_BLE_CENTRAL_LINK_COUNT //8
 #endif
 
 // <o> NRF_BLE_SCAN_APPEARANCE_CNT - Number of appearance filters. 
@@ -6254,7 +6255,7 @@
  
 
 #ifndef APP_SCHEDULER_WITH_PROFILER
-#define APP_SCHEDULER_WITH_PROFILER 0
+#define APP_SCHEDULER_WITH_PROFILER 1
 #endif
 
 // </e>
@@ -7296,7 +7297,7 @@
 // <e> NRF_FSTORAGE_ENABLED - nrf_fstorage - Flash abstraction library
 //==========================================================
 #ifndef NRF_FSTORAGE_ENABLED
-#define NRF_FSTORAGE_ENABLED 0
+#define NRF_FSTORAGE_ENABLED 1
 #endif
 // <h> nrf_fstorage - Common settings
 
@@ -11508,6 +11509,7 @@
 #endif
 
 // <o> NRF_SDH_BLE_CENTRAL_LINK_COUNT - Maximum number of central links. 
+// <i> Number of sensors of the DCU, sizes all per sensor tables (max 20 on S132/S140, 32 for the sensor mask)
 #ifndef NRF_SDH_BLE_CENTRAL_LINK_COUNT
 #define NRF_SDH_BLE_CENTRAL_LINK_COUNT 8 //4
 #endif
@@ -11516,7 +11518,7 @@
 // <i> Maximum number of total concurrent connections using the default configuration.
 
 #ifndef NRF_SDH_BLE_TOTAL_LINK_COUNT
-#define NRF_SDH_BLE_TOTAL_LINK_COUNT 8
+#define NRF_SDH_BLE_TOTAL_LINK_COUNT (NRF_SDH_BLE_PERIPHERAL_LINK_COUNT + NRF_SDH_BLE_CENTRAL_LINK_COUNT) //8
 #endif
 
 // <o> NRF_SDH_BLE_GAP_EVENT_LENGTH - GAP event length. 
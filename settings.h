@@ -6,6 +6,31 @@
 #define USR_DFU             0
 #define USR_ADVERTISING     0
 #define SOFTDEVICE_ENABLED  1
+// Spool data frames to flash when the STM32 can not keep up (nRF52840 only)
+#define USR_SPOOL           1
+// Simulated sensor fleet for load tests (COMM_CMD_SIM), keep 0 for measurements
+#define USR_SIM             0
+// Cycle counter profiler of the event handlers (COMM_CMD_REQ_PROF)
+#define USR_PROF            1
+// One task per stage instead of the superloop, set by the Makefile (make FREERTOS=1)
+#ifndef USR_FREERTOS
+#define USR_FREERTOS        0
+#endif
+// // // // // // // // // // //
+
+// // Log level per module: 0 off, 1 error, 2 warning, 3 info, 4 debug // //
+// Capped by NRF_LOG_DEFAULT_LEVEL. Builds without DEBUG keep warnings and errors of the
+// data path only, its diagnostics go to the binary event log (usr_evlog).
+#ifdef DEBUG
+#define USR_LOG_LEVEL_DATA_PATH     3
+#else
+#define USR_LOG_LEVEL_DATA_PATH     2
+#endif
+#define USR_LOG_LEVEL_BLE           USR_LOG_LEVEL_DATA_PATH
+#define USR_LOG_LEVEL_IMU_SERVICE   USR_LOG_LEVEL_DATA_PATH
+#define USR_LOG_LEVEL_COMM          USR_LOG_LEVEL_DATA_PATH
+#define USR_LOG_LEVEL_UART          USR_LOG_LEVEL_DATA_PATH
+#define USR_LOG_LEVEL_TIME_SYNC     USR_LOG_LEVEL_DATA_PATH
 // // // // // // // // // // //
 
 
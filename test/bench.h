@@ -0,0 +1,59 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: bench.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Timing helpers of the host benchmarks
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Keeps the results of the benchmarked calls alive
+static volatile uint32_t m_bench_sink;
+
+static inline double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// Best of a few runs, the host is not idle
+#define BENCH_RUNS                  5
+
+#define BENCH(name, iterations, samples_per_iteration, body)                    \
+    do {                                                                        \
+        double _best = 0.0;                                                     \
+        for (int _run = 0; _run < BENCH_RUNS; _run++) {                         \
+            double _start = bench_now_ns();                                     \
+            for (uint32_t i = 0; i < (iterations); i++) {                       \
+                body;                                                           \
+            }                                                                   \
+            double _ns = (bench_now_ns() - _start) /                            \
+                         ((double) (iterations) * (samples_per_iteration));     \
+            if ((_run == 0) || (_ns < _best)) _best = _ns;                      \
+        }                                                                       \
+        printf("%-24s %8.1f ns/sample\n", (name), _best);                       \
+    } while (0)
+
+#endif
@@ -0,0 +1,67 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: bench_frame.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host benchmark of the DATA frame encoders (usr_frame)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "usr_frame.h"
+
+#define ITERATIONS                  2000000
+
+// As in comm_send_emg: a notification of 40 samples in two frames
+#define EMG_NOTIFICATION_SAMPLES    40
+#define EMG_BENCH_FRAME_SAMPLES     20
+
+int main(void)
+{
+    static uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    static uint32_t emg[EMG_NOTIFICATION_SAMPLES];
+    stm32_quat_t quat = { 1 << 30, 12345, -6789, 1 << 20 };
+    stm32_raw_t raw = { { 1, -2, 3 }, { -4, 5, -6 }, { 7, -8, 9 } };
+
+    for (uint32_t i = 0; i < EMG_NOTIFICATION_SAMPLES; i++)
+    {
+        emg[i] = i * 0x10203;
+    }
+
+    printf("quat frame %u B, raw frame %u B, EMG frame %u B\n",
+           (unsigned) USR_FRAME_QUAT_LEN, (unsigned) USR_FRAME_RAW_LEN,
+           (unsigned) USR_FRAME_EMG_LEN(EMG_BENCH_FRAME_SAMPLES));
+
+    BENCH("usr_frame_quat", ITERATIONS, 1,
+          quat.w = (int32_t) i;
+          m_bench_sink += usr_frame_quat(frame, 0, &quat, i) + frame[USR_FRAME_QUAT_LEN-1]);
+
+    BENCH("usr_frame_raw", ITERATIONS, 1,
+          raw.accel.x = (int16_t) i;
+          m_bench_sink += usr_frame_raw(frame, 0, &raw, i) + frame[USR_FRAME_RAW_LEN-1]);
+
+    BENCH("usr_frame_emg", ITERATIONS / 10, EMG_NOTIFICATION_SAMPLES,
+          emg[0] = i;
+          for (uint8_t first = 0; first < EMG_NOTIFICATION_SAMPLES; first += EMG_BENCH_FRAME_SAMPLES)
+          {
+              m_bench_sink += usr_frame_emg(frame, 0, i, emg, first, EMG_BENCH_FRAME_SAMPLES) + frame[2];
+          });
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: bench_joint.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host benchmark of the relative orientation of sensor pairs (usr_joint)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "usr_joint.h"
+
+#define ITERATIONS                  2000000
+
+int main(void)
+{
+    usr_quat_q30_t a = { 759250125, 379625062, -455550075, 227775037 };
+    usr_quat_q30_t b = { 928476690, -154746115, 309492230, 464238345 };
+    usr_quat_q30_t rel;
+    int16_t angles[3];
+
+    BENCH("usr_joint_relative", ITERATIONS, 1,
+          a.x ^= (int32_t) (i & 1);
+          usr_joint_relative(&a, &b, &rel);
+          m_bench_sink += (uint32_t) rel.w);
+
+    BENCH("usr_joint_angles", ITERATIONS, 1,
+          rel.x ^= (int32_t) (i & 1);
+          usr_joint_angles(&rel, angles);
+          m_bench_sink += (uint32_t) angles[0]);
+
+    return 0;
+}
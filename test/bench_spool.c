@@ -0,0 +1,76 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: bench_spool.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Benchmarks of usr_spool on a RAM flash (sdk/sdk_fake.c)
+ *
+ *               The fake flash completes at memcpy speed, so these measure the
+ *               CPU cost of spooling only, not the nRF52840 write time.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "sdk_fake.h"
+#include "usr_spool.h"
+
+#define ITERATIONS                  2000000
+
+// Quaternion frame
+#define FRAME_LEN                   30
+#define DRAIN_FRAMES                (8 * USR_SPOOL_PAGE_SIZE / (5 + FRAME_LEN))
+
+int main(void)
+{
+    static uint8_t frame[256];
+    uint32_t seq;
+    uint8_t len;
+
+    sdk_fake_flash_init();
+    usr_spool_init(NULL);
+
+    // Wraps the spool many times, the oldest pages are dropped
+    BENCH("usr_spool_put", ITERATIONS, 1,
+          frame[0] = (uint8_t) i;
+          usr_spool_put(i, frame, FRAME_LEN);
+          sdk_fake_flash_process());
+
+    while (usr_spool_next(&seq, frame, &len))
+    {
+    }
+
+    // Drained right away, from RAM
+    BENCH("usr_spool_next (RAM)", ITERATIONS, 1,
+          usr_spool_put(i, frame, FRAME_LEN);
+          m_bench_sink += usr_spool_next(&seq, frame, &len) + seq);
+
+    // Eight pages spooled, then drained from flash
+    BENCH("usr_spool put + next", ITERATIONS / DRAIN_FRAMES / 10, DRAIN_FRAMES,
+          for (uint32_t s = 0; s < DRAIN_FRAMES; s++)
+          {
+              usr_spool_put(s, frame, FRAME_LEN);
+              sdk_fake_flash_process();
+          }
+          while (usr_spool_next(&seq, frame, &len))
+          {
+              m_bench_sink += seq;
+          });
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: notif_frames.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: DATA frames of a decoded notification, shared by the host tools
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "notif_frames.h"
+
+#include "nordic_common.h"
+#include "usr_frame.h"
+#include "usr_internal_comm.h"
+
+uint32_t notif_frames(ble_imu_service_c_evt_t const * p_evt, uint8_t sensor_nr, uint64_t real_time, uint32_t offset,
+                      notif_frame_handler_t handler, void * p_context)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t len;
+
+    switch (p_evt->evt_type)
+    {
+        case BLE_IMU_SERVICE_EVT_QUAT:
+            for (uint8_t i = 0; i < BLE_PACKET_BUFFER_COUNT; i++)
+            {
+                ble_imu_service_single_quat_t const * quat = &p_evt->params.value.quat_data.quat[i];
+                stm32_quat_t q = { quat->w, quat->x, quat->y, quat->z };
+
+                len = usr_frame_quat(frame, sensor_nr, &q, usr_frame_total_time(real_time, offset, quat->timestamp_ms));
+                handler(frame, len, p_context);
+            }
+            return BLE_PACKET_BUFFER_COUNT;
+
+        case BLE_IMU_SERVICE_EVT_EULER:
+        {
+            ble_imu_service_euler_t const * euler = &p_evt->params.value.euler_data;
+            int32_t q16[3] = { euler->roll, euler->pitch, euler->yaw };
+
+            len = usr_frame_euler(frame, sensor_nr, q16, usr_frame_total_time(real_time, offset, euler->timestamp_ms));
+            handler(frame, len, p_context);
+        }
+        return 1;
+
+        case BLE_IMU_SERVICE_EVT_RAW:
+            for (uint8_t i = 0; i < BLE_PACKET_BUFFER_COUNT; i++)
+            {
+                ble_imu_service_single_raw_t const * single = &p_evt->params.value.raw_data.single_raw[i];
+                stm32_raw_t raw = { { single->accel.x, single->accel.y, single->accel.z },
+                                    { single->gyro.x, single->gyro.y, single->gyro.z },
+                                    { single->compass.x, single->compass.y, single->compass.z } };
+
+                len = usr_frame_raw(frame, sensor_nr, &raw, usr_frame_total_time(real_time, offset, single->timestamp_ms));
+                handler(frame, len, p_context);
+            }
+            return BLE_PACKET_BUFFER_COUNT;
+
+        case BLE_IMU_SERVICE_EVT_ADC:
+        {
+            // One timestamp for the whole notification
+            ble_imu_service_adc_t const * adc = &p_evt->params.value.adc_data;
+            uint64_t time = usr_frame_total_time(real_time, offset, adc->timestamp_ms);
+
+            for (uint8_t first = 0; first < BLE_IMU_SERVICE_ADC_SAMPLES; first += EMG_FRAME_SAMPLES)
+            {
+                uint8_t count = MIN(EMG_FRAME_SAMPLES, (size_t) (BLE_IMU_SERVICE_ADC_SAMPLES - first));
+
+                len = usr_frame_emg(frame, sensor_nr, time, adc->raw, first, count);
+                handler(frame, len, p_context);
+            }
+        }
+        return BLE_IMU_SERVICE_ADC_SAMPLES;
+
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,39 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: notif_frames.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: DATA frames of a decoded notification, shared by the host tools
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _NOTIF_FRAMES_H_
+#define _NOTIF_FRAMES_H_
+
+#include <stdint.h>
+
+#include "ble_imu_service_c.h"
+
+// Receives every frame of a notification
+typedef void (*notif_frame_handler_t)(uint8_t * p_frame, uint32_t len, void * p_context);
+
+// Frames built as comm_process does, with the STM32 time of calculate_total_time.
+// INFO notifications (CONFIG frames) are left out. Returns the samples, 0 without DATA frames.
+uint32_t notif_frames(ble_imu_service_c_evt_t const * p_evt, uint8_t sensor_nr, uint64_t real_time, uint32_t offset,
+                      notif_frame_handler_t handler, void * p_context);
+
+#endif
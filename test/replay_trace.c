@@ -0,0 +1,295 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: replay_trace.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Replay of a notification trace (usr_trace) through the decoding of
+ *               the IMU service client and the DATA frame encoders (usr_frame)
+ *
+ *               The frames are built as comm_process does, the output is
+ *               compared byte for byte with a golden file. INFO notifications
+ *               (CONFIG frames) are counted, not replayed. Without a device
+ *               list, sensor_nr is the order in which a connection first shows up.
+ *
+ *                 replay_trace <trace> <golden>       compare
+ *                 replay_trace -w <trace> <golden>    write the golden file
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "nordic_common.h"
+#include "ble_imu_service_c.h"
+#include "notif_frames.h"
+#include "usr_trace.h"
+
+// STM32 time at the start of the replayed measurement
+#define REPLAY_REAL_TIME            1000000000ULL
+#define REPLAY_OFFSET_TIME          250
+#define REPLAY_BENCH_RUNS           200
+#define REPLAY_SENSORS_MAX          NRF_SDH_BLE_TOTAL_LINK_COUNT
+
+typedef struct
+{
+    uint32_t records;
+    uint32_t notifs;
+    uint32_t samples;
+    uint32_t frames;
+    uint32_t info;              // Not replayed
+    uint32_t rejected;          // Refused by the decoding (length, characteristic)
+    uint64_t start_ticks;       // Arrival tick (16 MHz) of the first record
+    uint64_t ticks;             // Of the last record
+} replay_stats_t;
+
+static uint8_t * file_read(char const * p_path, uint32_t * p_len)
+{
+    FILE * p_file = fopen(p_path, "rb");
+    if (p_file == NULL)
+    {
+        return NULL;
+    }
+
+    fseek(p_file, 0, SEEK_END);
+    long len = ftell(p_file);
+    fseek(p_file, 0, SEEK_SET);
+
+    uint8_t * p_data = malloc((len > 0) ? (size_t) len : 1);
+    if ((p_data != NULL) && (fread(p_data, 1, (size_t) len, p_file) != (size_t) len))
+    {
+        free(p_data);
+        p_data = NULL;
+    }
+    fclose(p_file);
+
+    *p_len = (uint32_t) len;
+    return p_data;
+}
+
+static uint8_t sensor_nr_get(uint8_t * p_slots, uint8_t conn_handle)
+{
+    for (uint8_t i = 0; i < REPLAY_SENSORS_MAX; i++)
+    {
+        if ((p_slots[i] == conn_handle) || (p_slots[i] == USR_TRACE_REC_TICK))
+        {
+            p_slots[i] = conn_handle;
+            return i;
+        }
+    }
+    return USR_TRACE_REC_TICK;
+}
+
+// Appends a frame to the output
+typedef struct
+{
+    uint8_t *        p_out;
+    uint32_t         len;
+    replay_stats_t * p_stats;
+} replay_out_t;
+
+static void frame_out(uint8_t * p_frame, uint32_t len, void * p_context)
+{
+    replay_out_t * p_out = p_context;
+
+    if (p_out->p_out != NULL)
+    {
+        memcpy(p_out->p_out + p_out->len, p_frame, len);
+    }
+    p_out->len += len;
+    p_out->p_stats->frames++;
+}
+
+// Frames of the whole trace into p_out (NULL to only count). false on a truncated record.
+static bool replay(uint8_t const * p_trace, uint32_t trace_len, uint8_t * p_out, uint32_t * p_out_len, replay_stats_t * p_stats)
+{
+    replay_out_t out = { .p_out = p_out, .len = 0, .p_stats = p_stats };
+    uint8_t slots[REPLAY_SENSORS_MAX];
+    uint32_t pos = 0;
+
+    memset(p_stats, 0, sizeof(replay_stats_t));
+    memset(slots, USR_TRACE_REC_TICK, sizeof(slots));
+    *p_out_len = 0;
+
+    while (pos < trace_len)
+    {
+        if (trace_len - pos < USR_TRACE_REC_HDR_LEN)
+        {
+            return false;
+        }
+
+        uint8_t const * p_hdr = p_trace + pos;
+        uint32_t delta_ticks;
+        memcpy(&delta_ticks, p_hdr, sizeof(delta_ticks));
+        uint8_t conn_handle = p_hdr[4];
+        uint8_t evt_type = p_hdr[5];
+        uint8_t len = p_hdr[6];
+
+        if (trace_len - pos - USR_TRACE_REC_HDR_LEN < len)
+        {
+            return false;
+        }
+        uint8_t const * p_payload = p_hdr + USR_TRACE_REC_HDR_LEN;
+        pos += USR_TRACE_REC_HDR_LEN + len;
+        p_stats->records++;
+
+        if (evt_type == USR_TRACE_REC_TICK)
+        {
+            if (len == sizeof(uint64_t))
+            {
+                memcpy(&p_stats->ticks, p_payload, sizeof(uint64_t));
+                if (p_stats->records == 1)
+                {
+                    p_stats->start_ticks = p_stats->ticks;
+                }
+            }
+            continue;
+        }
+        p_stats->ticks += delta_ticks;
+        p_stats->notifs++;
+
+        ble_imu_service_c_evt_t evt;
+        uint8_t sensor_nr = sensor_nr_get(slots, conn_handle);
+        if ((sensor_nr == USR_TRACE_REC_TICK) ||
+            (ble_imu_service_c_notif_decode((ble_imu_service_c_evt_type_t) evt_type, p_payload, len, &evt) != NRF_SUCCESS))
+        {
+            p_stats->rejected++;
+            continue;
+        }
+        evt.conn_handle = conn_handle;
+
+        uint32_t samples = notif_frames(&evt, sensor_nr, REPLAY_REAL_TIME, REPLAY_OFFSET_TIME, frame_out, &out);
+        if (samples == 0)
+        {
+            p_stats->info++;
+        }
+        p_stats->samples += samples;
+    }
+
+    *p_out_len = out.len;
+    return true;
+}
+
+// First difference, reported with the frame it is in
+static bool golden_compare(uint8_t const * p_out, uint32_t out_len, uint8_t const * p_golden, uint32_t golden_len)
+{
+    uint32_t frame_start = 0;
+    uint32_t frame = 0;
+
+    for (uint32_t i = 0; i < MIN(out_len, golden_len); i++)
+    {
+        if (i == frame_start + p_golden[frame_start + 1])
+        {
+            frame_start = i;
+            frame++;
+        }
+        if (p_out[i] != p_golden[i])
+        {
+            printf("replay_trace: frame %u (byte %u of the output) differs at offset %u: 0x%02X != 0x%02X\n",
+                   (unsigned) frame, (unsigned) frame_start, (unsigned) (i - frame_start), p_out[i], p_golden[i]);
+            return false;
+        }
+    }
+
+    if (out_len != golden_len)
+    {
+        printf("replay_trace: %u bytes, golden %u bytes\n", (unsigned) out_len, (unsigned) golden_len);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char * argv[])
+{
+    bool write = (argc == 4) && (strcmp(argv[1], "-w") == 0);
+
+    if ((argc != 3) && !write)
+    {
+        printf("usage: replay_trace [-w] <trace> <golden>\n");
+        return 2;
+    }
+
+    char const * p_trace_path = argv[argc - 2];
+    char const * p_golden_path = argv[argc - 1];
+
+    uint32_t trace_len;
+    uint8_t * p_trace = file_read(p_trace_path, &trace_len);
+    if (p_trace == NULL)
+    {
+        printf("replay_trace: cannot read %s\n", p_trace_path);
+        return 2;
+    }
+
+    // Sized by a first pass
+    uint32_t out_len;
+    replay_stats_t stats;
+
+    if (!replay(p_trace, trace_len, NULL, &out_len, &stats))
+    {
+        printf("replay_trace: %s is truncated\n", p_trace_path);
+        return 2;
+    }
+
+    uint8_t * p_out = malloc(out_len + 1);
+    if (p_out == NULL)
+    {
+        return 2;
+    }
+    (void) replay(p_trace, trace_len, p_out, &out_len, &stats);
+
+    printf("%s: %u records, %u notifications (%u rejected, %u info), %u samples, %u frames, %u bytes, %.1f s\n",
+           p_trace_path, (unsigned) stats.records, (unsigned) stats.notifs, (unsigned) stats.rejected,
+           (unsigned) stats.info, (unsigned) stats.samples, (unsigned) stats.frames, (unsigned) out_len,
+           (double) (stats.ticks - stats.start_ticks) / 16e6);
+
+    if (write)
+    {
+        FILE * p_file = fopen(p_golden_path, "wb");
+        bool ok = (p_file != NULL) && (fwrite(p_out, 1, out_len, p_file) == out_len);
+        if ((p_file == NULL) || (fclose(p_file) != 0) || !ok)
+        {
+            printf("replay_trace: cannot write %s\n", p_golden_path);
+            return 2;
+        }
+        printf("replay_trace: wrote %s\n", p_golden_path);
+        return 0;
+    }
+
+    uint32_t golden_len;
+    uint8_t * p_golden = file_read(p_golden_path, &golden_len);
+    if (p_golden == NULL)
+    {
+        printf("replay_trace: cannot read %s\n", p_golden_path);
+        return 2;
+    }
+
+    if (!golden_compare(p_out, out_len, p_golden, golden_len))
+    {
+        return 1;
+    }
+
+    // Decoding and encoding cost on the recorded data
+    replay_stats_t bench_stats;
+    BENCH("replay_trace", REPLAY_BENCH_RUNS, stats.samples,
+          replay(p_trace, trace_len, p_out, &out_len, &bench_stats);
+          m_bench_sink += out_len);
+
+    printf("replay_trace: output matches %s\n", p_golden_path);
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: app_error.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header, an error check aborts the test
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef APP_ERROR_H__
+#define APP_ERROR_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sdk_errors.h"
+
+#define APP_ERROR_CHECK(err_code)                                               \
+    do {                                                                        \
+        ret_code_t _err = (err_code);                                           \
+        if (_err != NRF_SUCCESS) {                                              \
+            printf("%s:%d: APP_ERROR_CHECK %u\n", __FILE__, __LINE__,          \
+                   (unsigned) _err);                                            \
+            abort();                                                            \
+        }                                                                       \
+    } while (0)
+
+#endif
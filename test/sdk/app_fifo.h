@@ -0,0 +1,47 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: app_fifo.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header, same semantics as the SDK
+ *               module (sdk/uart_fake.c)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef APP_FIFO_H__
+#define APP_FIFO_H__
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+typedef struct
+{
+    uint8_t *          p_buf;
+    uint16_t           buf_size_mask;   // Size - 1, the size is a power of two
+    volatile uint32_t  read_pos;
+    volatile uint32_t  write_pos;
+} app_fifo_t;
+
+ret_code_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size);
+ret_code_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte);
+ret_code_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte);
+// p_byte_array NULL: *p_size is set to the free space (write) or the used space (read)
+ret_code_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size);
+ret_code_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size);
+
+#endif
@@ -0,0 +1,142 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: ble.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the SoftDevice header, the events used by the
+ *               IMU service client (values of S140 v7)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef BLE_H__
+#define BLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+#define BLE_CONN_HANDLE_INVALID     0xFFFF
+#define BLE_GAP_ADDR_LEN            6
+#define BLE_GATT_HANDLE_INVALID     0x0000
+#define BLE_GATT_ATT_MTU_DEFAULT    23
+#define BLE_GATT_HVX_NOTIFICATION   0x01
+#define BLE_UUID_TYPE_BLE           0x01
+#define BLE_UUID_TYPE_VENDOR_BEGIN  0x02
+
+enum
+{
+    BLE_GAP_EVT_CONNECTED       = 0x10,
+    BLE_GAP_EVT_DISCONNECTED    = 0x11,
+};
+
+enum
+{
+    BLE_GATTC_EVT_READ_RSP      = 0x36,
+    BLE_GATTC_EVT_WRITE_RSP     = 0x38,
+    BLE_GATTC_EVT_HVX           = 0x39,
+};
+
+typedef struct
+{
+    uint16_t uuid;
+    uint8_t  type;
+} ble_uuid_t;
+
+typedef struct
+{
+    uint8_t uuid128[16];
+} ble_uuid128_t;
+
+typedef struct
+{
+    uint8_t  role;
+    uint16_t conn_sup_timeout;
+} ble_gap_evt_connected_t;
+
+typedef struct
+{
+    uint8_t reason;
+} ble_gap_evt_disconnected_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    union
+    {
+        ble_gap_evt_connected_t    connected;
+        ble_gap_evt_disconnected_t disconnected;
+    } params;
+} ble_gap_evt_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint8_t  type;
+    uint16_t len;
+    uint8_t  data[1];           // Variable length
+} ble_gattc_evt_hvx_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint16_t offset;
+    uint16_t len;
+    uint8_t  data[1];           // Variable length
+} ble_gattc_evt_read_rsp_t;
+
+typedef struct
+{
+    uint16_t handle;
+    uint8_t  write_op;
+    uint16_t offset;
+    uint16_t len;
+    uint8_t  data[1];           // Variable length
+} ble_gattc_evt_write_rsp_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    uint16_t gatt_status;
+    uint16_t error_handle;
+    union
+    {
+        ble_gattc_evt_hvx_t       hvx;
+        ble_gattc_evt_read_rsp_t  read_rsp;
+        ble_gattc_evt_write_rsp_t write_rsp;
+    } params;
+} ble_gattc_evt_t;
+
+typedef struct
+{
+    uint16_t evt_id;
+    uint16_t evt_len;
+} ble_evt_hdr_t;
+
+typedef struct
+{
+    ble_evt_hdr_t header;
+    union
+    {
+        ble_gap_evt_t   gap_evt;
+        ble_gattc_evt_t gattc_evt;
+    } evt;
+} ble_evt_t;
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type);
+
+#endif
@@ -0,0 +1,76 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: ble_db_discovery.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef BLE_DB_DISCOVERY_H__
+#define BLE_DB_DISCOVERY_H__
+
+#include <stdint.h>
+
+#include "ble.h"
+#include "nrf_ble_gq.h"
+#include "sdk_errors.h"
+
+#define BLE_GATT_DB_MAX_CHARS       6
+
+typedef enum
+{
+    BLE_DB_DISCOVERY_COMPLETE,
+    BLE_DB_DISCOVERY_ERROR,
+    BLE_DB_DISCOVERY_SRV_NOT_FOUND,
+    BLE_DB_DISCOVERY_AVAILABLE
+} ble_db_discovery_evt_type_t;
+
+typedef struct
+{
+    ble_uuid_t uuid;
+    uint16_t   handle_decl;
+    uint16_t   handle_value;
+} ble_gattc_char_t;
+
+typedef struct
+{
+    ble_gattc_char_t characteristic;
+    uint16_t         cccd_handle;
+} ble_gatt_db_char_t;
+
+typedef struct
+{
+    ble_uuid_t         srv_uuid;
+    uint8_t            char_count;
+    ble_gatt_db_char_t charateristics[BLE_GATT_DB_MAX_CHARS];
+} ble_gatt_db_srv_t;
+
+typedef struct
+{
+    ble_db_discovery_evt_type_t evt_type;
+    uint16_t                    conn_handle;
+    union
+    {
+        ble_gatt_db_srv_t discovered_db;
+        uint32_t          err_code;
+    } params;
+} ble_db_discovery_evt_t;
+
+ret_code_t ble_db_discovery_evt_register(ble_uuid_t const * p_uuid);
+
+#endif
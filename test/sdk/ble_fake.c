@@ -0,0 +1,59 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: ble_fake.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host implementation of the SoftDevice and BLE library stand-ins
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stddef.h>
+
+#include "ble.h"
+#include "ble_db_discovery.h"
+#include "nrf_ble_gq.h"
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type)
+{
+    if ((p_vs_uuid == NULL) || (p_uuid_type == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    *p_uuid_type = BLE_UUID_TYPE_VENDOR_BEGIN;
+    return NRF_SUCCESS;
+}
+
+ret_code_t ble_db_discovery_evt_register(ble_uuid_t const * p_uuid)
+{
+    return (p_uuid == NULL) ? NRF_ERROR_NULL : NRF_SUCCESS;
+}
+
+ret_code_t nrf_ble_gq_conn_handle_register(nrf_ble_gq_t * p_gatt_queue, uint16_t conn_handle)
+{
+    if (p_gatt_queue == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (conn_handle == BLE_CONN_HANDLE_INVALID)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    p_gatt_queue->links++;
+    return NRF_SUCCESS;
+}
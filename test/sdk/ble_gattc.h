@@ -0,0 +1,39 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: ble_gattc.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the SoftDevice header
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef BLE_GATTC_H__
+#define BLE_GATTC_H__
+
+#include "ble.h"
+
+typedef struct
+{
+    uint8_t         write_op;
+    uint8_t         flags;
+    uint16_t        handle;
+    uint16_t        offset;
+    uint16_t        len;
+    uint8_t const * p_value;
+} ble_gattc_write_params_t;
+
+#endif
@@ -0,0 +1,37 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: nrf.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the MDK header, the cycle counter only
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef NRF_H__
+#define NRF_H__
+
+#include <stdint.h>
+
+typedef struct
+{
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type sdk_fake_dwt;
+#define DWT                         (&sdk_fake_dwt)
+
+#endif
@@ -0,0 +1,38 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: nrf_ble_gq.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef NRF_BLE_GQ_H__
+#define NRF_BLE_GQ_H__
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+typedef struct
+{
+    uint32_t links;             // Connection handles registered
+} nrf_ble_gq_t;
+
+ret_code_t nrf_ble_gq_conn_handle_register(nrf_ble_gq_t * p_gatt_queue, uint16_t conn_handle);
+
+#endif
@@ -0,0 +1,108 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: nrf_libuarte_async.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header, transfers are timed by
+ *               sdk/uart_fake.c (see sdk_fake.h)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef NRF_LIBUARTE_ASYNC_H__
+#define NRF_LIBUARTE_ASYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+
+#define NRF_LIBUARTE_PERIPHERAL_NOT_USED    255
+
+// The bit rate itself, not the register value
+typedef enum
+{
+    NRF_UARTE_BAUDRATE_115200   = 115200,
+    NRF_UARTE_BAUDRATE_1000000  = 1000000
+} nrf_uarte_baudrate_t;
+
+typedef enum
+{
+    NRF_UARTE_PARITY_EXCLUDED,
+    NRF_UARTE_PARITY_INCLUDED
+} nrf_uarte_parity_t;
+
+typedef enum
+{
+    NRF_UARTE_HWFC_DISABLED,
+    NRF_UARTE_HWFC_ENABLED
+} nrf_uarte_hwfc_t;
+
+typedef enum
+{
+    NRF_LIBUARTE_ASYNC_EVT_RX_DATA,
+    NRF_LIBUARTE_ASYNC_EVT_TX_DONE,
+    NRF_LIBUARTE_ASYNC_EVT_ERROR,
+    NRF_LIBUARTE_ASYNC_EVT_OVERRUN_ERROR
+} nrf_libuarte_async_evt_type_t;
+
+typedef struct
+{
+    uint8_t * p_data;
+    size_t    length;
+} nrf_libuarte_async_data_t;
+
+typedef struct
+{
+    nrf_libuarte_async_evt_type_t type;
+    union
+    {
+        nrf_libuarte_async_data_t rxtx;
+        uint32_t                  errorsrc;
+    } data;
+} nrf_libuarte_async_evt_t;
+
+typedef void (*nrf_libuarte_async_evt_handler_t)(void * context, nrf_libuarte_async_evt_t * p_evt);
+
+typedef struct
+{
+    uint32_t             tx_pin;
+    uint32_t             rx_pin;
+    nrf_uarte_baudrate_t baudrate;
+    nrf_uarte_parity_t   parity;
+    nrf_uarte_hwfc_t     hwfc;
+    uint32_t             timeout_us;
+    uint8_t              int_prio;
+} nrf_libuarte_async_config_t;
+
+typedef struct
+{
+    nrf_libuarte_async_evt_handler_t evt_handler;
+    void *                           context;
+    uint32_t                         baudrate;
+} nrf_libuarte_async_t;
+
+#define NRF_LIBUARTE_ASYNC_DEFINE(_name, _uarte_idx, _timer0_idx, _rtc1_idx, _timer1_idx, _rx_buf_size, _rx_buf_cnt) \
+    static nrf_libuarte_async_t _name
+
+ret_code_t nrf_libuarte_async_init(nrf_libuarte_async_t * const p_libuarte, nrf_libuarte_async_config_t const * p_config,
+                                   nrf_libuarte_async_evt_handler_t evt_handler, void * context);
+void nrf_libuarte_async_enable(nrf_libuarte_async_t * const p_libuarte);
+ret_code_t nrf_libuarte_async_tx(nrf_libuarte_async_t * const p_libuarte, uint8_t * p_data, size_t length);
+void nrf_libuarte_async_rx_free(nrf_libuarte_async_t * const p_libuarte, uint8_t * p_data, size_t length);
+
+#endif
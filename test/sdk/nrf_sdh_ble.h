@@ -0,0 +1,38 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: nrf_sdh_ble.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header, values of the pca10056 sdk_config
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef NRF_SDH_BLE_H__
+#define NRF_SDH_BLE_H__
+
+#include "ble.h"
+
+#define NRF_SDH_BLE_CENTRAL_LINK_COUNT      20
+#define NRF_SDH_BLE_PERIPHERAL_LINK_COUNT   0
+#define NRF_SDH_BLE_TOTAL_LINK_COUNT        (NRF_SDH_BLE_PERIPHERAL_LINK_COUNT + NRF_SDH_BLE_CENTRAL_LINK_COUNT)
+#define NRF_SDH_BLE_GATT_MAX_MTU_SIZE       247
+
+// Events are passed to the handlers by the test
+#define NRF_SDH_BLE_OBSERVER(_name, _prio, _handler, _context)
+#define NRF_SDH_BLE_OBSERVERS(_name, _prio, _handler, _context, _cnt)
+
+#endif
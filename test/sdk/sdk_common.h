@@ -0,0 +1,51 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: sdk_common.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host stand-in of the nRF5 SDK header
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "sdk_errors.h"
+#include "nordic_common.h"
+
+#define LSB_16(a)                   ((uint8_t) ((a) & 0x00FF))
+#define MSB_16(a)                   ((uint8_t) (((a) & 0xFF00) >> 8))
+
+#define VERIFY_PARAM_NOT_NULL(p)                                                \
+    do {                                                                        \
+        if ((p) == NULL) {                                                      \
+            return NRF_ERROR_NULL;                                              \
+        }                                                                       \
+    } while (0)
+
+#define VERIFY_SUCCESS(err_code)                                                \
+    do {                                                                        \
+        if ((err_code) != NRF_SUCCESS) {                                        \
+            return (err_code);                                                  \
+        }                                                                       \
+    } while (0)
+
+#endif
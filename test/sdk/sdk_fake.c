@@ -0,0 +1,326 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: sdk_fake.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host implementation of the SDK stand-ins, see sdk_fake.h
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "sdk_fake.h"
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "app_error.h"
+#include "app_timer.h"
+#include "nrf_fstorage.h"
+#include "nrf_fstorage_sd.h"
+#include "usr_evq.h"
+
+// NRF_FSTORAGE_SD_QUEUE_SIZE of the sdk_config
+#define FLASH_QUEUE_SIZE            4
+#define FLASH_PAGE_SIZE             4096
+#define MAX_TIMERS                  8
+
+typedef struct
+{
+    nrf_fstorage_evt_id_t  id;
+    nrf_fstorage_t const * p_fs;
+    uint32_t               addr;
+    void const *           p_src;
+    uint32_t               len;
+} flash_op_t;
+
+nrf_fstorage_api_t nrf_fstorage_sd;
+
+static uint8_t * m_flash = NULL;
+
+static flash_op_t m_queue[FLASH_QUEUE_SIZE];
+static uint32_t   m_queue_head = 0;
+static uint32_t   m_queue_count = 0;
+static bool       m_fail_next = false;
+
+static uint32_t       m_ticks = 0;
+static app_timer_t *  m_timers[MAX_TIMERS];
+static uint32_t       m_timer_count = 0;
+
+
+void sdk_fake_flash_init(void)
+{
+    if (m_flash == NULL)
+    {
+        m_flash = mmap(NULL, SDK_FAKE_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (m_flash == MAP_FAILED)
+        {
+            APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+        }
+    }
+    memset(m_flash, 0xFF, SDK_FAKE_FLASH_SIZE);
+}
+
+uint8_t * sdk_fake_flash(void)
+{
+    return m_flash;
+}
+
+uint32_t sdk_fake_flash_pending(void)
+{
+    return m_queue_count;
+}
+
+static void flash_program(uint32_t addr, void const * p_src, uint32_t len)
+{
+    uint8_t const * p_byte = p_src;
+
+    // Programming only clears bits
+    for (uint32_t i = 0; i < len; i++)
+    {
+        m_flash[addr + i] &= p_byte[i];
+    }
+}
+
+static flash_op_t queue_pop(void)
+{
+    flash_op_t op = m_queue[m_queue_head];
+    m_queue_head = (m_queue_head + 1) % FLASH_QUEUE_SIZE;
+    m_queue_count--;
+    return op;
+}
+
+bool sdk_fake_flash_step(void)
+{
+    if (m_queue_count == 0)
+    {
+        return false;
+    }
+
+    flash_op_t op = queue_pop();
+    nrf_fstorage_evt_t evt = { .id = op.id, .result = NRF_SUCCESS, .addr = op.addr, .p_src = op.p_src, .len = op.len };
+
+    if (m_fail_next)
+    {
+        m_fail_next = false;
+        evt.result = NRF_ERROR_INTERNAL;
+    }
+    else if (op.id == NRF_FSTORAGE_EVT_ERASE_RESULT)
+    {
+        memset(m_flash + op.addr, 0xFF, op.len * FLASH_PAGE_SIZE);
+        m_ticks += APP_TIMER_TICKS(SDK_FAKE_ERASE_MS * op.len);
+    }
+    else
+    {
+        flash_program(op.addr, op.p_src, op.len);
+        m_ticks += APP_TIMER_TICKS(SDK_FAKE_WRITE_MS_PER_PAGE * op.len / FLASH_PAGE_SIZE);
+    }
+
+    if (op.p_fs->evt_handler != NULL)
+    {
+        op.p_fs->evt_handler(&evt);
+    }
+
+    return true;
+}
+
+void sdk_fake_flash_process(void)
+{
+    while (sdk_fake_flash_step())
+    {
+    }
+}
+
+void sdk_fake_flash_tear(uint32_t len)
+{
+    if (m_queue_count == 0)
+    {
+        return;
+    }
+
+    flash_op_t op = queue_pop();
+    if (op.id == NRF_FSTORAGE_EVT_WRITE_RESULT)
+    {
+        flash_program(op.addr, op.p_src, (len < op.len) ? len : op.len);
+    }
+}
+
+void sdk_fake_flash_fail_next(void)
+{
+    m_fail_next = true;
+}
+
+static ret_code_t flash_check(nrf_fstorage_t const * p_fs, uint32_t addr, uint32_t len)
+{
+    if ((p_fs == NULL) || (m_flash == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    if ((addr < p_fs->start_addr) || (addr + len > p_fs->end_addr) || (addr + len > SDK_FAKE_FLASH_SIZE))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    return NRF_SUCCESS;
+}
+
+static ret_code_t queue_push(flash_op_t const * p_op)
+{
+    if (m_queue_count == FLASH_QUEUE_SIZE)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_queue[(m_queue_head + m_queue_count) % FLASH_QUEUE_SIZE] = *p_op;
+    m_queue_count++;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_fstorage_init(nrf_fstorage_t * p_fs, nrf_fstorage_api_t const * p_api, void * p_param)
+{
+    (void) p_param;
+
+    if ((p_fs == NULL) || (p_api == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    p_fs->p_api = p_api;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_fstorage_read(nrf_fstorage_t const * p_fs, uint32_t addr, void * p_dest, uint32_t len)
+{
+    ret_code_t err_code = flash_check(p_fs, addr, len);
+    if (err_code == NRF_SUCCESS)
+    {
+        memcpy(p_dest, m_flash + addr, len);
+    }
+    return err_code;
+}
+
+ret_code_t nrf_fstorage_write(nrf_fstorage_t const * p_fs, uint32_t dest, void const * p_src, uint32_t len, void * p_param)
+{
+    (void) p_param;
+
+    if ((dest % 4 != 0) || (len % 4 != 0) || (len == 0))
+    {
+        return (len % 4 != 0) ? NRF_ERROR_INVALID_LENGTH : NRF_ERROR_INVALID_ADDR;
+    }
+
+    ret_code_t err_code = flash_check(p_fs, dest, len);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    flash_op_t op = { .id = NRF_FSTORAGE_EVT_WRITE_RESULT, .p_fs = p_fs, .addr = dest, .p_src = p_src, .len = len };
+    return queue_push(&op);
+}
+
+ret_code_t nrf_fstorage_erase(nrf_fstorage_t const * p_fs, uint32_t page_addr, uint32_t len, void * p_param)
+{
+    (void) p_param;
+
+    if ((page_addr % FLASH_PAGE_SIZE != 0) || (len == 0))
+    {
+        return (len == 0) ? NRF_ERROR_INVALID_LENGTH : NRF_ERROR_INVALID_ADDR;
+    }
+
+    ret_code_t err_code = flash_check(p_fs, page_addr, len * FLASH_PAGE_SIZE);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    flash_op_t op = { .id = NRF_FSTORAGE_EVT_ERASE_RESULT, .p_fs = p_fs, .addr = page_addr, .len = len };
+    return queue_push(&op);
+}
+
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler)
+{
+    (void) mode;
+
+    if (m_timer_count == MAX_TIMERS)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    (*p_timer_id)->handler = timeout_handler;
+    (*p_timer_id)->running = false;
+    m_timers[m_timer_count++] = *p_timer_id;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    (void) timeout_ticks;
+    (void) p_context;
+
+    timer_id->running = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    timer_id->running = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void)
+{
+    return m_ticks & 0xFFFFFF;
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    // RTC counter is 24 bit
+    return (ticks_to - ticks_from) & 0xFFFFFF;
+}
+
+void sdk_fake_ticks_add(uint32_t ticks)
+{
+    m_ticks += ticks;
+}
+
+uint32_t sdk_fake_timers_running(void)
+{
+    uint32_t running = 0;
+
+    for (uint32_t i = 0; i < m_timer_count; i++)
+    {
+        running += m_timers[i]->running ? 1 : 0;
+    }
+    return running;
+}
+
+void sdk_fake_timers_fire(void)
+{
+    for (uint32_t i = 0; i < m_timer_count; i++)
+    {
+        if (m_timers[i]->running)
+        {
+            m_timers[i]->handler(NULL);
+        }
+    }
+}
+
+// The scheduler runs the handler right away
+ret_code_t usr_evq_put(usr_evq_class_t cls, app_sched_event_handler_t handler)
+{
+    (void) cls;
+
+    handler(NULL, 0);
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: sdk_fake.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Control of the host SDK stand-ins: RAM flash behind nrf_fstorage,
+ *               a tick counter behind app_timer, direct usr_evq dispatch
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _SDK_FAKE_H_
+#define _SDK_FAKE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Covers the whole nRF52840 flash, addresses index it directly
+#define SDK_FAKE_FLASH_SIZE         0x100000
+
+// Flash timing of the nRF52840 datasheet, added to the tick counter per operation
+#define SDK_FAKE_ERASE_MS           85
+#define SDK_FAKE_WRITE_MS_PER_PAGE  42
+
+// Shared between processes, so a forked "boot" sees what the previous one programmed.
+// Call once before the first boot, erases everything.
+void sdk_fake_flash_init(void);
+
+uint8_t * sdk_fake_flash(void);
+
+// Erase or write operations queued, as nrf_fstorage_sd
+uint32_t sdk_fake_flash_pending(void);
+
+// Completes the oldest operation (event to the handler), false when none is pending
+bool sdk_fake_flash_step(void);
+
+// Completes all operations, including those queued from the event handler
+void sdk_fake_flash_process(void);
+
+// Power loss during the oldest operation: only the first len bytes of a write
+// are programmed, no event follows
+void sdk_fake_flash_tear(uint32_t len);
+
+// Fails the next operation (event with NRF_ERROR_INTERNAL)
+void sdk_fake_flash_fail_next(void);
+
+void sdk_fake_ticks_add(uint32_t ticks);
+
+// Timers created and started
+uint32_t sdk_fake_timers_running(void);
+
+// Expires all running timers once
+void sdk_fake_timers_fire(void);
+
+// Bytes of a finished UART transfer, at the time its TX_DONE is given
+typedef void (*sdk_fake_uart_tx_handler_t)(uint8_t const * p_data, uint32_t len, uint64_t time_ns);
+
+// Transfers take 10 bits per byte at the configured rate
+void sdk_fake_uart_capture(sdk_fake_uart_tx_handler_t handler);
+
+// Runs the UART up to time_ns: TX_DONE of every transfer finished by then
+void sdk_fake_uart_run(uint64_t time_ns);
+
+#endif
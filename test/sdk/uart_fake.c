@@ -0,0 +1,201 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: uart_fake.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host implementation of app_fifo and libuarte, see sdk_fake.h
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include "sdk_fake.h"
+
+#include <string.h>
+
+#include "app_fifo.h"
+#include "nordic_common.h"
+#include "nrf.h"
+#include "nrf_libuarte_async.h"
+
+#define UART_BITS_PER_BYTE          10
+
+DWT_Type sdk_fake_dwt;
+
+static nrf_libuarte_async_t * mp_uart = NULL;
+static uint8_t *  mp_tx_data;
+static uint32_t   m_tx_len = 0;         // Transfer in progress
+static uint64_t   m_tx_done_ns;
+static uint64_t   m_now_ns = 0;
+static sdk_fake_uart_tx_handler_t m_capture = NULL;
+
+
+static uint32_t fifo_length(app_fifo_t const * p_fifo)
+{
+    return p_fifo->write_pos - p_fifo->read_pos;
+}
+
+ret_code_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
+{
+    if (p_buf == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if ((buf_size == 0) || ((buf_size & (buf_size - 1)) != 0))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->p_buf = p_buf;
+    p_fifo->buf_size_mask = buf_size - 1;
+    p_fifo->read_pos = 0;
+    p_fifo->write_pos = 0;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte)
+{
+    if (fifo_length(p_fifo) > p_fifo->buf_size_mask)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    p_fifo->p_buf[p_fifo->write_pos & p_fifo->buf_size_mask] = byte;
+    p_fifo->write_pos++;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
+{
+    if (fifo_length(p_fifo) == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_byte = p_fifo->p_buf[p_fifo->read_pos & p_fifo->buf_size_mask];
+    p_fifo->read_pos++;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size)
+{
+    uint32_t count = fifo_length(p_fifo);
+    uint32_t read_size = MIN(*p_size, count);
+
+    *p_size = count;
+    if (count == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (p_byte_array == NULL)
+    {
+        return NRF_SUCCESS;
+    }
+
+    for (uint32_t i = 0; i < read_size; i++)
+    {
+        (void) app_fifo_get(p_fifo, &p_byte_array[i]);
+    }
+    *p_size = read_size;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size)
+{
+    uint32_t available = p_fifo->buf_size_mask + 1 - fifo_length(p_fifo);
+    uint32_t write_size = MIN(*p_size, available);
+
+    *p_size = available;
+    if (available == 0)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    if (p_byte_array == NULL)
+    {
+        return NRF_SUCCESS;
+    }
+
+    for (uint32_t i = 0; i < write_size; i++)
+    {
+        (void) app_fifo_put(p_fifo, p_byte_array[i]);
+    }
+    *p_size = write_size;
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_libuarte_async_init(nrf_libuarte_async_t * const p_libuarte, nrf_libuarte_async_config_t const * p_config,
+                                   nrf_libuarte_async_evt_handler_t evt_handler, void * context)
+{
+    p_libuarte->evt_handler = evt_handler;
+    p_libuarte->context = context;
+    p_libuarte->baudrate = p_config->baudrate;
+    mp_uart = p_libuarte;
+    return NRF_SUCCESS;
+}
+
+void nrf_libuarte_async_enable(nrf_libuarte_async_t * const p_libuarte)
+{
+}
+
+ret_code_t nrf_libuarte_async_tx(nrf_libuarte_async_t * const p_libuarte, uint8_t * p_data, size_t length)
+{
+    if (m_tx_len != 0)
+    {
+        return NRF_ERROR_BUSY;
+    }
+    if (length == 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    mp_tx_data = p_data;
+    m_tx_len = (uint32_t) length;
+    m_tx_done_ns = m_now_ns + (uint64_t) length * UART_BITS_PER_BYTE * 1000000000ULL / p_libuarte->baudrate;
+    return NRF_SUCCESS;
+}
+
+void nrf_libuarte_async_rx_free(nrf_libuarte_async_t * const p_libuarte, uint8_t * p_data, size_t length)
+{
+}
+
+void sdk_fake_uart_capture(sdk_fake_uart_tx_handler_t handler)
+{
+    m_capture = handler;
+}
+
+void sdk_fake_uart_run(uint64_t time_ns)
+{
+    // The handler starts the next transfer from TX_DONE
+    while ((mp_uart != NULL) && (m_tx_len != 0) && (m_tx_done_ns <= time_ns))
+    {
+        nrf_libuarte_async_evt_t evt = { .type = NRF_LIBUARTE_ASYNC_EVT_TX_DONE };
+        evt.data.rxtx.p_data = mp_tx_data;
+        evt.data.rxtx.length = m_tx_len;
+
+        m_now_ns = m_tx_done_ns;
+        m_tx_len = 0;
+
+        if (m_capture != NULL)
+        {
+            m_capture(evt.data.rxtx.p_data, (uint32_t) evt.data.rxtx.length, m_now_ns);
+        }
+        mp_uart->evt_handler(mp_uart->context, &evt);
+    }
+
+    if (time_ns > m_now_ns)
+    {
+        m_now_ns = time_ns;
+    }
+}
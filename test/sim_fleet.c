@@ -0,0 +1,605 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: sim_fleet.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Load test of the data path on the host: a simulated sensor fleet
+ *
+ *               BLE events (CONNECTED, HVX, DISCONNECTED) of N sensors go into
+ *               ble_imu_service_c_on_ble_evt of every client instance, as the
+ *               SoftDevice observers do. The decoded notifications are framed
+ *               (notif_frames) and queued with uart_queued_tx_try of usr_uart,
+ *               the libuarte stand-in transmits them at 1 Mbaud in simulated
+ *               time. One sensor disconnects and reconnects halfway.
+ *               The BLE radio and the STM32 (flow control) are not modelled.
+ *
+ *                 sim_fleet                                 sweep, saturation per rate
+ *                 sim_fleet <sensors> <rate_hz> [quat|raw|euler|emg] [jitter_ms] [loss_pct] [s]
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "app_error.h"
+#include "nordic_common.h"
+#include "sdk_fake.h"
+#include "ble_imu_service_c.h"
+#include "notif_frames.h"
+#include "usr_frame.h"
+#include "usr_uart.h"
+
+#define SIM_SENSORS_MAX             NRF_SDH_BLE_CENTRAL_LINK_COUNT
+#define SIM_SECONDS                 10
+#define SIM_RECONNECT_MS            200
+#define SIM_LATENCY_RING            1024
+#define SIM_NOTIF_MAX_LEN           (BLE_IMU_SERVICE_MAX_DATA_LEN)
+
+// Handles of the IMU service, the same on every sensor
+#define SIM_HANDLE_ADC              0x10
+#define SIM_HANDLE_QUAT             0x13
+#define SIM_HANDLE_RAW              0x16
+#define SIM_HANDLE_EULER            0x19
+#define SIM_HANDLE_INFO             0x1C
+
+typedef struct
+{
+    uint8_t  sensors;
+    uint16_t rate_hz;               // Samples per second of one sensor
+    ble_imu_service_c_evt_type_t type;
+    uint16_t jitter_ms;             // Arrival spread of a notification, +-
+    uint8_t  loss_pct;              // Notifications lost over the air
+    uint32_t seconds;
+} sim_config_t;
+
+typedef struct
+{
+    uint32_t notifs;                // Delivered to the client
+    uint32_t lost;                  // Simulated loss
+    uint32_t ignored;               // Arrived after the DISCONNECTED event
+    uint32_t samples;
+    uint32_t frames;                // Queued for the UART
+    uint32_t dropped;               // UART FIFO full
+    uint32_t bad_frames;            // Start byte, length or CS wrong in the UART output
+    uint64_t offered_bytes;
+    uint64_t tx_bytes;
+    uint32_t fifo_max;
+    uint64_t fifo_sum;
+    uint64_t latency_sum_ns;        // Notification arrival to the last byte transmitted
+    uint64_t latency_max_ns;
+    uint32_t latency_count;
+    double   cpu_ns;                // Host time in the BLE event handlers
+} sim_result_t;
+
+typedef struct
+{
+    uint64_t phase_ns;              // Nominal time of the first notification
+    uint64_t next_ns;
+    uint32_t notifs;                // Sent, including the lost ones
+    bool     connected;
+} sim_sensor_t;
+
+// Frames in flight: end of the frame in the UART byte stream, arrival of its notification
+typedef struct
+{
+    uint64_t end;
+    uint64_t arrival_ns;
+} sim_inflight_t;
+
+static sim_config_t m_config;
+static sim_result_t * mp_result;
+
+static ble_imu_service_c_t m_imu[SIM_SENSORS_MAX];
+static nrf_ble_gq_t m_gatt_queue;
+static sim_sensor_t m_sensors[SIM_SENSORS_MAX];
+
+static uint64_t m_now_ns;
+static uint64_t m_queued_bytes;
+static sim_inflight_t m_inflight[SIM_LATENCY_RING];
+static uint32_t m_inflight_head;
+static uint32_t m_inflight_count;
+
+// UART output parser, frames may span transfers
+static uint8_t  m_rx_frame[USR_INTERNAL_COMM_MAX_LEN];
+static uint32_t m_rx_len;
+
+
+static uint32_t rand_below(uint32_t n)
+{
+    return (n == 0) ? 0 : (uint32_t) rand() % n;
+}
+
+static uint8_t samples_per_notif(ble_imu_service_c_evt_type_t type)
+{
+    switch (type)
+    {
+        case BLE_IMU_SERVICE_EVT_EULER:
+            return 1;
+        case BLE_IMU_SERVICE_EVT_ADC:
+            return BLE_IMU_SERVICE_ADC_SAMPLES;
+        default:
+            return BLE_PACKET_BUFFER_COUNT;
+    }
+}
+
+static uint64_t notif_period_ns(void)
+{
+    return (uint64_t) samples_per_notif(m_config.type) * 1000000000ULL / m_config.rate_hz;
+}
+
+static void uart_tx_done(uint8_t const * p_data, uint32_t len, uint64_t time_ns)
+{
+    mp_result->tx_bytes += len;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((m_rx_len == 0) && (p_data[i] != START_BYTE))
+        {
+            mp_result->bad_frames++;
+            continue;
+        }
+
+        m_rx_frame[m_rx_len++] = p_data[i];
+        if ((m_rx_len >= 2) && (m_rx_len == m_rx_frame[1]))
+        {
+            if (usr_frame_cs(m_rx_frame, m_rx_len) != m_rx_frame[m_rx_len - 1])
+            {
+                mp_result->bad_frames++;
+            }
+            m_rx_len = 0;
+        }
+        else if ((m_rx_len >= 2) && ((m_rx_frame[1] < OVERHEAD_BYTES) || (m_rx_len >= sizeof(m_rx_frame))))
+        {
+            mp_result->bad_frames++;
+            m_rx_len = 0;
+        }
+    }
+
+    while ((m_inflight_count > 0) && (m_inflight[m_inflight_head].end <= mp_result->tx_bytes))
+    {
+        uint64_t latency = time_ns - m_inflight[m_inflight_head].arrival_ns;
+
+        mp_result->latency_sum_ns += latency;
+        mp_result->latency_max_ns = MAX(mp_result->latency_max_ns, latency);
+        mp_result->latency_count++;
+
+        m_inflight_head = (m_inflight_head + 1) % SIM_LATENCY_RING;
+        m_inflight_count--;
+    }
+}
+
+// As comm_data_tx: a frame that does not fit the UART FIFO is not sent live
+static void frame_tx(uint8_t * p_frame, uint32_t len, void * p_context)
+{
+    mp_result->offered_bytes += len;
+
+    if (uart_queued_tx_try(p_frame, &len) != NRF_SUCCESS)
+    {
+        mp_result->dropped++;
+        return;
+    }
+
+    mp_result->frames++;
+    m_queued_bytes += len;
+
+    if (m_inflight_count < SIM_LATENCY_RING)
+    {
+        sim_inflight_t * p_inflight = &m_inflight[(m_inflight_head + m_inflight_count) % SIM_LATENCY_RING];
+        p_inflight->end = m_queued_bytes;
+        p_inflight->arrival_ns = m_now_ns;
+        m_inflight_count++;
+    }
+}
+
+// imu_service_c_evt_handler, sensor_nr is the device list slot
+static void imu_evt_handler(ble_imu_service_c_t * p_imu, ble_imu_service_c_evt_t * p_evt)
+{
+    uint8_t sensor_nr = (uint8_t) (p_imu - m_imu);
+
+    mp_result->notifs++;
+    mp_result->samples += notif_frames(p_evt, sensor_nr, 0, 0, frame_tx, NULL);
+}
+
+static void uart_rx_scheduled(void * p_event_data, uint16_t event_size)
+{
+}
+
+// To every client instance, as NRF_SDH_BLE_OBSERVERS
+static void ble_evt_dispatch(ble_evt_t const * p_ble_evt)
+{
+    for (uint8_t i = 0; i < m_config.sensors; i++)
+    {
+        ble_imu_service_c_on_ble_evt(p_ble_evt, &m_imu[i]);
+    }
+}
+
+static void sensor_connect(uint8_t sensor)
+{
+    ble_evt_t evt = { .header.evt_id = BLE_GAP_EVT_CONNECTED };
+    evt.evt.gap_evt.conn_handle = sensor;
+    ble_evt_dispatch(&evt);
+
+    // After the service discovery, as usr_ble
+    imu_service_db_t db =
+    {
+        .adc_handle = SIM_HANDLE_ADC, .adc_cccd_handle = SIM_HANDLE_ADC + 1,
+        .quat_handle = SIM_HANDLE_QUAT, .quat_cccd_handle = SIM_HANDLE_QUAT + 1,
+        .raw_handle = SIM_HANDLE_RAW, .raw_cccd_handle = SIM_HANDLE_RAW + 1,
+        .euler_handle = SIM_HANDLE_EULER, .euler_cccd_handle = SIM_HANDLE_EULER + 1,
+        .info_handle = SIM_HANDLE_INFO, .info_cccd_handle = SIM_HANDLE_INFO + 1,
+    };
+    APP_ERROR_CHECK(ble_imu_service_c_handles_assign(&m_imu[sensor], sensor, &db));
+    m_sensors[sensor].connected = true;
+}
+
+static void sensor_disconnect(uint8_t sensor)
+{
+    ble_evt_t evt = { .header.evt_id = BLE_GAP_EVT_DISCONNECTED };
+    evt.evt.gap_evt.conn_handle = sensor;
+    evt.evt.gap_evt.params.disconnected.reason = 0x08;     // Supervision timeout
+    ble_evt_dispatch(&evt);
+
+    m_sensors[sensor].connected = false;
+}
+
+static uint16_t notif_payload(uint8_t sensor, uint32_t notif, uint8_t * p_data)
+{
+    uint8_t samples = samples_per_notif(m_config.type);
+    uint32_t first_ms = (uint32_t) ((uint64_t) notif * samples * 1000 / m_config.rate_hz);
+    uint32_t step_ms = 1000 / m_config.rate_hz;
+    ble_evt_value_t value;
+
+    memset(&value, 0, sizeof(value));
+
+    switch (m_config.type)
+    {
+        case BLE_IMU_SERVICE_EVT_QUAT:
+            for (uint8_t i = 0; i < samples; i++)
+            {
+                ble_imu_service_single_quat_t * q = &value.quat_data.quat[i];
+                q->w = (1 << 30) - (int32_t) (notif * 4099 + i);
+                q->x = (int32_t) (sensor << 20) + (int32_t) i;
+                q->y = -(int32_t) (notif * 31);
+                q->z = (int32_t) rand() - RAND_MAX / 2;
+                q->timestamp_ms = first_ms + i * step_ms;
+            }
+            memcpy(p_data, &value, sizeof(ble_imu_service_quat_t));
+            return sizeof(ble_imu_service_quat_t);
+
+        case BLE_IMU_SERVICE_EVT_RAW:
+            for (uint8_t i = 0; i < samples; i++)
+            {
+                ble_imu_service_single_raw_t * r = &value.raw_data.single_raw[i];
+                r->accel.x = (int16_t) rand();
+                r->gyro.y = (int16_t) rand();
+                r->compass.z = (int16_t) rand();
+                r->timestamp_ms = first_ms + i * step_ms;
+            }
+            memcpy(p_data, &value, sizeof(ble_imu_service_raw_t));
+            return sizeof(ble_imu_service_raw_t);
+
+        case BLE_IMU_SERVICE_EVT_EULER:
+            value.euler_data.roll = (int32_t) (notif << 12);
+            value.euler_data.pitch = (int32_t) (sensor << 16);
+            value.euler_data.yaw = (int32_t) rand() - RAND_MAX / 2;
+            value.euler_data.timestamp_ms = first_ms;
+            memcpy(p_data, &value, sizeof(ble_imu_service_euler_t));
+            return sizeof(ble_imu_service_euler_t);
+
+        default:
+            for (uint8_t i = 0; i < samples; i++)
+            {
+                value.adc_data.raw[i] = (uint32_t) rand() & 0xFFFFFF;
+            }
+            value.adc_data.timestamp_ms = first_ms;
+            memcpy(p_data, &value, sizeof(ble_imu_service_adc_t));
+            return sizeof(ble_imu_service_adc_t);
+    }
+}
+
+static uint16_t notif_handle(void)
+{
+    switch (m_config.type)
+    {
+        case BLE_IMU_SERVICE_EVT_QUAT:
+            return SIM_HANDLE_QUAT;
+        case BLE_IMU_SERVICE_EVT_RAW:
+            return SIM_HANDLE_RAW;
+        case BLE_IMU_SERVICE_EVT_EULER:
+            return SIM_HANDLE_EULER;
+        default:
+            return SIM_HANDLE_ADC;
+    }
+}
+
+static void notif_deliver(uint8_t sensor, uint32_t notif)
+{
+    // The data array of the event is as long as the notification
+    static union
+    {
+        ble_evt_t evt;
+        uint8_t   raw[sizeof(ble_evt_t) + SIM_NOTIF_MAX_LEN];
+    } buf;
+    ble_evt_t * p_evt = &buf.evt;
+
+    memset(p_evt, 0, sizeof(ble_evt_t));
+    p_evt->header.evt_id = BLE_GATTC_EVT_HVX;
+    p_evt->evt.gattc_evt.conn_handle = sensor;
+    p_evt->evt.gattc_evt.params.hvx.handle = notif_handle();
+    p_evt->evt.gattc_evt.params.hvx.type = BLE_GATT_HVX_NOTIFICATION;
+    p_evt->evt.gattc_evt.params.hvx.len = notif_payload(sensor, notif, buf.raw + offsetof(ble_evt_t, evt.gattc_evt.params.hvx.data));
+
+    uint32_t notifs = mp_result->notifs;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ble_evt_dispatch(p_evt);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mp_result->cpu_ns += (double) (end.tv_sec - start.tv_sec) * 1e9 + (double) (end.tv_nsec - start.tv_nsec);
+
+    if (mp_result->notifs == notifs)
+    {
+        mp_result->ignored++;
+    }
+
+    uint32_t pending = uart_tx_pending();
+    mp_result->fifo_max = MAX(mp_result->fifo_max, pending);
+    mp_result->fifo_sum += pending;
+}
+
+static void sim_run(void)
+{
+    uint64_t period = notif_period_ns();
+    uint64_t end_ns = (uint64_t) m_config.seconds * 1000000000ULL;
+    uint64_t disconnect_ns = end_ns / 2;
+    uint64_t reconnect_ns = disconnect_ns + SIM_RECONNECT_MS * 1000000ULL;
+    uint8_t cycled = m_config.sensors - 1;
+    bool stale_sent = false;
+
+    srand(m_config.sensors * 1000 + m_config.rate_hz);
+    sdk_fake_uart_capture(uart_tx_done);
+    libuarte_init(uart_rx_scheduled);
+
+    for (uint8_t i = 0; i < m_config.sensors; i++)
+    {
+        ble_imu_service_c_init_t init = { .evt_handler = imu_evt_handler, .p_gatt_queue = &m_gatt_queue };
+        APP_ERROR_CHECK(ble_imu_service_c_init(&m_imu[i], &init));
+
+        sensor_connect(i);
+        // Sensors are not started at the same moment
+        m_sensors[i].phase_ns = rand_below((uint32_t) MIN(period, UINT32_MAX));
+        m_sensors[i].next_ns = m_sensors[i].phase_ns;
+    }
+
+    while (true)
+    {
+        uint8_t sensor = 0;
+        for (uint8_t i = 1; i < m_config.sensors; i++)
+        {
+            if (m_sensors[i].next_ns < m_sensors[sensor].next_ns)
+            {
+                sensor = i;
+            }
+        }
+
+        sim_sensor_t * p_sensor = &m_sensors[sensor];
+        if (p_sensor->next_ns >= end_ns)
+        {
+            break;
+        }
+
+        m_now_ns = p_sensor->next_ns;
+        sdk_fake_uart_run(m_now_ns);
+
+        if (m_sensors[cycled].connected && (m_now_ns >= disconnect_ns) && (m_now_ns < reconnect_ns))
+        {
+            sensor_disconnect(cycled);
+        }
+        else if (!m_sensors[cycled].connected && (m_now_ns >= reconnect_ns))
+        {
+            sensor_connect(cycled);
+        }
+
+        if (!p_sensor->connected && !stale_sent)
+        {
+            // Still in the SoftDevice queue when the link dropped
+            notif_deliver(sensor, p_sensor->notifs);
+            stale_sent = true;
+        }
+        else if (p_sensor->connected)
+        {
+            if (rand_below(100) < m_config.loss_pct)
+            {
+                mp_result->lost++;
+            }
+            else
+            {
+                notif_deliver(sensor, p_sensor->notifs);
+            }
+        }
+        p_sensor->notifs++;
+
+        // Jitter around the nominal time, notifications of a link stay in order
+        int64_t nominal = (int64_t) (p_sensor->phase_ns + p_sensor->notifs * period);
+        int64_t jitter_us = (int64_t) rand_below(2 * m_config.jitter_ms * 1000 + 1) - (int64_t) m_config.jitter_ms * 1000;
+        int64_t next = MAX(nominal + jitter_us * 1000, (int64_t) p_sensor->next_ns + 1);
+        p_sensor->next_ns = (uint64_t) next;
+    }
+
+    // Transmit what is left
+    while (uart_in_progress())
+    {
+        m_now_ns += 1000000;
+        sdk_fake_uart_run(m_now_ns);
+    }
+}
+
+// Every run in its own process, the modules start with fresh state
+static void sim(sim_config_t const * p_config, sim_result_t * p_result)
+{
+    fflush(stdout);
+    memset(mp_result, 0, sizeof(sim_result_t));
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        m_config = *p_config;
+        sim_run();
+        _exit(0);
+    }
+
+    int status;
+    if ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    {
+        printf("sim_fleet: run of %u sensors failed\n", (unsigned) p_config->sensors);
+        exit(1);
+    }
+    *p_result = *mp_result;
+}
+
+static bool saturated(sim_result_t const * p_result)
+{
+    return p_result->dropped > 0;
+}
+
+static void header_print(void)
+{
+    printf("sensors  rate  notif/s  frames/s  UART kB/s  FIFO avg/max  dropped  latency avg/max ms  ns/sample\n");
+}
+
+static void result_print(sim_config_t const * p_config, sim_result_t const * p_result)
+{
+    double seconds = p_config->seconds;
+
+    printf("%7u %5u %8.0f %9.0f %10.1f %7.0f/%-5u %8u %9.2f/%-8.2f %10.1f%s\n",
+           (unsigned) p_config->sensors, (unsigned) p_config->rate_hz,
+           p_result->notifs / seconds, p_result->frames / seconds, p_result->tx_bytes / seconds / 1000,
+           p_result->notifs ? (double) p_result->fifo_sum / p_result->notifs : 0.0, (unsigned) p_result->fifo_max,
+           (unsigned) p_result->dropped,
+           p_result->latency_count ? p_result->latency_sum_ns / 1e6 / p_result->latency_count : 0.0,
+           p_result->latency_max_ns / 1e6,
+           p_result->samples ? p_result->cpu_ns / p_result->samples : 0.0,
+           saturated(p_result) ? "  saturated" : "");
+
+    if ((p_result->bad_frames > 0) || (p_result->ignored != 1))
+    {
+        printf("sim_fleet: %u bad frames, %u notifications after the disconnect\n",
+               (unsigned) p_result->bad_frames, (unsigned) p_result->ignored);
+    }
+}
+
+static bool type_parse(char const * p_name, ble_imu_service_c_evt_type_t * p_type)
+{
+    static struct
+    {
+        char const * p_name;
+        ble_imu_service_c_evt_type_t type;
+    } const types[] =
+    {
+        { "quat", BLE_IMU_SERVICE_EVT_QUAT },
+        { "raw", BLE_IMU_SERVICE_EVT_RAW },
+        { "euler", BLE_IMU_SERVICE_EVT_EULER },
+        { "emg", BLE_IMU_SERVICE_EVT_ADC },
+    };
+
+    for (uint8_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if (strcmp(p_name, types[i].p_name) == 0)
+        {
+            *p_type = types[i].type;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char * argv[])
+{
+    sim_config_t config = { .sensors = 1, .rate_hz = 100, .type = BLE_IMU_SERVICE_EVT_QUAT,
+                            .jitter_ms = 5, .loss_pct = 1, .seconds = SIM_SECONDS };
+    sim_result_t result;
+
+    mp_result = mmap(NULL, sizeof(sim_result_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mp_result == MAP_FAILED)
+    {
+        return 1;
+    }
+
+    if (argc >= 3)
+    {
+        config.sensors = (uint8_t) atoi(argv[1]);
+        config.rate_hz = (uint16_t) atoi(argv[2]);
+        if (((argc > 3) && !type_parse(argv[3], &config.type)) ||
+            (config.sensors == 0) || (config.sensors > SIM_SENSORS_MAX) || (config.rate_hz == 0))
+        {
+            printf("usage: sim_fleet [<sensors 1-%u> <rate_hz> [quat|raw|euler|emg] [jitter_ms] [loss_pct] [s]]\n",
+                   (unsigned) SIM_SENSORS_MAX);
+            return 2;
+        }
+        config.jitter_ms = (argc > 4) ? (uint16_t) atoi(argv[4]) : config.jitter_ms;
+        config.loss_pct = (argc > 5) ? (uint8_t) atoi(argv[5]) : config.loss_pct;
+        config.seconds = (argc > 6) ? (uint32_t) atoi(argv[6]) : config.seconds;
+
+        header_print();
+        sim(&config, &result);
+        result_print(&config, &result);
+        return 0;
+    }
+
+    // Quaternions at the rates of the sensors, up to the link count
+    static uint16_t const rates[] = { 100, 200, 400 };
+
+    printf("Quaternions, %u ms jitter, %u %% loss, %u s per run, UART 1 Mbaud\n",
+           (unsigned) config.jitter_ms, (unsigned) config.loss_pct, (unsigned) config.seconds);
+    header_print();
+
+    for (uint8_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        sim_result_t last;
+
+        config.rate_hz = rates[r];
+        for (config.sensors = 1; config.sensors <= SIM_SENSORS_MAX; config.sensors++)
+        {
+            sim(&config, &result);
+            if (saturated(&result))
+            {
+                break;
+            }
+            last = result;
+        }
+
+        // The last run without drops and the first with
+        if (config.sensors > 1)
+        {
+            config.sensors--;
+            result_print(&config, &last);
+            config.sensors++;
+        }
+        if (config.sensors <= SIM_SENSORS_MAX)
+        {
+            result_print(&config, &result);
+        }
+    }
+
+    return 0;
+}
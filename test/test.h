@@ -0,0 +1,57 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: test.h
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Assertions of the host tests
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+
+static int m_checks = 0;
+static int m_failures = 0;
+
+// Keeps running after a failure, main returns TEST_RESULT()
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        m_checks++;                                                             \
+        if (!(cond)) {                                                          \
+            m_failures++;                                                       \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+    do {                                                                        \
+        long long _a = (long long) (a), _b = (long long) (b);                   \
+        m_checks++;                                                             \
+        if (_a != _b) {                                                         \
+            m_failures++;                                                       \
+            printf("%s:%d: %s == %s failed (%lld != %lld)\n",                   \
+                   __FILE__, __LINE__, #a, #b, _a, _b);                         \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RESULT(name)                                                       \
+    (printf("%s: %d checks, %d failed\n", (name), m_checks, m_failures),        \
+     (m_failures == 0) ? 0 : 1)
+
+#endif
@@ -0,0 +1,292 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: test_frame.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host tests of the UART framing core (usr_frame)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "test.h"
+#include "usr_frame.h"
+
+#define Q16(deg)                    ((int32_t) ((deg) * 65536.0))
+
+static uint64_t get_u64(uint8_t const * p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Every frame: start byte, length byte, DATA, sensor, type and a valid CS
+static void check_data_frame(uint8_t const * p_frame, uint32_t len, uint32_t expected_len, uint8_t sensor_nr, uint8_t type)
+{
+    CHECK_EQ(len, expected_len);
+    CHECK_EQ(p_frame[0], START_BYTE);
+    CHECK_EQ(p_frame[1], len);
+    CHECK_EQ(p_frame[2], DATA);
+    CHECK_EQ(p_frame[3], sensor_nr);
+    CHECK_EQ(p_frame[4], type);
+    CHECK_EQ(p_frame[len-1], usr_frame_cs(p_frame, len));
+}
+
+static void test_cs(void)
+{
+    uint8_t frame[] = { 0x73, 0x06, 0x02, 0x10, 0xA5, 0x00 };
+
+    CHECK_EQ(usr_frame_cs(frame, sizeof(frame)), 0x73 ^ 0x06 ^ 0x02 ^ 0x10 ^ 0xA5);
+
+    // The CS byte itself is not included
+    frame[5] = 0xFF;
+    CHECK_EQ(usr_frame_cs(frame, sizeof(frame)), 0x73 ^ 0x06 ^ 0x02 ^ 0x10 ^ 0xA5);
+
+    uint8_t single[] = { 0x42 };
+    CHECK_EQ(usr_frame_cs(single, sizeof(single)), 0);
+}
+
+static void test_total_time(void)
+{
+    CHECK_EQ(usr_frame_total_time(1000, 20, 300), 1320);
+    CHECK_EQ(usr_frame_total_time(1700000000000ULL, 2000, 0), 1700000002000ULL);
+}
+
+static void test_q_to_float(void)
+{
+    CHECK(usr_frame_q_to_float(1L << 30, 30) == 1.0f);
+    CHECK(usr_frame_q_to_float(-(1L << 29), 30) == -0.5f);
+    CHECK(usr_frame_q_to_float(3 << 16, 16) == 3.0f);
+    CHECK(usr_frame_q_to_float(0, 30) == 0.0f);
+}
+
+static void test_centideg(void)
+{
+    CHECK_EQ(usr_frame_centideg(0), 0);
+    CHECK_EQ(usr_frame_centideg(Q16(90)), 9000);
+    CHECK_EQ(usr_frame_centideg(Q16(-45.5)), -4550);
+    CHECK_EQ(usr_frame_centideg(Q16(180)), 18000);
+    CHECK_EQ(usr_frame_centideg(Q16(-180)), -18000);
+
+    // Wrapped to -180.00 .. 180.00
+    CHECK_EQ(usr_frame_centideg(Q16(190)), -17000);
+    CHECK_EQ(usr_frame_centideg(Q16(-190)), 17000);
+    CHECK_EQ(usr_frame_centideg(Q16(370)), 1000);
+    CHECK_EQ(usr_frame_centideg(Q16(-370)), -1000);
+    CHECK_EQ(usr_frame_centideg(Q16(720)), 0);
+
+    // Rounded to the nearest 0.01 degree
+    CHECK_EQ(usr_frame_centideg(Q16(12.344)), 1234);
+    CHECK_EQ(usr_frame_centideg(Q16(12.346)), 1235);
+    CHECK_EQ(usr_frame_centideg(Q16(-12.346)), -1235);
+}
+
+static void test_battery(void)
+{
+    CHECK_EQ(usr_frame_battery_mv(0), USR_FRAME_BATTERY_MV_MIN);
+    CHECK_EQ(usr_frame_battery_mv(255), USR_FRAME_BATTERY_MV_MAX);
+    CHECK_EQ(usr_frame_battery_mv(128), 3502);
+
+    // Steps of the discharge curve: the first level at or above 4100 mV, 3300 mV, ...
+    CHECK_EQ(usr_frame_battery_percent(255), 100);
+    CHECK_EQ(usr_frame_battery_percent(237), 100);
+    CHECK_EQ(usr_frame_battery_percent(236), 90);
+    CHECK_EQ(usr_frame_battery_percent(92), 10);
+    CHECK_EQ(usr_frame_battery_percent(91), 0);
+    CHECK_EQ(usr_frame_battery_percent(0), 0);
+
+    // Every level at or above the voltage of its step, never decreasing with the level
+    uint8_t last = 0;
+    for (uint32_t raw = 0; raw <= 255; raw++)
+    {
+        uint8_t percent = usr_frame_battery_percent((uint8_t) raw);
+        uint16_t mv = usr_frame_battery_mv((uint8_t) raw);
+
+        CHECK(percent >= last);
+        if (percent == 100) CHECK(mv >= 4100);
+        if (percent == 0) CHECK(mv < 3300);
+        last = percent;
+    }
+}
+
+static void test_rate(void)
+{
+    CHECK_EQ(usr_frame_rate(0, 1000), 0);
+    CHECK_EQ(usr_frame_rate(500, 1000), 500);
+    CHECK_EQ(usr_frame_rate(333, 2000), 166);
+    CHECK_EQ(usr_frame_rate(100, 0), 0);
+
+    // Limited to 16 bit, no overflow of count * 1000
+    CHECK_EQ(usr_frame_rate(70000, 1000), UINT16_MAX);
+    CHECK_EQ(usr_frame_rate(UINT32_MAX, 1), UINT16_MAX);
+    CHECK_EQ(usr_frame_rate(UINT32_MAX, UINT32_MAX), 1000);
+}
+
+static void test_ns_per_sample(void)
+{
+    CHECK_EQ(usr_frame_ns_per_sample(0, 64, 10), 0);
+    CHECK_EQ(usr_frame_ns_per_sample(6400, 64, 10), 10000);
+    CHECK_EQ(usr_frame_ns_per_sample(6400, 64, 0), 0);
+    CHECK_EQ(usr_frame_ns_per_sample(6400, 0, 10), 0);
+
+    // No overflow of cycles * 1000
+    CHECK_EQ(usr_frame_ns_per_sample(UINT32_MAX, 64, 1000), 67108863);
+}
+
+static void test_quat(void)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    stm32_quat_t q = { 1 << 30, -123456, 7, -(1 << 29) };
+    uint64_t time = 0x0102030405060708ULL;
+
+    uint32_t len = usr_frame_quat(frame, 3, &q, time);
+    check_data_frame(frame, len, USR_FRAME_QUAT_LEN, 3, QUATERNIONS);
+
+    CHECK(memcmp(&frame[PACKET_DATA_PLACEHOLDER], &q, sizeof(q)) == 0);
+    CHECK_EQ(get_u64(&frame[PACKET_DATA_PLACEHOLDER + sizeof(q)]), time);
+}
+
+static void test_euler(void)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    int32_t q16[3] = { Q16(10.5), Q16(-90), Q16(270) };
+    int16_t angles[3];
+
+    uint32_t len = usr_frame_euler(frame, 0, q16, 42);
+    check_data_frame(frame, len, USR_FRAME_EULER_LEN, 0, EULER);
+
+    memcpy(angles, &frame[PACKET_DATA_PLACEHOLDER], sizeof(angles));
+    CHECK_EQ(angles[0], 1050);
+    CHECK_EQ(angles[1], -9000);
+    CHECK_EQ(angles[2], -9000);
+    CHECK_EQ(get_u64(&frame[PACKET_DATA_PLACEHOLDER + sizeof(angles)]), 42);
+}
+
+static void test_raw(void)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    stm32_raw_t raw = { { 1, -2, 3 }, { -4, 5, -6 }, { 7, -8, 9 } };
+
+    uint32_t len = usr_frame_raw(frame, 19, &raw, 1234567);
+    check_data_frame(frame, len, USR_FRAME_RAW_LEN, 19, RAW);
+
+    CHECK(memcmp(&frame[PACKET_DATA_PLACEHOLDER], &raw, sizeof(raw)) == 0);
+    CHECK_EQ(get_u64(&frame[PACKET_DATA_PLACEHOLDER + sizeof(raw)]), 1234567);
+}
+
+static void test_emg(void)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t samples[8] = { 0, 1, 0x123456, 0xABCDEF, 0xFFFFFF, 0x01000002, 6, 7 };
+    uint8_t first = 2;
+    uint8_t count = 4;
+
+    uint32_t len = usr_frame_emg(frame, 5, 99, samples, first, count);
+    check_data_frame(frame, len, USR_FRAME_EMG_LEN(count), 5, EMG);
+
+    uint8_t const * p = &frame[PACKET_DATA_PLACEHOLDER];
+    CHECK_EQ(get_u64(p), 99);
+    p += sizeof(uint64_t);
+    CHECK_EQ(p[0], first);
+    CHECK_EQ(p[1], count);
+    CHECK_EQ(p[2], EMG_SAMPLE_BYTES);
+    p += 3;
+
+    // Little endian, EMG_SAMPLE_BYTES per sample
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t sample = 0;
+        for (uint8_t b = 0; b < EMG_SAMPLE_BYTES; b++)
+        {
+            sample |= (uint32_t) p[i*EMG_SAMPLE_BYTES + b] << (8*b);
+        }
+
+        uint32_t expected = samples[first + i];
+        #if (EMG_SAMPLE_BYTES == 2)
+        expected = (expected > UINT16_MAX) ? UINT16_MAX : expected;
+        #else
+        expected &= (1UL << (8*EMG_SAMPLE_BYTES)) - 1;
+        #endif
+        CHECK_EQ(sample, expected);
+    }
+}
+
+static uint32_t config_frame(uint8_t * p_frame, uint8_t cmd)
+{
+    uint32_t len = CONFIG_PACKET_DATA_OFFSET + 2;
+
+    p_frame[0] = START_BYTE;
+    p_frame[1] = (uint8_t) len;
+    p_frame[2] = CONFIG;
+    p_frame[3] = cmd;
+    p_frame[len-1] = usr_frame_cs(p_frame, len);
+
+    return len;
+}
+
+static void test_rx_check(void)
+{
+    uint8_t frame[USR_INTERNAL_COMM_MAX_LEN];
+    uint32_t len;
+
+    len = config_frame(frame, COMM_CMD_REQ_TELEMETRY);
+    CHECK_EQ(usr_frame_rx_check(frame, len), USR_FRAME_RX_OK);
+
+    CHECK_EQ(usr_frame_rx_check(frame, 0), USR_FRAME_RX_START);
+
+    len = config_frame(frame, COMM_CMD_REQ_TELEMETRY);
+    frame[0] = 0x00;
+    CHECK_EQ(usr_frame_rx_check(frame, len), USR_FRAME_RX_START);
+
+    len = config_frame(frame, COMM_CMD_REQ_TELEMETRY);
+    CHECK_EQ(usr_frame_rx_check(frame, len - 1), USR_FRAME_RX_LEN);
+    CHECK_EQ(usr_frame_rx_check(frame, CONFIG_PACKET_DATA_OFFSET), USR_FRAME_RX_LEN);
+
+    len = config_frame(frame, COMM_CMD_REQ_TELEMETRY);
+    frame[len-1] ^= 0x01;
+    CHECK_EQ(usr_frame_rx_check(frame, len), USR_FRAME_RX_CS);
+
+    len = config_frame(frame, COMM_CMD_REQ_TELEMETRY);
+    frame[2] = DATA;
+    frame[len-1] = usr_frame_cs(frame, len);
+    CHECK_EQ(usr_frame_rx_check(frame, len), USR_FRAME_RX_COMMAND);
+
+    // A frame built by the encoders is not a command
+    stm32_quat_t q = { 1 << 30, 0, 0, 0 };
+    len = usr_frame_quat(frame, 0, &q, 0);
+    CHECK_EQ(usr_frame_rx_check(frame, len), USR_FRAME_RX_COMMAND);
+}
+
+int main(void)
+{
+    test_cs();
+    test_total_time();
+    test_q_to_float();
+    test_centideg();
+    test_battery();
+    test_rate();
+    test_ns_per_sample();
+    test_quat();
+    test_euler();
+    test_raw();
+    test_emg();
+    test_rx_check();
+
+    return TEST_RESULT("test_frame");
+}
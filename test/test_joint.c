@@ -0,0 +1,308 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: test_joint.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Host tests of the relative orientation of sensor pairs (usr_joint)
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test.h"
+#include "usr_joint.h"
+
+#define REF_PAIRS                   1000000
+#define MAX_Q30_ERROR               2       // LSB
+#define MAX_ANGLE_ERROR             0.52    // 0.01 degrees
+// Roll and yaw are not defined at +-90 degrees pitch, checked below this
+#define GIMBAL_PITCH_DEG            85.0
+
+#define PERIOD_MS                   10
+#define SAMPLES_PER_NOTIFICATION    3
+
+static uint64_t m_rng = 0x9E3779B97F4A7C15ULL;
+
+static usr_joint_result_t m_results[64];
+static uint32_t m_result_count = 0;
+
+// xorshift64*, reproducible over hosts
+static double rand_unit(void)
+{
+    m_rng ^= m_rng >> 12;
+    m_rng ^= m_rng << 25;
+    m_rng ^= m_rng >> 27;
+    return (double) ((m_rng * 0x2545F4914F6CDD1DULL) >> 11) / (double) (1ULL << 53);
+}
+
+// Uniform random rotation (Shoemake), rounded to Q30
+static void rand_quat(usr_quat_q30_t * p_q)
+{
+    double u1 = rand_unit(), u2 = 2.0 * M_PI * rand_unit(), u3 = 2.0 * M_PI * rand_unit();
+    double s1 = sqrt(1.0 - u1), s2 = sqrt(u1);
+
+    p_q->w = (int32_t) lround(s1 * sin(u2) * USR_JOINT_Q30_ONE);
+    p_q->x = (int32_t) lround(s1 * cos(u2) * USR_JOINT_Q30_ONE);
+    p_q->y = (int32_t) lround(s2 * sin(u3) * USR_JOINT_Q30_ONE);
+    p_q->z = (int32_t) lround(s2 * cos(u3) * USR_JOINT_Q30_ONE);
+}
+
+// In Q30 LSB, not rounded
+static void ref_relative(usr_quat_q30_t const * p_a, usr_quat_q30_t const * p_b, double rel[4])
+{
+    double aw = p_a->w, ax = -(double) p_a->x, ay = -(double) p_a->y, az = -(double) p_a->z;
+    double bw = p_b->w, bx = p_b->x, by = p_b->y, bz = p_b->z;
+    double scale = (double) USR_JOINT_Q30_ONE;
+
+    rel[0] = (aw*bw - ax*bx - ay*by - az*bz) / scale;
+    rel[1] = (aw*bx + ax*bw + ay*bz - az*by) / scale;
+    rel[2] = (aw*by - ax*bz + ay*bw + az*bx) / scale;
+    rel[3] = (aw*bz + ax*by - ay*bx + az*bw) / scale;
+}
+
+static void ref_angles(usr_quat_q30_t const * p_q, double angles[3])
+{
+    double w = p_q->w / (double) USR_JOINT_Q30_ONE;
+    double x = p_q->x / (double) USR_JOINT_Q30_ONE;
+    double y = p_q->y / (double) USR_JOINT_Q30_ONE;
+    double z = p_q->z / (double) USR_JOINT_Q30_ONE;
+    double sin_pitch = fmax(-1.0, fmin(1.0, 2.0 * (w*y - z*x)));
+
+    angles[0] = atan2(2.0 * (w*x + y*z), 1.0 - 2.0 * (x*x + y*y)) * 18000.0 / M_PI;
+    angles[1] = asin(sin_pitch) * 18000.0 / M_PI;
+    angles[2] = atan2(2.0 * (w*z + x*y), 1.0 - 2.0 * (y*y + z*z)) * 18000.0 / M_PI;
+}
+
+// Error of an angle in 0.01 degrees, over the +-180 degrees wrap
+static double angle_error(int16_t value, double ref)
+{
+    double diff = fabs(value - ref);
+    return fmin(diff, 36000.0 - diff);
+}
+
+static void test_relative_reference(void)
+{
+    double max_q30 = 0.0;
+    double max_angle = 0.0;
+    uint32_t negative_w = 0;
+
+    for (uint32_t i = 0; i < REF_PAIRS; i++)
+    {
+        usr_quat_q30_t a, b, rel;
+        double ref[4];
+
+        rand_quat(&a);
+        rand_quat(&b);
+        usr_joint_relative(&a, &b, &rel);
+        ref_relative(&a, &b, ref);
+
+        if (rel.w < 0)
+        {
+            negative_w++;
+        }
+
+        // q and -q are the same rotation, compare with the sign that was kept
+        double sign = ((ref[0] < 0.0) && (rel.w >= 0)) || ((ref[0] > 0.0) && (rel.w < 0)) ? -1.0 : 1.0;
+        int32_t const * p_rel = &rel.w;
+        for (uint8_t k = 0; k < 4; k++)
+        {
+            max_q30 = fmax(max_q30, fabs(p_rel[k] - sign * ref[k]));
+        }
+
+        int16_t angles[3];
+        double ref_ang[3];
+        usr_joint_angles(&rel, angles);
+        ref_angles(&rel, ref_ang);
+
+        max_angle = fmax(max_angle, angle_error(angles[1], ref_ang[1]));
+        if (fabs(ref_ang[1]) < GIMBAL_PITCH_DEG * 100.0)
+        {
+            max_angle = fmax(max_angle, angle_error(angles[0], ref_ang[0]));
+            max_angle = fmax(max_angle, angle_error(angles[2], ref_ang[2]));
+        }
+    }
+
+    printf("relative: max error %.2f LSB, angles: max error %.3f (0.01 deg) over %d pairs\n",
+           max_q30, max_angle, REF_PAIRS);
+
+    CHECK_EQ(negative_w, 0);
+    CHECK(max_q30 <= MAX_Q30_ERROR);
+    CHECK(max_angle <= MAX_ANGLE_ERROR);
+}
+
+static void test_angles(void)
+{
+    usr_quat_q30_t identity = { USR_JOINT_Q30_ONE, 0, 0, 0 };
+    int16_t angles[3];
+
+    usr_joint_angles(&identity, angles);
+    CHECK_EQ(angles[0], 0);
+    CHECK_EQ(angles[1], 0);
+    CHECK_EQ(angles[2], 0);
+
+    // 90 degrees about each axis
+    int32_t c = (int32_t) lround(M_SQRT1_2 * USR_JOINT_Q30_ONE);
+    usr_quat_q30_t roll = { c, c, 0, 0 };
+    usr_quat_q30_t yaw = { c, 0, 0, -c };
+    usr_quat_q30_t pitch = { c, 0, c, 0 };
+
+    usr_joint_angles(&roll, angles);
+    CHECK_EQ(angles[0], 9000);
+    CHECK_EQ(angles[2], 0);
+
+    usr_joint_angles(&yaw, angles);
+    CHECK_EQ(angles[0], 0);
+    CHECK_EQ(angles[2], -9000);
+
+    // Clamped at the pole, no NaN
+    usr_joint_angles(&pitch, angles);
+    CHECK_EQ(angles[1], 9000);
+}
+
+static void result_handler(usr_joint_result_t const * p_result)
+{
+    if (m_result_count < sizeof(m_results) / sizeof(m_results[0]))
+    {
+        m_results[m_result_count] = *p_result;
+    }
+    m_result_count++;
+}
+
+static void notify(uint8_t slot, uint32_t first_ms, uint8_t count)
+{
+    usr_joint_sample_t samples[SAMPLES_PER_NOTIFICATION];
+    usr_quat_q30_t identity = { USR_JOINT_Q30_ONE, 0, 0, 0 };
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        samples[i].q = identity;
+        samples[i].timestamp_ms = first_ms + i * PERIOD_MS;
+    }
+    usr_joint_on_quat(slot, samples, count);
+}
+
+static void pairs_setup(void)
+{
+    usr_joint_pair_t pair = { .slot_a = 0, .slot_b = 1, .outputs = USR_JOINT_OUT_QUAT | USR_JOINT_OUT_ANGLES };
+
+    usr_joint_init(result_handler);
+    CHECK(usr_joint_pairs_set(&pair, 1, 2));
+    m_result_count = 0;
+}
+
+// Every sample of sensor b is handled once, in order
+static void check_aligned(uint32_t notifications, uint32_t b_offset_ms)
+{
+    uint32_t expected = notifications * SAMPLES_PER_NOTIFICATION;
+
+    CHECK_EQ(m_result_count, expected);
+    for (uint32_t i = 0; (i < m_result_count) && (i < expected); i++)
+    {
+        CHECK_EQ(m_results[i].pair, 0);
+        CHECK_EQ(m_results[i].timestamp_ms, 1000 + b_offset_ms + i * PERIOD_MS);
+        CHECK_EQ(m_results[i].q.w, USR_JOINT_Q30_ONE);
+    }
+}
+
+static void test_alignment(void)
+{
+    uint32_t const notifications = 5;
+    uint32_t const step = SAMPLES_PER_NOTIFICATION * PERIOD_MS;
+
+    // Sensor a first
+    pairs_setup();
+    for (uint32_t n = 0; n < notifications; n++)
+    {
+        notify(0, 1000 + n * step, SAMPLES_PER_NOTIFICATION);
+        notify(1, 1000 + 2 + n * step, SAMPLES_PER_NOTIFICATION);
+    }
+    check_aligned(notifications, 2);
+
+    // Sensor b first, its samples wait for sensor a
+    pairs_setup();
+    for (uint32_t n = 0; n < notifications; n++)
+    {
+        notify(1, 1000 + 3 + n * step, SAMPLES_PER_NOTIFICATION);
+        notify(0, 1000 + n * step, SAMPLES_PER_NOTIFICATION);
+    }
+    check_aligned(notifications, 3);
+
+    // Skew of USR_JOINT_MAX_SKEW_MS is still combined
+    pairs_setup();
+    for (uint32_t n = 0; n < notifications; n++)
+    {
+        notify(0, 1000 + n * step, SAMPLES_PER_NOTIFICATION);
+        notify(1, 1000 + USR_JOINT_MAX_SKEW_MS + n * step, SAMPLES_PER_NOTIFICATION);
+    }
+    check_aligned(notifications, USR_JOINT_MAX_SKEW_MS);
+
+    // Clocks far apart, nothing is combined
+    pairs_setup();
+    for (uint32_t n = 0; n < notifications; n++)
+    {
+        notify(0, 1500 + n * step, SAMPLES_PER_NOTIFICATION);
+        notify(1, 1000 + n * step, SAMPLES_PER_NOTIFICATION);
+    }
+    CHECK_EQ(m_result_count, 0);
+
+    // A forgotten sensor is not matched with its old samples
+    pairs_setup();
+    notify(0, 1000, SAMPLES_PER_NOTIFICATION);
+    usr_joint_forget(0);
+    notify(1, 1000, SAMPLES_PER_NOTIFICATION);
+    CHECK_EQ(m_result_count, 0);
+}
+
+static void test_pairs_set(void)
+{
+    usr_joint_pair_t pairs[USR_JOINT_PAIRS_MAX + 1];
+
+    usr_joint_init(result_handler);
+
+    for (uint8_t i = 0; i < USR_JOINT_PAIRS_MAX + 1; i++)
+    {
+        pairs[i].slot_a = i;
+        pairs[i].slot_b = i + 1;
+        pairs[i].outputs = USR_JOINT_OUT_QUAT;
+    }
+
+    CHECK(usr_joint_pairs_set(pairs, USR_JOINT_PAIRS_MAX, USR_JOINT_PAIRS_MAX + 1));
+    CHECK(!usr_joint_pairs_set(pairs, USR_JOINT_PAIRS_MAX + 1, USR_JOINT_PAIRS_MAX + 2));
+    CHECK(!usr_joint_pairs_set(pairs, 1, 1));
+    CHECK(usr_joint_pairs_set(pairs, 0, 0));
+
+    usr_joint_pair_t same = { .slot_a = 1, .slot_b = 1, .outputs = USR_JOINT_OUT_QUAT };
+    CHECK(!usr_joint_pairs_set(&same, 1, 2));
+
+    usr_joint_pair_t no_output = { .slot_a = 0, .slot_b = 1, .outputs = 0 };
+    CHECK(!usr_joint_pairs_set(&no_output, 1, 2));
+
+    usr_joint_pair_t unknown_output = { .slot_a = 0, .slot_b = 1, .outputs = 0x80 };
+    CHECK(!usr_joint_pairs_set(&unknown_output, 1, 2));
+}
+
+int main(void)
+{
+    test_relative_reference();
+    test_angles();
+    test_alignment();
+    test_pairs_set();
+
+    return TEST_RESULT("test_joint");
+}
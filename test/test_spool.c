@@ -0,0 +1,481 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: test_spool.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Unit tests of usr_spool on a RAM flash (sdk/sdk_fake.c)
+ *
+ *               Every boot runs in a forked process, so the module starts with
+ *               fresh state while the flash keeps what was programmed before:
+ *               power loss is exiting a boot with flash operations pending.
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "sdk_fake.h"
+#include "usr_spool.h"
+
+#define PAGE_MAGIC                  0x4C4F5053
+#define PAGE_HDR_LEN                12
+#define RECORD_HDR_LEN              5
+#define FRAME_LEN                   20
+#define FRAME_MAX_LEN               256
+#define FRAMES_PER_PAGE             ((USR_SPOOL_PAGE_SIZE - PAGE_HDR_LEN) / (RECORD_HDR_LEN + FRAME_LEN))
+
+typedef struct
+{
+    int checks;
+    int failures;
+} boot_result_t;
+
+static boot_result_t * m_boot_result;
+static uint32_t m_drain_calls;
+
+
+static void drain_handler(void)
+{
+    m_drain_calls++;
+}
+
+// Runs one boot of the device, in a child process
+static void boot(void (*body)(void))
+{
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        m_checks = 0;
+        m_failures = 0;
+
+        usr_spool_init(drain_handler);
+        body();
+
+        m_boot_result->checks = m_checks;
+        m_boot_result->failures = m_failures;
+        fflush(stdout);
+        _exit(0);
+    }
+
+    int status;
+    CHECK(waitpid(pid, &status, 0) == pid);
+    CHECK(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+    m_checks += m_boot_result->checks;
+    m_failures += m_boot_result->failures;
+    m_boot_result->checks = 0;
+    m_boot_result->failures = 0;
+}
+
+static void frame_fill(uint8_t * p_frame, uint32_t seq)
+{
+    for (uint8_t i = 0; i < FRAME_LEN; i++)
+    {
+        p_frame[i] = (uint8_t) (seq * 7 + i);
+    }
+}
+
+static void put(uint32_t first, uint32_t count)
+{
+    uint8_t frame[FRAME_LEN];
+
+    for (uint32_t seq = first; seq < first + count; seq++)
+    {
+        frame_fill(frame, seq);
+        usr_spool_put(seq, frame, FRAME_LEN);
+    }
+}
+
+// Puts with the flash keeping up, as when the writes finish between two notifications
+static void put_flushed(uint32_t first, uint32_t count)
+{
+    for (uint32_t seq = first; seq < first + count; seq++)
+    {
+        put(seq, 1);
+        sdk_fake_flash_process();
+    }
+}
+
+// Drains up to max frames, they must be in order starting at first
+static uint32_t drain_n(uint32_t first, uint32_t max)
+{
+    uint8_t frame[FRAME_MAX_LEN];
+    uint8_t expected[FRAME_LEN];
+    uint32_t seq;
+    uint8_t len;
+    uint32_t count = 0;
+    uint32_t bad = 0;
+
+    while ((count < max) && usr_spool_next(&seq, frame, &len))
+    {
+        frame_fill(expected, first + count);
+        if ((seq != first + count) || (len != FRAME_LEN) || (memcmp(frame, expected, FRAME_LEN) != 0))
+        {
+            bad++;
+        }
+        count++;
+    }
+    CHECK_EQ(bad, 0);
+
+    return count;
+}
+
+static uint32_t drain(uint32_t first)
+{
+    return drain_n(first, UINT32_MAX);
+}
+
+static uint32_t page_magic(uint16_t page)
+{
+    uint32_t magic;
+    memcpy(&magic, sdk_fake_flash() + USR_SPOOL_START + page * USR_SPOOL_PAGE_SIZE, sizeof(magic));
+    return magic;
+}
+
+static uint32_t page_seq(uint16_t page)
+{
+    uint32_t seq;
+    memcpy(&seq, sdk_fake_flash() + USR_SPOOL_START + page * USR_SPOOL_PAGE_SIZE + 4, sizeof(seq));
+    return seq;
+}
+
+// Programs one page and returns it, to find where a boot continues
+static uint16_t page_next_written(void)
+{
+    usr_spool_stats_t stats;
+
+    put_flushed(0, FRAMES_PER_PAGE + 1);
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages_written, 1);
+
+    uint16_t newest = 0;
+    for (uint16_t page = 0; page < USR_SPOOL_PAGES; page++)
+    {
+        if ((page_magic(page) == PAGE_MAGIC) && (page_seq(page) >= page_seq(newest)))
+        {
+            newest = page;
+        }
+    }
+    return newest;
+}
+
+static void boot_empty(void)
+{
+    usr_spool_stats_t stats;
+    uint8_t frame[FRAME_MAX_LEN];
+    uint32_t seq;
+    uint8_t len;
+
+    CHECK(!usr_spool_next(&seq, frame, &len));
+    CHECK_EQ(sdk_fake_timers_running(), 0);
+
+    // Frames in RAM only
+    put(100, 3);
+    CHECK_EQ(sdk_fake_timers_running(), 1);
+    CHECK_EQ(sdk_fake_flash_pending(), 0);
+
+    sdk_fake_timers_fire();
+    CHECK_EQ(m_drain_calls, 1);
+
+    CHECK_EQ(drain(100), 3);
+    CHECK_EQ(sdk_fake_timers_running(), 0);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages, 0);
+    CHECK_EQ(stats.pages_written, 0);
+    CHECK_EQ(stats.bytes_spooled, 3 * FRAME_LEN);
+    CHECK_EQ(stats.bytes_drained, 3 * FRAME_LEN);
+
+    // The drained buffer is reused
+    put(200, FRAMES_PER_PAGE);
+    CHECK_EQ(sdk_fake_flash_pending(), 0);
+    CHECK_EQ(drain(200), FRAMES_PER_PAGE);
+}
+
+static void test_empty(void)
+{
+    sdk_fake_flash_init();
+    boot(boot_empty);
+
+    // Nothing was programmed
+    CHECK(page_magic(0) != PAGE_MAGIC);
+}
+
+static void boot_drain_order(void)
+{
+    usr_spool_stats_t stats;
+    uint8_t frame[FRAME_MAX_LEN];
+    uint32_t seq;
+    uint8_t len;
+
+    // One page worth of frames stays in RAM
+    put(0, FRAMES_PER_PAGE);
+    CHECK_EQ(sdk_fake_flash_pending(), 0);
+
+    // The next one starts programming the page, the buffer being programmed is not read
+    put(FRAMES_PER_PAGE, 1);
+    CHECK_EQ(sdk_fake_flash_pending(), 1);
+    CHECK(!usr_spool_next(&seq, frame, &len));
+    CHECK_EQ(sdk_fake_timers_running(), 1);
+
+    sdk_fake_flash_process();
+    CHECK_EQ(page_magic(0), PAGE_MAGIC);
+    CHECK_EQ(page_seq(0), 0);
+
+    put_flushed(FRAMES_PER_PAGE + 1, 2 * FRAMES_PER_PAGE);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages, 3);
+    CHECK_EQ(stats.pages_written, 3);
+    CHECK_EQ(stats.overruns, 0);
+    CHECK_EQ(stats.errors, 0);
+    // Erase + write of the fake
+    CHECK((stats.write_ms_avg >= SDK_FAKE_ERASE_MS + SDK_FAKE_WRITE_MS_PER_PAGE - 1) &&
+          (stats.write_ms_avg <= SDK_FAKE_ERASE_MS + SDK_FAKE_WRITE_MS_PER_PAGE));
+    CHECK_EQ(stats.write_ms_max, stats.write_ms_avg);
+
+    // Flash pages oldest first, then the RAM buffer
+    CHECK_EQ(drain(0), 3 * FRAMES_PER_PAGE + 1);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages, 0);
+    CHECK_EQ(stats.bytes_drained, stats.bytes_spooled);
+    CHECK_EQ(sdk_fake_timers_running(), 0);
+}
+
+static void boot_drain_partial(void)
+{
+    usr_spool_stats_t stats;
+
+    // Partly drained from RAM before the page is programmed
+    put(0, FRAMES_PER_PAGE);
+    CHECK_EQ(drain_n(0, 10), 10);
+    put_flushed(FRAMES_PER_PAGE, 1);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages_written, 1);
+    CHECK_EQ(stats.pages, 1);
+
+    // The page is read from the first frame not drained yet
+    CHECK_EQ(drain(10), FRAMES_PER_PAGE + 1 - 10);
+}
+
+static void test_drain_order(void)
+{
+    sdk_fake_flash_init();
+    boot(boot_drain_order);
+    boot(boot_drain_partial);
+}
+
+static void boot_overrun(void)
+{
+    usr_spool_stats_t stats;
+
+    // The flash does not keep up: both buffers fill, the rest is dropped
+    put(0, 2 * FRAMES_PER_PAGE + 10);
+    CHECK_EQ(sdk_fake_flash_pending(), 1);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.overruns, 10);
+
+    sdk_fake_flash_process();
+    CHECK_EQ(drain(0), 2 * FRAMES_PER_PAGE);
+}
+
+static void boot_flash_error(void)
+{
+    usr_spool_stats_t stats;
+
+    // A failed erase loses that page, the spool keeps going
+    sdk_fake_flash_fail_next();
+    put_flushed(0, FRAMES_PER_PAGE + 1);
+    put_flushed(FRAMES_PER_PAGE + 1, FRAMES_PER_PAGE);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.errors, 1);
+    CHECK_EQ(stats.pages_written, 1);
+    CHECK_EQ(drain(FRAMES_PER_PAGE), FRAMES_PER_PAGE + 1);
+}
+
+static void test_overrun(void)
+{
+    sdk_fake_flash_init();
+    boot(boot_overrun);
+    boot(boot_flash_error);
+}
+
+static void boot_wrap(void)
+{
+    usr_spool_stats_t stats;
+    uint32_t pages = USR_SPOOL_PAGES + 2;
+
+    // Two pages more than the spool holds, the oldest two are given up
+    put_flushed(0, pages * FRAMES_PER_PAGE + 1);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages_written, pages);
+    CHECK_EQ(stats.pages, USR_SPOOL_PAGES);
+    CHECK_EQ(stats.lost, 2 * FRAMES_PER_PAGE);
+
+    // Written round robin: the first two pages hold the newest frames
+    CHECK_EQ(page_seq(0), USR_SPOOL_PAGES);
+    CHECK_EQ(page_seq(1), USR_SPOOL_PAGES + 1);
+    CHECK_EQ(page_seq(2), 2);
+
+    CHECK_EQ(drain(2 * FRAMES_PER_PAGE), USR_SPOOL_PAGES * FRAMES_PER_PAGE + 1);
+}
+
+static void boot_after_wrap(void)
+{
+    // Continues after the newest page, not at page 0
+    CHECK_EQ(page_next_written(), 2);
+    CHECK_EQ(page_seq(2), USR_SPOOL_PAGES + 2);
+}
+
+static void boot_last_page(void)
+{
+    // Fill up to the last page
+    put_flushed(0, (USR_SPOOL_PAGES - 3) * FRAMES_PER_PAGE + 1);
+    CHECK_EQ(page_seq(USR_SPOOL_PAGES - 1), 2 * USR_SPOOL_PAGES - 1);
+}
+
+static void boot_wrap_write_page(void)
+{
+    // The newest page is the last one, the write position wraps to page 0
+    CHECK_EQ(page_next_written(), 0);
+}
+
+static void boot_long_run(void)
+{
+    usr_spool_stats_t stats;
+
+    // The page counter of the stats wraps, the average write time does not
+    put_flushed(0, (UINT16_MAX + 2) * FRAMES_PER_PAGE + 1);
+
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages_written, 1);
+    CHECK_EQ(stats.pages, USR_SPOOL_PAGES);
+    CHECK((stats.write_ms_avg >= SDK_FAKE_ERASE_MS + SDK_FAKE_WRITE_MS_PER_PAGE - 1) &&
+          (stats.write_ms_avg <= SDK_FAKE_ERASE_MS + SDK_FAKE_WRITE_MS_PER_PAGE));
+}
+
+static void test_wrap(void)
+{
+    sdk_fake_flash_init();
+    boot(boot_wrap);
+    boot(boot_after_wrap);
+    boot(boot_last_page);
+    boot(boot_wrap_write_page);
+    boot(boot_long_run);
+}
+
+static void boot_three_pages(void)
+{
+    put_flushed(0, 3 * FRAMES_PER_PAGE + 1);
+    // Power lost with frames in RAM
+}
+
+static void boot_discard(void)
+{
+    uint8_t frame[FRAME_MAX_LEN];
+    uint32_t seq;
+    uint8_t len;
+    usr_spool_stats_t stats;
+
+    // Frames of the previous boot are not drained
+    CHECK(!usr_spool_next(&seq, frame, &len));
+    usr_spool_stats_get(&stats);
+    CHECK_EQ(stats.pages, 0);
+
+    CHECK_EQ(page_next_written(), 3);
+    CHECK_EQ(page_seq(3), 3);
+}
+
+static void boot_lost_during_erase(void)
+{
+    // Power lost after the erase, before the write
+    put(0, FRAMES_PER_PAGE + 1);
+    CHECK(sdk_fake_flash_step());
+    CHECK_EQ(sdk_fake_flash_pending(), 1);
+}
+
+static void boot_after_erase(void)
+{
+    // Page 4 is blank, page 3 is still the newest
+    CHECK(page_magic(4) != PAGE_MAGIC);
+    CHECK_EQ(page_next_written(), 4);
+    CHECK_EQ(page_seq(4), 4);
+}
+
+static void boot_lost_during_write(void)
+{
+    // Power lost with only the page header and a few records programmed
+    put(0, FRAMES_PER_PAGE + 1);
+    CHECK(sdk_fake_flash_step());
+    sdk_fake_flash_tear(PAGE_HDR_LEN + 4 * (RECORD_HDR_LEN + FRAME_LEN));
+}
+
+static void boot_after_write(void)
+{
+    uint8_t frame[FRAME_MAX_LEN];
+    uint32_t seq;
+    uint8_t len;
+
+    // The torn page has a header: its sequence number is used up
+    CHECK_EQ(page_magic(5), PAGE_MAGIC);
+    CHECK_EQ(page_seq(5), 5);
+    CHECK(!usr_spool_next(&seq, frame, &len));
+
+    CHECK_EQ(page_next_written(), 6);
+    CHECK_EQ(page_seq(6), 6);
+
+    // And the spool works as before
+    CHECK_EQ(drain(0), FRAMES_PER_PAGE + 1);
+}
+
+static void test_power_loss(void)
+{
+    sdk_fake_flash_init();
+    boot(boot_three_pages);
+    boot(boot_discard);
+    boot(boot_lost_during_erase);
+    boot(boot_after_erase);
+    boot(boot_lost_during_write);
+    boot(boot_after_write);
+}
+
+int main(void)
+{
+    m_boot_result = mmap(NULL, sizeof(boot_result_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (m_boot_result == MAP_FAILED)
+    {
+        return 1;
+    }
+
+    test_empty();
+    test_drain_order();
+    test_overrun();
+    test_wrap();
+    test_power_loss();
+
+    return TEST_RESULT("test_spool");
+}
@@ -0,0 +1,49 @@
+/*  ____  ____      _    __  __  ____ ___
+ * |  _ \|  _ \    / \  |  \/  |/ ___/ _ \
+ * | | | | |_) |  / _ \ | |\/| | |  | | | |
+ * | |_| |  _ <  / ___ \| |  | | |__| |_| |
+ * |____/|_| \_\/_/   \_\_|  |_|\____\___/
+ *                           research group
+ *                             dramco.be/
+ *
+ *  KU Leuven - Technology Campus Gent,
+ *  Gebroeders De Smetstraat 1,
+ *  B-9000 Gent, Belgium
+ *
+ *         File: usr_stubs.c
+ *      Created: 2026-10-19
+ *       Author: Jona Cappelle
+ *      Version: 1.0
+ *
+ *  Description: Stand-ins of the DCU modules the host tools do not build
+ *
+ *  Commissiond by Interreg NOMADe
+ *
+ */
+
+#include <stdint.h>
+
+#include "usr_evlog.h"
+#include "usr_gatt_sched.h"
+#include "usr_latency.h"
+#include "usr_prof.h"
+#include "usr_trace.h"
+
+void usr_trace_on_notif(uint16_t conn_handle, uint8_t evt_type, uint8_t const * p_data, uint16_t len) { }
+
+void usr_latency_ingest_begin(void) { }
+void usr_latency_ingest_end(void) { }
+void usr_latency_on_rx(void) { }
+void usr_latency_on_queued(uint8_t const * p_data, uint32_t len) { }
+void usr_latency_on_dma(uint32_t len) { }
+void usr_latency_on_tx_done(uint32_t len) { }
+
+void usr_evlog(usr_evlog_id_t id, uint16_t a, uint32_t b) { }
+
+uint32_t usr_prof_enter(void) { return 0; }
+void usr_prof_exit(usr_prof_handler_t handler, uint32_t start) { }
+
+ret_code_t usr_gatt_sched_write(uint16_t conn_handle, usr_gatt_prio_t prio, uint16_t handle, uint8_t const * p_value, uint16_t len)
+{
+    return NRF_SUCCESS;
+}